@@ -0,0 +1,307 @@
+#ifndef STAN_ANALYZE_MCMC_COMPUTE_RANK_NORMALIZED_DIAGNOSTICS_HPP
+#define STAN_ANALYZE_MCMC_COMPUTE_RANK_NORMALIZED_DIAGNOSTICS_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <stan/analyze/mcmc/compute_potential_scale_reduction.hpp>
+#include <boost/math/distributions/normal.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Rank normalized convergence diagnostics of each column of a set of
+ * draws, computed by <code>compute_rank_normalized_diagnostics</code>.
+ */
+struct rank_normalized_diagnostics {
+  /**
+   * Split R-hat of the rank normalized draws.
+   */
+  Eigen::VectorXd rhat_bulk;
+
+  /**
+   * Split R-hat of the rank normalized draws folded around the median.
+   */
+  Eigen::VectorXd rhat_tail;
+
+  /**
+   * Effective sample size of the rank normalized split chains.
+   */
+  Eigen::VectorXd ess_bulk;
+
+  /**
+   * Smaller of the effective sample sizes of the indicators of the draws
+   * not above the 5% and 95% quantiles of the split chains.
+   */
+  Eigen::VectorXd ess_tail;
+};
+
+namespace internal {
+
+/**
+ * Normal scores of the average ranks of <code>size</code> draws, as
+ * computed by <code>rank_transform</code>, indexed by twice the average
+ * rank, which is a multiple of one half.  They depend only on the
+ * number of draws, so every column shares them.
+ */
+inline std::vector<double> rank_normal_scores(size_t size) {
+  std::vector<double> scores(2 * size + 1,
+                             std::numeric_limits<double>::quiet_NaN());
+  boost::math::normal_distribution<double> dist;
+  for (size_t k = 2; k <= 2 * size; ++k) {
+    double avg_rank = k / 2.0;
+    double p = (avg_rank - 3.0 / 8.0) / (size - 2.0 * 3.0 / 8.0 + 1.0);
+    scores[k] = boost::math::quantile(dist, p);
+  }
+  return scores;
+}
+
+/**
+ * Type 7 quantile of sorted values, matching
+ * <code>stan::math::quantile</code>.
+ */
+inline double sorted_quantile(
+    const std::vector<std::pair<double, Eigen::Index>>& sorted, double p) {
+  double index = (sorted.size() - 1) * p;
+  size_t lo = std::floor(index);
+  size_t hi = std::ceil(index);
+  double h = index - lo;
+  return (1 - h) * sorted[lo].first + h * sorted[hi].first;
+}
+
+/**
+ * Write the normal scores of the average ranks of sorted values,
+ * averaging the ranks of ties, to the positions the values came from.
+ */
+inline void assign_rank_scores(
+    const std::vector<std::pair<double, Eigen::Index>>& sorted,
+    const std::vector<double>& scores, Eigen::MatrixXd& z) {
+  const Eigen::Index size = sorted.size();
+  for (Eigen::Index i = 0; i < size; ++i) {
+    Eigen::Index j = i + 1;
+    double sum_ranks = j;
+    Eigen::Index count = 1;
+    while (j < size && sorted[j].first == sorted[i].first) {
+      sum_ranks += j + 1;
+      ++j;
+      ++count;
+    }
+    const double score
+        = scores[static_cast<size_t>(2 * (sum_ranks / count))];
+    for (Eigen::Index k = i; k < j; ++k)
+      z(sorted[k].second) = score;
+    i = j - 1;
+  }
+}
+
+/**
+ * Buffers reused for the columns handled by one task.
+ */
+struct rank_workspace {
+  std::vector<std::pair<double, Eigen::Index>> sorted;
+  std::vector<std::pair<double, Eigen::Index>> folded;
+  Eigen::MatrixXd split;
+  Eigen::MatrixXd z;
+  Eigen::MatrixXd indicator;
+  std::vector<const double*> columns;
+  std::vector<size_t> sizes;
+};
+
+inline double split_ess(const Eigen::MatrixXd& x, rank_workspace& ws) {
+  for (Eigen::Index k = 0; k < x.cols(); ++k)
+    ws.columns[k] = x.col(k).data();
+  return compute_effective_sample_size(ws.columns, ws.sizes);
+}
+
+inline double indicator_ess(const Eigen::MatrixXd& split, double bound,
+                            rank_workspace& ws) {
+  ws.indicator = (split.array() <= bound).cast<double>().matrix();
+  return split_ess(ws.indicator, ws);
+}
+
+/**
+ * Computes the diagnostics of one column from its split chains, which
+ * the caller has copied to <code>ws.split</code>.
+ */
+inline void rank_normalized_column(const std::vector<double>& scores,
+                                   rank_workspace& ws, double& rhat_bulk,
+                                   double& rhat_tail, double& ess_bulk,
+                                   double& ess_tail) {
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  rhat_bulk = rhat_tail = ess_bulk = ess_tail = nan;
+  const Eigen::MatrixXd& split = ws.split;
+  const Eigen::Index size = split.size();
+  if (split.rows() < 2 || !split.allFinite()
+      || split.isApproxToConstant(split(0)))
+    return;
+
+  ws.sorted.resize(size);
+  for (Eigen::Index i = 0; i < size; ++i)
+    ws.sorted[i] = {split(i), i};
+  std::sort(ws.sorted.begin(), ws.sorted.end());
+
+  ws.z.resize(split.rows(), split.cols());
+  assign_rank_scores(ws.sorted, scores, ws.z);
+  rhat_bulk = rhat(ws.z);
+  ess_bulk = split_ess(ws.z, ws);
+
+  // The distances to the median are sorted by merging the values below
+  // the median, in reverse, with those above it
+  const double median = sorted_quantile(ws.sorted, 0.5);
+  Eigen::Index below = std::lower_bound(ws.sorted.begin(), ws.sorted.end(),
+                                        std::make_pair(median, Eigen::Index(0)))
+                       - ws.sorted.begin();
+  Eigen::Index above = below;
+  ws.folded.resize(size);
+  for (Eigen::Index k = 0; k < size; ++k) {
+    const double left = below > 0
+                            ? std::fabs(ws.sorted[below - 1].first - median)
+                            : std::numeric_limits<double>::infinity();
+    const double right = above < size
+                             ? std::fabs(ws.sorted[above].first - median)
+                             : std::numeric_limits<double>::infinity();
+    if (left < right) {
+      --below;
+      ws.folded[k] = {left, ws.sorted[below].second};
+    } else {
+      ws.folded[k] = {right, ws.sorted[above].second};
+      ++above;
+    }
+  }
+  assign_rank_scores(ws.folded, scores, ws.z);
+  rhat_tail = rhat(ws.z);
+
+  const double lower
+      = indicator_ess(split, sorted_quantile(ws.sorted, 0.05), ws);
+  const double upper
+      = indicator_ess(split, sorted_quantile(ws.sorted, 0.95), ws);
+  ess_tail = std::isnan(lower) || std::isnan(upper) ? nan
+                                                     : std::min(lower, upper);
+}
+
+/**
+ * Computes the diagnostics of every column, given a function which
+ * returns a pointer to the draws of a column in a chain.
+ */
+template <typename ColumnBegin>
+rank_normalized_diagnostics rank_normalized_columns(
+    Eigen::Index num_params, size_t num_chains, size_t num_draws,
+    const ColumnBegin& column_begin, size_t grain_size) {
+  rank_normalized_diagnostics result;
+  result.rhat_bulk.resize(num_params);
+  result.rhat_tail.resize(num_params);
+  result.ess_bulk.resize(num_params);
+  result.ess_tail.resize(num_params);
+  const size_t half = num_draws / 2;
+  const size_t second_half = num_draws - half;
+  const std::vector<double> scores = rank_normal_scores(2 * num_chains * half);
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, num_params,
+                                       std::max<size_t>(grain_size, 1)),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        rank_workspace ws;
+        ws.split.resize(half, 2 * num_chains);
+        ws.columns.resize(2 * num_chains);
+        ws.sizes.assign(2 * num_chains, half);
+        for (Eigen::Index j = r.begin(); j != r.end(); ++j) {
+          for (size_t c = 0; c < num_chains; ++c) {
+            const double* draws = column_begin(j, c);
+            for (size_t n = 0; n < half; ++n) {
+              ws.split(n, 2 * c) = draws[n];
+              ws.split(n, 2 * c + 1) = draws[second_half + n];
+            }
+          }
+          rank_normalized_column(scores, ws, result.rhat_bulk(j),
+                                 result.rhat_tail(j), result.ess_bulk(j),
+                                 result.ess_tail(j));
+        }
+      });
+  return result;
+}
+
+}  // namespace internal
+
+/**
+ * Computes the rank normalized split R-hat and effective sample sizes,
+ * for the bulk and the tails, of every column of a matrix of draws.
+ * Based on paper https://arxiv.org/abs/1903.08008
+ *
+ * The R-hats equal those of
+ * <code>compute_split_potential_scale_reduction_rank</code>.  Each
+ * column is sorted once, and the ranks of the draws folded around the
+ * median are found by merging the sorted draws on either side of the
+ * median instead of sorting again.  The normal scores of the ranks are
+ * computed once for all columns, since they depend only on the number
+ * of draws.  The columns are processed in parallel with TBB.
+ *
+ * Entries are NaN for columns with non-finite or constant draws, and
+ * the effective sample sizes are NaN with fewer than four draws in each
+ * half chain.
+ *
+ * @param draws draws in rows and quantities in columns, with the chains
+ * stacked one after the other
+ * @param num_chains number of chains, which must divide the number of
+ * rows
+ * @param grain_size number of columns processed by each task
+ * @return diagnostics of each column
+ * @throw std::invalid_argument if the rows cannot be split in chains
+ */
+inline rank_normalized_diagnostics compute_rank_normalized_diagnostics(
+    const Eigen::MatrixXd& draws, size_t num_chains, size_t grain_size = 16) {
+  if (num_chains == 0 || draws.rows() % num_chains != 0)
+    throw std::invalid_argument(
+        "compute_rank_normalized_diagnostics: the number of draws must be "
+        "a multiple of the number of chains");
+  const size_t num_draws = draws.rows() / num_chains;
+  return internal::rank_normalized_columns(
+      draws.cols(), num_chains, num_draws,
+      [&draws, num_draws](Eigen::Index j, size_t c) {
+        return draws.col(j).data() + c * num_draws;
+      },
+      grain_size);
+}
+
+/**
+ * Computes the rank normalized split R-hat and effective sample sizes,
+ * for the bulk and the tails, of every column of the draws of several
+ * chains.  Chains are trimmed from the back to match the length of the
+ * shortest chain.
+ *
+ * @param chains draws of each chain, with draws in rows and quantities
+ * in columns
+ * @param grain_size number of columns processed by each task
+ * @return diagnostics of each column
+ * @throw std::invalid_argument if there are no chains or the chains
+ * have different numbers of columns
+ */
+inline rank_normalized_diagnostics compute_rank_normalized_diagnostics(
+    const std::vector<Eigen::MatrixXd>& chains, size_t grain_size = 16) {
+  if (chains.empty())
+    throw std::invalid_argument(
+        "compute_rank_normalized_diagnostics: no chains");
+  Eigen::Index num_draws = chains[0].rows();
+  for (const auto& chain : chains) {
+    if (chain.cols() != chains[0].cols())
+      throw std::invalid_argument(
+          "compute_rank_normalized_diagnostics: chains have different "
+          "numbers of columns");
+    num_draws = std::min(num_draws, chain.rows());
+  }
+  return internal::rank_normalized_columns(
+      chains[0].cols(), chains.size(), num_draws,
+      [&chains](Eigen::Index j, size_t c) { return chains[c].col(j).data(); },
+      grain_size);
+}
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
@@ -0,0 +1,415 @@
+#ifndef STAN_ANALYZE_MCMC_ONLINE_CONVERGENCE_HPP
+#define STAN_ANALYZE_MCMC_ONLINE_CONVERGENCE_HPP
+
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+namespace analyze {
+
+/**
+ * Options for <code>online_convergence</code>.
+ */
+struct online_convergence_options {
+  /**
+   * Number of batches at which pairs of batches are merged, an even
+   * number of at least 8.  Each chain keeps between half this number
+   * and this number of batches per quantity.
+   */
+  size_t max_batches = 32;
+
+  /**
+   * Track the indicators of the 5% and 95% quantiles for the tail
+   * effective sample size.
+   */
+  bool tail = true;
+
+  /**
+   * Number of draws of each chain from which its 5% and 95% quantiles
+   * are estimated before the tail indicators are tracked.
+   */
+  size_t tail_pilot = 100;
+};
+
+/**
+ * Convergence diagnostics of every quantity computed by
+ * <code>online_convergence::summary()</code>.  The entries are NaN
+ * until the summary is ready and for quantities which are constant or
+ * not finite.
+ */
+struct online_convergence_summary {
+  /**
+   * True once every chain has enough draws for the diagnostics.
+   */
+  bool ready = false;
+
+  /**
+   * Fewest draws in any chain.
+   */
+  size_t min_num_draws = 0;
+
+  /**
+   * Split potential scale reduction of each quantity.
+   */
+  Eigen::VectorXd rhat;
+
+  /**
+   * Effective sample size of each quantity.
+   */
+  Eigen::VectorXd ess_bulk;
+
+  /**
+   * Smaller of the effective sample sizes of the indicators of the 5%
+   * and 95% quantiles of each quantity.
+   */
+  Eigen::VectorXd ess_tail;
+};
+
+/**
+ * Streaming estimates of the split potential scale reduction and the
+ * effective sample size of a set of quantities over several chains,
+ * updated one draw at a time in constant memory.
+ *
+ * <p>Each chain keeps the mean and sum of squared deviations of its draws
+ * in consecutive batches of equal size.  When the number of batches
+ * reaches <code>max_batches</code>, neighbouring batches are merged and
+ * the batch size doubles, so the batches always cover all draws but the
+ * latest, incomplete batch.
+ *
+ * <p>The split potential scale reduction is computed from the first and
+ * second halves of the batches of each chain, using the classic rather
+ * than the rank normalized formula, which would need every draw.  The
+ * effective sample size uses the batch means estimate of the asymptotic
+ * variance, \f$\hat{\sigma}^2 = b \, \mathrm{Var}(\bar{x}_{batch})\f$,
+ * as <code>N var_plus / sigma^2</code>, capped at
+ * <code>N log10(N)</code> like <code>compute_effective_sample_size</code>.
+ * The tail effective sample size is computed in the same way for the
+ * indicators of the 5% and 95% quantiles, which are estimated per chain
+ * from its first <code>tail_pilot</code> draws.
+ *
+ * <p>Chains may be updated concurrently from different threads; each
+ * chain is guarded by its own mutex, which <code>summary()</code> takes
+ * only while reading that chain.
+ */
+class online_convergence {
+ public:
+  /**
+   * Construct the estimator.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] num_params number of quantities in each draw
+   * @param[in] options batching and tail options
+   * @throw std::invalid_argument if there are no chains or
+   * <code>max_batches</code> is odd or smaller than 8
+   */
+  online_convergence(size_t num_chains, size_t num_params,
+                     const online_convergence_options& options
+                     = online_convergence_options())
+      : num_params_(num_params), options_(options) {
+    if (num_chains == 0)
+      throw std::invalid_argument("online_convergence: no chains");
+    if (options_.max_batches < 8 || options_.max_batches % 2 != 0)
+      throw std::invalid_argument(
+          "online_convergence: max_batches must be even and at least 8");
+    options_.tail_pilot = std::max<size_t>(options_.tail_pilot, 1);
+    chains_.reserve(num_chains);
+    for (size_t c = 0; c < num_chains; ++c)
+      chains_.emplace_back(new chain_state(num_params, options_));
+  }
+
+  size_t num_chains() const { return chains_.size(); }
+
+  size_t num_params() const { return num_params_; }
+
+  /**
+   * Return the number of draws added to a chain.
+   *
+   * @param[in] chain index of the chain
+   */
+  size_t num_draws(size_t chain) const {
+    return chains_[chain]->num_draws.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Add a draw to a chain.
+   *
+   * @param[in] chain index of the chain
+   * @param[in] draw pointer to <code>num_params()</code> values
+   */
+  void add_draw(size_t chain, const double* draw) {
+    chain_state& state = *chains_[chain];
+    Eigen::Map<const Eigen::VectorXd> x(draw, num_params_);
+    std::lock_guard<std::mutex> lock(state.mutex);
+    const Eigen::Index b = state.num_batches;
+    const size_t n = state.num_draws.load(std::memory_order_relaxed) + 1;
+    ++state.in_batch;
+    const Eigen::VectorXd delta = x - state.mean.col(b);
+    state.mean.col(b) += delta / state.in_batch;
+    state.m2.col(b).array()
+        += delta.array() * (x - state.mean.col(b)).array();
+    if (options_.tail) {
+      if (state.tail_ready) {
+        add_indicators(state, x, b);
+      } else {
+        state.pilot.col(n - 1) = x;
+        if (n == static_cast<size_t>(state.pilot.cols()))
+          start_tail(state, n);
+      }
+    }
+    state.num_draws.store(n, std::memory_order_relaxed);
+    if (state.in_batch == state.batch_size) {
+      state.in_batch = 0;
+      ++state.num_batches;
+      if (state.num_batches == options_.max_batches)
+        merge_batches(state);
+      clear_batch(state, state.num_batches);
+    }
+  }
+
+  /**
+   * Return the diagnostics of the draws added so far.
+   *
+   * @return diagnostics of each quantity
+   */
+  online_convergence_summary summary() const {
+    const size_t num_chains = chains_.size();
+    const size_t num_halves = 2 * num_chains;
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    online_convergence_summary result;
+    result.rhat = Eigen::VectorXd::Constant(num_params_, nan);
+    result.ess_bulk = Eigen::VectorXd::Constant(num_params_, nan);
+    result.ess_tail = Eigen::VectorXd::Constant(num_params_, nan);
+    result.min_num_draws = num_draws(0);
+    for (size_t c = 1; c < num_chains; ++c)
+      result.min_num_draws = std::min(result.min_num_draws, num_draws(c));
+
+    half_statistics bulk(num_params_, num_chains);
+    half_statistics lower(num_params_, num_chains);
+    half_statistics upper(num_params_, num_chains);
+    double num_total = 0;
+    double half_size = 0;
+    for (size_t c = 0; c < num_chains; ++c) {
+      const chain_state& state = *chains_[c];
+      std::lock_guard<std::mutex> lock(state.mutex);
+      const Eigen::Index k = state.num_batches;
+      if (k < 4 || (options_.tail && !state.tail_ready))
+        return result;
+      const Eigen::Index h = k / 2;
+      const double b = state.batch_size;
+      num_total += k * b;
+      half_size += h * b;
+      bulk.add(c, state.mean.leftCols(k), &state.m2, b, h);
+      if (options_.tail) {
+        lower.add(c, state.lower.leftCols(k) / b, nullptr, b, h);
+        upper.add(c, state.upper.leftCols(k) / b, nullptr, b, h);
+      }
+    }
+    result.ready = true;
+    half_size /= num_halves;
+
+    Eigen::ArrayXd var_plus, within;
+    bulk.pooled_variance(half_size, var_plus, within);
+    result.rhat
+        = (within > 0).select((var_plus / within).sqrt(), nan).matrix();
+    result.ess_bulk = ess(bulk, var_plus, num_total).matrix();
+    if (options_.tail) {
+      lower.pooled_variance(half_size, var_plus, within);
+      Eigen::ArrayXd ess_lower = ess(lower, var_plus, num_total);
+      upper.pooled_variance(half_size, var_plus, within);
+      Eigen::ArrayXd ess_upper = ess(upper, var_plus, num_total);
+      result.ess_tail = (ess_lower.isNaN() || ess_upper.isNaN())
+                            .select(nan, ess_lower.min(ess_upper))
+                            .matrix();
+    }
+    return result;
+  }
+
+ private:
+  struct chain_state {
+    chain_state(size_t num_params, const online_convergence_options& options)
+        : mean(Eigen::MatrixXd::Zero(num_params, options.max_batches)),
+          m2(Eigen::MatrixXd::Zero(num_params, options.max_batches)) {
+      if (options.tail) {
+        lower = Eigen::MatrixXd::Zero(num_params, options.max_batches);
+        upper = Eigen::MatrixXd::Zero(num_params, options.max_batches);
+        pilot.resize(num_params, options.tail_pilot);
+      }
+    }
+
+    mutable std::mutex mutex;
+    std::atomic<size_t> num_draws{0};
+    size_t batch_size = 1;
+    size_t num_batches = 0;
+    size_t in_batch = 0;
+    // Quantities in rows, batches in columns; the column after the last
+    // complete batch holds the incomplete one
+    Eigen::MatrixXd mean;
+    Eigen::MatrixXd m2;
+    // Number of draws at or below the 5% quantile and at or above the
+    // 95% quantile in each batch
+    Eigen::MatrixXd lower;
+    Eigen::MatrixXd upper;
+    Eigen::VectorXd lower_bound;
+    Eigen::VectorXd upper_bound;
+    Eigen::MatrixXd pilot;
+    bool tail_ready = false;
+  };
+
+  /**
+   * Means and variances of the two halves of every chain and the
+   * batch means estimate of the asymptotic variance of each chain.
+   */
+  struct half_statistics {
+    half_statistics(size_t num_params, size_t num_chains)
+        : mean(num_params, 2 * num_chains),
+          var(num_params, 2 * num_chains),
+          sigma2(num_params, num_chains) {}
+
+    /**
+     * Add a chain from its batch means and, if not null, the sums of
+     * squared deviations within the batches; without them the batches
+     * hold indicators, whose variance follows from their mean.
+     */
+    template <typename Means>
+    void add(size_t chain, const Means& batch_mean, const Eigen::MatrixXd* m2,
+             double b, Eigen::Index h) {
+      const Eigen::Index k = batch_mean.cols();
+      const double n = h * b;
+      for (int half = 0; half < 2; ++half) {
+        const Eigen::Index first = half == 0 ? 0 : k - h;
+        const Eigen::MatrixXd block = batch_mean.middleCols(first, h);
+        const Eigen::ArrayXd half_mean = block.rowwise().mean().array();
+        Eigen::ArrayXd half_var;
+        if (m2) {
+          half_var = (m2->middleCols(first, h).rowwise().sum().array()
+                      + b
+                            * (block.colwise() - half_mean.matrix())
+                                  .array()
+                                  .square()
+                                  .rowwise()
+                                  .sum())
+                     / (n - 1);
+        } else {
+          half_var = half_mean * (1 - half_mean) * n / (n - 1);
+        }
+        mean.col(2 * chain + half) = half_mean;
+        var.col(2 * chain + half) = half_var;
+      }
+      const Eigen::VectorXd chain_mean = batch_mean.rowwise().mean();
+      sigma2.col(chain) = b
+                          * (batch_mean.colwise() - chain_mean)
+                                .array()
+                                .square()
+                                .rowwise()
+                                .sum()
+                          / (k - 1);
+    }
+
+    void pooled_variance(double n, Eigen::ArrayXd& var_plus,
+                         Eigen::ArrayXd& within) const {
+      const Eigen::Index num_halves = mean.cols();
+      const Eigen::ArrayXd grand_mean = mean.rowwise().mean();
+      const Eigen::ArrayXd between
+          = (mean.colwise() - grand_mean).square().rowwise().sum()
+            / (num_halves - 1);
+      within = var.rowwise().mean();
+      var_plus = (n - 1) / n * within + between;
+    }
+
+    Eigen::ArrayXXd mean;
+    Eigen::ArrayXXd var;
+    Eigen::ArrayXXd sigma2;
+  };
+
+  static Eigen::ArrayXd ess(const half_statistics& stats,
+                            const Eigen::ArrayXd& var_plus, double num_total) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const Eigen::ArrayXd sigma2 = stats.sigma2.rowwise().mean();
+    const double max_ess = num_total * std::log10(num_total);
+    return (var_plus > 0 && sigma2 > 0)
+        .select((num_total * var_plus / sigma2).min(max_ess), nan);
+  }
+
+  static void clear_batch(chain_state& state, Eigen::Index b) {
+    state.mean.col(b).setZero();
+    state.m2.col(b).setZero();
+    if (state.lower.size() > 0) {
+      state.lower.col(b).setZero();
+      state.upper.col(b).setZero();
+    }
+  }
+
+  /**
+   * Merges neighbouring pairs of complete batches, doubling their size.
+   */
+  void merge_batches(chain_state& state) const {
+    const Eigen::Index half = state.num_batches / 2;
+    const double b = state.batch_size;
+    for (Eigen::Index j = 0; j < half; ++j) {
+      const Eigen::VectorXd delta
+          = state.mean.col(2 * j + 1) - state.mean.col(2 * j);
+      state.m2.col(j) = state.m2.col(2 * j) + state.m2.col(2 * j + 1)
+                        + delta.cwiseAbs2() * (b / 2);
+      state.mean.col(j) = state.mean.col(2 * j) + delta / 2;
+      if (options_.tail) {
+        state.lower.col(j)
+            = state.lower.col(2 * j) + state.lower.col(2 * j + 1);
+        state.upper.col(j)
+            = state.upper.col(2 * j) + state.upper.col(2 * j + 1);
+      }
+    }
+    state.num_batches = half;
+    state.batch_size *= 2;
+  }
+
+  static void add_indicators(chain_state& state,
+                             const Eigen::Ref<const Eigen::VectorXd>& x,
+                             Eigen::Index b) {
+    state.lower.col(b).array()
+        += (x.array() <= state.lower_bound.array()).cast<double>();
+    state.upper.col(b).array()
+        += (x.array() >= state.upper_bound.array()).cast<double>();
+  }
+
+  /**
+   * Estimates the quantiles from the pilot draws and counts the pilot
+   * draws in the batches they belong to.
+   */
+  static void start_tail(chain_state& state, size_t n) {
+    const Eigen::Index num_params = state.pilot.rows();
+    state.lower_bound.resize(num_params);
+    state.upper_bound.resize(num_params);
+    std::vector<double> row(n);
+    const size_t lower_index = static_cast<size_t>(0.05 * (n - 1) + 0.5);
+    const size_t upper_index = static_cast<size_t>(0.95 * (n - 1) + 0.5);
+    for (Eigen::Index p = 0; p < num_params; ++p) {
+      for (size_t i = 0; i < n; ++i)
+        row[i] = state.pilot(p, i);
+      std::nth_element(row.begin(), row.begin() + lower_index, row.end());
+      state.lower_bound(p) = row[lower_index];
+      std::nth_element(row.begin(), row.begin() + upper_index, row.end());
+      state.upper_bound(p) = row[upper_index];
+    }
+    for (size_t i = 0; i < n; ++i)
+      add_indicators(state, state.pilot.col(i), i / state.batch_size);
+    state.pilot.resize(0, 0);
+    state.tail_ready = true;
+  }
+
+  size_t num_params_;
+  online_convergence_options options_;
+  std::vector<std::unique_ptr<chain_state>> chains_;
+};
+
+}  // namespace analyze
+}  // namespace stan
+
+#endif
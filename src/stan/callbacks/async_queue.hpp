@@ -0,0 +1,199 @@
+#ifndef STAN_CALLBACKS_ASYNC_QUEUE_HPP
+#define STAN_CALLBACKS_ASYNC_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * What an asynchronous writer does when its buffer is full.
+ */
+enum class async_backpressure {
+  /**
+   * Wait for the background thread to make room; nothing is lost.
+   */
+  block,
+  /**
+   * Discard the draw and count it; names and comments still wait.
+   */
+  drop
+};
+
+/**
+ * Bounded single-producer, single-consumer ring buffer drained by a
+ * background thread, used by <code>async_writer</code> and
+ * <code>async_structured_writer</code>.
+ *
+ * <p>The producer fills a preallocated record in place, so records whose
+ * members keep their capacity are reused without allocating.  Pushing
+ * and popping only touch two atomic indices; the mutex and condition
+ * variables are used only to put a thread to sleep on a full or empty
+ * buffer and to wake it again.
+ *
+ * <p>An exception thrown while consuming a record is stored and
+ * rethrown to the producer on its next call; the records still queued
+ * are then discarded.
+ *
+ * @tparam Record type of the records, default constructible
+ */
+template <typename Record>
+class async_queue {
+ public:
+  /**
+   * Construct a queue and start its background thread.
+   *
+   * @param[in] capacity maximum number of queued records, at least 1
+   * @param[in] policy what to do with droppable records when full
+   * @param[in] consume function called on the background thread for
+   * each record, in order
+   */
+  async_queue(std::size_t capacity, async_backpressure policy,
+              std::function<void(Record&)> consume)
+      : records_(std::max<std::size_t>(capacity, 1) + 1),
+        policy_(policy),
+        consume_(std::move(consume)),
+        thread_([this] { run(); }) {}
+
+  async_queue(const async_queue&) = delete;
+  async_queue& operator=(const async_queue&) = delete;
+
+  /**
+   * Drains the queue and stops the background thread.
+   */
+  ~async_queue() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    has_records_.notify_one();
+    thread_.join();
+  }
+
+  /**
+   * Fill the next free record and queue it, waiting for room if the
+   * buffer is full unless the record may be dropped under the
+   * <code>drop</code> policy.
+   *
+   * @tparam F type of the fill function
+   * @param[in] fill function called with the record to fill
+   * @param[in] droppable true if the record may be dropped
+   * @return true if the record was queued
+   * @throw any exception thrown while consuming an earlier record
+   */
+  template <typename F>
+  bool push(F&& fill, bool droppable) {
+    rethrow_if_failed();
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    const std::size_t next = advance(tail);
+    if (next == head_.load(std::memory_order_acquire)) {
+      if (droppable && policy_ == async_backpressure::drop) {
+        ++num_dropped_;
+        return false;
+      }
+      wait_for_producer([this, next] { return next != head_.load(); });
+    }
+    fill(records_[tail]);
+    tail_.store(next);
+    if (consumer_waiting_.load()) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      has_records_.notify_one();
+    }
+    return true;
+  }
+
+  /**
+   * Wait until every queued record has been consumed.
+   *
+   * @throw any exception thrown while consuming a record
+   */
+  void drain() {
+    const std::size_t tail = tail_.load(std::memory_order_relaxed);
+    wait_for_producer([this, tail] { return head_.load() == tail; });
+    rethrow_if_failed();
+  }
+
+  /**
+   * Return the number of records dropped because the buffer was full.
+   */
+  std::size_t num_dropped() const { return num_dropped_; }
+
+ private:
+  std::vector<Record> records_;
+  async_backpressure policy_;
+  std::function<void(Record&)> consume_;
+  std::atomic<std::size_t> head_{0};
+  std::atomic<std::size_t> tail_{0};
+  std::atomic<bool> producer_waiting_{false};
+  std::atomic<bool> consumer_waiting_{false};
+  std::atomic<bool> failed_{false};
+  std::exception_ptr error_;
+  std::size_t num_dropped_ = 0;
+  bool stop_ = false;
+  std::mutex mutex_;
+  std::condition_variable has_records_;
+  std::condition_variable has_room_;
+  std::thread thread_;
+
+  std::size_t advance(std::size_t index) const {
+    return index + 1 == records_.size() ? 0 : index + 1;
+  }
+
+  template <typename Pred>
+  void wait_for_producer(Pred ready) {
+    if (ready())
+      return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    producer_waiting_ = true;
+    has_room_.wait(lock, ready);
+    producer_waiting_ = false;
+  }
+
+  void rethrow_if_failed() {
+    if (failed_.load(std::memory_order_acquire))
+      std::rethrow_exception(error_);
+  }
+
+  void run() {
+    while (true) {
+      const std::size_t head = head_.load(std::memory_order_relaxed);
+      if (head == tail_.load()) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        consumer_waiting_ = true;
+        has_records_.wait(
+            lock, [this, head] { return stop_ || head != tail_.load(); });
+        consumer_waiting_ = false;
+        if (head == tail_.load())
+          return;
+        continue;
+      }
+      if (!failed_.load(std::memory_order_relaxed)) {
+        try {
+          consume_(records_[head]);
+        } catch (...) {
+          error_ = std::current_exception();
+          failed_.store(true, std::memory_order_release);
+        }
+      }
+      head_.store(advance(head));
+      if (producer_waiting_.load()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        has_room_.notify_one();
+      }
+    }
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef STAN_CALLBACKS_ASYNC_STRUCTURED_WRITER_HPP
+#define STAN_CALLBACKS_ASYNC_STRUCTURED_WRITER_HPP
+
+#include <stan/callbacks/async_queue.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <complex>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>async_structured_writer</code> is an implementation of
+ * <code>structured_writer</code> that forwards every call to another
+ * structured writer on a background thread.
+ *
+ * Each call is queued with copies of its arguments and replayed in
+ * order.  Ending the outermost record waits until the whole record has
+ * been written, as do <code>flush()</code> and destruction.  Records
+ * are written rarely, so unlike <code>async_writer</code> the queued
+ * calls are not preallocated.
+ *
+ * An exception thrown by the underlying writer is rethrown from the
+ * next call to this writer.
+ */
+class async_structured_writer final : public structured_writer {
+ public:
+  /**
+   * Constructor accepting the structured writer to forward to.
+   *
+   * @param[in, out] inner writer called on the background thread; must
+   * outlive this writer and not be used by other threads meanwhile
+   * @param[in] capacity maximum number of queued calls
+   */
+  explicit async_structured_writer(structured_writer& inner,
+                                   std::size_t capacity = 256)
+      : inner_(inner),
+        queue_(capacity, async_backpressure::block,
+               [this](call& c) {
+                 c(inner_);
+                 c = nullptr;
+               }) {}
+
+  /**
+   * Writes everything queued before returning.
+   */
+  virtual ~async_structured_writer() {}
+
+  void begin_record() {
+    ++depth_;
+    enqueue([](structured_writer& w) { w.begin_record(); });
+  }
+
+  void begin_record(const std::string& key) {
+    ++depth_;
+    enqueue([key](structured_writer& w) { w.begin_record(key); });
+  }
+
+  /**
+   * Queues the end of a record, waiting until it has been written if
+   * it is the outermost one.
+   */
+  void end_record() {
+    enqueue([](structured_writer& w) { w.end_record(); });
+    if (depth_ > 0 && --depth_ == 0)
+      queue_.drain();
+  }
+
+  void write(const std::string& key) {
+    enqueue([key](structured_writer& w) { w.write(key); });
+  }
+
+  void write(const std::string& key, const std::string& value) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key, bool value) { enqueue_value(key, value); }
+
+  void write(const std::string& key, int value) { enqueue_value(key, value); }
+
+  void write(const std::string& key, std::size_t value) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key,
+             long long int value  // NOLINT(runtime/int)
+  ) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key, unsigned int value) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key, double value) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key, const std::complex<double>& value) {
+    enqueue_value(key, value);
+  }
+
+  void write(const std::string& key, const std::vector<double>& values) {
+    enqueue_value(key, values);
+  }
+
+  void write(const std::string& key, const std::vector<std::string>& values) {
+    enqueue_value(key, values);
+  }
+
+  void write(const std::string& key,
+             const std::vector<std::complex<double>>& values) {
+    enqueue_value(key, values);
+  }
+
+  void write(const std::string& key, const std::vector<int>& values) {
+    enqueue_value(key, values);
+  }
+
+  void write(const std::string& key, const Eigen::MatrixXd& mat) {
+    enqueue_value(key, mat);
+  }
+
+  void write(const std::string& key, const Eigen::VectorXd& vec) {
+    enqueue_value(key, vec);
+  }
+
+  void write(const std::string& key, const Eigen::RowVectorXd& vec) {
+    enqueue_value(key, vec);
+  }
+
+  /**
+   * Queues a string value; the characters are copied, so the pointer
+   * need not outlive the call.
+   */
+  void write(const std::string& key, const char* value) {
+    std::string copy(value);
+    enqueue([key, copy](structured_writer& w) { w.write(key, copy.c_str()); });
+  }
+
+  /**
+   * Waits until every queued call has been forwarded.
+   */
+  void flush() { queue_.drain(); }
+
+ private:
+  using call = std::function<void(structured_writer&)>;
+
+  template <typename F>
+  void enqueue(F&& f) {
+    queue_.push([&f](call& c) { c = std::forward<F>(f); }, false);
+  }
+
+  template <typename T>
+  void enqueue_value(const std::string& key, const T& value) {
+    enqueue([key, value](structured_writer& w) { w.write(key, value); });
+  }
+
+  structured_writer& inner_;
+  std::size_t depth_ = 0;
+  async_queue<call> queue_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef STAN_CALLBACKS_ASYNC_WRITER_HPP
+#define STAN_CALLBACKS_ASYNC_WRITER_HPP
+
+#include <stan/callbacks/async_queue.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>async_writer</code> is an implementation of <code>writer</code>
+ * that forwards every call to another writer on a background thread,
+ * so that formatting and disk stalls of the underlying writer do not
+ * hold up the sampler.
+ *
+ * Calls are queued in a bounded buffer and replayed in order.  The
+ * values are copied into preallocated records, so queueing a draw does
+ * not allocate once the buffer has been filled once.  A blank comment,
+ * which the services write at the end of each section of output, waits
+ * until everything queued so far has been written, as does
+ * <code>flush()</code> and destruction.
+ *
+ * An exception thrown by the underlying writer is rethrown from the
+ * next call to this writer.
+ */
+class async_writer final : public writer {
+ public:
+  /**
+   * Constructor accepting the writer to forward to.
+   *
+   * @param[in, out] inner writer called on the background thread; must
+   * outlive this writer and not be used by other threads meanwhile
+   * @param[in] capacity maximum number of queued calls
+   * @param[in] policy what to do with a draw when the buffer is full
+   */
+  explicit async_writer(writer& inner, std::size_t capacity = 1024,
+                        async_backpressure policy = async_backpressure::block)
+      : inner_(inner),
+        queue_(capacity, policy, [this](record& r) { consume(r); }) {}
+
+  /**
+   * Writes everything queued before returning.
+   */
+  virtual ~async_writer() {}
+
+  void operator()(const std::vector<std::string>& names) {
+    queue_.push(
+        [&names](record& r) {
+          r.type = record::names_call;
+          r.names = names;
+        },
+        false);
+  }
+
+  void operator()(const std::vector<double>& state) {
+    queue_.push(
+        [&state](record& r) {
+          r.type = record::values_call;
+          r.values.assign(state.begin(), state.end());
+        },
+        true);
+  }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    queue_.push(
+        [&values](record& r) {
+          r.type = record::matrix_call;
+          r.matrix = values;
+        },
+        true);
+  }
+
+  /**
+   * Queues a blank comment and waits until it has been written.
+   */
+  void operator()() {
+    queue_.push([](record& r) { r.type = record::blank_call; }, false);
+    queue_.drain();
+  }
+
+  void operator()(const std::string& message) {
+    queue_.push(
+        [&message](record& r) {
+          r.type = record::message_call;
+          r.message = message;
+        },
+        false);
+  }
+
+  /**
+   * Waits until every queued call has been forwarded.
+   */
+  void flush() { queue_.drain(); }
+
+  /**
+   * Return the number of draws dropped because the buffer was full
+   * under the <code>drop</code> policy.
+   */
+  std::size_t num_dropped() const { return queue_.num_dropped(); }
+
+ private:
+  /**
+   * A queued call; the members are reused from one call to the next.
+   */
+  struct record {
+    enum kind {
+      names_call,
+      values_call,
+      matrix_call,
+      blank_call,
+      message_call
+    };
+    kind type = blank_call;
+    std::vector<std::string> names;
+    std::vector<double> values;
+    Eigen::MatrixXd matrix;
+    std::string message;
+  };
+
+  void consume(record& r) {
+    switch (r.type) {
+      case record::names_call:
+        inner_(r.names);
+        break;
+      case record::values_call:
+        inner_(r.values);
+        break;
+      case record::matrix_call:
+        inner_(r.matrix);
+        break;
+      case record::blank_call:
+        inner_();
+        break;
+      case record::message_call:
+        inner_(r.message);
+        break;
+    }
+  }
+
+  writer& inner_;
+  async_queue<record> queue_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef STAN_CALLBACKS_BUFFER_LOGGER_HPP
+#define STAN_CALLBACKS_BUFFER_LOGGER_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * <code>buffer_logger</code> is an implementation of
+ * <code>logger</code> that keeps the messages in memory, in the order
+ * they were logged, until they are replayed to another logger.
+ *
+ * It lets work running on other threads log its messages to a logger
+ * which is not thread safe, or in a deterministic order.
+ */
+class buffer_logger final : public logger {
+ public:
+  void debug(const std::string& message) { add(level::debug, message); }
+
+  void debug(const std::stringstream& message) {
+    add(level::debug, message.str());
+  }
+
+  void info(const std::string& message) { add(level::info, message); }
+
+  void info(const std::stringstream& message) {
+    add(level::info, message.str());
+  }
+
+  void warn(const std::string& message) { add(level::warn, message); }
+
+  void warn(const std::stringstream& message) {
+    add(level::warn, message.str());
+  }
+
+  void error(const std::string& message) { add(level::error, message); }
+
+  void error(const std::stringstream& message) {
+    add(level::error, message.str());
+  }
+
+  void fatal(const std::string& message) { add(level::fatal, message); }
+
+  void fatal(const std::stringstream& message) {
+    add(level::fatal, message.str());
+  }
+
+  /**
+   * Return the number of messages in the buffer.
+   */
+  size_t size() const { return messages_.size(); }
+
+  /**
+   * Log the buffered messages to another logger, with their levels and
+   * in the order they were logged, and empty the buffer.
+   *
+   * @param[in,out] logger logger receiving the messages
+   */
+  void replay(logger& logger) {
+    for (const auto& message : messages_) {
+      switch (message.first) {
+        case level::debug:
+          logger.debug(message.second);
+          break;
+        case level::info:
+          logger.info(message.second);
+          break;
+        case level::warn:
+          logger.warn(message.second);
+          break;
+        case level::error:
+          logger.error(message.second);
+          break;
+        case level::fatal:
+          logger.fatal(message.second);
+          break;
+      }
+    }
+    messages_.clear();
+  }
+
+ private:
+  enum class level { debug, info, warn, error, fatal };
+
+  std::vector<std::pair<level, std::string>> messages_;
+
+  void add(level lvl, const std::string& message) {
+    messages_.emplace_back(lvl, message);
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -0,0 +1,448 @@
+#ifndef STAN_CALLBACKS_COLUMNAR_WRITER_HPP
+#define STAN_CALLBACKS_COLUMNAR_WRITER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/columnar_format.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * `columnar_writer` is an implementation of `writer` that writes draws
+ * in the binary columnar format described in
+ * `stan::io::columnar_format` rather than as CSV text.
+ *
+ * Draws are buffered and written a chunk at a time, each chunk storing
+ * the values of one column contiguously, so a single column can be
+ * read, or memory mapped, without touching the others.  Values are
+ * written exactly, without formatting.  Comments are kept in the JSON
+ * header or trailer together with their position among the draws, and
+ * the step size and inverse metric are recovered from the adaptation
+ * comments, so `stan::io::columnar_reader` can reproduce the Stan CSV
+ * output.
+ *
+ * The file is complete once `close()` has been called or the writer
+ * has been destroyed.  Offsets in the chunk index are relative to the
+ * position of the stream when the writer was constructed.
+ *
+ * @tparam Stream A type with a valid `write(const char*, std::streamsize)`
+ * @tparam Deleter A class with a valid `operator()` method for deleting the
+ * output stream
+ */
+template <typename Stream, typename Deleter = std::default_delete<Stream>>
+class columnar_writer final : public writer {
+ public:
+  /**
+   * Constructs a columnar writer with an output stream.
+   *
+   * @param[in, out] output A unique pointer to a type inheriting from
+   * `std::ostream`, opened in binary mode
+   * @param[in] chunk_size maximum number of draws per chunk.  The
+   * default of zero picks a size so that each chunk holds about 4MB.
+   */
+  explicit columnar_writer(std::unique_ptr<Stream, Deleter>&& output,
+                           std::size_t chunk_size = 0)
+      : output_(std::move(output)), chunk_size_(chunk_size) {}
+
+  columnar_writer();
+  columnar_writer(columnar_writer& other) = delete;
+  columnar_writer(columnar_writer&& other) = default;
+
+  /**
+   * Writes any buffered draws and the trailer.
+   */
+  virtual ~columnar_writer() {
+    try {
+      close();
+    } catch (...) {
+    }
+  }
+
+  /**
+   * Writes the header with the specified column names.  Must be called
+   * at most once, before any draws.
+   *
+   * @param[in] names Names in a std::vector
+   * @throw std::logic_error if the header has already been written
+   */
+  void operator()(const std::vector<std::string>& names) {
+    if (output_ == nullptr)
+      return;
+    if (header_written_)
+      throw std::logic_error(
+          "columnar_writer: names must be written before any draws");
+    names_ = names;
+    write_header(names.size());
+  }
+
+  /**
+   * Buffers a draw, writing a chunk when the buffer is full.
+   *
+   * @param[in] values Values in a std::vector
+   * @throw std::invalid_argument if the number of values does not match
+   * the number of columns
+   */
+  void operator()(const std::vector<double>& values) {
+    if (output_ == nullptr)
+      return;
+    if (!header_written_)
+      write_header(values.size());
+    check_size(values.size());
+    for (std::size_t j = 0; j < values.size(); ++j)
+      buffer_.coeffRef(rows_, j) = values[j];
+    end_row();
+  }
+
+  /**
+   * Buffers multiple draws.
+   *
+   * @param[in] values A matrix of values, with parameters in the rows and
+   * draws in the columns.
+   * @throw std::invalid_argument if the number of rows does not match
+   * the number of columns of the output
+   */
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    if (output_ == nullptr)
+      return;
+    if (!header_written_)
+      write_header(values.rows());
+    check_size(values.rows());
+    for (Eigen::Index n = 0; n < values.cols(); ++n) {
+      buffer_.row(rows_) = values.col(n).transpose();
+      end_row();
+    }
+  }
+
+  /**
+   * Records a blank comment.
+   */
+  void operator()() {
+    if (output_ == nullptr)
+      return;
+    comments_.push_back({num_draws_, true, std::string()});
+  }
+
+  /**
+   * Records a comment.
+   *
+   * @param[in] message A string
+   */
+  void operator()(const std::string& message) {
+    if (output_ == nullptr)
+      return;
+    comments_.push_back({num_draws_, false, message});
+  }
+
+  /**
+   * Writes the buffered draws and the trailer and flushes the stream.
+   * Nothing is written after the first call.
+   */
+  void close() {
+    if (output_ == nullptr || closed_)
+      return;
+    if (!header_written_)
+      write_header(names_.size());
+    write_chunk();
+    write_trailer();
+    output_->flush();
+    closed_ = true;
+  }
+
+  /**
+   * Get the underlying stream
+   */
+  inline auto& get_stream() noexcept { return *output_; }
+
+ private:
+  /**
+   * A comment and the number of draws written before it.
+   */
+  struct comment {
+    std::size_t draw;
+    bool blank;
+    std::string text;
+  };
+
+  /**
+   * Target size in bytes of a chunk when no chunk size is specified.
+   */
+  static constexpr std::size_t default_chunk_bytes = std::size_t(1) << 22;
+
+  std::unique_ptr<Stream, Deleter> output_;
+  std::size_t chunk_size_;
+  std::vector<std::string> names_;
+  std::size_t num_columns_ = 0;
+  bool header_written_ = false;
+  bool closed_ = false;
+  std::size_t header_comments_ = 0;
+  std::vector<comment> comments_;
+
+  /**
+   * Buffered draws of the current chunk, one column per output column,
+   * so each column is written with a single call.
+   */
+  Eigen::MatrixXd buffer_;
+  Eigen::Index rows_ = 0;
+  std::size_t num_draws_ = 0;
+  std::uint64_t offset_ = 0;
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> chunks_;
+  std::vector<double> swapped_;
+
+  void check_size(std::size_t size) const {
+    if (size != num_columns_) {
+      std::stringstream msg;
+      msg << "columnar_writer: expecting " << num_columns_
+          << " values per draw, found " << size;
+      throw std::invalid_argument(msg.str());
+    }
+  }
+
+  void end_row() {
+    ++rows_;
+    ++num_draws_;
+    if (rows_ == buffer_.rows())
+      write_chunk();
+  }
+
+  void write_bytes(const char* data, std::size_t n) {
+    output_->write(data, n);
+    offset_ += n;
+  }
+
+  void write_uint64(std::uint64_t value) {
+    char bytes[8];
+    io::columnar_format::encode_uint64(value, bytes);
+    write_bytes(bytes, 8);
+  }
+
+  /**
+   * Writes a JSON document padded with spaces to a multiple of 8 bytes,
+   * preceded by its length.
+   */
+  void write_header_json(std::string json) {
+    json.append((8 - json.size() % 8) % 8, ' ');
+    write_uint64(json.size());
+    write_bytes(json.data(), json.size());
+  }
+
+  void write_header(std::size_t num_columns) {
+    num_columns_ = num_columns;
+    const std::size_t row_bytes = 8 * std::max<std::size_t>(1, num_columns);
+    std::size_t chunk_rows = chunk_size_;
+    if (chunk_rows == 0)
+      chunk_rows = default_chunk_bytes / row_bytes;
+    chunk_rows = std::max<std::size_t>(1, chunk_rows);
+    buffer_.resize(chunk_rows, num_columns);
+
+    std::stringstream json;
+    json << "{\"format\":\"stan_columnar\",\"version\":"
+         << io::columnar_format::version << ",\"num_columns\":" << num_columns
+         << ",\"chunk_size\":" << chunk_rows << ",\"names\":[";
+    for (std::size_t j = 0; j < names_.size(); ++j)
+      json << (j ? "," : "") << io::columnar_format::quote(names_[j]);
+    json << "],\"variables\":[";
+    write_variables(json);
+    json << "],\"comments\":[";
+    for (std::size_t i = 0; i < comments_.size(); ++i) {
+      json << (i ? "," : "");
+      if (comments_[i].blank)
+        json << "null";
+      else
+        json << io::columnar_format::quote(comments_[i].text);
+    }
+    json << "]}";
+
+    write_bytes(io::columnar_format::magic, io::columnar_format::magic_size);
+    write_header_json(json.str());
+    header_comments_ = comments_.size();
+    header_written_ = true;
+  }
+
+  /**
+   * Writes the variables making up the columns, grouping consecutive
+   * names of the form `base.i.j` into a variable `base` with
+   * dimensions given by the largest indices.
+   */
+  void write_variables(std::ostream& json) const {
+    std::string base;
+    std::vector<std::size_t> dims;
+    bool first = true;
+    auto emit = [&]() {
+      json << (first ? "" : ",") << "{\"name\":"
+           << io::columnar_format::quote(base) << ",\"dims\":[";
+      for (std::size_t k = 0; k < dims.size(); ++k)
+        json << (k ? "," : "") << dims[k];
+      json << "]}";
+      first = false;
+    };
+    bool open = false;
+    for (const auto& name : names_) {
+      std::string name_base;
+      std::vector<std::size_t> indices;
+      split_name(name, name_base, indices);
+      if (open && name_base == base && indices.size() == dims.size()
+          && !indices.empty()) {
+        for (std::size_t k = 0; k < dims.size(); ++k)
+          dims[k] = std::max(dims[k], indices[k]);
+        continue;
+      }
+      if (open)
+        emit();
+      base = name_base;
+      dims = indices;
+      open = true;
+    }
+    if (open)
+      emit();
+  }
+
+  static void split_name(const std::string& name, std::string& base,
+                         std::vector<std::size_t>& indices) {
+    std::size_t dot = name.find('.');
+    base = name.substr(0, dot);
+    indices.clear();
+    while (dot != std::string::npos) {
+      std::size_t next = name.find('.', dot + 1);
+      std::string part = name.substr(dot + 1, next == std::string::npos
+                                                  ? std::string::npos
+                                                  : next - dot - 1);
+      char* end = nullptr;
+      unsigned long index = std::strtoul(part.c_str(), &end, 10);
+      if (part.empty() || *end != '\0' || index == 0) {
+        base = name;
+        indices.clear();
+        return;
+      }
+      indices.push_back(index);
+      dot = next;
+    }
+  }
+
+  void write_chunk() {
+    if (rows_ == 0)
+      return;
+    chunks_.emplace_back(offset_, rows_);
+    write_uint64(rows_);
+    for (Eigen::Index j = 0; j < buffer_.cols(); ++j) {
+      const double* column = buffer_.col(j).data();
+      if (!io::columnar_format::host_is_little_endian()) {
+        swapped_.assign(column, column + rows_);
+        io::columnar_format::swap_to_little_endian(swapped_.data(), rows_);
+        column = swapped_.data();
+      }
+      write_bytes(reinterpret_cast<const char*>(column), 8 * rows_);
+    }
+    rows_ = 0;
+  }
+
+  static std::string format_number(double x) {
+    if (!std::isfinite(x))
+      return "null";
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", x);
+    return buffer;
+  }
+
+  /**
+   * Parses a comment of comma separated numbers into a row of the
+   * inverse metric, returning false if it is not one.
+   */
+  static bool parse_metric_row(const std::string& text,
+                               std::vector<double>& row) {
+    row.clear();
+    const char* begin = text.c_str();
+    while (true) {
+      char* end = nullptr;
+      double x = std::strtod(begin, &end);
+      if (end == begin)
+        return false;
+      row.push_back(x);
+      while (*end == ' ')
+        ++end;
+      if (*end == '\0')
+        return true;
+      if (*end != ',')
+        return false;
+      begin = end + 1;
+    }
+  }
+
+  /**
+   * Writes the step size and inverse metric found in the comments, as
+   * written by `base_hmc::write_sampler_state`.
+   */
+  void write_adaptation(std::ostream& json) const {
+    static const std::string step_size_label = "Step size = ";
+    bool found = false;
+    double step_size = 0;
+    std::vector<std::vector<double>> metric;
+    for (std::size_t i = 0; i < comments_.size(); ++i) {
+      const std::string& text = comments_[i].text;
+      if (text.compare(0, step_size_label.size(), step_size_label) == 0) {
+        found = true;
+        step_size = std::strtod(text.c_str() + step_size_label.size(), nullptr);
+      } else if (text == "Diagonal elements of inverse mass matrix:"
+                 || text == "Elements of inverse mass matrix:") {
+        metric.clear();
+        std::vector<double> row;
+        while (i + 1 < comments_.size()
+               && parse_metric_row(comments_[i + 1].text, row)) {
+          metric.push_back(row);
+          ++i;
+        }
+      }
+    }
+    if (!found)
+      return;
+    json << ",\"adaptation\":{\"step_size\":" << format_number(step_size)
+         << ",\"inv_metric\":[";
+    for (std::size_t i = 0; i < metric.size(); ++i) {
+      json << (i ? "," : "") << "[";
+      for (std::size_t j = 0; j < metric[i].size(); ++j)
+        json << (j ? "," : "") << format_number(metric[i][j]);
+      json << "]";
+    }
+    json << "]}";
+  }
+
+  void write_trailer() {
+    std::stringstream json;
+    json << "{\"num_draws\":" << num_draws_ << ",\"chunks\":[";
+    for (std::size_t i = 0; i < chunks_.size(); ++i)
+      json << (i ? "," : "") << "{\"offset\":" << chunks_[i].first
+           << ",\"rows\":" << chunks_[i].second << "}";
+    json << "],\"comments\":[";
+    for (std::size_t i = header_comments_; i < comments_.size(); ++i) {
+      json << (i > header_comments_ ? "," : "") << "{\"draw\":"
+           << comments_[i].draw;
+      if (!comments_[i].blank)
+        json << ",\"text\":" << io::columnar_format::quote(comments_[i].text);
+      json << "}";
+    }
+    json << "]";
+    write_adaptation(json);
+    json << "}";
+
+    std::string trailer = json.str();
+    write_bytes(trailer.data(), trailer.size());
+    write_uint64(trailer.size());
+    write_bytes(io::columnar_format::magic, io::columnar_format::magic_size);
+  }
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -0,0 +1,131 @@
+#ifndef STAN_CALLBACKS_CSV_ROW_BUFFER_HPP
+#define STAN_CALLBACKS_CSV_ROW_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace stan {
+namespace callbacks {
+
+/**
+ * How the stream writers format values.
+ */
+enum class number_format {
+  /**
+   * Through <code>operator&lt;&lt;</code>, with the precision set on
+   * the stream, writing and flushing each line.
+   */
+  stream_precision,
+  /**
+   * As the shortest string which reads back as the same double,
+   * collecting lines in a buffer which is written in batches.
+   */
+  shortest_round_trip
+};
+
+/**
+ * Reusable buffer in which the stream writers assemble CSV lines in
+ * the <code>shortest_round_trip</code> format, so that a batch of lines
+ * is written to the stream with a single call.
+ *
+ * Values are formatted with <code>std::to_chars</code> where the
+ * standard library supports it for doubles, which yields the shortest
+ * representation that round-trips; otherwise they are written with 17
+ * significant digits, which also round-trips.
+ */
+class csv_row_buffer {
+ public:
+  /**
+   * Size in bytes above which the buffered lines should be written.
+   */
+  static constexpr std::size_t batch_bytes = std::size_t(1) << 16;
+
+  /**
+   * Append a line of comma separated values.
+   *
+   * @tparam T type of the values, double or std::string
+   * @param[in] values values of the line, which is skipped if empty
+   */
+  template <typename T>
+  void append_line(const std::vector<T>& values) {
+    if (values.empty())
+      return;
+    for (const auto& x : values) {
+      append(x);
+      buffer_ += ',';
+    }
+    buffer_.back() = '\n';
+  }
+
+  /**
+   * Append a comment line.
+   *
+   * @param[in] prefix comment prefix
+   * @param[in] message comment
+   */
+  void append_comment(const std::string& prefix, const std::string& message) {
+    buffer_ += prefix;
+    buffer_ += message;
+    buffer_ += '\n';
+  }
+
+  /**
+   * Append a value.
+   *
+   * @param[in] x value
+   */
+  void append(double x) {
+    const std::size_t size = buffer_.size();
+    buffer_.resize(size + max_chars);
+    char* first = &buffer_[size];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    char* last = std::to_chars(first, first + max_chars, x).ptr;
+#else
+    char* last = first + std::snprintf(first, max_chars, "%.17g", x);
+#endif
+    buffer_.resize(last - &buffer_[0]);
+  }
+
+  void append(const std::string& x) { buffer_ += x; }
+
+  /**
+   * Return true if the buffered lines should be written.
+   */
+  bool full() const { return buffer_.size() >= batch_bytes; }
+
+  /**
+   * Write the buffered lines to the stream and clear the buffer, which
+   * keeps its capacity.
+   *
+   * @tparam Stream type with a valid <code>write(const char*, n)</code>
+   * @param[in, out] output stream to write to
+   */
+  template <typename Stream>
+  void write_to(Stream& output) {
+    if (buffer_.empty())
+      return;
+    output.write(buffer_.data(), buffer_.size());
+    buffer_.clear();
+  }
+
+ private:
+  /**
+   * Upper bound on the length of a formatted double, e.g.
+   * "-2.2250738585072014e-308".
+   */
+  static constexpr std::size_t max_chars = 32;
+
+  std::string buffer_;
+};
+
+}  // namespace callbacks
+}  // namespace stan
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef STAN_CALLBACKS_STREAM_WRITER_HPP
 #define STAN_CALLBACKS_STREAM_WRITER_HPP
 
+#include <stan/callbacks/csv_row_buffer.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <ostream>
 #include <vector>
@@ -12,6 +13,11 @@ namespace callbacks {
 /**
  * <code>stream_writer</code> is an implementation
  * of <code>writer</code> that writes to a stream.
+ *
+ * In the <code>shortest_round_trip</code> format, lines are collected
+ * in a buffer and written in batches without flushing the stream; the
+ * buffer is written out, and the stream flushed, on each comment, on
+ * <code>flush()</code> and on destruction.
  */
 class stream_writer : public writer {
  public:
@@ -22,15 +28,18 @@ class stream_writer : public writer {
    * @param[in, out] output stream to write
    * @param[in] comment_prefix string to stream before
    *   each comment line. Default is "".
+   * @param[in] format how to format values. Default is
+   *   <code>stream_precision</code>.
    */
-  explicit stream_writer(std::ostream& output,
-                         const std::string& comment_prefix = "")
-      : output_(output), comment_prefix_(comment_prefix) {}
+  explicit stream_writer(
+      std::ostream& output, const std::string& comment_prefix = "",
+      number_format format = number_format::stream_precision)
+      : output_(output), comment_prefix_(comment_prefix), format_(format) {}
 
   /**
    * Virtual destructor
    */
-  virtual ~stream_writer() {}
+  virtual ~stream_writer() { buffer_.write_to(output_); }
 
   /**
    * Writes a set of names on a single line in csv format followed
@@ -47,8 +56,9 @@ class stream_writer : public writer {
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
+   * Note: in the <code>stream_precision</code> format the precision of
+   *  the output is determined by the settings of the stream on
+   *  construction.
    *
    * @param[in] state Values in a std::vector
    */
@@ -57,7 +67,7 @@ class stream_writer : public writer {
   /**
    * Writes the comment_prefix to the stream followed by a newline.
    */
-  void operator()() { output_ << comment_prefix_ << std::endl; }
+  void operator()() { (*this)(std::string()); }
 
   /**
    * Writes the comment_prefix then the message followed by a newline.
@@ -65,9 +75,22 @@ class stream_writer : public writer {
    * @param[in] message A string
    */
   void operator()(const std::string& message) {
+    if (format_ == number_format::shortest_round_trip) {
+      buffer_.append_comment(comment_prefix_, message);
+      flush();
+      return;
+    }
     output_ << comment_prefix_ << message << std::endl;
   }
 
+  /**
+   * Writes any buffered lines and flushes the stream.
+   */
+  void flush() {
+    buffer_.write_to(output_);
+    output_.flush();
+  }
+
  private:
   /**
    * Output stream
@@ -79,6 +102,16 @@ class stream_writer : public writer {
    */
   std::string comment_prefix_;
 
+  /**
+   * How values are formatted
+   */
+  number_format format_;
+
+  /**
+   * Lines not yet written in the <code>shortest_round_trip</code> format
+   */
+  csv_row_buffer buffer_;
+
   /**
    * Writes a set of values in csv format followed by a newline.
    *
@@ -91,6 +124,12 @@ class stream_writer : public writer {
   void write_vector(const std::vector<T>& v) {
     if (v.empty())
       return;
+    if (format_ == number_format::shortest_round_trip) {
+      buffer_.append_line(v);
+      if (buffer_.full())
+        buffer_.write_to(output_);
+      return;
+    }
 
     typename std::vector<T>::const_iterator last = v.end();
     --last;
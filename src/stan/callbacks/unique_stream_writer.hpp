@@ -1,6 +1,7 @@
 #ifndef STAN_CALLBACKS_UNIQUE_STREAM_WRITER_HPP
 #define STAN_CALLBACKS_UNIQUE_STREAM_WRITER_HPP
 
+#include <stan/callbacks/csv_row_buffer.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <memory>
@@ -15,6 +16,11 @@ namespace callbacks {
  * `unique_stream_writer` is an implementation
  * of `writer` that holds a unique pointer to the stream it is
  * writing to.
+ *
+ * In the `shortest_round_trip` format, lines are collected in a buffer
+ * and written in batches without flushing the stream; the buffer is
+ * written out, and the stream flushed, on each comment, on `flush()`
+ * and on destruction.
  * @tparam Stream A type with with a valid `operator<<(std::string)`
  * @tparam Deleter A class with a valid `operator()` method for deleting the
  * output stream
@@ -30,20 +36,30 @@ class unique_stream_writer final : public writer {
    * `std::ostream`
    * @param[in] comment_prefix string to stream before each comment line.
    *  Default is "".
+   * @param[in] format how to format values. Default is `stream_precision`.
    */
-  explicit unique_stream_writer(std::unique_ptr<Stream, Deleter>&& output,
-                                const std::string& comment_prefix = "")
-      : output_(std::move(output)), comment_prefix_(comment_prefix) {}
+  explicit unique_stream_writer(
+      std::unique_ptr<Stream, Deleter>&& output,
+      const std::string& comment_prefix = "",
+      number_format format = number_format::stream_precision)
+      : output_(std::move(output)),
+        comment_prefix_(comment_prefix),
+        format_(format) {}
 
   unique_stream_writer();
   unique_stream_writer(unique_stream_writer& other) = delete;
   unique_stream_writer(unique_stream_writer&& other)
       : output_(std::move(other.output_)),
-        comment_prefix_(std::move(other.comment_prefix_)) {}
+        comment_prefix_(std::move(other.comment_prefix_)),
+        format_(other.format_),
+        buffer_(std::move(other.buffer_)) {}
   /**
    * Virtual destructor
    */
-  virtual ~unique_stream_writer() {}
+  virtual ~unique_stream_writer() {
+    if (output_ != nullptr)
+      buffer_.write_to(*output_);
+  }
 
   /**
    * Writes a set of names on a single line in csv format followed
@@ -60,15 +76,16 @@ class unique_stream_writer final : public writer {
   }
 
   /**
-   * Get the underlying stream
+   * Get the underlying stream. Lines buffered in the
+   * `shortest_round_trip` format are only on the stream after `flush()`.
    */
   inline auto& get_stream() noexcept { return *output_; }
 
   /**
    * Writes a set of values in csv format followed by a newline.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
+   * Note: in the `stream_precision` format the precision of the output is
+   *  determined by the settings of the stream on construction.
    *
    * @param[in] values Values in a std::vector
    */
@@ -81,8 +98,8 @@ class unique_stream_writer final : public writer {
   /**
    * Writes multiple rows and columns of values in csv format.
    *
-   * Note: the precision of the output is determined by the settings
-   *  of the stream on construction.
+   * Note: in the `stream_precision` format the precision of the output is
+   *  determined by the settings of the stream on construction.
    *
    * @param[in] values A matrix of values. The input is expected to have
    * parameters in the rows and samples in the columns. The matrix is then
@@ -91,6 +108,16 @@ class unique_stream_writer final : public writer {
   void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
     if (output_ == nullptr)
       return;
+    if (format_ == number_format::shortest_round_trip) {
+      row_.resize(values.rows());
+      for (Eigen::Index j = 0; j < values.cols(); ++j) {
+        Eigen::Map<Eigen::VectorXd>(row_.data(), row_.size()) = values.col(j);
+        buffer_.append_line(row_);
+        if (buffer_.full())
+          buffer_.write_to(*output_);
+      }
+      return;
+    }
     *output_ << values.transpose().format(CommaInitFmt);
   }
 
@@ -100,6 +127,11 @@ class unique_stream_writer final : public writer {
   void operator()() {
     if (output_ == nullptr)
       return;
+    if (format_ == number_format::shortest_round_trip) {
+      buffer_.append_comment(comment_prefix_, "");
+      flush();
+      return;
+    }
     *output_ << comment_prefix_ << std::endl;
   }
 
@@ -111,9 +143,24 @@ class unique_stream_writer final : public writer {
   void operator()(const std::string& message) {
     if (output_ == nullptr)
       return;
+    if (format_ == number_format::shortest_round_trip) {
+      buffer_.append_comment(comment_prefix_, message);
+      flush();
+      return;
+    }
     *output_ << comment_prefix_ << message << std::endl;
   }
 
+  /**
+   * Writes any buffered lines and flushes the stream.
+   */
+  void flush() {
+    if (output_ == nullptr)
+      return;
+    buffer_.write_to(*output_);
+    output_->flush();
+  }
+
  private:
   /**
    * Comma formatter for writing Eigen matrices
@@ -131,6 +178,21 @@ class unique_stream_writer final : public writer {
    */
   std::string comment_prefix_;
 
+  /**
+   * How values are formatted
+   */
+  number_format format_;
+
+  /**
+   * Lines not yet written in the `shortest_round_trip` format
+   */
+  csv_row_buffer buffer_;
+
+  /**
+   * Reused row of the matrix being written
+   */
+  std::vector<double> row_;
+
   /**
    * Writes a set of values in csv format followed by a newline.
    *
@@ -146,6 +208,12 @@ class unique_stream_writer final : public writer {
     if (v.empty()) {
       return;
     }
+    if (format_ == number_format::shortest_round_trip) {
+      buffer_.append_line(v);
+      if (buffer_.full())
+        buffer_.write_to(*output_);
+      return;
+    }
     auto last = v.end();
     --last;
     for (auto it = v.begin(); it != last; ++it) {
@@ -287,6 +287,21 @@ class array_var_context : public var_context {
     return empty_vec_r_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name, without copying them unless they are integers.
+   *
+   * @param name Name of variable.
+   * @return View of the values of variable.
+   */
+  vals_view<double> vals_r_view(const std::string& name) const {
+    const auto ret_val_r = vars_r_.find(name);
+    if (ret_val_r != vars_r_.end()) {
+      return vals_view<double>(ret_val_r->second.first);
+    }
+    return vals_view<double>(vals_r(name));
+  }
+
   /**
    * Return the double values for the variable with the specified
    * name or null.
@@ -346,6 +361,25 @@ class array_var_context : public var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the dimensions for the double variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the dimensions of variable.
+   */
+  vals_view<size_t> dims_r_view(const std::string& name) const {
+    const auto ret_val_r = vars_r_.find(name);
+    if (ret_val_r != vars_r_.end()) {
+      return vals_view<size_t>(ret_val_r->second.second);
+    }
+    const auto ret_val_i = vars_i_.find(name);
+    if (ret_val_i != vars_i_.end()) {
+      return vals_view<size_t>(ret_val_i->second.second);
+    }
+    return vals_view<size_t>();
+  }
+
   /**
    * Return the integer values for the variable with the specified
    * name.
@@ -361,6 +395,21 @@ class array_var_context : public var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the values.
+   */
+  vals_view<int> vals_i_view(const std::string& name) const {
+    auto ret_val_i = vars_i_.find(name);
+    if (ret_val_i != vars_i_.end()) {
+      return vals_view<int>(ret_val_i->second.first);
+    }
+    return vals_view<int>();
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
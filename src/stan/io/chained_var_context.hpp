@@ -34,6 +34,11 @@ class chained_var_context : public var_context {
     return vc1_.contains_r(name) ? vc1_.vals_r(name) : vc2_.vals_r(name);
   }
 
+  vals_view<double> vals_r_view(const std::string& name) const {
+    return vc1_.contains_r(name) ? vc1_.vals_r_view(name)
+                                 : vc2_.vals_r_view(name);
+  }
+
   std::vector<std::complex<double>> vals_c(const std::string& name) const {
     return vc1_.contains_r(name) ? vc1_.vals_c(name) : vc2_.vals_c(name);
   }
@@ -42,10 +47,20 @@ class chained_var_context : public var_context {
     return vc1_.contains_i(name) ? vc1_.vals_i(name) : vc2_.vals_i(name);
   }
 
+  vals_view<int> vals_i_view(const std::string& name) const {
+    return vc1_.contains_i(name) ? vc1_.vals_i_view(name)
+                                 : vc2_.vals_i_view(name);
+  }
+
   std::vector<size_t> dims_r(const std::string& name) const {
     return vc1_.contains_r(name) ? vc1_.dims_r(name) : vc2_.dims_r(name);
   }
 
+  vals_view<size_t> dims_r_view(const std::string& name) const {
+    return vc1_.contains_r(name) ? vc1_.dims_r_view(name)
+                                 : vc2_.dims_r_view(name);
+  }
+
   std::vector<size_t> dims_i(const std::string& name) const {
     return vc1_.contains_r(name) ? vc1_.dims_i(name) : vc2_.dims_i(name);
   }
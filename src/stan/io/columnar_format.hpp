@@ -0,0 +1,165 @@
+#ifndef STAN_IO_COLUMNAR_FORMAT_HPP
+#define STAN_IO_COLUMNAR_FORMAT_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace stan {
+namespace io {
+
+/**
+ * Constants and helpers shared by <code>callbacks::columnar_writer</code>
+ * and <code>io::columnar_reader</code>.
+ *
+ * <p>A columnar draws file is laid out as
+ *
+ * <pre>
+ *   magic                 8 bytes, "STANCOL1"
+ *   header length         uint64
+ *   header                JSON, padded with spaces to a multiple of 8 bytes
+ *   chunk ...             uint64 number of rows, then for each column
+ *                         that many float64 values
+ *   trailer               JSON
+ *   trailer length        uint64
+ *   magic                 8 bytes, "STANCOL1"
+ * </pre>
+ *
+ * <p>All integers and values are little-endian.  Chunks start on
+ * 8-byte boundaries, so every column slice of every chunk is an
+ * aligned array of doubles which can be memory mapped in place; the
+ * offset of each chunk is listed in the trailer.
+ *
+ * <p>The header holds the column names, the variables and dimensions
+ * they make up, the chunk size and the comments written before the
+ * first draw.  The trailer holds the number of draws, the chunk
+ * index, the remaining comments (each tagged with the number of draws
+ * written before it, so the original output can be replayed) and the
+ * step size and inverse metric when adaptation information was
+ * written.
+ */
+struct columnar_format {
+  static constexpr const char* magic = "STANCOL1";
+  static constexpr std::size_t magic_size = 8;
+  static constexpr int version = 1;
+
+  /**
+   * Return true if the host stores values little-endian.
+   */
+  static bool host_is_little_endian() {
+    const std::uint16_t one = 1;
+    unsigned char first_byte;
+    std::memcpy(&first_byte, &one, 1);
+    return first_byte == 1;
+  }
+
+  /**
+   * Reverse the byte order of each of the specified 8-byte values in
+   * place if the host is big-endian, converting between host and file
+   * byte order.
+   *
+   * @param[in,out] data pointer to the values
+   * @param[in] n number of values
+   */
+  static void swap_to_little_endian(void* data, std::size_t n) {
+    if (host_is_little_endian())
+      return;
+    unsigned char* bytes = static_cast<unsigned char*>(data);
+    for (std::size_t i = 0; i < n; ++i, bytes += 8)
+      for (int b = 0; b < 4; ++b)
+        std::swap(bytes[b], bytes[7 - b]);
+  }
+
+  /**
+   * Encode an unsigned 64-bit integer as 8 little-endian bytes.
+   *
+   * @param[in] value value to encode
+   * @param[out] bytes buffer of at least 8 bytes
+   */
+  static void encode_uint64(std::uint64_t value, char* bytes) {
+    for (int b = 0; b < 8; ++b)
+      bytes[b] = static_cast<char>((value >> (8 * b)) & 0xff);
+  }
+
+  /**
+   * Decode an unsigned 64-bit integer from 8 little-endian bytes.
+   *
+   * @param[in] bytes buffer of at least 8 bytes
+   * @return decoded value
+   */
+  static std::uint64_t decode_uint64(const char* bytes) {
+    std::uint64_t value = 0;
+    for (int b = 7; b >= 0; --b)
+      value = (value << 8) | static_cast<unsigned char>(bytes[b]);
+    return value;
+  }
+
+  /**
+   * Read an unsigned 64-bit little-endian integer from the stream.
+   *
+   * @param[in,out] in input stream
+   * @return value read
+   * @throw std::domain_error if the stream ends early
+   */
+  static std::uint64_t read_uint64(std::istream& in) {
+    char bytes[8];
+    if (!in.read(bytes, 8))
+      throw std::domain_error("columnar draws file is truncated");
+    return decode_uint64(bytes);
+  }
+
+  /**
+   * Return the specified string as a quoted and escaped JSON string.
+   *
+   * @param[in] value string to quote
+   * @return JSON string literal
+   */
+  static std::string quote(const std::string& value) {
+    std::string quoted;
+    quoted.reserve(value.size() + 2);
+    quoted += '"';
+    for (char c : value) {
+      switch (c) {
+        case '"':
+          quoted += "\\\"";
+          break;
+        case '\\':
+          quoted += "\\\\";
+          break;
+        case '\n':
+          quoted += "\\n";
+          break;
+        case '\r':
+          quoted += "\\r";
+          break;
+        case '\t':
+          quoted += "\\t";
+          break;
+        case '\b':
+          quoted += "\\b";
+          break;
+        case '\f':
+          quoted += "\\f";
+          break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            quoted += escaped;
+          } else {
+            quoted += c;
+          }
+      }
+    }
+    quoted += '"';
+    return quoted;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+#endif
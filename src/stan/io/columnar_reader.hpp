@@ -0,0 +1,444 @@
+#ifndef STAN_IO_COLUMNAR_READER_HPP
+#define STAN_IO_COLUMNAR_READER_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/columnar_format.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <rapidjson/document.h>
+#include <rapidjson/error/en.h>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace io {
+
+/**
+ * A variable made up of one or more columns of a columnar draws file.
+ */
+struct columnar_variable {
+  std::string name;
+  std::vector<size_t> dims;
+};
+
+/**
+ * A chunk of a columnar draws file: the offset of its row count from
+ * the start of the file and the number of draws it holds.
+ */
+struct columnar_chunk {
+  std::uint64_t offset;
+  std::uint64_t rows;
+};
+
+/**
+ * A comment of a columnar draws file and the number of draws written
+ * before it.
+ */
+struct columnar_comment {
+  size_t draw;
+  bool blank;
+  std::string text;
+};
+
+/**
+ * Reads draws written by <code>callbacks::columnar_writer</code>.
+ *
+ * <p>The header and trailer are read on construction; the draws are
+ * read on demand, a column at a time, by seeking to its slice in each
+ * chunk.  Tools which memory map the file can use
+ * <code>column_offset</code> to locate the slices instead.
+ */
+class columnar_reader {
+ public:
+  /**
+   * Read the header and trailer of the columnar draws file on the
+   * specified stream, which must be seekable, opened in binary mode and
+   * outlive the reader.
+   *
+   * @param[in,out] in input stream positioned at the start of the file
+   * @throw std::domain_error if the stream does not hold a complete
+   * columnar draws file
+   */
+  explicit columnar_reader(std::istream& in) : in_(in), start_(in.tellg()) {
+    const size_t magic_size = columnar_format::magic_size;
+    std::string magic(magic_size, '\0');
+    if (!in_.read(&magic[0], magic_size) || magic != columnar_format::magic)
+      throw std::domain_error("not a columnar draws file");
+    std::uint64_t header_size = columnar_format::read_uint64(in_);
+    rapidjson::Document header;
+    parse(read_string(header_size), header);
+    read_header(header);
+
+    in_.seekg(0, std::ios::end);
+    const std::uint64_t end = static_cast<std::uint64_t>(in_.tellg()) - start_;
+    if (end < 2 * magic_size + header_size + 16)
+      throw std::domain_error("columnar draws file is truncated");
+    seek(end - magic_size - 8);
+    std::uint64_t trailer_size = columnar_format::read_uint64(in_);
+    if (!in_.read(&magic[0], magic_size) || magic != columnar_format::magic
+        || trailer_size > end - 2 * magic_size - 16 - header_size)
+      throw std::domain_error("columnar draws file is truncated");
+    seek(end - magic_size - 8 - trailer_size);
+    rapidjson::Document trailer;
+    parse(read_string(trailer_size), trailer);
+    read_trailer(trailer);
+  }
+
+  /**
+   * Return the column names.
+   */
+  const std::vector<std::string>& names() const { return names_; }
+
+  /**
+   * Return the variables the columns make up, in order.
+   */
+  const std::vector<columnar_variable>& variables() const {
+    return variables_;
+  }
+
+  size_t num_columns() const { return num_columns_; }
+
+  size_t num_draws() const { return num_draws_; }
+
+  /**
+   * Return the chunk index.
+   */
+  const std::vector<columnar_chunk>& chunks() const { return chunks_; }
+
+  /**
+   * Return the comments written before the column names.
+   */
+  const std::vector<columnar_comment>& header_comments() const {
+    return header_comments_;
+  }
+
+  /**
+   * Return the comments written after the column names.
+   */
+  const std::vector<columnar_comment>& comments() const { return comments_; }
+
+  /**
+   * Return true if the file holds a step size and inverse metric.
+   */
+  bool has_adaptation() const { return has_adaptation_; }
+
+  /**
+   * Return the step size and inverse metric, with the diagonal of a
+   * diagonal metric stored as a single row as in
+   * <code>stan_csv_reader</code>.
+   */
+  const stan_csv_adaptation& adaptation() const { return adaptation_; }
+
+  /**
+   * Return the index of the column with the specified name.
+   *
+   * @param[in] name column name
+   * @throw std::invalid_argument if there is no such column
+   */
+  size_t column_index(const std::string& name) const {
+    for (size_t j = 0; j < names_.size(); ++j)
+      if (names_[j] == name)
+        return j;
+    throw std::invalid_argument("columnar_reader: no column named " + name);
+  }
+
+  /**
+   * Return the offset from the start of the file of the values of the
+   * specified column within the specified chunk.  The values are
+   * <code>chunks()[chunk].rows</code> little-endian doubles, aligned
+   * to 8 bytes.
+   *
+   * @param[in] chunk index of the chunk
+   * @param[in] column index of the column
+   */
+  std::uint64_t column_offset(size_t chunk, size_t column) const {
+    return chunks_[chunk].offset + 8 + 8 * column * chunks_[chunk].rows;
+  }
+
+  /**
+   * Read all draws of the specified column.
+   *
+   * @param[in] column index of the column
+   * @return vector of <code>num_draws()</code> values
+   * @throw std::out_of_range if the index is out of range
+   */
+  Eigen::VectorXd column(size_t column) {
+    if (column >= num_columns_)
+      throw std::out_of_range("columnar_reader: column index out of range");
+    Eigen::VectorXd values(num_draws_);
+    size_t row = 0;
+    for (size_t c = 0; c < chunks_.size(); ++c) {
+      read_values(column_offset(c, column), chunks_[c].rows,
+                  values.data() + row);
+      row += chunks_[c].rows;
+    }
+    return values;
+  }
+
+  /**
+   * Read all draws of the column with the specified name.
+   *
+   * @param[in] name column name
+   * @return vector of <code>num_draws()</code> values
+   */
+  Eigen::VectorXd column(const std::string& name) {
+    return column(column_index(name));
+  }
+
+  /**
+   * Read all draws, one draw per row as in <code>stan_csv</code>.
+   *
+   * @return matrix of <code>num_draws()</code> rows and
+   * <code>num_columns()</code> columns
+   */
+  Eigen::MatrixXd draws() {
+    Eigen::MatrixXd values(num_draws_, num_columns_);
+    Eigen::VectorXd buffer;
+    size_t row = 0;
+    for (size_t c = 0; c < chunks_.size(); ++c) {
+      // Columns of a chunk are contiguous, so read it in one pass
+      const Eigen::Index rows = chunks_[c].rows;
+      buffer.resize(rows * num_columns_);
+      read_values(column_offset(c, 0), buffer.size(), buffer.data());
+      values.middleRows(row, rows)
+          = Eigen::Map<Eigen::MatrixXd>(buffer.data(), rows, num_columns_);
+      row += rows;
+    }
+    return values;
+  }
+
+  /**
+   * Write the contents of the file to the specified writer in the order
+   * they were originally written: the header comments, the column
+   * names, then the draws interleaved with the remaining comments.
+   * Replaying into a <code>stream_writer</code> with the comment prefix
+   * <code>"# "</code> reproduces the Stan CSV output.
+   *
+   * @param[in,out] writer writer to replay to
+   */
+  void replay(callbacks::writer& writer) {
+    for (const auto& comment : header_comments_)
+      write_comment(comment, writer);
+    if (!names_.empty())
+      writer(names_);
+    std::vector<double> draw(num_columns_);
+    Eigen::VectorXd buffer;
+    auto comment = comments_.begin();
+    size_t row = 0;
+    for (size_t c = 0; c < chunks_.size(); ++c) {
+      const size_t rows = chunks_[c].rows;
+      buffer.resize(rows * num_columns_);
+      read_values(column_offset(c, 0), buffer.size(), buffer.data());
+      for (size_t i = 0; i < rows; ++i, ++row) {
+        for (; comment != comments_.end() && comment->draw <= row; ++comment)
+          write_comment(*comment, writer);
+        for (size_t j = 0; j < num_columns_; ++j)
+          draw[j] = buffer.coeff(j * rows + i);
+        writer(draw);
+      }
+    }
+    for (; comment != comments_.end(); ++comment)
+      write_comment(*comment, writer);
+  }
+
+  /**
+   * Read the whole file into a <code>stan_csv</code>, as
+   * <code>stan_csv_reader::parse</code> would read the equivalent CSV
+   * file.  Only the names, adaptation and draws are filled in; the
+   * names are prettified as by <code>prettify_stan_csv_name</code>.
+   */
+  stan_csv to_stan_csv() {
+    stan_csv data;
+    data.header = names_;
+    for (auto& name : data.header)
+      prettify_stan_csv_name(name);
+    data.adaptation = adaptation_;
+    data.samples = draws();
+    data.timing.warmup = 0;
+    data.timing.sampling = 0;
+    return data;
+  }
+
+ private:
+  std::istream& in_;
+  std::streamoff start_;
+  std::vector<std::string> names_;
+  std::vector<columnar_variable> variables_;
+  size_t num_columns_ = 0;
+  size_t num_draws_ = 0;
+  std::vector<columnar_chunk> chunks_;
+  std::vector<columnar_comment> header_comments_;
+  std::vector<columnar_comment> comments_;
+  bool has_adaptation_ = false;
+  stan_csv_adaptation adaptation_;
+
+  static void malformed(const std::string& what) {
+    throw std::domain_error("columnar draws file has a malformed " + what);
+  }
+
+  void seek(std::uint64_t offset) {
+    in_.clear();
+    if (!in_.seekg(start_ + static_cast<std::streamoff>(offset)))
+      throw std::domain_error("columnar draws file is truncated");
+  }
+
+  std::string read_string(std::uint64_t size) {
+    std::string value(size, '\0');
+    if (size > 0 && !in_.read(&value[0], size))
+      throw std::domain_error("columnar draws file is truncated");
+    return value;
+  }
+
+  void read_values(std::uint64_t offset, size_t n, double* values) {
+    seek(offset);
+    if (!in_.read(reinterpret_cast<char*>(values), 8 * n))
+      throw std::domain_error("columnar draws file is truncated");
+    columnar_format::swap_to_little_endian(values, n);
+  }
+
+  static void parse(const std::string& json, rapidjson::Document& doc) {
+    doc.Parse(json.c_str(), json.size());
+    if (doc.HasParseError() || !doc.IsObject()) {
+      std::stringstream msg;
+      msg << "columnar draws file has malformed JSON: "
+          << rapidjson::GetParseError_En(doc.GetParseError());
+      throw std::domain_error(msg.str());
+    }
+  }
+
+  static const rapidjson::Value& member(const rapidjson::Value& object,
+                                        const char* name) {
+    auto it = object.FindMember(name);
+    if (it == object.MemberEnd())
+      malformed(std::string("entry, missing ") + name);
+    return it->value;
+  }
+
+  static size_t to_size(const rapidjson::Value& value, const char* what) {
+    if (!value.IsUint64())
+      malformed(what);
+    return value.GetUint64();
+  }
+
+  static double to_double(const rapidjson::Value& value) {
+    if (value.IsNull())
+      return std::numeric_limits<double>::quiet_NaN();
+    if (!value.IsNumber())
+      malformed("adaptation entry");
+    return value.GetDouble();
+  }
+
+  void read_header(const rapidjson::Document& header) {
+    if (to_size(member(header, "version"), "version")
+        > static_cast<size_t>(columnar_format::version))
+      throw std::domain_error("columnar draws file version is not supported");
+    num_columns_ = to_size(member(header, "num_columns"), "column count");
+    const rapidjson::Value& names = member(header, "names");
+    if (!names.IsArray())
+      malformed("names entry");
+    for (const auto& name : names.GetArray()) {
+      if (!name.IsString())
+        malformed("names entry");
+      names_.emplace_back(name.GetString(), name.GetStringLength());
+    }
+    if (!names_.empty() && names_.size() != num_columns_)
+      malformed("names entry");
+    const rapidjson::Value& variables = member(header, "variables");
+    if (!variables.IsArray())
+      malformed("variables entry");
+    for (const auto& variable : variables.GetArray()) {
+      columnar_variable var;
+      const rapidjson::Value& name = member(variable, "name");
+      const rapidjson::Value& dims = member(variable, "dims");
+      if (!name.IsString() || !dims.IsArray())
+        malformed("variables entry");
+      var.name.assign(name.GetString(), name.GetStringLength());
+      for (const auto& dim : dims.GetArray())
+        var.dims.push_back(to_size(dim, "variables entry"));
+      variables_.push_back(var);
+    }
+    const rapidjson::Value& comments = member(header, "comments");
+    if (!comments.IsArray())
+      malformed("comments entry");
+    for (const auto& comment : comments.GetArray()) {
+      if (comment.IsNull())
+        header_comments_.push_back({0, true, std::string()});
+      else if (comment.IsString())
+        header_comments_.push_back(
+            {0, false,
+             std::string(comment.GetString(), comment.GetStringLength())});
+      else
+        malformed("comments entry");
+    }
+  }
+
+  void read_trailer(const rapidjson::Document& trailer) {
+    num_draws_ = to_size(member(trailer, "num_draws"), "draw count");
+    const rapidjson::Value& chunks = member(trailer, "chunks");
+    if (!chunks.IsArray())
+      malformed("chunk index");
+    size_t rows = 0;
+    for (const auto& chunk : chunks.GetArray()) {
+      chunks_.push_back({to_size(member(chunk, "offset"), "chunk index"),
+                         to_size(member(chunk, "rows"), "chunk index")});
+      rows += chunks_.back().rows;
+    }
+    if (rows != num_draws_)
+      malformed("chunk index");
+    const rapidjson::Value& comments = member(trailer, "comments");
+    if (!comments.IsArray())
+      malformed("comments entry");
+    for (const auto& comment : comments.GetArray()) {
+      columnar_comment c{to_size(member(comment, "draw"), "comments entry"),
+                         true, std::string()};
+      auto text = comment.FindMember("text");
+      if (text != comment.MemberEnd()) {
+        if (!text->value.IsString())
+          malformed("comments entry");
+        c.blank = false;
+        c.text.assign(text->value.GetString(), text->value.GetStringLength());
+      }
+      comments_.push_back(c);
+    }
+    auto adaptation = trailer.FindMember("adaptation");
+    if (adaptation != trailer.MemberEnd()) {
+      has_adaptation_ = true;
+      adaptation_.step_size
+          = to_double(member(adaptation->value, "step_size"));
+      const rapidjson::Value& metric
+          = member(adaptation->value, "inv_metric");
+      if (!metric.IsArray())
+        malformed("adaptation entry");
+      const rapidjson::SizeType rows = metric.Size();
+      const rapidjson::SizeType cols = rows > 0 && metric[0].IsArray()
+                                           ? metric[0].Size()
+                                           : 0;
+      adaptation_.metric.resize(rows, cols);
+      for (rapidjson::SizeType i = 0; i < rows; ++i) {
+        if (!metric[i].IsArray() || metric[i].Size() != cols)
+          malformed("adaptation entry");
+        for (rapidjson::SizeType j = 0; j < cols; ++j)
+          adaptation_.metric(i, j) = to_double(metric[i][j]);
+      }
+    }
+  }
+
+  static void write_comment(const columnar_comment& comment,
+                            callbacks::writer& writer) {
+    if (comment.blank)
+      writer();
+    else
+      writer(comment.text);
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
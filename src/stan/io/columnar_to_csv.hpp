@@ -0,0 +1,33 @@
+#ifndef STAN_IO_COLUMNAR_TO_CSV_HPP
+#define STAN_IO_COLUMNAR_TO_CSV_HPP
+
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/io/columnar_reader.hpp>
+#include <istream>
+#include <ostream>
+
+namespace stan {
+namespace io {
+
+/**
+ * Convert a columnar draws file written by
+ * <code>callbacks::columnar_writer</code> to the Stan CSV format, with
+ * comments prefixed by <code>"# "</code>.
+ *
+ * Note: the precision of the output is determined by the settings of
+ * the output stream.
+ *
+ * @param[in,out] in seekable input stream holding the columnar file
+ * @param[in,out] out output stream for the CSV
+ * @throw std::domain_error if the input is not a columnar draws file
+ */
+inline void columnar_to_csv(std::istream& in, std::ostream& out) {
+  columnar_reader reader(in);
+  callbacks::stream_writer writer(out, "# ");
+  reader.replay(writer);
+}
+
+}  // namespace io
+}  // namespace stan
+
+#endif
@@ -674,7 +674,7 @@ class dump : public stan::io::var_context {
     if (contains_r_only(name)) {
       return (vars_r_.find(name)->second).first;
     } else if (contains_i(name)) {
-      std::vector<int> vec_int = (vars_i_.find(name)->second).first;
+      const std::vector<int>& vec_int = (vars_i_.find(name)->second).first;
       std::vector<double> vec_r(vec_int.size());
       for (size_t ii = 0; ii < vec_int.size(); ii++) {
         vec_r[ii] = vec_int[ii];
@@ -684,6 +684,20 @@ class dump : public stan::io::var_context {
     return empty_vec_r_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name, without copying them unless they are integers.
+   *
+   * @param name Name of variable.
+   * @return View of the values of variable.
+   */
+  vals_view<double> vals_r_view(const std::string& name) const {
+    if (contains_r_only(name)) {
+      return vals_view<double>((vars_r_.find(name)->second).first);
+    }
+    return vals_view<double>(vals_r(name));
+  }
+
   std::vector<std::complex<double>> vals_c(const std::string& name) const {
     const auto val_r = vars_r_.find(name);
     if (val_r != vars_r_.end()) {
@@ -731,6 +745,22 @@ class dump : public stan::io::var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the dimensions for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the dimensions of variable.
+   */
+  vals_view<size_t> dims_r_view(const std::string& name) const {
+    if (contains_r_only(name)) {
+      return vals_view<size_t>((vars_r_.find(name)->second).second);
+    } else if (contains_i(name)) {
+      return vals_view<size_t>((vars_i_.find(name)->second).second);
+    }
+    return vals_view<size_t>();
+  }
+
   /**
    * Return the integer values for the variable with the specified
    * name.
@@ -745,6 +775,20 @@ class dump : public stan::io::var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the values.
+   */
+  vals_view<int> vals_i_view(const std::string& name) const {
+    if (contains_i(name)) {
+      return vals_view<int>((vars_i_.find(name)->second).first);
+    }
+    return vals_view<int>();
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
@@ -110,7 +110,7 @@ class json_data : public stan::io::var_context {
     if (contains_r_only(name)) {
       return (vars_r_.find(name)->second).first;
     } else if (contains_i(name)) {
-      std::vector<int> vec_int = (vars_i_.find(name)->second).first;
+      const std::vector<int>& vec_int = (vars_i_.find(name)->second).first;
       std::vector<double> vec_r(vec_int.size());
       for (size_t ii = 0; ii < vec_int.size(); ii++) {
         vec_r[ii] = vec_int[ii];
@@ -120,6 +120,20 @@ class json_data : public stan::io::var_context {
     return empty_vec_r_;
   }
 
+  /**
+   * Return a view of the double values for the variable with the
+   * specified name, without copying them unless they are integers.
+   *
+   * @param name Name of variable.
+   * @return View of the values of variable.
+   */
+  stan::io::vals_view<double> vals_r_view(const std::string &name) const {
+    if (contains_r_only(name)) {
+      return stan::io::vals_view<double>((vars_r_.find(name)->second).first);
+    }
+    return stan::io::vals_view<double>(vals_r(name));
+  }
+
   /**
    * Read out the complex values for the variable with the specified
    * name and return a flat vector of complex values.
@@ -175,6 +189,22 @@ class json_data : public stan::io::var_context {
     return empty_vec_ui_;
   }
 
+  /**
+   * Return a view of the dimensions for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the dimensions of variable.
+   */
+  stan::io::vals_view<size_t> dims_r_view(const std::string &name) const {
+    if (contains_r_only(name)) {
+      return stan::io::vals_view<size_t>((vars_r_.find(name)->second).second);
+    } else if (contains_i(name)) {
+      return stan::io::vals_view<size_t>((vars_i_.find(name)->second).second);
+    }
+    return stan::io::vals_view<size_t>();
+  }
+
   /**
    * Return the integer values for the variable with the specified
    * name.
@@ -189,6 +219,20 @@ class json_data : public stan::io::var_context {
     return empty_vec_i_;
   }
 
+  /**
+   * Return a view of the integer values for the variable with the
+   * specified name.
+   *
+   * @param name Name of variable.
+   * @return View of the values.
+   */
+  stan::io::vals_view<int> vals_i_view(const std::string &name) const {
+    if (contains_i(name)) {
+      return stan::io::vals_view<int>((vars_i_.find(name)->second).first);
+    }
+    return stan::io::vals_view<int>();
+  }
+
   /**
    * Return the dimensions for the integer variable with the specified
    * name.
@@ -243,7 +287,7 @@ class json_data : public stan::io::var_context {
   void validate_dims(const std::string &stage, const std::string &name,
                      const std::string &base_type,
                      const std::vector<size_t> &dims_declared) const {
-    std::vector<size_t> dims = dims_r(name);
+    const stan::io::vals_view<size_t> dims = dims_r_view(name);
 
     // JSON '[ ]' is ambiguous - any multi-dim variable with len 0 dim
     size_t num_elements = 1;
@@ -0,0 +1,303 @@
+#ifndef STAN_IO_STAN_CSV_FILE_READER_HPP
+#define STAN_IO_STAN_CSV_FILE_READER_HPP
+
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+
+namespace stan {
+namespace io {
+
+/**
+ * Options for <code>stan_csv_file_reader::parse</code>.
+ */
+struct stan_csv_read_options {
+  /**
+   * Names of the columns to read, in the order they should appear in
+   * the samples, either as in the file (<code>mu.1</code>) or
+   * prettified (<code>mu[1]</code>).  All columns are read if empty.
+   */
+  std::vector<std::string> columns;
+
+  /**
+   * Parse blocks of rows in parallel.
+   */
+  bool parallel = false;
+
+  /**
+   * Number of rows parsed by each parallel task.
+   */
+  size_t grain_size = 256;
+};
+
+/**
+ * Reads a Stan output csv file by memory mapping it.
+ *
+ * <p>The comments and header before the draws are read by
+ * <code>stan_csv_reader</code>.  The draws are then indexed in one pass
+ * over the mapped file, which finds the start of each row and reads the
+ * timing comments, so that the samples matrix is allocated once, and
+ * parsed in a second pass with <code>std::from_chars</code>, optionally
+ * in parallel over blocks of rows and only for a subset of columns.
+ *
+ * <p>Values which are not numbers are read as NaN.  Where the standard
+ * library lacks <code>std::from_chars</code> for doubles, values are
+ * parsed with <code>std::strtod</code>.
+ */
+class stan_csv_file_reader {
+ public:
+  /**
+   * Parses the file.
+   *
+   * @param[in] filename path of the file
+   * @param[out] out output stream to send messages
+   * @param[in] options columns to read and parallelism
+   * @return contents of the file, with the header and samples
+   * restricted to the selected columns
+   * @throw std::invalid_argument if the file cannot be opened, has no
+   * header, lacks a selected column or a column is selected twice
+   */
+  static stan_csv parse(const std::string& filename, std::ostream* out,
+                        const stan_csv_read_options& options
+                        = stan_csv_read_options()) {
+    namespace bip = boost::interprocess;
+    stan_csv data;
+    bip::mapped_region region;
+    try {
+      bip::file_mapping file(filename.c_str(), bip::read_only);
+      region = bip::mapped_region(file, bip::read_only);
+    } catch (const bip::interprocess_exception& e) {
+      // Mapping an empty file fails
+      if (out)
+        *out << "Error: cannot map " << filename << ": " << e.what()
+             << std::endl;
+      throw std::invalid_argument("Cannot read input file " + filename);
+    }
+    const char* begin = static_cast<const char*>(region.get_address());
+    const char* end = begin + region.get_size();
+
+    const char* draws = read_preamble(begin, end, data, out);
+
+    std::vector<size_t> columns;
+    select_columns(data.header, options.columns, columns);
+    const size_t num_file_columns = data.header.size();
+    if (!options.columns.empty()) {
+      std::vector<std::string> header;
+      for (size_t j : columns)
+        header.push_back(data.header[j]);
+      data.header = header;
+    }
+
+    std::vector<const char*> rows;
+    if (!index_rows(draws, end, num_file_columns, rows, data.timing,
+                    data.metadata.num_warmup, out)) {
+      if (out)
+        *out << "Warning: non-fatal error reading samples" << std::endl;
+      return data;
+    }
+
+    // Output column of each file column, or -1 if it is not read
+    std::vector<int> output_column(num_file_columns, -1);
+    for (size_t k = 0; k < columns.size(); ++k)
+      output_column[columns[k]] = k;
+    data.samples.resize(rows.size(), columns.size());
+    const size_t num_rows = rows.size();
+    auto parse_rows = [&](const tbb::blocked_range<size_t>& r) {
+      for (size_t i = r.begin(); i != r.end(); ++i) {
+        const char* row_end = i + 1 < num_rows ? rows[i + 1] : end;
+        parse_row(rows[i], row_end, output_column, data.samples, i);
+      }
+    };
+    if (options.parallel) {
+      const size_t grain_size = std::max<size_t>(options.grain_size, 1);
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, num_rows, grain_size),
+                        parse_rows);
+    } else {
+      parse_rows(tbb::blocked_range<size_t>(0, num_rows));
+    }
+    return data;
+  }
+
+ private:
+  /**
+   * Return a pointer to the line following the one starting at the
+   * specified position.
+   */
+  static const char* next_line(const char* line, const char* end) {
+    const char* newline
+        = static_cast<const char*>(std::memchr(line, '\n', end - line));
+    return newline ? newline + 1 : end;
+  }
+
+  /**
+   * Reads the metadata, header and adaptation with
+   * <code>stan_csv_reader</code>, returning a pointer to the first
+   * line of draws.
+   */
+  static const char* read_preamble(const char* begin, const char* end,
+                                   stan_csv& data, std::ostream* out) {
+    const char* line = begin;
+    bool header_found = false;
+    while (line < end) {
+      if (*line != '#' && *line != '\n') {
+        if (header_found)
+          break;
+        header_found = true;
+      }
+      line = next_line(line, end);
+    }
+    std::stringstream preamble(std::string(begin, line));
+    if (!stan_csv_reader::read_metadata(preamble, data.metadata, out)) {
+      if (out)
+        *out << "Warning: non-fatal error reading metadata" << std::endl;
+    }
+    if (!stan_csv_reader::read_header(preamble, data.header, out)) {
+      if (out)
+        *out << "Error: error reading header" << std::endl;
+      throw std::invalid_argument("Error with header of input file in parse");
+    }
+    if (!stan_csv_reader::read_adaptation(preamble, data.adaptation, out)) {
+      if (out)
+        *out << "Warning: non-fatal error reading adaptation data" << std::endl;
+    }
+    return line;
+  }
+
+  static void select_columns(const std::vector<std::string>& header,
+                             const std::vector<std::string>& names,
+                             std::vector<size_t>& columns) {
+    columns.clear();
+    if (names.empty()) {
+      for (size_t j = 0; j < header.size(); ++j)
+        columns.push_back(j);
+      return;
+    }
+    for (std::string name : names) {
+      prettify_stan_csv_name(name);
+      auto it = std::find(header.begin(), header.end(), name);
+      if (it == header.end())
+        throw std::invalid_argument("Column " + name
+                                    + " not found in input file");
+      const size_t j = it - header.begin();
+      if (std::find(columns.begin(), columns.end(), j) != columns.end())
+        throw std::invalid_argument("Column " + name + " selected twice");
+      columns.push_back(j);
+    }
+  }
+
+  /**
+   * Finds the start of each row of draws and reads the timing comments
+   * and the number of warmup iterations if warmup ended early, checking
+   * that every row has the expected number of columns.
+   */
+  static bool index_rows(const char* line, const char* end, size_t num_columns,
+                         std::vector<const char*>& rows,
+                         stan_csv_timing& timing, size_t& num_warmup,
+                         std::ostream* out) {
+    while (line < end) {
+      const char* line_end = next_line(line, end);
+      if (*line == '#') {
+        std::string comment(line, line_end);
+        if (!stan_csv_reader::read_num_warmup(comment, num_warmup))
+          read_timing(comment, timing);
+      } else if (*line != '\n' && !(*line == '\r' && line + 1 < end
+                                    && line[1] == '\n')) {
+        size_t cols = std::count(line, line_end, ',') + 1;
+        if (cols != num_columns) {
+          if (out)
+            *out << "Error: expected " << num_columns
+                 << " columns, but found " << cols << " instead for row "
+                 << rows.size() + 1 << std::endl;
+          rows.clear();
+          return false;
+        }
+        rows.push_back(line);
+      }
+      line = line_end;
+    }
+    return true;
+  }
+
+  static void read_timing(const std::string& line, stan_csv_timing& timing) {
+    double* total = nullptr;
+    if (line.find("(Warm-up)") != std::string::npos)
+      total = &timing.warmup;
+    else if (line.find("(Sampling)") != std::string::npos)
+      total = &timing.sampling;
+    else
+      return;
+    size_t left = 17;
+    size_t right = line.find(" seconds");
+    double seconds = 0;
+    if (right != std::string::npos && right > left)
+      std::stringstream(line.substr(left, right - left)) >> seconds;
+    *total += seconds;
+  }
+
+  /**
+   * Parses the selected columns of one row of draws.
+   */
+  static void parse_row(const char* field, const char* end,
+                        const std::vector<int>& output_column,
+                        Eigen::MatrixXd& samples, size_t row) {
+    for (size_t j = 0; j < output_column.size(); ++j) {
+      const char* field_end = static_cast<const char*>(
+          std::memchr(field, j + 1 < output_column.size() ? ',' : '\n',
+                      end - field));
+      if (field_end == nullptr)
+        field_end = end;
+      if (output_column[j] >= 0)
+        samples.coeffRef(row, output_column[j]) = parse_value(field, field_end);
+      field = field_end + 1;
+    }
+  }
+
+  static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+  }
+
+  static double parse_value(const char* first, const char* last) {
+    while (first < last && is_space(*first))
+      ++first;
+    while (last > first && is_space(last[-1]))
+      --last;
+    if (first < last && *first == '+')
+      ++first;
+    double value = std::numeric_limits<double>::quiet_NaN();
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars(first, last, value);
+#else
+    char buffer[64];
+    const size_t n = std::min<size_t>(last - first, sizeof(buffer) - 1);
+    std::memcpy(buffer, first, n);
+    buffer[n] = '\0';
+    char* parsed_end = nullptr;
+    double parsed = std::strtod(buffer, &parsed_end);
+    if (parsed_end != buffer)
+      value = parsed;
+#endif
+    return value;
+  }
+};
+
+}  // namespace io
+}  // namespace stan
+
+#endif
@@ -274,8 +274,49 @@ class stan_csv_reader {
       return true;
   }
 
+  /**
+   * Reads the number of warmup iterations from the comment written when
+   * warmup ends early, "Warmup converged after N iterations".
+   *
+   * @param[in] line comment line
+   * @param[out] num_warmup number of warmup iterations run, unchanged
+   *   if the line is not that comment
+   * @return true if the line is that comment
+   */
+  static bool read_num_warmup(const std::string& line, size_t& num_warmup) {
+    static const std::string prefix = "Warmup converged after ";
+    size_t left = line.find(prefix);
+    if (left == std::string::npos)
+      return false;
+    std::stringstream ss(line.substr(left + prefix.size()));
+    size_t n;
+    if (!(ss >> n))
+      return false;
+    num_warmup = n;
+    return true;
+  }
+
   static bool read_samples(std::istream& in, Eigen::MatrixXd& samples,
                            stan_csv_timing& timing, std::ostream* out) {
+    size_t num_warmup = 0;
+    return read_samples(in, samples, timing, num_warmup, out);
+  }
+
+  /**
+   * Reads the draws and the timing, and the number of warmup iterations
+   * if warmup ended early.
+   *
+   * @param[in] in input stream
+   * @param[out] samples draws
+   * @param[out] timing timing
+   * @param[in,out] num_warmup number of warmup iterations, replaced by
+   *   the number run if warmup ended early
+   * @param[out] out output stream for messages
+   * @return false if the draws can not be read
+   */
+  static bool read_samples(std::istream& in, Eigen::MatrixXd& samples,
+                           stan_csv_timing& timing, size_t& num_warmup,
+                           std::ostream* out) {
     std::stringstream ss;
     std::string line;
 
@@ -309,6 +350,8 @@ class stan_csv_reader {
           double sampling;
           std::stringstream(line.substr(left, right - left)) >> sampling;
           timing.sampling += sampling;
+        } else {
+          read_num_warmup(line, num_warmup);
         }
       } else {
         ss << line << '\n';
@@ -373,7 +416,8 @@ class stan_csv_reader {
     data.timing.warmup = 0;
     data.timing.sampling = 0;
 
-    if (!read_samples(in, data.samples, data.timing, out)) {
+    if (!read_samples(in, data.samples, data.timing,
+                      data.metadata.num_warmup, out)) {
       if (out)
         *out << "Warning: non-fatal error reading samples" << std::endl;
     }
@@ -42,7 +42,7 @@ inline void validate_dims(const stan::io::var_context& context,
       throw std::runtime_error(msg.str());
     }
   }
-  std::vector<size_t> dims = context.dims_r(name);
+  const vals_view<size_t> dims = context.dims_r_view(name);
   if (dims.size() != dims_declared.size()) {
     std::stringstream msg;
     msg << "mismatch in number dimensions declared and found in context"
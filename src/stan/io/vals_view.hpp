@@ -0,0 +1,122 @@
+#ifndef STAN_IO_VALS_VIEW_HPP
+#define STAN_IO_VALS_VIEW_HPP
+
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace stan {
+
+namespace io {
+
+/**
+ * A read-only view of the values or dimensions of a variable in a
+ * <code>var_context</code>.
+ *
+ * <p>A view either refers to values stored elsewhere, which must outlive
+ * it, or owns a vector of values, for values which are not stored in the
+ * requested type (such as integers read as reals) and for
+ * implementations of <code>var_context</code> which only return copies.
+ * The values of an owning view stay at the same address when the view is
+ * moved, so views can be returned by value.
+ *
+ * @tparam T Type of values.
+ */
+template <typename T>
+class vals_view {
+ public:
+  using value_type = T;
+  using const_iterator = const T*;
+
+  /**
+   * Construct an empty view.
+   */
+  vals_view() : data_(nullptr), size_(0) {}
+
+  /**
+   * Construct a view of values stored elsewhere.
+   *
+   * @param data Pointer to the first value.
+   * @param size Number of values.
+   */
+  vals_view(const T* data, size_t size) : data_(data), size_(size) {}
+
+  /**
+   * Construct a view of the values of a vector, which must outlive the
+   * view.
+   *
+   * @param vals Values to view.
+   */
+  explicit vals_view(const std::vector<T>& vals)
+      : data_(vals.data()), size_(vals.size()) {}
+
+  /**
+   * Construct a view which owns its values.
+   *
+   * @param vals Values to take ownership of.
+   */
+  explicit vals_view(std::vector<T>&& vals)
+      : owned_(std::move(vals)), data_(owned_.data()), size_(owned_.size()) {}
+
+  vals_view(vals_view&& other) noexcept
+      : owned_(std::move(other.owned_)),
+        data_(other.data_),
+        size_(other.size_) {
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+
+  vals_view& operator=(vals_view&& other) noexcept {
+    owned_ = std::move(other.owned_);
+    data_ = other.data_;
+    size_ = other.size_;
+    other.data_ = nullptr;
+    other.size_ = 0;
+    return *this;
+  }
+
+  // Copying an owning view would leave the copy pointing at the original
+  vals_view(const vals_view&) = delete;
+  vals_view& operator=(const vals_view&) = delete;
+
+  const T* data() const { return data_; }
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+  const_iterator begin() const { return data_; }
+  const_iterator end() const { return data_ + size_; }
+  const T& operator[](size_t i) const { return data_[i]; }
+
+  /**
+   * Return the value at the specified position, checking the bounds.
+   *
+   * @param i Position.
+   * @throw std::out_of_range If the position is past the end.
+   */
+  const T& at(size_t i) const {
+    if (i >= size_)
+      throw std::out_of_range("vals_view::at: index out of range");
+    return data_[i];
+  }
+
+  /**
+   * Return <code>true</code> if the view owns a copy of its values.
+   */
+  bool owns_values() const { return !owned_.empty(); }
+
+  /**
+   * Return a copy of the values.
+   */
+  std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+ private:
+  std::vector<T> owned_;
+  const T* data_;
+  size_t size_;
+};
+
+}  // namespace io
+
+}  // namespace stan
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef STAN_IO_VAR_CONTEXT_HPP
 #define STAN_IO_VAR_CONTEXT_HPP
 
+#include <stan/io/vals_view.hpp>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -56,6 +57,22 @@ class var_context {
    */
   virtual std::vector<double> vals_r(const std::string& name) const = 0;
 
+  /**
+   * Return a view of the floating point values for the variable of
+   * the specified name, as returned by <code>vals_r</code>.
+   *
+   * <p>Implementations which store the values as doubles should
+   * return a view of the stored values, which stays valid as long as
+   * the context is not modified.  By default the view owns a copy of
+   * the values returned by <code>vals_r</code>.
+   *
+   * @param name Name of variable.
+   * @return View of the values for the named variable.
+   */
+  virtual vals_view<double> vals_r_view(const std::string& name) const {
+    return vals_view<double>(vals_r(name));
+  }
+
   /**
    * Return the complex floating point values for the variable of the
    * specified variable name in last-index-major order.  This
@@ -81,6 +98,18 @@ class var_context {
    */
   virtual std::vector<size_t> dims_r(const std::string& name) const = 0;
 
+  /**
+   * Return a view of the dimensions for the specified floating point
+   * variable, as returned by <code>dims_r</code>.  By default the view
+   * owns a copy of the dimensions returned by <code>dims_r</code>.
+   *
+   * @param name Name of variable.
+   * @return View of the dimensions for the variable.
+   */
+  virtual vals_view<size_t> dims_r_view(const std::string& name) const {
+    return vals_view<size_t>(dims_r(name));
+  }
+
   /**
    * Return <code>true</code> if the specified variable name has
    * integer values.
@@ -101,6 +130,18 @@ class var_context {
    */
   virtual std::vector<int> vals_i(const std::string& name) const = 0;
 
+  /**
+   * Return a view of the integer values for the variable of the
+   * specified name, as returned by <code>vals_i</code>.  By default the
+   * view owns a copy of the values returned by <code>vals_i</code>.
+   *
+   * @param name Name of variable.
+   * @return View of the integer values.
+   */
+  virtual vals_view<int> vals_i_view(const std::string& name) const {
+    return vals_view<int>(vals_i(name));
+  }
+
   /**
    * Return the dimensions of the specified floating point variable.
    * If the variable doesn't exist (or if it is a scalar), the
@@ -145,10 +186,12 @@ class var_context {
   /**
    * Append vector of dimensions to message string.
    *
+   * @tparam Dims type of sequence of dimension sizes
    * @param msg message string
    * @param dims array of dimension sizes
    */
-  void dims_msg(std::stringstream& msg, const std::vector<size_t>& dims) const {
+  template <typename Dims>
+  void dims_msg(std::stringstream& msg, const Dims& dims) const {
     msg << '(';
     for (size_t i = 0; i < dims.size(); ++i) {
       if (i > 0)
@@ -14,6 +14,18 @@ class base_adapter {
 
   bool adapting() { return adapt_flag_; }
 
+  /**
+   * Return true if warmup may end before its configured number of
+   * iterations, once <code>adaptation_converged</code> holds.
+   */
+  virtual bool adaptive_warmup() const { return false; }
+
+  /**
+   * Return true once the adaptation has converged, so that warmup can
+   * end early.
+   */
+  virtual bool adaptation_converged() const { return false; }
+
  protected:
   bool adapt_flag_;
 };
@@ -2,7 +2,9 @@
 #define STAN_MCMC_COVAR_ADAPTATION_HPP
 
 #include <stan/math/prim.hpp>
+#include <stan/mcmc/pooled_adaptation.hpp>
 #include <stan/mcmc/windowed_adaptation.hpp>
+#include <cstddef>
 #include <vector>
 
 namespace stan {
@@ -12,7 +14,22 @@ namespace mcmc {
 class covar_adaptation : public windowed_adaptation {
  public:
   explicit covar_adaptation(int n)
-      : windowed_adaptation("covariance"), estimator_(n) {}
+      : windowed_adaptation("covariance"),
+        estimator_(n),
+        pool_(nullptr),
+        chain_(0) {}
+
+  /**
+   * Pool the estimates at the end of each window with those of other
+   * chains, or stop pooling if the pool is null.
+   *
+   * @param pool pool shared by the chains
+   * @param chain index of this chain in the pool
+   */
+  void set_pool(pooled_adaptation* pool, std::size_t chain) {
+    pool_ = pool;
+    chain_ = chain;
+  }
 
   bool learn_covariance(Eigen::MatrixXd& covar, const Eigen::VectorXd& q) {
     if (adaptation_window())
@@ -21,9 +38,14 @@ class covar_adaptation : public windowed_adaptation {
     if (end_adaptation_window()) {
       compute_next_window();
 
-      estimator_.sample_covariance(covar);
-
-      double n = static_cast<double>(estimator_.num_samples());
+      const Eigen::MatrixXd previous = covar;
+      double n;
+      if (pool_) {
+        pool_->pool_covariance(chain_, estimator_, covar, n);
+      } else {
+        estimator_.sample_covariance(covar);
+        n = static_cast<double>(estimator_.num_samples());
+      }
       covar = (n / (n + 5.0)) * covar
               + 1e-3 * (5.0 / (n + 5.0))
                     * Eigen::MatrixXd::Identity(covar.rows(), covar.cols());
@@ -36,6 +58,8 @@ class covar_adaptation : public windowed_adaptation {
             "function is too wide or improper. "
             "There may be problems with your model specification.");
 
+      update_convergence((covar - previous).norm() / previous.norm());
+
       estimator_.restart();
 
       ++adapt_window_counter_;
@@ -48,6 +72,8 @@ class covar_adaptation : public windowed_adaptation {
 
  protected:
   stan::math::welford_covar_estimator estimator_;
+  pooled_adaptation* pool_;
+  std::size_t chain_;
 };
 
 }  // namespace mcmc
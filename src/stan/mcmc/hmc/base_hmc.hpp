@@ -5,6 +5,7 @@
 #include <stan/callbacks/writer.hpp>
 #include <stan/callbacks/structured_writer.hpp>
 #include <stan/mcmc/base_mcmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/gradient_evaluator.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
 #include <boost/random/uniform_01.hpp>
 #include <cmath>
@@ -66,12 +67,19 @@ class base_hmc : public base_mcmc {
 
   /**
    * write stepsize and elements of mass matrix as a JSON object
+   *
+   * @param struct_writer writer for the tuning parameters
+   * @param num_warmup number of warmup iterations run, written only if
+   * not negative
    */
-  void write_sampler_state_struct(callbacks::structured_writer& struct_writer) {
+  void write_sampler_state_struct(callbacks::structured_writer& struct_writer,
+                                  int num_warmup = -1) {
     struct_writer.begin_record();
     struct_writer.write("stepsize", get_nominal_stepsize());
     struct_writer.write("metric_type", z_.metric_type());
     struct_writer.write("inv_metric", z_.inv_e_metric_);
+    if (num_warmup >= 0)
+      struct_writer.write("num_warmup", num_warmup);
     struct_writer.end_record();
   }
 
@@ -192,6 +200,17 @@ class base_hmc : public base_mcmc {
 
   double get_stepsize_jitter() const noexcept { return this->epsilon_jitter_; }
 
+  /**
+   * Route the gradient evaluations of this sampler's Hamiltonian
+   * through the specified evaluator.
+   *
+   * @param evaluator evaluator for the log density and its gradient,
+   * or <code>nullptr</code> to evaluate the model directly
+   */
+  void set_gradient_evaluator(gradient_evaluator* evaluator) {
+    this->hamiltonian_.set_gradient_evaluator(evaluator);
+  }
+
   void sample_stepsize() {
     this->epsilon_ = this->nom_epsilon_;
     if (this->epsilon_jitter_)
@@ -3,6 +3,7 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/mcmc/hmc/hamiltonians/gradient_evaluator.hpp>
 #include <stan/model/gradient.hpp>
 #include <stan/model/log_prob_propto.hpp>
 #include <iostream>
@@ -16,7 +17,8 @@ namespace mcmc {
 template <class Model, class Point, class BaseRNG>
 class base_hamiltonian {
  public:
-  explicit base_hamiltonian(const Model& model) : model_(model) {}
+  explicit base_hamiltonian(const Model& model)
+      : model_(model), gradient_evaluator_(nullptr) {}
 
   ~base_hamiltonian() {}
 
@@ -40,9 +42,33 @@ class base_hamiltonian {
 
   virtual Eigen::VectorXd dtau_dp(Point& z) = 0;
 
+  /**
+   * Write dtau_dp into a preallocated vector.  Metrics that can form
+   * the product in place override this to avoid a temporary.
+   *
+   * @param z point in phase space
+   * @param p_sharp vector into which the sharp momentum is written
+   */
+  virtual void dtau_dp_into(Point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = dtau_dp(z);
+  }
+
   // phi = 0.5 * log | Lambda (q) | + V(q)
   virtual Eigen::VectorXd dphi_dq(Point& z, callbacks::logger& logger) = 0;
 
+  /**
+   * Write dphi_dq into a preallocated vector.  Metrics that can form
+   * the gradient in place override this to avoid a temporary.
+   *
+   * @param z point in phase space
+   * @param dphi vector into which the gradient is written
+   * @param logger logger for messages
+   */
+  virtual void dphi_dq_into(Point& z, Eigen::VectorXd& dphi,
+                            callbacks::logger& logger) {
+    dphi = dphi_dq(z, logger);
+  }
+
   virtual void sample_p(Point& z, BaseRNG& rng) = 0;
 
   void init(Point& z, callbacks::logger& logger) {
@@ -60,7 +86,10 @@ class base_hamiltonian {
 
   void update_potential_gradient(Point& z, callbacks::logger& logger) {
     try {
-      stan::model::gradient(model_, z.q, z.V, z.g, logger);
+      if (gradient_evaluator_ != nullptr)
+        (*gradient_evaluator_)(z.q, z.V, z.g, logger);
+      else
+        stan::model::gradient(model_, z.q, z.V, z.g, logger);
       z.V = -z.V;
     } catch (const std::domain_error& e) {
       this->write_error_msg_(e, logger);
@@ -77,8 +106,21 @@ class base_hamiltonian {
     update_potential_gradient(z, logger);
   }
 
+  /**
+   * Route gradient evaluations through the specified evaluator rather
+   * than evaluating the model directly.  The evaluator is not owned
+   * and must outlive its use; passing <code>nullptr</code> restores
+   * direct evaluation.
+   *
+   * @param evaluator evaluator for the log density and its gradient
+   */
+  void set_gradient_evaluator(gradient_evaluator* evaluator) {
+    gradient_evaluator_ = evaluator;
+  }
+
  protected:
   const Model& model_;
+  gradient_evaluator* gradient_evaluator_;
 
   void write_error_msg_(const std::exception& e, callbacks::logger& logger) {
     logger.error(
@@ -18,9 +18,7 @@ class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
   explicit dense_e_metric(const Model& model)
       : base_hamiltonian<Model, dense_e_point, BaseRNG>(model) {}
 
-  double T(dense_e_point& z) {
-    return 0.5 * z.p.transpose() * z.inv_e_metric_ * z.p;
-  }
+  double T(dense_e_point& z) { return 0.5 * z.p.dot(z.inv_e_metric_p()); }
 
   double tau(dense_e_point& z) { return T(z); }
 
@@ -34,12 +32,21 @@ class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
     return Eigen::VectorXd::Zero(this->model_.num_params_r());
   }
 
-  Eigen::VectorXd dtau_dp(dense_e_point& z) { return z.inv_e_metric_ * z.p; }
+  Eigen::VectorXd dtau_dp(dense_e_point& z) { return z.inv_e_metric_p(); }
 
   Eigen::VectorXd dphi_dq(dense_e_point& z, callbacks::logger& logger) {
     return z.g;
   }
 
+  void dtau_dp_into(dense_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = z.inv_e_metric_p();
+  }
+
+  void dphi_dq_into(dense_e_point& z, Eigen::VectorXd& dphi,
+                    callbacks::logger& logger) {
+    dphi = z.g;
+  }
+
   void sample_p(dense_e_point& z, BaseRNG& rng) {
     typedef typename stan::math::index_type<Eigen::VectorXd>::type idx_t;
     boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
@@ -50,7 +57,7 @@ class dense_e_metric : public base_hamiltonian<Model, dense_e_point, BaseRNG> {
     for (idx_t i = 0; i < u.size(); ++i)
       u(i) = rand_dense_gaus();
 
-    z.p = z.inv_e_metric_.llt().matrixU().solve(u);
+    z.p = z.inv_e_metric_llt().matrixU().solve(u);
   }
 };
 
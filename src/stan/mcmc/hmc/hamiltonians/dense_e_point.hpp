@@ -3,12 +3,24 @@
 
 #include <stan/callbacks/writer.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <Eigen/Cholesky>
+#include <sstream>
+#include <string>
 
 namespace stan {
 namespace mcmc {
 /**
  * Point in a phase space with a base
  * Euclidean manifold with dense metric
+ *
+ * The Cholesky factor of the inverse mass matrix and the product of the
+ * inverse mass matrix with the momentum are cached.  The factor is
+ * recomputed only after the metric is changed through
+ * <code>set_metric</code> or announced with <code>metric_changed</code>,
+ * which must be called after writing to <code>inv_e_metric_</code>
+ * directly.  The product is recomputed whenever the momentum differs from
+ * the one it was computed for, which costs O(N) to check instead of the
+ * O(N^2) of the product.
  */
 class dense_e_point : public ps_point {
  public:
@@ -34,6 +46,47 @@ class dense_e_point : public ps_point {
    */
   void set_metric(const Eigen::MatrixXd& inv_e_metric) {
     inv_e_metric_ = inv_e_metric;
+    metric_changed();
+  }
+
+  /**
+   * Discard the cached factor and product after the inverse mass matrix
+   * has been modified in place.
+   */
+  void metric_changed() {
+    inv_e_metric_llt_valid_ = false;
+    inv_e_metric_p_valid_ = false;
+  }
+
+  /**
+   * Return the Cholesky factorization of the inverse mass matrix,
+   * factoring it only if the metric changed since the last call.
+   *
+   * @return Cholesky factorization of the inverse mass matrix
+   */
+  const Eigen::LLT<Eigen::MatrixXd>& inv_e_metric_llt() {
+    if (!inv_e_metric_llt_valid_) {
+      inv_e_metric_llt_.compute(inv_e_metric_);
+      inv_e_metric_llt_valid_ = true;
+    }
+    return inv_e_metric_llt_;
+  }
+
+  /**
+   * Return the product of the inverse mass matrix with the momentum,
+   * computing it only if the momentum or the metric changed since the
+   * last call.
+   *
+   * @return product of the inverse mass matrix and p
+   */
+  const Eigen::VectorXd& inv_e_metric_p() {
+    if (!inv_e_metric_p_valid_ || p_cached_.size() != p.size()
+        || p_cached_ != p) {
+      inv_e_metric_p_.noalias() = inv_e_metric_ * p;
+      p_cached_ = p;
+      inv_e_metric_p_valid_ = true;
+    }
+    return inv_e_metric_p_;
   }
 
   /**
@@ -55,6 +108,14 @@ class dense_e_point : public ps_point {
   }
 
   inline std::string metric_type() { return "dense_e"; }
+
+ private:
+  Eigen::LLT<Eigen::MatrixXd> inv_e_metric_llt_;
+  bool inv_e_metric_llt_valid_{false};
+  Eigen::VectorXd inv_e_metric_p_;
+  // Momentum inv_e_metric_p_ was computed for
+  Eigen::VectorXd p_cached_;
+  bool inv_e_metric_p_valid_{false};
 };
 
 }  // namespace mcmc
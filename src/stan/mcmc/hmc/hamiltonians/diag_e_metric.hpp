@@ -41,6 +41,15 @@ class diag_e_metric : public base_hamiltonian<Model, diag_e_point, BaseRNG> {
     return z.g;
   }
 
+  void dtau_dp_into(diag_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = z.inv_e_metric_.cwiseProduct(z.p);
+  }
+
+  void dphi_dq_into(diag_e_point& z, Eigen::VectorXd& dphi,
+                    callbacks::logger& logger) {
+    dphi = z.g;
+  }
+
   void sample_p(diag_e_point& z, BaseRNG& rng) {
     boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
         rand_diag_gaus(rng, boost::normal_distribution<>());
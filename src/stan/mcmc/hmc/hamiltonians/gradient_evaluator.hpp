@@ -0,0 +1,39 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_GRADIENT_EVALUATOR_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_GRADIENT_EVALUATOR_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Interface through which a Hamiltonian can delegate evaluation of
+ * the log density and its gradient instead of calling
+ * <code>stan::model::gradient</code> on its model directly, e.g. so
+ * that evaluations from several chains can be batched together.
+ */
+class gradient_evaluator {
+ public:
+  virtual ~gradient_evaluator() {}
+
+  /**
+   * Evaluate the log density and its gradient at the specified
+   * unconstrained parameters.  Points outside the support should be
+   * reported either by throwing <code>std::domain_error</code> or by
+   * returning a log density of negative infinity.
+   *
+   * @param[in] q unconstrained parameters
+   * @param[out] lp log density
+   * @param[out] grad gradient of the log density
+   * @param[in,out] logger logger for messages
+   */
+  virtual void operator()(const Eigen::VectorXd& q, double& lp,
+                          Eigen::VectorXd& grad, callbacks::logger& logger)
+      = 0;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
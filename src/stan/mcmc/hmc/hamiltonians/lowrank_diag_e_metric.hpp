@@ -0,0 +1,76 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_DIAG_E_METRIC_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_DIAG_E_METRIC_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/hmc/hamiltonians/base_hamiltonian.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_diag_e_point.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <boost/random/normal_distribution.hpp>
+
+namespace stan {
+namespace mcmc {
+
+// Euclidean manifold with diagonal plus low rank metric
+template <class Model, class BaseRNG>
+class lowrank_diag_e_metric
+    : public base_hamiltonian<Model, lowrank_diag_e_point, BaseRNG> {
+ public:
+  explicit lowrank_diag_e_metric(const Model& model)
+      : base_hamiltonian<Model, lowrank_diag_e_point, BaseRNG>(model) {}
+
+  double T(lowrank_diag_e_point& z) {
+    z.inv_e_metric_times(z.p, p_sharp_);
+    return 0.5 * z.p.dot(p_sharp_);
+  }
+
+  double tau(lowrank_diag_e_point& z) { return T(z); }
+
+  double phi(lowrank_diag_e_point& z) { return this->V(z); }
+
+  double dG_dt(lowrank_diag_e_point& z, callbacks::logger& logger) {
+    return 2 * T(z) - z.q.dot(z.g);
+  }
+
+  Eigen::VectorXd dtau_dq(lowrank_diag_e_point& z,
+                          callbacks::logger& logger) {
+    return Eigen::VectorXd::Zero(this->model_.num_params_r());
+  }
+
+  Eigen::VectorXd dtau_dp(lowrank_diag_e_point& z) {
+    Eigen::VectorXd p_sharp;
+    z.inv_e_metric_times(z.p, p_sharp);
+    return p_sharp;
+  }
+
+  Eigen::VectorXd dphi_dq(lowrank_diag_e_point& z,
+                          callbacks::logger& logger) {
+    return z.g;
+  }
+
+  void dtau_dp_into(lowrank_diag_e_point& z, Eigen::VectorXd& p_sharp) {
+    z.inv_e_metric_times(z.p, p_sharp);
+  }
+
+  void dphi_dq_into(lowrank_diag_e_point& z, Eigen::VectorXd& dphi,
+                    callbacks::logger& logger) {
+    dphi = z.g;
+  }
+
+  void sample_p(lowrank_diag_e_point& z, BaseRNG& rng) {
+    boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
+        rand_gaus(rng, boost::normal_distribution<>());
+
+    Eigen::VectorXd u(z.p.size());
+    for (int i = 0; i < u.size(); ++i)
+      u(i) = rand_gaus();
+
+    z.metric_sqrt_times(u, z.p);
+  }
+
+ private:
+  Eigen::VectorXd p_sharp_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -0,0 +1,198 @@
+#ifndef STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_DIAG_E_POINT_HPP
+#define STAN_MCMC_HMC_HAMILTONIANS_LOWRANK_DIAG_E_POINT_HPP
+
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+
+namespace stan {
+namespace mcmc {
+/**
+ * Point in a phase space with a base Euclidean manifold whose inverse
+ * metric is diagonal plus low rank,
+ *
+ *   M^{-1} = D + U U^T,
+ *
+ * with D a positive diagonal matrix and U an N x k factor with k much
+ * smaller than N, so that products with the metric and draws of the
+ * momentum cost O(N k) instead of O(N^2).
+ *
+ * Drawing the momentum needs the inverse square root of
+ * I + V V^T with V = D^{-1/2} U, which is computed from the
+ * eigendecomposition of the k x k matrix V^T V when the metric changes.
+ * The factor is recomputed after <code>set_metric</code> or after
+ * <code>metric_changed</code>, which must be called after writing to
+ * <code>inv_e_metric_</code> or <code>inv_e_metric_factor_</code>
+ * directly.
+ */
+class lowrank_diag_e_point : public ps_point {
+ public:
+  /**
+   * Diagonal of the inverse mass matrix.
+   */
+  Eigen::VectorXd inv_e_metric_;
+
+  /**
+   * Low rank factor U of the inverse mass matrix.
+   */
+  Eigen::MatrixXd inv_e_metric_factor_;
+
+  /**
+   * Construct a point in n-dimensional phase space with the identity
+   * matrix as inverse mass matrix.
+   *
+   * @param n number of dimensions
+   */
+  explicit lowrank_diag_e_point(int n)
+      : ps_point(n), inv_e_metric_(n), inv_e_metric_factor_(n, 0) {
+    inv_e_metric_.setOnes();
+  }
+
+  /**
+   * Set the diagonal of the inverse mass matrix and drop its low rank
+   * part.
+   *
+   * @param inv_e_metric diagonal of inverse mass matrix
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric) {
+    inv_e_metric_ = inv_e_metric;
+    inv_e_metric_factor_.resize(inv_e_metric.size(), 0);
+    metric_changed();
+  }
+
+  /**
+   * Set the diagonal and the low rank factor of the inverse mass matrix.
+   *
+   * @param inv_e_metric diagonal of inverse mass matrix
+   * @param inv_e_metric_factor low rank factor of inverse mass matrix
+   */
+  void set_metric(const Eigen::VectorXd& inv_e_metric,
+                  const Eigen::MatrixXd& inv_e_metric_factor) {
+    inv_e_metric_ = inv_e_metric;
+    inv_e_metric_factor_ = inv_e_metric_factor;
+    metric_changed();
+  }
+
+  /**
+   * Discard the cached factorization after the inverse mass matrix has
+   * been modified in place.
+   */
+  void metric_changed() { factorization_valid_ = false; }
+
+  /**
+   * Rank of the low rank part of the inverse mass matrix.
+   */
+  int rank() const { return inv_e_metric_factor_.cols(); }
+
+  /**
+   * Write the product of the inverse mass matrix with a vector.
+   *
+   * @param[in] x vector
+   * @param[out] y product of the inverse mass matrix with x
+   */
+  void inv_e_metric_times(const Eigen::VectorXd& x, Eigen::VectorXd& y) {
+    if (rank() == 0) {
+      y = inv_e_metric_.cwiseProduct(x);
+      return;
+    }
+    work_.noalias() = inv_e_metric_factor_.transpose() * x;
+    y = inv_e_metric_.cwiseProduct(x);
+    y.noalias() += inv_e_metric_factor_ * work_;
+  }
+
+  /**
+   * Write a draw from a normal distribution with covariance the mass
+   * matrix, given a standard normal draw.
+   *
+   * @param[in] u standard normal draw
+   * @param[out] p draw with covariance the mass matrix
+   */
+  void metric_sqrt_times(const Eigen::VectorXd& u, Eigen::VectorXd& p) {
+    factor();
+    // (I + V V^T)^{-1/2} = I + E diag(scales) E^T
+    p = u;
+    if (eigenvectors_.cols() > 0) {
+      work_.noalias() = eigenvectors_.transpose() * u;
+      work_ = work_.cwiseProduct(scales_);
+      p.noalias() += eigenvectors_ * work_;
+    }
+    p = p.cwiseQuotient(inv_e_metric_.cwiseSqrt());
+  }
+
+  /**
+   * Write the diagonal and the low rank factor of the inverse mass
+   * matrix to string and handoff to writer.
+   *
+   * @param writer Stan writer callback
+   */
+  inline void write_metric(stan::callbacks::writer& writer) {
+    writer("Diagonal elements of inverse mass matrix:");
+    std::stringstream inv_e_metric_ss;
+    if (inv_e_metric_.size() > 0)
+      inv_e_metric_ss << inv_e_metric_(0);
+    for (int i = 1; i < inv_e_metric_.size(); ++i)
+      inv_e_metric_ss << ", " << inv_e_metric_(i);
+    writer(inv_e_metric_ss.str());
+    writer("Low rank factor of inverse mass matrix:");
+    if (rank() == 0) {
+      writer("");
+      return;
+    }
+    for (int i = 0; i < inv_e_metric_factor_.rows(); ++i) {
+      std::stringstream factor_ss;
+      factor_ss << inv_e_metric_factor_(i, 0);
+      for (int j = 1; j < inv_e_metric_factor_.cols(); ++j)
+        factor_ss << ", " << inv_e_metric_factor_(i, j);
+      writer(factor_ss.str());
+    }
+  }
+
+  inline std::string metric_type() { return "lowrank_diag_e"; }
+
+ private:
+  bool factorization_valid_{false};
+  // Orthonormal eigenvectors E of V V^T with nonzero eigenvalues
+  Eigen::MatrixXd eigenvectors_;
+  // (1 + lambda)^{-1/2} - 1 for each eigenvalue lambda of V V^T
+  Eigen::VectorXd scales_;
+  Eigen::VectorXd work_;
+
+  void factor() {
+    if (factorization_valid_)
+      return;
+    factorization_valid_ = true;
+    eigenvectors_.resize(inv_e_metric_.size(), 0);
+    scales_.resize(0);
+    if (rank() == 0)
+      return;
+    Eigen::MatrixXd v
+        = inv_e_metric_.cwiseSqrt().cwiseInverse().asDiagonal()
+          * inv_e_metric_factor_;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(v.transpose() * v);
+    const Eigen::VectorXd& lambda = solver.eigenvalues();
+    const double tol = 1e-12 * std::max(1.0, lambda.maxCoeff());
+    int n_pos = 0;
+    for (int i = 0; i < lambda.size(); ++i)
+      n_pos += lambda(i) > tol;
+    eigenvectors_.resize(v.rows(), n_pos);
+    scales_.resize(n_pos);
+    // V W Lambda^{-1/2} are the eigenvectors of V V^T
+    for (int i = 0, j = 0; i < lambda.size(); ++i) {
+      if (lambda(i) <= tol)
+        continue;
+      eigenvectors_.col(j) = v * solver.eigenvectors().col(i)
+                             / std::sqrt(lambda(i));
+      scales_(j) = 1.0 / std::sqrt(1.0 + lambda(i)) - 1.0;
+      ++j;
+    }
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
@@ -36,6 +36,15 @@ class unit_e_metric : public base_hamiltonian<Model, unit_e_point, BaseRNG> {
     return z.g;
   }
 
+  void dtau_dp_into(unit_e_point& z, Eigen::VectorXd& p_sharp) {
+    p_sharp = z.p;
+  }
+
+  void dphi_dq_into(unit_e_point& z, Eigen::VectorXd& dphi,
+                    callbacks::logger& logger) {
+    dphi = z.g;
+  }
+
   void sample_p(unit_e_point& z, BaseRNG& rng) {
     boost::variate_generator<BaseRNG&, boost::normal_distribution<> >
         rand_unit_gaus(rng, boost::normal_distribution<>());
@@ -16,20 +16,28 @@ class expl_leapfrog : public base_leapfrog<Hamiltonian> {
   void begin_update_p(typename Hamiltonian::PointType& z,
                       Hamiltonian& hamiltonian, double epsilon,
                       callbacks::logger& logger) {
-    z.p -= epsilon * hamiltonian.dphi_dq(z, logger);
+    hamiltonian.dphi_dq_into(z, buffer_, logger);
+    z.p -= epsilon * buffer_;
   }
 
   void update_q(typename Hamiltonian::PointType& z, Hamiltonian& hamiltonian,
                 double epsilon, callbacks::logger& logger) {
-    z.q += epsilon * hamiltonian.dtau_dp(z);
+    hamiltonian.dtau_dp_into(z, buffer_);
+    z.q += epsilon * buffer_;
     hamiltonian.update_potential_gradient(z, logger);
   }
 
   void end_update_p(typename Hamiltonian::PointType& z,
                     Hamiltonian& hamiltonian, double epsilon,
                     callbacks::logger& logger) {
-    z.p -= epsilon * hamiltonian.dphi_dq(z, logger);
+    hamiltonian.dphi_dq_into(z, buffer_, logger);
+    z.p -= epsilon * buffer_;
   }
+
+ private:
+  // Reused across updates so that steady state integration does not
+  // allocate temporaries
+  Eigen::VectorXd buffer_;
 };
 
 }  // namespace mcmc
@@ -33,6 +33,7 @@ class adapt_dense_e_nuts : public dense_e_nuts<Model, BaseRNG>,
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
+        this->z_.metric_changed();
         this->init_stepsize(logger);
 
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
@@ -44,7 +45,7 @@ class adapt_dense_e_nuts : public dense_e_nuts<Model, BaseRNG>,
 
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
-    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->complete_stepsize_adaptation(this->nom_epsilon_);
   }
 };
 
@@ -44,7 +44,7 @@ class adapt_diag_e_nuts : public diag_e_nuts<Model, BaseRNG>,
 
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
-    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->complete_stepsize_adaptation(this->nom_epsilon_);
   }
 };
 
@@ -0,0 +1,61 @@
+#ifndef STAN_MCMC_HMC_NUTS_ADAPT_LOWRANK_DIAG_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_ADAPT_LOWRANK_DIAG_E_NUTS_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/mcmc/stepsize_lowrank_covar_adapter.hpp>
+#include <stan/mcmc/hmc/nuts/lowrank_diag_e_nuts.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and adaptive
+ * diagonal plus low rank metric and adaptive step size
+ */
+template <class Model, class BaseRNG>
+class adapt_lowrank_diag_e_nuts : public lowrank_diag_e_nuts<Model, BaseRNG>,
+                                  public stepsize_lowrank_covar_adapter {
+ public:
+  /**
+   * @param model model
+   * @param rng random number generator
+   * @param rank maximum rank of the low rank part of the metric
+   */
+  adapt_lowrank_diag_e_nuts(const Model& model, BaseRNG& rng, int rank = 10)
+      : lowrank_diag_e_nuts<Model, BaseRNG>(model, rng),
+        stepsize_lowrank_covar_adapter(model.num_params_r(), rank) {}
+
+  ~adapt_lowrank_diag_e_nuts() {}
+
+  sample transition(sample& init_sample, callbacks::logger& logger) {
+    sample s
+        = lowrank_diag_e_nuts<Model, BaseRNG>::transition(init_sample, logger);
+
+    if (this->adapt_flag_) {
+      this->stepsize_adaptation_.learn_stepsize(this->nom_epsilon_,
+                                                s.accept_stat());
+
+      bool update = this->lowrank_covar_adaptation_.learn_covariance(
+          this->z_.inv_e_metric_, this->z_.inv_e_metric_factor_,
+          this->z_.q);
+
+      if (update) {
+        this->z_.metric_changed();
+        this->init_stepsize(logger);
+
+        this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
+        this->stepsize_adaptation_.restart();
+      }
+    }
+    return s;
+  }
+
+  void disengage_adaptation() {
+    base_adapter::disengage_adaptation();
+    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
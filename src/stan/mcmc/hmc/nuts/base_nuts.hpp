@@ -5,9 +5,15 @@
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/base_hmc.hpp>
 #include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_workspace.hpp>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -27,7 +33,11 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        iterative_(false),
+        speculative_(false),
+        cancel_(nullptr),
+        model_(model) {}
 
   /**
    * specialized constructor for specified diag mass matrix
@@ -40,7 +50,11 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        iterative_(false),
+        speculative_(false),
+        cancel_(nullptr),
+        model_(model) {}
 
   /**
    * specialized constructor for specified dense mass matrix
@@ -53,7 +67,29 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         max_deltaH_(1000),
         n_leapfrog_(0),
         divergent_(false),
-        energy_(0) {}
+        energy_(0),
+        iterative_(false),
+        speculative_(false),
+        cancel_(nullptr),
+        model_(model) {}
+
+  /**
+   * Copy a sampler.  The copy does not share the speculation state and
+   * creates its own on its first speculative transition.
+   */
+  base_nuts(const base_nuts& other)
+      : base_hmc<Model, Hamiltonian, Integrator, BaseRNG>(other),
+        depth_(other.depth_),
+        max_depth_(other.max_depth_),
+        max_deltaH_(other.max_deltaH_),
+        n_leapfrog_(other.n_leapfrog_),
+        divergent_(other.divergent_),
+        energy_(other.energy_),
+        iterative_(other.iterative_),
+        speculative_(other.speculative_),
+        cancel_(other.cancel_),
+        model_(other.model_),
+        workspace_(other.workspace_) {}
 
   ~base_nuts() {}
 
@@ -75,39 +111,122 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int get_max_depth() { return this->max_depth_; }
   double get_max_delta() { return this->max_deltaH_; }
 
+  /**
+   * Select how trajectories are built.  The default recursive builder
+   * and the iterative builder consume random numbers in the same order
+   * and give the same draws for a given seed.
+   *
+   * @param iterative true to build trees with
+   * <code>build_tree_iterative</code>, false to use the recursive
+   * <code>build_tree</code>
+   */
+  void set_iterative_tree(bool iterative) { iterative_ = iterative; }
+
+  bool get_iterative_tree() const noexcept { return this->iterative_; }
+
+  /**
+   * Select whether trajectories are expanded speculatively in both
+   * directions at once.
+   *
+   * <p>The doubling directions of a transition are drawn up front and
+   * the forward and backward halves of the trajectory are then built
+   * concurrently as TBB tasks, each by its own helper sampler with its
+   * own random number generator seeded from this sampler's.  The
+   * subtrees are merged in the usual order as they complete, and a
+   * helper may only run one doubling ahead of the merge so that work
+   * wasted past the U-turn stays bounded; outstanding work is
+   * cancelled as soon as the trajectory terminates.  Draws are
+   * deterministic for a given seed whatever the number of threads,
+   * but differ from those of the serial builder.  As the two halves
+   * of a trajectory are the only independent work, this at most
+   * halves the wall time of a transition.
+   *
+   * <p>Requires a thread safe autodiff stack (<code>STAN_THREADS</code>)
+   * and is not combined with a gradient evaluator set on this sampler.
+   *
+   * @param speculative true to expand trajectories in both
+   * directions concurrently
+   */
+  void set_speculative_expansion(bool speculative) {
+    speculative_ = speculative;
+  }
+
+  bool get_speculative_expansion() const noexcept {
+    return this->speculative_;
+  }
+
   sample transition(sample& init_sample, callbacks::logger& logger) {
     // Initialize the algorithm
     this->sample_stepsize();
 
     this->seed(init_sample.cont_params());
 
+    double accept_prob = build_trajectory(logger);
+    return sample(this->z_.q, -this->z_.V, accept_prob);
+  }
+
+  /**
+   * Draw a momentum, build a trajectory from the current state and
+   * move to the state sampled from it.  All intermediate states and
+   * momenta live in the sampler's workspace, so once the workspace
+   * has been sized building a trajectory serially does not allocate.
+   * <code>transition</code> still allocates the sample it returns, and
+   * speculative expansion allocates for its tasks.
+   *
+   * @param logger Logger for messages
+   * @return Average acceptance probability across the trajectory
+   */
+  double build_trajectory(callbacks::logger& logger) {
+    if (speculative_)
+      return build_trajectory_speculative(logger);
+
     this->hamiltonian_.sample_p(this->z_, this->rand_int_);
     this->hamiltonian_.init(this->z_, logger);
 
-    ps_point z_fwd(this->z_);  // State at forward end of trajectory
-    ps_point z_bck(z_fwd);     // State at backward end of trajectory
+    // Reuse trajectory storage across transitions
+    workspace_.resize(this->z_.p.size(), this->max_depth_);
+
+    ps_point& z_fwd = workspace_.z_fwd;  // State at forward end of trajectory
+    ps_point& z_bck = workspace_.z_bck;  // State at backward end of trajectory
+    z_fwd.ps_point::operator=(this->z_);
+    z_bck.ps_point::operator=(z_fwd);
 
-    ps_point z_sample(z_fwd);
-    ps_point z_propose(z_fwd);
+    ps_point& z_sample = workspace_.z_sample;
+    ps_point& z_propose = workspace_.z_propose;
+    z_sample.ps_point::operator=(z_fwd);
+    z_propose.ps_point::operator=(z_fwd);
 
     // Momentum and sharp momentum at forward end of forward subtree
-    Eigen::VectorXd p_fwd_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_fwd = this->hamiltonian_.dtau_dp(this->z_);
+    Eigen::VectorXd& p_fwd_fwd = workspace_.p_fwd_fwd;
+    Eigen::VectorXd& p_sharp_fwd_fwd = workspace_.p_sharp_fwd_fwd;
+    p_fwd_fwd = this->z_.p;
+    this->hamiltonian_.dtau_dp_into(this->z_, p_sharp_fwd_fwd);
 
     // Momentum and sharp momentum at backward end of forward subtree
-    Eigen::VectorXd p_fwd_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_fwd_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_fwd_bck = workspace_.p_fwd_bck;
+    Eigen::VectorXd& p_sharp_fwd_bck = workspace_.p_sharp_fwd_bck;
+    p_fwd_bck = this->z_.p;
+    p_sharp_fwd_bck = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at forward end of backward subtree
-    Eigen::VectorXd p_bck_fwd = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_fwd = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_fwd = workspace_.p_bck_fwd;
+    Eigen::VectorXd& p_sharp_bck_fwd = workspace_.p_sharp_bck_fwd;
+    p_bck_fwd = this->z_.p;
+    p_sharp_bck_fwd = p_sharp_fwd_fwd;
 
     // Momentum and sharp momentum at backward end of backward subtree
-    Eigen::VectorXd p_bck_bck = this->z_.p;
-    Eigen::VectorXd p_sharp_bck_bck = p_sharp_fwd_fwd;
+    Eigen::VectorXd& p_bck_bck = workspace_.p_bck_bck;
+    Eigen::VectorXd& p_sharp_bck_bck = workspace_.p_sharp_bck_bck;
+    p_bck_bck = this->z_.p;
+    p_sharp_bck_bck = p_sharp_fwd_fwd;
 
     // Integrated momenta along trajectory
-    Eigen::VectorXd rho = this->z_.p.transpose();
+    Eigen::VectorXd& rho = workspace_.rho;
+    rho = this->z_.p;
+
+    Eigen::VectorXd& rho_fwd = workspace_.rho_fwd;
+    Eigen::VectorXd& rho_bck = workspace_.rho_bck;
+    Eigen::VectorXd& rho_extended = workspace_.rho_extended;
 
     // Log sum of state weights (offset by H0) along trajectory
     double log_sum_weight = 0;  // log(exp(H0 - H0))
@@ -122,8 +241,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
     while (this->depth_ < this->max_depth_) {
       // Build a new subtree in a random direction
-      Eigen::VectorXd rho_fwd = Eigen::VectorXd::Zero(rho.size());
-      Eigen::VectorXd rho_bck = Eigen::VectorXd::Zero(rho.size());
+      rho_fwd.setZero();
+      rho_bck.setZero();
 
       bool valid_subtree = false;
       double log_sum_weight_subtree = -std::numeric_limits<double>::infinity();
@@ -135,7 +254,7 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         p_bck_fwd = p_fwd_fwd;
         p_sharp_bck_fwd = p_sharp_fwd_fwd;
 
-        valid_subtree = build_tree(
+        valid_subtree = extend_tree(
             this->depth_, z_propose, p_sharp_fwd_bck, p_sharp_fwd_fwd, rho_fwd,
             p_fwd_bck, p_fwd_fwd, H0, 1, n_leapfrog, log_sum_weight_subtree,
             sum_metro_prob, logger);
@@ -147,7 +266,7 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         p_fwd_bck = p_bck_bck;
         p_sharp_fwd_bck = p_sharp_bck_bck;
 
-        valid_subtree = build_tree(
+        valid_subtree = extend_tree(
             this->depth_, z_propose, p_sharp_bck_fwd, p_sharp_bck_bck, rho_bck,
             p_bck_fwd, p_bck_bck, H0, -1, n_leapfrog, log_sum_weight_subtree,
             sum_metro_prob, logger);
@@ -179,7 +298,7 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
           = compute_criterion(p_sharp_bck_bck, p_sharp_fwd_fwd, rho);
 
       // Demand satisfaction between subtrees
-      Eigen::VectorXd rho_extended = rho_bck + p_fwd_bck;
+      rho_extended = rho_bck + p_fwd_bck;
 
       persist_criterion
           &= compute_criterion(p_sharp_bck_bck, p_sharp_fwd_bck, rho_extended);
@@ -200,7 +319,81 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
     this->z_.ps_point::operator=(z_sample);
     this->energy_ = this->hamiltonian_.H(this->z_);
-    return sample(this->z_.q, -this->z_.V, accept_prob);
+    return accept_prob;
+  }
+
+  /**
+   * Draw a momentum and build a trajectory from the current state,
+   * expanding it in both directions concurrently as described in
+   * <code>set_speculative_expansion</code>, then move to the state
+   * sampled from it.
+   *
+   * @param logger Logger for messages
+   * @return Average acceptance probability across the trajectory
+   */
+  double build_trajectory_speculative(callbacks::logger& logger) {
+    this->hamiltonian_.sample_p(this->z_, this->rand_int_);
+    this->hamiltonian_.init(this->z_, logger);
+
+    const int n = this->z_.p.size();
+    workspace_.resize(n, 0);
+    if (!speculation_)
+      speculation_.reset(new speculation_state(model_, this->rand_int_));
+    speculation_state& state = *speculation_;
+    state.resize(n, this->max_depth_);
+
+    workspace_.z_sample.ps_point::operator=(this->z_);
+    workspace_.p_fwd_fwd = this->z_.p;
+    this->hamiltonian_.dtau_dp_into(this->z_, workspace_.p_sharp_fwd_fwd);
+    workspace_.p_fwd_bck = this->z_.p;
+    workspace_.p_sharp_fwd_bck = workspace_.p_sharp_fwd_fwd;
+    workspace_.p_bck_fwd = this->z_.p;
+    workspace_.p_sharp_bck_fwd = workspace_.p_sharp_fwd_fwd;
+    workspace_.p_bck_bck = this->z_.p;
+    workspace_.p_sharp_bck_bck = workspace_.p_sharp_fwd_fwd;
+    workspace_.rho = this->z_.p;
+
+    state.H0 = this->hamiltonian_.H(this->z_);
+    state.log_sum_weight = 0;  // log(exp(H0 - H0))
+    state.sum_metro_prob = 0;
+    state.n_leapfrog = 0;
+    state.num_merged = 0;
+    state.stop = false;
+
+    // Doubling directions, then one seed for each half of the trajectory
+    for (int k = 0; k < this->max_depth_; ++k)
+      state.forward[k] = this->rand_uniform_() > 0.5;
+    for (int d = 0; d < 2; ++d) {
+      direction_stream& stream = state.streams[d];
+      stream.rng.seed(this->rand_int_());
+      base_nuts& helper = *stream.sampler;
+      stream.sampler->parent_ = this;
+      helper.z_ = this->z_;
+      helper.epsilon_ = this->epsilon_;
+      helper.max_deltaH_ = this->max_deltaH_;
+      helper.iterative_ = this->iterative_;
+      helper.divergent_ = false;
+      helper.cancel_ = &state.stop;
+      stream.next_level = next_level(d == 0, -1);
+      stream.parked = false;
+    }
+
+    this->depth_ = 0;
+    this->divergent_ = false;
+
+    tbb::this_task_arena::isolate([&] {
+      for (int d = 0; d < 2; ++d)
+        state.tasks.run([this, d, &logger] { run_stream(d, logger); });
+      state.tasks.wait();
+    });
+
+    this->n_leapfrog_ = state.n_leapfrog;
+    double accept_prob
+        = state.sum_metro_prob / static_cast<double>(state.n_leapfrog);
+
+    this->z_.ps_point::operator=(workspace_.z_sample);
+    this->energy_ = this->hamiltonian_.H(this->z_);
+    return accept_prob;
   }
 
   void get_sampler_param_names(std::vector<std::string>& names) {
@@ -225,6 +418,163 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     return p_sharp_plus.dot(rho) > 0 && p_sharp_minus.dot(rho) > 0;
   }
 
+  /**
+   * Build a new subtree with the selected tree builder.  Arguments
+   * are as for <code>build_tree</code>.
+   */
+  bool extend_tree(int depth, ps_point& z_propose,
+                   Eigen::VectorXd& p_sharp_beg, Eigen::VectorXd& p_sharp_end,
+                   Eigen::VectorXd& rho, Eigen::VectorXd& p_beg,
+                   Eigen::VectorXd& p_end, double H0, double sign,
+                   int& n_leapfrog, double& log_sum_weight,
+                   double& sum_metro_prob, callbacks::logger& logger) {
+    if (iterative_)
+      return build_tree_iterative(depth, z_propose, p_sharp_beg, p_sharp_end,
+                                  rho, p_beg, p_end, H0, sign, n_leapfrog,
+                                  log_sum_weight, sum_metro_prob, logger);
+    return build_tree(depth, z_propose, p_sharp_beg, p_sharp_end, rho, p_beg,
+                      p_end, H0, sign, n_leapfrog, log_sum_weight,
+                      sum_metro_prob, logger);
+  }
+
+  /**
+   * Iteratively build a new subtree to completion or until the
+   * subtree becomes invalid.  Returns validity of the resulting
+   * subtree.
+   *
+   * States are generated in order and each completed subtree of 2^k
+   * states is kept as a checkpoint at level k until its sibling is
+   * complete, at which point the two are merged and their U-turn
+   * criteria checked.  Merges therefore happen in the same order as
+   * in the recursive <code>build_tree</code>, so both consume the
+   * same random numbers and return the same subtree, while only
+   * <code>depth</code> checkpoints are live at any time.
+   *
+   * @param depth Depth of the desired subtree
+   * @param z_propose State proposed from subtree
+   * @param p_sharp_beg Sharp momentum at beginning of new tree
+   * @param p_sharp_end Sharp momentum at end of new tree
+   * @param rho Summed momentum across trajectory
+   * @param p_beg Momentum at beginning of returned tree
+   * @param p_end Momentum at end of returned tree
+   * @param H0 Hamiltonian of initial state
+   * @param sign Direction in time to built subtree
+   * @param n_leapfrog Summed number of leapfrog evaluations
+   * @param log_sum_weight Log of summed weights across trajectory
+   * @param sum_metro_prob Summed Metropolis probabilities across trajectory
+   * @param logger Logger for messages
+   */
+  bool build_tree_iterative(int depth, ps_point& z_propose,
+                            Eigen::VectorXd& p_sharp_beg,
+                            Eigen::VectorXd& p_sharp_end, Eigen::VectorXd& rho,
+                            Eigen::VectorXd& p_beg, Eigen::VectorXd& p_end,
+                            double H0, double sign, int& n_leapfrog,
+                            double& log_sum_weight, double& sum_metro_prob,
+                            callbacks::logger& logger) {
+    workspace_.resize(this->z_.p.size(), 0);
+    workspace_.resize_checkpoints(depth);
+
+    // Summed momentum of the subtree currently being grown
+    Eigen::VectorXd& rho_tree = workspace_.rho_tree;
+    Eigen::VectorXd& rho_subtree = workspace_.rho_subtree;
+    double log_sum_weight_tree = -std::numeric_limits<double>::infinity();
+
+    const int num_states = 1 << depth;
+    for (int n = 0; n < num_states; ++n) {
+      if (cancelled())
+        return false;
+
+      this->integrator_.evolve(this->z_, this->hamiltonian_,
+                               sign * this->epsilon_, logger);
+      ++n_leapfrog;
+
+      double h = this->hamiltonian_.H(this->z_);
+      if (std::isnan(h))
+        h = std::numeric_limits<double>::infinity();
+
+      if ((h - H0) > this->max_deltaH_)
+        this->divergent_ = true;
+
+      log_sum_weight_tree = math::log_sum_exp(
+          -std::numeric_limits<double>::infinity(), H0 - h);
+
+      if (H0 - h > 0)
+        sum_metro_prob += 1;
+      else
+        sum_metro_prob += std::exp(H0 - h);
+
+      z_propose = this->z_;
+
+      this->hamiltonian_.dtau_dp_into(this->z_, p_sharp_beg);
+      p_sharp_end = p_sharp_beg;
+
+      rho_tree = this->z_.p;
+      p_beg = this->z_.p;
+      p_end = p_beg;
+
+      if (this->divergent_)
+        return false;
+
+      // Merge the new state with every completed sibling subtree to
+      // its left, smallest first
+      int level = 0;
+      for (; (n >> level) & 1; ++level) {
+        nuts_workspace::checkpoint& init = workspace_.checkpoint_at(level);
+
+        // Multinomial sample from right subtree
+        double log_sum_weight_subtree
+            = math::log_sum_exp(init.log_sum_weight, log_sum_weight_tree);
+
+        if (!(log_sum_weight_tree > log_sum_weight_subtree)) {
+          double accept_prob
+              = std::exp(log_sum_weight_tree - log_sum_weight_subtree);
+          if (!(this->rand_uniform_() < accept_prob))
+            z_propose = init.z_propose;
+        }
+        log_sum_weight_tree = log_sum_weight_subtree;
+
+        rho_subtree = init.rho + rho_tree;
+
+        // Demand satisfaction around merged subtrees
+        bool persist_criterion
+            = compute_criterion(init.p_sharp_beg, p_sharp_end, rho_subtree);
+
+        // Demand satisfaction between subtrees
+        Eigen::VectorXd& rho_extended = workspace_.rho_extended;
+        rho_extended = init.rho + p_beg;
+        persist_criterion
+            &= compute_criterion(init.p_sharp_beg, p_sharp_beg, rho_extended);
+
+        rho_extended = rho_tree + init.p_end;
+        persist_criterion
+            &= compute_criterion(init.p_sharp_end, p_sharp_end, rho_extended);
+
+        if (!persist_criterion)
+          return false;
+
+        // The merged subtree starts where the initial subtree started
+        p_beg = init.p_beg;
+        p_sharp_beg = init.p_sharp_beg;
+        rho_tree.swap(rho_subtree);
+      }
+
+      if (level < depth) {
+        nuts_workspace::checkpoint& saved = workspace_.checkpoint_at(level);
+        saved.z_propose = z_propose;
+        saved.p_beg = p_beg;
+        saved.p_sharp_beg = p_sharp_beg;
+        saved.p_end = p_end;
+        saved.p_sharp_end = p_sharp_end;
+        saved.rho = rho_tree;
+        saved.log_sum_weight = log_sum_weight_tree;
+      }
+    }
+
+    rho += rho_tree;
+    log_sum_weight = math::log_sum_exp(log_sum_weight, log_sum_weight_tree);
+    return true;
+  }
+
   /**
    * Recursively build a new subtree to completion or until
    * the subtree becomes invalid.  Returns validity of the
@@ -251,6 +601,9 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
                   double& sum_metro_prob, callbacks::logger& logger) {
     // Base case
     if (depth == 0) {
+      if (cancelled())
+        return false;
+
       this->integrator_.evolve(this->z_, this->hamiltonian_,
                                sign * this->epsilon_, logger);
       ++n_leapfrog;
@@ -271,7 +624,7 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
 
       z_propose = this->z_;
 
-      p_sharp_beg = this->hamiltonian_.dtau_dp(this->z_);
+      this->hamiltonian_.dtau_dp_into(this->z_, p_sharp_beg);
       p_sharp_end = p_sharp_beg;
 
       rho += this->z_.p;
@@ -282,14 +635,20 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
     }
     // General recursion
 
+    // Storage for this level of the recursion, sized lazily so that
+    // trees deeper than max_depth_ can still be built directly
+    workspace_.resize(this->z_.p.size(), depth + 1);
+    nuts_workspace::subtree_buffers& ws = workspace_.subtree(depth);
+
     // Build the initial subtree
     double log_sum_weight_init = -std::numeric_limits<double>::infinity();
 
     // Momentum and sharp momentum at end of the initial subtree
-    Eigen::VectorXd p_init_end(this->z_.p.size());
-    Eigen::VectorXd p_sharp_init_end(this->z_.p.size());
+    Eigen::VectorXd& p_init_end = ws.p_init_end;
+    Eigen::VectorXd& p_sharp_init_end = ws.p_sharp_init_end;
 
-    Eigen::VectorXd rho_init = Eigen::VectorXd::Zero(rho.size());
+    Eigen::VectorXd& rho_init = ws.rho_init;
+    rho_init.setZero();
 
     bool valid_init
         = build_tree(depth - 1, z_propose, p_sharp_beg, p_sharp_init_end,
@@ -300,15 +659,17 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
       return false;
 
     // Build the final subtree
-    ps_point z_propose_final(this->z_);
+    ps_point& z_propose_final = ws.z_propose_final;
+    z_propose_final.ps_point::operator=(this->z_);
 
     double log_sum_weight_final = -std::numeric_limits<double>::infinity();
 
     // Momentum and sharp momentum at beginning of the final subtree
-    Eigen::VectorXd p_final_beg(this->z_.p.size());
-    Eigen::VectorXd p_sharp_final_beg(this->z_.p.size());
+    Eigen::VectorXd& p_final_beg = ws.p_final_beg;
+    Eigen::VectorXd& p_sharp_final_beg = ws.p_sharp_final_beg;
 
-    Eigen::VectorXd rho_final = Eigen::VectorXd::Zero(rho.size());
+    Eigen::VectorXd& rho_final = ws.rho_final;
+    rho_final.setZero();
 
     bool valid_final
         = build_tree(depth - 1, z_propose_final, p_sharp_final_beg, p_sharp_end,
@@ -332,7 +693,8 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
         z_propose = z_propose_final;
     }
 
-    Eigen::VectorXd rho_subtree = rho_init + rho_final;
+    Eigen::VectorXd& rho_subtree = ws.rho_subtree;
+    rho_subtree = rho_init + rho_final;
     rho += rho_subtree;
 
     // Demand satisfaction around merged subtrees
@@ -358,6 +720,247 @@ class base_nuts : public base_hmc<Model, Hamiltonian, Integrator, BaseRNG> {
   int n_leapfrog_;
   bool divergent_;
   double energy_;
+
+ protected:
+  class speculation_helper;
+
+  /**
+   * Helper sampler building one direction of a speculatively expanded
+   * trajectory, with the random number generator it owns.
+   */
+  struct direction_stream {
+    direction_stream(const Model& model, const BaseRNG& parent_rng)
+        : rng(parent_rng),
+          sampler(new speculation_helper(model, rng)),
+          next_level(0),
+          parked(false) {}
+
+    BaseRNG rng;
+    std::unique_ptr<speculation_helper> sampler;
+    int next_level;
+    bool parked;
+  };
+
+  /**
+   * Shared state of a speculatively expanded trajectory.  Everything
+   * other than the helpers' own trees is guarded by the mutex.
+   */
+  struct speculation_state {
+    speculation_state(const Model& model, const BaseRNG& parent_rng)
+        : streams{{model, parent_rng}, {model, parent_rng}},
+          stop(false),
+          num_merged(0),
+          H0(0),
+          log_sum_weight(0),
+          sum_metro_prob(0),
+          n_leapfrog(0) {}
+
+    void resize(int n, int max_depth) {
+      if (!subtrees.empty() && subtrees[0].rho.size() != n)
+        subtrees.clear();
+      while (static_cast<int>(subtrees.size()) < max_depth)
+        subtrees.emplace_back(n);
+      forward.resize(max_depth);
+    }
+
+    // Forward stream first, then backward
+    direction_stream streams[2];
+    std::vector<nuts_workspace::speculative_subtree> subtrees;
+    std::vector<bool> forward;
+    std::mutex mutex;
+    std::atomic<bool> stop;
+    tbb::task_group tasks;
+    int num_merged;
+    double H0;
+    double log_sum_weight;
+    double sum_metro_prob;
+    int n_leapfrog;
+  };
+
+  /**
+   * Return true if the trajectory this sampler is building for a
+   * speculative expansion has been cancelled.
+   */
+  inline bool cancelled() const {
+    return cancel_ != nullptr && cancel_->load(std::memory_order_relaxed);
+  }
+
+  /**
+   * Return the first doubling after <code>level</code> in the given
+   * direction, or the maximum depth if there is none.
+   */
+  int next_level(bool forward, int level) const {
+    const speculation_state& state = *speculation_;
+    for (++level; level < this->max_depth_; ++level)
+      if (state.forward[level] == forward)
+        break;
+    return level;
+  }
+
+  /**
+   * Build the subtrees of one direction in order, merging whatever has
+   * completed after each one.  A helper parks instead of running more
+   * than one doubling ahead of the merge and is restarted by the merge
+   * once it catches up.
+   */
+  void run_stream(int d, callbacks::logger& logger) {
+    speculation_state& state = *speculation_;
+    direction_stream& stream = state.streams[d];
+    const bool forward = d == 0;
+    while (true) {
+      const int level = stream.next_level;
+      {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        if (state.stop || level >= this->max_depth_)
+          return;
+        if (level > state.num_merged + 1) {
+          stream.parked = true;
+          return;
+        }
+      }
+
+      nuts_workspace::speculative_subtree& subtree = state.subtrees[level];
+      subtree.rho.setZero();
+      subtree.log_sum_weight = -std::numeric_limits<double>::infinity();
+      subtree.sum_metro_prob = 0;
+      subtree.n_leapfrog = 0;
+      subtree.valid = stream.sampler->extend_tree(
+          level, subtree.z_propose, subtree.p_sharp_beg, subtree.p_sharp_end,
+          subtree.rho, subtree.p_beg, subtree.p_end, state.H0,
+          forward ? 1 : -1, subtree.n_leapfrog, subtree.log_sum_weight,
+          subtree.sum_metro_prob, logger);
+      subtree.divergent = stream.sampler->divergent_;
+      stream.next_level = next_level(forward, level);
+
+      std::lock_guard<std::mutex> lock(state.mutex);
+      subtree.ready = true;
+      merge_subtrees(logger);
+      if (!subtree.valid)
+        return;
+    }
+  }
+
+  /**
+   * Merge completed subtrees into the trajectory in doubling order,
+   * exactly as <code>build_trajectory</code> does after each
+   * <code>extend_tree</code>, and restart parked helpers that may now
+   * proceed.  Must be called with the speculation mutex held.
+   */
+  void merge_subtrees(callbacks::logger& logger) {
+    speculation_state& state = *speculation_;
+    nuts_workspace& ws = workspace_;
+    while (!state.stop && state.num_merged < this->max_depth_
+           && state.subtrees[state.num_merged].ready) {
+      nuts_workspace::speculative_subtree& subtree
+          = state.subtrees[state.num_merged];
+      subtree.ready = false;
+      ++state.num_merged;
+      state.n_leapfrog += subtree.n_leapfrog;
+      state.sum_metro_prob += subtree.sum_metro_prob;
+      this->divergent_ = this->divergent_ || subtree.divergent;
+      if (!subtree.valid) {
+        state.stop = true;
+        break;
+      }
+
+      if (state.forward[state.num_merged - 1]) {
+        ws.rho_bck = ws.rho;
+        ws.p_bck_fwd = ws.p_fwd_fwd;
+        ws.p_sharp_bck_fwd = ws.p_sharp_fwd_fwd;
+        ws.rho_fwd = subtree.rho;
+        ws.p_fwd_bck = subtree.p_beg;
+        ws.p_sharp_fwd_bck = subtree.p_sharp_beg;
+        ws.p_fwd_fwd = subtree.p_end;
+        ws.p_sharp_fwd_fwd = subtree.p_sharp_end;
+      } else {
+        ws.rho_fwd = ws.rho;
+        ws.p_fwd_bck = ws.p_bck_bck;
+        ws.p_sharp_fwd_bck = ws.p_sharp_bck_bck;
+        ws.rho_bck = subtree.rho;
+        ws.p_bck_fwd = subtree.p_beg;
+        ws.p_sharp_bck_fwd = subtree.p_sharp_beg;
+        ws.p_bck_bck = subtree.p_end;
+        ws.p_sharp_bck_bck = subtree.p_sharp_end;
+      }
+
+      // Sample from accepted subtree
+      ++(this->depth_);
+
+      if (subtree.log_sum_weight > state.log_sum_weight) {
+        ws.z_sample = subtree.z_propose;
+      } else {
+        double accept_prob
+            = std::exp(subtree.log_sum_weight - state.log_sum_weight);
+        if (this->rand_uniform_() < accept_prob)
+          ws.z_sample = subtree.z_propose;
+      }
+
+      state.log_sum_weight
+          = math::log_sum_exp(state.log_sum_weight, subtree.log_sum_weight);
+
+      // Break when no-u-turn criterion is no longer satisfied
+      ws.rho = ws.rho_bck + ws.rho_fwd;
+
+      // Demand satisfaction around merged subtrees
+      bool persist_criterion
+          = compute_criterion(ws.p_sharp_bck_bck, ws.p_sharp_fwd_fwd, ws.rho);
+
+      // Demand satisfaction between subtrees
+      ws.rho_extended = ws.rho_bck + ws.p_fwd_bck;
+
+      persist_criterion &= compute_criterion(
+          ws.p_sharp_bck_bck, ws.p_sharp_fwd_bck, ws.rho_extended);
+
+      ws.rho_extended = ws.rho_fwd + ws.p_bck_fwd;
+      persist_criterion &= compute_criterion(
+          ws.p_sharp_bck_fwd, ws.p_sharp_fwd_fwd, ws.rho_extended);
+
+      if (!persist_criterion)
+        state.stop = true;
+    }
+    if (state.stop)
+      return;
+
+    for (int d = 0; d < 2; ++d) {
+      direction_stream& stream = state.streams[d];
+      if (stream.parked && stream.next_level <= state.num_merged + 1) {
+        stream.parked = false;
+        state.tasks.run([this, d, &logger] { run_stream(d, logger); });
+      }
+    }
+  }
+
+  bool iterative_;
+  bool speculative_;
+  const std::atomic<bool>* cancel_;
+  const Model& model_;
+  nuts_workspace workspace_;
+  std::unique_ptr<speculation_state> speculation_;
+};
+
+/**
+ * Sampler building one half of a speculatively expanded trajectory.
+ * The no-U-turn criterion is deferred to the sampler the trajectory
+ * belongs to, so that the subtrees built here terminate exactly as
+ * that sampler's own would, including when a derived sampler
+ * overrides <code>compute_criterion</code>.  The criterion may be
+ * called from both helpers at once and must not modify the sampler.
+ */
+template <class Model, template <class, class> class Hamiltonian,
+          template <class> class Integrator, class BaseRNG>
+class base_nuts<Model, Hamiltonian, Integrator, BaseRNG>::speculation_helper
+    : public base_nuts<Model, Hamiltonian, Integrator, BaseRNG> {
+ public:
+  speculation_helper(const Model& model, BaseRNG& rng)
+      : base_nuts<Model, Hamiltonian, Integrator, BaseRNG>(model, rng),
+        parent_(nullptr) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    return parent_->compute_criterion(p_sharp_minus, p_sharp_plus, rho);
+  }
+
+  base_nuts* parent_;
 };
 
 }  // namespace mcmc
@@ -0,0 +1,55 @@
+#ifndef STAN_MCMC_HMC_NUTS_LOWRANK_DIAG_E_NUTS_HPP
+#define STAN_MCMC_HMC_NUTS_LOWRANK_DIAG_E_NUTS_HPP
+
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_diag_e_point.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_diag_e_metric.hpp>
+#include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+
+namespace stan {
+namespace mcmc {
+/**
+ * The No-U-Turn sampler (NUTS) with multinomial sampling
+ * with a Gaussian-Euclidean disintegration and diagonal plus
+ * low rank metric
+ */
+template <class Model, class BaseRNG>
+class lowrank_diag_e_nuts
+    : public base_nuts<Model, lowrank_diag_e_metric, expl_leapfrog, BaseRNG> {
+ public:
+  lowrank_diag_e_nuts(const Model& model, BaseRNG& rng)
+      : base_nuts<Model, lowrank_diag_e_metric, expl_leapfrog, BaseRNG>(
+          model, rng) {}
+
+  using base_nuts<Model, lowrank_diag_e_metric, expl_leapfrog,
+                  BaseRNG>::set_metric;
+
+  void set_metric(const Eigen::VectorXd& inv_e_metric,
+                  const Eigen::MatrixXd& inv_e_metric_factor) {
+    this->z_.set_metric(inv_e_metric, inv_e_metric_factor);
+  }
+
+  /**
+   * write stepsize and the diagonal and low rank factor of the inverse
+   * mass matrix as a JSON object
+   *
+   * @param struct_writer writer for the tuning parameters
+   * @param num_warmup number of warmup iterations run, written only if
+   * not negative
+   */
+  void write_sampler_state_struct(callbacks::structured_writer& struct_writer,
+                                  int num_warmup = -1) {
+    struct_writer.begin_record();
+    struct_writer.write("stepsize", this->get_nominal_stepsize());
+    struct_writer.write("metric_type", this->z_.metric_type());
+    struct_writer.write("inv_metric", this->z_.inv_e_metric_);
+    struct_writer.write("inv_metric_factor", this->z_.inv_e_metric_factor_);
+    if (num_warmup >= 0)
+      struct_writer.write("num_warmup", num_warmup);
+    struct_writer.end_record();
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
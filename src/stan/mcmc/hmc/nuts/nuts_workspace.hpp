@@ -0,0 +1,301 @@
+#ifndef STAN_MCMC_HMC_NUTS_NUTS_WORKSPACE_HPP
+#define STAN_MCMC_HMC_NUTS_NUTS_WORKSPACE_HPP
+
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/mcmc/hmc/hamiltonians/ps_point.hpp>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Preallocated storage for the states and momenta used while building
+ * a NUTS trajectory.
+ *
+ * The trajectory bookkeeping in <code>base_nuts</code> needs a fixed
+ * set of vectors for the outer doubling loop and one set of vectors
+ * for every level of the recursive subtree construction.  Holding
+ * them here lets the sampler size everything once and reuse the
+ * storage across transitions, so that once the workspace has grown
+ * to the maximum tree depth no further heap allocations are made
+ * while building trajectories.
+ *
+ * The iterative tree builder instead keeps one checkpoint per level,
+ * holding the completed subtree of that size that is waiting to be
+ * merged with its sibling, so it only needs O(max_depth) vectors
+ * regardless of how the tree is traversed.
+ */
+class nuts_workspace {
+ public:
+  /**
+   * Storage used by one level of the recursive subtree construction.
+   */
+  struct subtree_buffers {
+    explicit subtree_buffers(int n)
+        : z_propose_final(n),
+          p_init_end(n),
+          p_sharp_init_end(n),
+          p_final_beg(n),
+          p_sharp_final_beg(n),
+          rho_init(n),
+          rho_final(n),
+          rho_subtree(n) {}
+
+    /**
+     * State proposed from the final subtree
+     */
+    ps_point z_propose_final;
+
+    /**
+     * Momentum and sharp momentum at end of the initial subtree
+     */
+    Eigen::VectorXd p_init_end;
+    Eigen::VectorXd p_sharp_init_end;
+
+    /**
+     * Momentum and sharp momentum at beginning of the final subtree
+     */
+    Eigen::VectorXd p_final_beg;
+    Eigen::VectorXd p_sharp_final_beg;
+
+    /**
+     * Summed momenta across the initial, final and merged subtrees
+     */
+    Eigen::VectorXd rho_init;
+    Eigen::VectorXd rho_final;
+    Eigen::VectorXd rho_subtree;
+  };
+
+  /**
+   * Completed subtree of 2^k states stored at level k by the
+   * iterative tree builder.
+   */
+  struct checkpoint {
+    explicit checkpoint(int n)
+        : z_propose(n),
+          p_beg(n),
+          p_sharp_beg(n),
+          p_end(n),
+          p_sharp_end(n),
+          rho(n),
+          log_sum_weight(0) {}
+
+    /**
+     * State proposed from the subtree
+     */
+    ps_point z_propose;
+
+    /**
+     * Momentum and sharp momentum at the beginning and end of the
+     * subtree
+     */
+    Eigen::VectorXd p_beg;
+    Eigen::VectorXd p_sharp_beg;
+    Eigen::VectorXd p_end;
+    Eigen::VectorXd p_sharp_end;
+
+    /**
+     * Summed momentum across the subtree
+     */
+    Eigen::VectorXd rho;
+
+    /**
+     * Log of summed weights across the subtree
+     */
+    double log_sum_weight;
+  };
+
+  /**
+   * Subtree built by a helper sampler during a speculative expansion
+   * of the trajectory, held until it can be merged in order.
+   */
+  struct speculative_subtree {
+    explicit speculative_subtree(int n)
+        : z_propose(n),
+          p_sharp_beg(n),
+          p_sharp_end(n),
+          p_beg(n),
+          p_end(n),
+          rho(n),
+          log_sum_weight(0),
+          sum_metro_prob(0),
+          n_leapfrog(0),
+          valid(false),
+          divergent(false),
+          ready(false) {}
+
+    /**
+     * State proposed from the subtree
+     */
+    ps_point z_propose;
+
+    /**
+     * Momentum and sharp momentum at the beginning and end of the
+     * subtree, and summed momentum across it
+     */
+    Eigen::VectorXd p_sharp_beg;
+    Eigen::VectorXd p_sharp_end;
+    Eigen::VectorXd p_beg;
+    Eigen::VectorXd p_end;
+    Eigen::VectorXd rho;
+
+    /**
+     * Log of summed weights, summed Metropolis probabilities and
+     * number of leapfrog steps across the subtree
+     */
+    double log_sum_weight;
+    double sum_metro_prob;
+    int n_leapfrog;
+
+    /**
+     * Whether the subtree is valid, whether it diverged, and whether
+     * it is complete and waiting to be merged
+     */
+    bool valid;
+    bool divergent;
+    bool ready;
+  };
+
+  /**
+   * Construct an empty workspace.  Storage is allocated on the first
+   * call to <code>resize</code>.
+   */
+  nuts_workspace()
+      : z_fwd(0), z_bck(0), z_sample(0), z_propose(0), dim_(-1) {}
+
+  /**
+   * Size the workspace for trajectories in an <code>n</code>
+   * dimensional phase space with subtrees of up to
+   * <code>max_depth</code> levels.  Existing storage is reused when it
+   * is already large enough, so calling this before every transition
+   * does not allocate once the workspace has been sized.
+   *
+   * @param n number of dimensions
+   * @param max_depth maximum depth of the subtrees that will be built
+   */
+  void resize(int n, int max_depth) {
+    if (n != dim_) {
+      dim_ = n;
+      z_fwd = ps_point(n);
+      z_bck = ps_point(n);
+      z_sample = ps_point(n);
+      z_propose = ps_point(n);
+      p_fwd_fwd.resize(n);
+      p_sharp_fwd_fwd.resize(n);
+      p_fwd_bck.resize(n);
+      p_sharp_fwd_bck.resize(n);
+      p_bck_fwd.resize(n);
+      p_sharp_bck_fwd.resize(n);
+      p_bck_bck.resize(n);
+      p_sharp_bck_bck.resize(n);
+      rho.resize(n);
+      rho_fwd.resize(n);
+      rho_bck.resize(n);
+      rho_extended.resize(n);
+      rho_tree.resize(n);
+      rho_subtree.resize(n);
+      subtrees_.clear();
+      checkpoints_.clear();
+    }
+    if (max_depth > static_cast<int>(subtrees_.size())) {
+      subtrees_.reserve(max_depth);
+      while (static_cast<int>(subtrees_.size()) < max_depth)
+        subtrees_.emplace_back(n);
+    }
+  }
+
+  /**
+   * Size the checkpoints used by the iterative tree builder for
+   * trees of up to <code>max_depth</code> levels.  The phase space
+   * dimension must already have been set with <code>resize</code>.
+   *
+   * @param max_depth maximum depth of the trees that will be built
+   */
+  void resize_checkpoints(int max_depth) {
+    if (max_depth > static_cast<int>(checkpoints_.size())) {
+      checkpoints_.reserve(max_depth);
+      while (static_cast<int>(checkpoints_.size()) < max_depth)
+        checkpoints_.emplace_back(dim_);
+    }
+  }
+
+  /**
+   * Return the storage for subtrees of the specified depth.  The
+   * workspace must have been sized for at least
+   * <code>depth + 1</code> levels.
+   *
+   * @param depth depth of the subtree
+   * @return storage for that level of the recursion
+   */
+  inline subtree_buffers& subtree(int depth) { return subtrees_[depth]; }
+
+  /**
+   * Return the checkpoint for completed subtrees of 2^level states.
+   * The checkpoints must have been sized for at least
+   * <code>level + 1</code> levels.
+   *
+   * @param level level of the checkpoint
+   * @return checkpoint for that level
+   */
+  inline checkpoint& checkpoint_at(int level) { return checkpoints_[level]; }
+
+  /**
+   * Return the number of subtree levels currently allocated.
+   */
+  inline int max_depth() const { return subtrees_.size(); }
+
+  /**
+   * Return the dimension of the phase space the workspace is sized
+   * for, or -1 if it has not been sized yet.
+   */
+  inline int dim() const { return dim_; }
+
+  /**
+   * States at the forward and backward ends of the trajectory
+   */
+  ps_point z_fwd;
+  ps_point z_bck;
+
+  /**
+   * Current sample and the state proposed from the newest subtree
+   */
+  ps_point z_sample;
+  ps_point z_propose;
+
+  /**
+   * Momentum and sharp momentum at the ends of the forward and
+   * backward subtrees
+   */
+  Eigen::VectorXd p_fwd_fwd;
+  Eigen::VectorXd p_sharp_fwd_fwd;
+  Eigen::VectorXd p_fwd_bck;
+  Eigen::VectorXd p_sharp_fwd_bck;
+  Eigen::VectorXd p_bck_fwd;
+  Eigen::VectorXd p_sharp_bck_fwd;
+  Eigen::VectorXd p_bck_bck;
+  Eigen::VectorXd p_sharp_bck_bck;
+
+  /**
+   * Integrated momenta along the trajectory and its two halves
+   */
+  Eigen::VectorXd rho;
+  Eigen::VectorXd rho_fwd;
+  Eigen::VectorXd rho_bck;
+  Eigen::VectorXd rho_extended;
+
+  /**
+   * Summed momenta of the subtree being grown by the iterative tree
+   * builder and of the merge of that subtree with its sibling
+   */
+  Eigen::VectorXd rho_tree;
+  Eigen::VectorXd rho_subtree;
+
+ private:
+  int dim_;
+  std::vector<subtree_buffers> subtrees_;
+  std::vector<checkpoint> checkpoints_;
+};
+
+}  // namespace mcmc
+}  // namespace stan
+#endif
@@ -36,6 +36,7 @@ class adapt_dense_e_static_hmc : public dense_e_static_hmc<Model, BaseRNG>,
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
+        this->z_.metric_changed();
         this->init_stepsize(logger);
         this->update_L_();
 
@@ -48,7 +49,7 @@ class adapt_dense_e_static_hmc : public dense_e_static_hmc<Model, BaseRNG>,
 
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
-    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->complete_stepsize_adaptation(this->nom_epsilon_);
   }
 };
 
@@ -35,6 +35,7 @@ class adapt_dense_e_static_uniform
           this->z_.inv_e_metric_, this->z_.q);
 
       if (update) {
+        this->z_.metric_changed();
         this->init_stepsize(logger);
         this->stepsize_adaptation_.set_mu(log(10 * this->nom_epsilon_));
         this->stepsize_adaptation_.restart();
@@ -45,7 +46,7 @@ class adapt_dense_e_static_uniform
 
   void disengage_adaptation() {
     base_adapter::disengage_adaptation();
-    this->stepsize_adaptation_.complete_adaptation(this->nom_epsilon_);
+    this->complete_stepsize_adaptation(this->nom_epsilon_);
   }
 };
 }  // namespace mcmc
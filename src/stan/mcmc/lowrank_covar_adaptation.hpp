@@ -0,0 +1,213 @@
+#ifndef STAN_MCMC_LOWRANK_COVAR_ADAPTATION_HPP
+#define STAN_MCMC_LOWRANK_COVAR_ADAPTATION_HPP
+
+#include <stan/math/prim.hpp>
+#include <stan/mcmc/windowed_adaptation.hpp>
+#include <boost/random/mixmax.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <Eigen/Eigenvalues>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace stan {
+
+namespace mcmc {
+
+/**
+ * Windowed adaptation of an inverse metric which is diagonal plus low
+ * rank, D + U U^T, for the lowrank_diag_e samplers.
+ *
+ * The metric is the probabilistic PCA fit to the correlation matrix R of
+ * the draws in the window: with S the diagonal of their variances and
+ * (lambda_i, e_i) the k leading eigenpairs of R,
+ *
+ *   D = sigma^2 S,  U = S^{1/2} E (Lambda - sigma^2 I)^{1/2},
+ *
+ * where sigma^2 is the average of the remaining eigenvalues, so the
+ * metric matches the variance of the draws along the leading directions
+ * and on average in the others.  The eigenpairs are estimated in a single
+ * pass with a randomized Nystrom sketch of the covariance: the window only
+ * accumulates the product of the covariance with a fixed N x l Gaussian
+ * test matrix, with l the rank plus a small oversampling, so memory and
+ * work per draw are O(N l) and the N x N covariance is never formed.
+ *
+ * The estimates are regularized toward a small multiple of the identity
+ * in the same way as by <code>var_adaptation</code> and
+ * <code>covar_adaptation</code>.
+ */
+class lowrank_covar_adaptation : public windowed_adaptation {
+ public:
+  /**
+   * Construct an adaptation for the specified dimension and rank.
+   *
+   * @param n number of parameters
+   * @param rank maximum rank of the low rank part of the metric
+   */
+  lowrank_covar_adaptation(int n, int rank)
+      : windowed_adaptation("low rank covariance"),
+        rank_(std::max(0, std::min(rank, n))),
+        var_estimator_(n),
+        omega_(n, std::min(n, rank_ + oversampling_)),
+        sketch_(n, omega_.cols()),
+        sum_(n) {
+    // The test matrix is fixed so the adaptation does not consume draws
+    // from the random number generator of the sampler
+    boost::random::mixmax rng(1, 0, 0, 0);
+    boost::random::normal_distribution<> std_normal;
+    for (int j = 0; j < omega_.cols(); ++j)
+      for (int i = 0; i < omega_.rows(); ++i)
+        omega_(i, j) = std_normal(rng);
+    restart_estimator();
+  }
+
+  /**
+   * Return the maximum rank of the low rank part of the metric.
+   */
+  int rank() const { return rank_; }
+
+  /**
+   * Add a draw to the window and, at the end of a window, replace the
+   * diagonal and the low rank factor of the inverse metric with their
+   * estimates from the window.
+   *
+   * @param[in,out] var diagonal of the inverse metric
+   * @param[in,out] factor low rank factor of the inverse metric
+   * @param[in] q draw
+   * @return true if the metric was updated
+   * @throw std::runtime_error if the estimates are not finite
+   */
+  bool learn_covariance(Eigen::VectorXd& var, Eigen::MatrixXd& factor,
+                        const Eigen::VectorXd& q) {
+    if (adaptation_window())
+      add_sample(q);
+
+    if (end_adaptation_window()) {
+      compute_next_window();
+
+      estimate(var, factor);
+
+      double n = static_cast<double>(num_samples_);
+      var = (n / (n + 5.0)) * var
+            + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
+      factor *= std::sqrt(n / (n + 5.0));
+
+      if (!var.allFinite() || !factor.allFinite())
+        throw std::runtime_error(
+            "Numerical overflow in metric adaptation. "
+            "This occurs when the sampler encounters extreme values on the "
+            "unconstrained space; this may happen when the posterior density "
+            "function is too wide or improper. "
+            "There may be problems with your model specification.");
+
+      restart_estimator();
+
+      ++adapt_window_counter_;
+      return true;
+    }
+
+    ++adapt_window_counter_;
+    return false;
+  }
+
+ protected:
+  static constexpr int oversampling_ = 10;
+  // Lower bound on sigma^2, which is noisy when the rank is close to the
+  // dimension or the sketch is poor
+  static constexpr double min_residual_variance_ = 1e-2;
+
+  int rank_;
+  stan::math::welford_var_estimator var_estimator_;
+  // Gaussian test matrix of the sketch
+  Eigen::MatrixXd omega_;
+  // Sum over the window of (q - shift) (q - shift)^T omega
+  Eigen::MatrixXd sketch_;
+  // Sum over the window of q - shift
+  Eigen::VectorXd sum_;
+  // First draw of the window, subtracted to limit cancellation
+  Eigen::VectorXd shift_;
+  int num_samples_;
+
+  void restart_estimator() {
+    var_estimator_.restart();
+    sketch_.setZero();
+    sum_.setZero();
+    num_samples_ = 0;
+  }
+
+  void add_sample(const Eigen::VectorXd& q) {
+    var_estimator_.add_sample(q);
+    if (num_samples_ == 0)
+      shift_ = q;
+    Eigen::VectorXd x = q - shift_;
+    sketch_.noalias() += x * (omega_.transpose() * x).transpose();
+    sum_ += x;
+    ++num_samples_;
+  }
+
+  /**
+   * Estimate the diagonal and the low rank factor from the window.
+   *
+   * @param[out] var variance of the draws
+   * @param[out] factor low rank factor
+   */
+  void estimate(Eigen::VectorXd& var, Eigen::MatrixXd& factor) {
+    var_estimator_.sample_variance(var);
+    factor.resize(var.size(), 0);
+    if (num_samples_ < 2 || rank_ == 0 || !var.allFinite()
+        || (var.array() <= 0).any())
+      return;
+
+    // Product of the sample covariance with the test matrix
+    const double n = num_samples_;
+    Eigen::VectorXd mean = sum_ / n;
+    Eigen::MatrixXd y
+        = (sketch_ - n * mean * (omega_.transpose() * mean).transpose())
+          / (n - 1.0);
+
+    // Nystrom approximation C ~ F F^T, shifted to keep the core matrix
+    // positive definite in floating point
+    const double nu = std::numeric_limits<double>::epsilon()
+                      * std::sqrt(static_cast<double>(y.rows())) * y.norm();
+    y += nu * omega_;
+    Eigen::MatrixXd core = omega_.transpose() * y;
+    core = 0.5 * (core + core.transpose()).eval();
+    Eigen::LLT<Eigen::MatrixXd> llt(core);
+    if (llt.info() != Eigen::Success)
+      return;
+    Eigen::MatrixXd f = llt.matrixL().solve(y.transpose()).transpose();
+
+    // Leading eigenpairs of the correlation matrix S^{-1/2} F F^T S^{-1/2}
+    Eigen::MatrixXd f_std = var.cwiseSqrt().cwiseInverse().asDiagonal() * f;
+    Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> solver(f_std.transpose()
+                                                          * f_std);
+    const Eigen::VectorXd& lambda = solver.eigenvalues();
+    const int dim = var.size();
+    int k = std::min<int>(rank_, lambda.size());
+    if (k == dim)
+      --k;
+    // The trace of the correlation matrix is the dimension
+    double sigma_sq
+        = (dim - lambda.tail(k).sum()) / static_cast<double>(dim - k);
+    sigma_sq = std::min(1.0, std::max(sigma_sq, min_residual_variance_));
+    while (k > 0 && lambda(lambda.size() - k) <= sigma_sq)
+      --k;
+    var *= sigma_sq;
+    factor.resize(dim, k);
+    // With E = F_std W Lambda^{-1/2}, the column
+    // S^{1/2} E (lambda - sigma^2)^{1/2} is F W (1 - sigma^2 / lambda)^{1/2}
+    for (int j = 0; j < k; ++j) {
+      const int i = lambda.size() - 1 - j;
+      factor.col(j) = f * solver.eigenvectors().col(i)
+                      * std::sqrt(1.0 - sigma_sq / lambda(i));
+    }
+  }
+};
+
+}  // namespace mcmc
+
+}  // namespace stan
+
+#endif
@@ -0,0 +1,270 @@
+#ifndef STAN_MCMC_POOLED_ADAPTATION_HPP
+#define STAN_MCMC_POOLED_ADAPTATION_HPP
+
+#include <stan/math/prim.hpp>
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+/**
+ * Pools the metric adaptation, and optionally the step size adaptation,
+ * of several chains warming up at the same time.
+ *
+ * At the end of every adaptation window each chain hands its Welford
+ * estimator to the pool and blocks until every chain still running has
+ * done the same.  The estimators are then merged, in order of the chains
+ * so that the result does not depend on the order in which they arrive,
+ * and every chain gets the metric estimated from the draws of all of
+ * them.  With step size pooling the chains also wait for each other at
+ * the end of warmup and all take the geometric mean of their adapted
+ * step sizes.  After warmup the chains do not interact.
+ *
+ * Every chain is expected to take part from the start, so the chains
+ * must run concurrently; a chain that stops early, for instance because
+ * of an error, must call <code>leave</code> so that the others do not
+ * wait for it.
+ */
+class pooled_adaptation {
+ public:
+  /**
+   * Construct a pool for the specified number of chains.
+   *
+   * @param num_chains number of chains
+   * @param pool_stepsize true to pool the adapted step sizes
+   */
+  explicit pooled_adaptation(std::size_t num_chains,
+                             bool pool_stepsize = false)
+      : pool_stepsize_(pool_stepsize),
+        num_active_(num_chains),
+        num_arrived_(0),
+        generation_(0),
+        arrived_(num_chains, false),
+        counts_(num_chains, 0),
+        means_(num_chains),
+        scatters_(num_chains),
+        stepsizes_(num_chains, 0) {}
+
+  /**
+   * Return the number of chains in the pool.
+   */
+  std::size_t num_chains() const { return arrived_.size(); }
+
+  /**
+   * Return true if the step sizes are pooled.
+   */
+  bool pools_stepsize() const { return pool_stepsize_; }
+
+  /**
+   * Return the number of times the chains have synchronized.
+   */
+  std::size_t num_synchronizations() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return generation_;
+  }
+
+  /**
+   * Remove a chain from the pool.  If every remaining chain is already
+   * waiting, their exchange completes now.
+   *
+   * @param chain index of the chain
+   */
+  void leave(std::size_t chain) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_active_;
+    if (num_arrived_ > 0 && num_arrived_ == num_active_)
+      complete();
+  }
+
+  /**
+   * Merge the variance estimator of a chain with those of the other
+   * chains, blocking until all of them have arrived.
+   *
+   * @param[in] chain index of the chain
+   * @param[in] estimator estimator of the chain for the window
+   * @param[out] var pooled variance
+   * @param[out] n pooled number of draws
+   */
+  void pool_variance(std::size_t chain,
+                     stan::math::welford_var_estimator& estimator,
+                     Eigen::VectorXd& var, double& n) {
+    Eigen::VectorXd mean;
+    estimator.sample_mean(mean);
+    Eigen::VectorXd chain_var = Eigen::VectorXd::Zero(mean.size());
+    estimator.sample_variance(chain_var);
+    const double count = estimator.num_samples();
+    exchange(
+        chain,
+        [&] {
+          counts_[chain] = count;
+          means_[chain] = mean;
+          scatters_[chain] = std::max(count - 1.0, 0.0) * chain_var;
+        },
+        [this] { merge(true); },
+        [&] {
+          n = pooled_count_;
+          var = pooled_scatter_.col(0) / std::max(pooled_count_ - 1.0, 1.0);
+        });
+  }
+
+  /**
+   * Merge the covariance estimator of a chain with those of the other
+   * chains, blocking until all of them have arrived.
+   *
+   * @param[in] chain index of the chain
+   * @param[in] estimator estimator of the chain for the window
+   * @param[out] covar pooled covariance
+   * @param[out] n pooled number of draws
+   */
+  void pool_covariance(std::size_t chain,
+                       stan::math::welford_covar_estimator& estimator,
+                       Eigen::MatrixXd& covar, double& n) {
+    Eigen::VectorXd mean;
+    estimator.sample_mean(mean);
+    Eigen::MatrixXd chain_covar
+        = Eigen::MatrixXd::Zero(mean.size(), mean.size());
+    estimator.sample_covariance(chain_covar);
+    const double count = estimator.num_samples();
+    exchange(
+        chain,
+        [&] {
+          counts_[chain] = count;
+          means_[chain] = mean;
+          scatters_[chain] = std::max(count - 1.0, 0.0) * chain_covar;
+        },
+        [this] { merge(false); },
+        [&] {
+          n = pooled_count_;
+          covar = pooled_scatter_ / std::max(pooled_count_ - 1.0, 1.0);
+        });
+  }
+
+  /**
+   * Replace the adapted step size of a chain with the geometric mean of
+   * the adapted step sizes of all chains, blocking until all of them
+   * have arrived.
+   *
+   * @param[in] chain index of the chain
+   * @param[in,out] epsilon adapted step size
+   */
+  void pool_stepsize(std::size_t chain, double& epsilon) {
+    const double log_epsilon = std::log(epsilon);
+    exchange(
+        chain, [&] { stepsizes_[chain] = log_epsilon; },
+        [this] {
+          double sum = 0;
+          int count = 0;
+          for (std::size_t i = 0; i < arrived_.size(); ++i) {
+            if (arrived_[i]) {
+              sum += stepsizes_[i];
+              ++count;
+            }
+          }
+          pooled_stepsize_ = std::exp(sum / count);
+        },
+        [&] { epsilon = pooled_stepsize_; });
+  }
+
+ private:
+  bool pool_stepsize_;
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+  std::size_t num_active_;
+  std::size_t num_arrived_;
+  std::size_t generation_;
+  std::vector<bool> arrived_;
+  std::function<void()> combine_;
+
+  std::vector<double> counts_;
+  std::vector<Eigen::VectorXd> means_;
+  std::vector<Eigen::MatrixXd> scatters_;
+  std::vector<double> stepsizes_;
+
+  double pooled_count_;
+  Eigen::MatrixXd pooled_scatter_;
+  double pooled_stepsize_;
+
+  /**
+   * Post the contribution of a chain, wait for the other chains, and
+   * read the result.  The last chain to arrive combines the
+   * contributions.
+   */
+  template <typename Post, typename Combine, typename Read>
+  void exchange(std::size_t chain, const Post& post, const Combine& combine,
+                const Read& read) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    post();
+    arrived_[chain] = true;
+    ++num_arrived_;
+    if (num_arrived_ == 1)
+      combine_ = combine;
+    if (num_arrived_ == num_active_) {
+      complete();
+    } else {
+      const std::size_t generation = generation_;
+      ready_.wait(lock, [this, generation] {
+        return generation_ != generation;
+      });
+    }
+    read();
+  }
+
+  /**
+   * Combine the posted contributions and release the waiting chains.
+   * Must be called with the mutex held.
+   */
+  void complete() {
+    combine_();
+    for (std::size_t i = 0; i < arrived_.size(); ++i)
+      arrived_[i] = false;
+    num_arrived_ = 0;
+    ++generation_;
+    ready_.notify_all();
+  }
+
+  /**
+   * Merge the posted Welford estimators with the parallel update of
+   * Chan et al.  The scatter of each chain is a column of squared
+   * deviations if <code>diagonal</code> and a matrix otherwise.
+   */
+  void merge(bool diagonal) {
+    pooled_count_ = 0;
+    Eigen::VectorXd mean;
+    for (std::size_t i = 0; i < arrived_.size(); ++i) {
+      if (!arrived_[i])
+        continue;
+      if (pooled_count_ == 0)
+        pooled_scatter_ = Eigen::MatrixXd::Zero(scatters_[i].rows(),
+                                                scatters_[i].cols());
+      if (counts_[i] == 0)
+        continue;
+      if (pooled_count_ == 0) {
+        pooled_count_ = counts_[i];
+        mean = means_[i];
+        pooled_scatter_ = scatters_[i];
+        continue;
+      }
+      const double count = pooled_count_ + counts_[i];
+      const Eigen::VectorXd delta = means_[i] - mean;
+      const double weight = pooled_count_ * counts_[i] / count;
+      if (diagonal)
+        pooled_scatter_.col(0)
+            += scatters_[i].col(0) + weight * delta.cwiseAbs2();
+      else
+        pooled_scatter_ += scatters_[i] + weight * delta * delta.transpose();
+      mean += (counts_[i] / count) * delta;
+      pooled_count_ = count;
+    }
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <stan/mcmc/base_adaptation.hpp>
 #include <cmath>
+#include <cstddef>
+#include <vector>
 
 namespace stan {
 
@@ -11,7 +13,13 @@ namespace mcmc {
 class stepsize_adaptation : public base_adaptation {
  public:
   stepsize_adaptation()
-      : mu_(0.5), delta_(0.5), gamma_(0.05), kappa_(0.75), t0_(10) {
+      : mu_(0.5),
+        delta_(0.5),
+        gamma_(0.05),
+        kappa_(0.75),
+        t0_(10),
+        stability_tol_(0),
+        x_bar_history_(25) {
     restart();
   }
 
@@ -46,10 +54,36 @@ class stepsize_adaptation : public base_adaptation {
 
   double get_t0() const noexcept { return t0_; }
 
+  /**
+   * Set when the adapted step size is considered stable: the averaged
+   * step size must change by less than the relative tolerance over the
+   * last <code>window</code> iterations, which is checked after every
+   * iteration past the first window.  A tolerance of zero, the default,
+   * never considers it stable.
+   *
+   * @param tol relative tolerance on the change of the step size
+   * @param window number of iterations over which the change is taken
+   */
+  void set_stability_params(double tol, unsigned int window) {
+    stability_tol_ = tol;
+    if (window > 0)
+      x_bar_history_.assign(window, 0);
+  }
+
+  double get_stability_tol() const noexcept { return stability_tol_; }
+
+  /**
+   * Return true if the averaged step size changed by less than the
+   * stability tolerance over the last stability window.
+   */
+  bool stable() const noexcept { return stable_; }
+
   void restart() {
     counter_ = 0;
     s_bar_ = 0;
     x_bar_ = 0;
+    x_bar_history_.assign(x_bar_history_.size(), 0);
+    stable_ = false;
   }
 
   void learn_stepsize(double& epsilon, double adapt_stat) {
@@ -67,6 +101,16 @@ class stepsize_adaptation : public base_adaptation {
 
     x_bar_ = (1.0 - x_eta) * x_bar_ + x_eta * x;
 
+    if (stability_tol_ > 0) {
+      // The slot holds x_bar_ from one window ago
+      const std::size_t window = x_bar_history_.size();
+      double& x_bar_past
+          = x_bar_history_[static_cast<std::size_t>(counter_) % window];
+      stable_ = counter_ > window
+                && std::fabs(x_bar_ - x_bar_past) < std::log1p(stability_tol_);
+      x_bar_past = x_bar_;
+    }
+
     epsilon = std::exp(x);
   }
 
@@ -81,6 +125,10 @@ class stepsize_adaptation : public base_adaptation {
   double gamma_;    // Adaptation scaling
   double kappa_;    // Adaptation shrinkage
   double t0_;       // Effective starting iteration
+
+  double stability_tol_;               // Relative tolerance on the step size
+  std::vector<double> x_bar_history_;  // x_bar_ over the stability window
+  bool stable_;  // x_bar_ changed little over the last window
 };
 
 }  // namespace mcmc
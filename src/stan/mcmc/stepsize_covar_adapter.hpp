@@ -3,8 +3,10 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/mcmc/base_adapter.hpp>
+#include <stan/mcmc/pooled_adaptation.hpp>
 #include <stan/mcmc/stepsize_adaptation.hpp>
 #include <stan/mcmc/covar_adaptation.hpp>
+#include <cstddef>
 
 namespace stan {
 
@@ -12,7 +14,11 @@ namespace mcmc {
 
 class stepsize_covar_adapter : public base_adapter {
  public:
-  explicit stepsize_covar_adapter(int n) : covar_adaptation_(n) {}
+  explicit stepsize_covar_adapter(int n)
+      : covar_adaptation_(n),
+        pool_(nullptr),
+        chain_(0),
+        adaptive_warmup_(false) {}
 
   stepsize_adaptation& get_stepsize_adaptation() {
     return stepsize_adaptation_;
@@ -31,9 +37,68 @@ class stepsize_covar_adapter : public base_adapter {
                                         base_window, logger);
   }
 
+  /**
+   * End warmup early once the adaptation has converged.  The remaining
+   * slow windows are skipped once the relative change of the metric
+   * between two windows falls below <code>metric_tol</code>, and warmup
+   * ends during the terminal buffer once the adapted step size has
+   * changed by less than <code>stepsize_tol</code> over the last
+   * <code>stepsize_window</code> iterations, or at the end of the
+   * terminal buffer otherwise.
+   *
+   * @param metric_tol relative tolerance on the change of the metric,
+   * zero to keep every window
+   * @param stepsize_tol relative tolerance on the change of the step size,
+   * zero to run the whole terminal buffer
+   * @param stepsize_window number of iterations over which the change of
+   * the step size is taken
+   */
+  void set_adaptive_warmup(double metric_tol, double stepsize_tol,
+                           unsigned int stepsize_window = 25) {
+    adaptive_warmup_ = metric_tol > 0 || stepsize_tol > 0;
+    covar_adaptation_.set_convergence_tolerance(metric_tol);
+    stepsize_adaptation_.set_stability_params(stepsize_tol, stepsize_window);
+  }
+
+  bool adaptive_warmup() const { return adaptive_warmup_; }
+
+  bool adaptation_converged() const {
+    return adaptive_warmup_ && covar_adaptation_.windows_finished()
+           && (covar_adaptation_.schedule_finished()
+               || stepsize_adaptation_.stable());
+  }
+
+  /**
+   * Pool the metric adaptation, and the step size adaptation if the pool
+   * does so, with the other chains in the pool.
+   *
+   * @param pool pool shared by the chains, or null to stop pooling
+   * @param chain index of this chain in the pool
+   */
+  void set_adaptation_pool(pooled_adaptation* pool, std::size_t chain) {
+    pool_ = pool;
+    chain_ = chain;
+    covar_adaptation_.set_pool(pool, chain);
+  }
+
+  /**
+   * Finish the step size adaptation, pooling the adapted step size with
+   * the other chains if requested.
+   *
+   * @param[out] epsilon adapted step size
+   */
+  void complete_stepsize_adaptation(double& epsilon) {
+    stepsize_adaptation_.complete_adaptation(epsilon);
+    if (pool_ && pool_->pools_stepsize())
+      pool_->pool_stepsize(chain_, epsilon);
+  }
+
  protected:
   stepsize_adaptation stepsize_adaptation_;
   covar_adaptation covar_adaptation_;
+  pooled_adaptation* pool_;
+  std::size_t chain_;
+  bool adaptive_warmup_;
 };
 
 }  // namespace mcmc
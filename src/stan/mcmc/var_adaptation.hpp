@@ -2,7 +2,9 @@
 #define STAN_MCMC_VAR_ADAPTATION_HPP
 
 #include <stan/math/prim.hpp>
+#include <stan/mcmc/pooled_adaptation.hpp>
 #include <stan/mcmc/windowed_adaptation.hpp>
+#include <cstddef>
 #include <vector>
 
 namespace stan {
@@ -12,7 +14,22 @@ namespace mcmc {
 class var_adaptation : public windowed_adaptation {
  public:
   explicit var_adaptation(int n)
-      : windowed_adaptation("variance"), estimator_(n) {}
+      : windowed_adaptation("variance"),
+        estimator_(n),
+        pool_(nullptr),
+        chain_(0) {}
+
+  /**
+   * Pool the estimates at the end of each window with those of other
+   * chains, or stop pooling if the pool is null.
+   *
+   * @param pool pool shared by the chains
+   * @param chain index of this chain in the pool
+   */
+  void set_pool(pooled_adaptation* pool, std::size_t chain) {
+    pool_ = pool;
+    chain_ = chain;
+  }
 
   bool learn_variance(Eigen::VectorXd& var, const Eigen::VectorXd& q) {
     if (adaptation_window())
@@ -21,9 +38,14 @@ class var_adaptation : public windowed_adaptation {
     if (end_adaptation_window()) {
       compute_next_window();
 
-      estimator_.sample_variance(var);
-
-      double n = static_cast<double>(estimator_.num_samples());
+      const Eigen::VectorXd previous = var;
+      double n;
+      if (pool_) {
+        pool_->pool_variance(chain_, estimator_, var, n);
+      } else {
+        estimator_.sample_variance(var);
+        n = static_cast<double>(estimator_.num_samples());
+      }
       var = (n / (n + 5.0)) * var
             + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(var.size());
 
@@ -35,6 +57,8 @@ class var_adaptation : public windowed_adaptation {
             "function is too wide or improper. "
             "There may be problems with your model specification.");
 
+      update_convergence((var - previous).norm() / previous.norm());
+
       estimator_.restart();
 
       ++adapt_window_counter_;
@@ -47,6 +71,8 @@ class var_adaptation : public windowed_adaptation {
 
  protected:
   stan::math::welford_var_estimator estimator_;
+  pooled_adaptation* pool_;
+  std::size_t chain_;
 };
 
 }  // namespace mcmc
@@ -3,6 +3,7 @@
 
 #include <stan/callbacks/logger.hpp>
 #include <stan/mcmc/base_adaptation.hpp>
+#include <limits>
 #include <ostream>
 #include <string>
 
@@ -16,6 +17,7 @@ class windowed_adaptation : public base_adaptation {
     adapt_init_buffer_ = 0;
     adapt_term_buffer_ = 0;
     adapt_base_window_ = 0;
+    convergence_tol_ = 0;
 
     restart();
   }
@@ -24,6 +26,40 @@ class windowed_adaptation : public base_adaptation {
     adapt_window_counter_ = 0;
     adapt_window_size_ = adapt_base_window_;
     adapt_next_window_ = adapt_init_buffer_ + adapt_window_size_ - 1;
+    num_windows_ = 0;
+    metric_change_ = std::numeric_limits<double>::infinity();
+  }
+
+  /**
+   * Set the tolerance on the relative change of the metric between the
+   * estimates of two consecutive windows.  Once the change falls below
+   * it the remaining slow windows are skipped and adaptation moves on
+   * to the terminal buffer.  Zero, the default, keeps the full schedule.
+   *
+   * @param tol tolerance on the relative change of the metric
+   */
+  void set_convergence_tolerance(double tol) { convergence_tol_ = tol; }
+
+  /**
+   * Return the relative change of the metric between the estimates of
+   * the last two windows, or infinity before the second window ends.
+   */
+  double metric_change() const { return metric_change_; }
+
+  /**
+   * Return true once the slow windows are over, so that only the
+   * terminal buffer remains.
+   */
+  bool windows_finished() const {
+    return adapt_window_counter_ + adapt_term_buffer_ >= num_warmup_;
+  }
+
+  /**
+   * Return true once the schedule, including the terminal buffer, is
+   * over.
+   */
+  bool schedule_finished() const {
+    return num_warmup_ > 0 && adapt_window_counter_ >= num_warmup_;
   }
 
   void set_window_params(unsigned int num_warmup, unsigned int init_buffer,
@@ -112,6 +148,29 @@ class windowed_adaptation : public base_adaptation {
  protected:
   std::string estimator_name_;
 
+  /**
+   * Record the relative change of the metric estimated at the end of the
+   * current window and skip the remaining slow windows if it is below
+   * the tolerance.  The change from the initial metric to the first
+   * estimate is not used.
+   *
+   * @param relative_change relative change of the metric
+   */
+  void update_convergence(double relative_change) {
+    if (++num_windows_ < 2)
+      return;
+    metric_change_ = relative_change;
+    if (convergence_tol_ > 0 && relative_change < convergence_tol_
+        && adapt_window_counter_ + 1 + adapt_term_buffer_ < num_warmup_) {
+      num_warmup_ = adapt_window_counter_ + 1 + adapt_term_buffer_;
+      adapt_next_window_ = adapt_window_counter_;
+    }
+  }
+
+  double convergence_tol_;
+  unsigned int num_windows_;
+  double metric_change_;
+
   unsigned int num_warmup_;
   unsigned int adapt_init_buffer_;
   unsigned int adapt_term_buffer_;
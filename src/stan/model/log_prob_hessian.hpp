@@ -0,0 +1,136 @@
+#ifndef STAN_MODEL_LOG_PROB_HESSIAN_HPP
+#define STAN_MODEL_LOG_PROB_HESSIAN_HPP
+
+#include <stan/math/mix.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+
+namespace stan {
+namespace model {
+namespace internal {
+
+/**
+ * Functor for the log density of a model with the specified
+ * <code>propto</code> and Jacobian flags, for any autodiff type.
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+struct log_prob_functor {
+  const M& model;
+  std::ostream* msgs;
+
+  log_prob_functor(const M& m, std::ostream* out) : model(m), msgs(out) {}
+
+  template <typename T>
+  T operator()(const Eigen::Matrix<T, Eigen::Dynamic, 1>& x) const {
+    // log_prob() requires non-const but doesn't modify its argument
+    return model.template log_prob<propto, jacobian_adjust_transform, T>(
+        const_cast<Eigen::Matrix<T, Eigen::Dynamic, 1>&>(x), msgs);
+  }
+};
+
+}  // namespace internal
+
+/**
+ * Evaluate the log density of a model, its gradient, and its Hessian,
+ * with the columns of the Hessian computed in parallel.
+ *
+ * By default the Hessian is found by central finite differences of
+ * gradients, with the same step sizes as
+ * <code>stan::math::internal::finite_diff_hessian_auto</code>, at a cost
+ * of 2N gradient evaluations.  With <code>hessian_vector_product</code>
+ * each column is instead the exact product of the Hessian with a unit
+ * vector, computed with forward over reverse mode autodiff at the cost of
+ * N Hessian-vector products, which avoids truncation error.  Either way
+ * the result is symmetrized.
+ *
+ * Each column is evaluated on its own autodiff stack, so the work is
+ * split over TBB worker threads without interfering with the stack of
+ * the calling thread.  Messages printed by the model while evaluating
+ * the columns are written to <code>msgs</code> once each task is done.
+ *
+ * @tparam propto True if calculation is up to proportion
+ * (double-only terms dropped).
+ * @tparam jacobian_adjust_transform True if the log absolute
+ * Jacobian determinant of inverse parameter transforms is added to the
+ * log probability.
+ * @tparam M Class of model.
+ * @param[in] model Model.
+ * @param[in] params_r Real-valued parameter vector.
+ * @param[out] lp Log density at params_r.
+ * @param[out] gradient Gradient of the log density at params_r.
+ * @param[out] hessian Hessian of the log density at params_r.
+ * @param[in] hessian_vector_product True to compute the columns with
+ * Hessian-vector products instead of finite differences.
+ * @param[in, out] msgs Stream to which print statements in Stan
+ * programs are written, default is 0
+ * @param[in] grain_size Number of columns evaluated by each task.
+ */
+template <bool propto, bool jacobian_adjust_transform, class M>
+void log_prob_hessian(const M& model, const Eigen::VectorXd& params_r,
+                      double& lp, Eigen::VectorXd& gradient,
+                      Eigen::MatrixXd& hessian,
+                      bool hessian_vector_product = false,
+                      std::ostream* msgs = 0, size_t grain_size = 1) {
+  using functor_t
+      = internal::log_prob_functor<propto, jacobian_adjust_transform, M>;
+  const Eigen::Index d = params_r.size();
+  // Column i holds the difference of the gradients on either side of
+  // params_r along coordinate i, or the Hessian times the unit vector i
+  Eigen::MatrixXd columns(d, d);
+  Eigen::VectorXd epsilons(d);
+  std::mutex msgs_guard;
+  tbb::parallel_for(
+      tbb::blocked_range<Eigen::Index>(0, d, std::max<size_t>(grain_size, 1)),
+      [&](const tbb::blocked_range<Eigen::Index>& r) {
+        std::stringstream task_msgs;
+        functor_t f(model, msgs ? &task_msgs : nullptr);
+        stan::math::ScopedChainableStack stack;
+        stack.execute([&] {
+          Eigen::VectorXd x(params_r);
+          Eigen::VectorXd g_plus(d);
+          Eigen::VectorXd g_minus(d);
+          double fx;
+          for (Eigen::Index i = r.begin(); i < r.end(); ++i) {
+            if (hessian_vector_product) {
+              Eigen::VectorXd v = Eigen::VectorXd::Unit(d, i);
+              Eigen::VectorXd hv;
+              stan::math::hessian_times_vector(f, params_r, v, fx, hv);
+              columns.col(i) = hv;
+              continue;
+            }
+            epsilons(i) = stan::math::finite_diff_stepsize(params_r(i));
+            x(i) = params_r(i) + epsilons(i);
+            stan::math::gradient(f, x, fx, g_plus);
+            x(i) = params_r(i) - epsilons(i);
+            stan::math::gradient(f, x, fx, g_minus);
+            x(i) = params_r(i);
+            columns.col(i) = g_plus - g_minus;
+          }
+        });
+        if (msgs && task_msgs.rdbuf()->in_avail() > 0) {
+          std::lock_guard<std::mutex> guard(msgs_guard);
+          *msgs << task_msgs.str();
+        }
+      });
+
+  hessian.resize(d, d);
+  for (Eigen::Index i = 0; i < d; ++i) {
+    for (Eigen::Index j = i; j < d; ++j) {
+      if (hessian_vector_product)
+        hessian(j, i) = 0.5 * (columns(j, i) + columns(i, j));
+      else
+        hessian(j, i) = columns(i, j) / (4 * epsilons(j))
+                        + columns(j, i) / (4 * epsilons(i));
+      hessian(i, j) = hessian(j, i);
+    }
+  }
+  stan::math::gradient(functor_t(model, msgs), params_r, lp, gradient);
+}
+
+}  // namespace model
+}  // namespace stan
+#endif
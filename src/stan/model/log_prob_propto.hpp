@@ -72,7 +72,7 @@ double log_prob_propto(const M& model, std::vector<double>& params_r,
  * @param[in,out] msgs
  */
 template <bool jacobian_adjust_transform, class M>
-double log_prob_propto(const M& model, Eigen::VectorXd& params_r,
+double log_prob_propto(const M& model, const Eigen::VectorXd& params_r,
                        std::ostream* msgs = 0) {
   using stan::math::var;
   using std::vector;
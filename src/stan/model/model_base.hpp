@@ -335,6 +335,64 @@ class model_base : public prob_grad {
       return log_prob(params_r, msgs);
   }
 
+  /**
+   * Evaluate the log density and its gradient at a batch of
+   * unconstrained parameter vectors, one per column of the input.
+   *
+   * <p>This is the entry point used when several chains advance in
+   * lockstep and share one gradient evaluation per leapfrog step.
+   * The default implementation evaluates each column in turn with
+   * reverse-mode autodiff; models whose log density can be evaluated
+   * on many points at once, reusing data and vectorized likelihood
+   * code across them, may override it.
+   *
+   * <p>An exception thrown while evaluating any column, such as
+   * `std::domain_error` for a point that is rejected, is propagated
+   * and the outputs are left unspecified.  Callers needing the result
+   * of every other point then evaluate the columns one at a time.
+   *
+   * @param[in] params_r unconstrained parameters, one point per column
+   * @param[in] propto `true` if normalizing constants should be dropped
+   * @param[in] jacobian `true` if the log Jacobian adjustment is
+   * included
+   * @param[out] log_probs log density of each column
+   * @param[out] gradients gradient of the log density for each column
+   * @param[in,out] msgs stream to which messages are written
+   */
+  virtual void log_prob_grad_batch(const Eigen::MatrixXd& params_r,
+                                   bool propto, bool jacobian,
+                                   Eigen::VectorXd& log_probs,
+                                   Eigen::MatrixXd& gradients,
+                                   std::ostream* msgs = nullptr) const {
+    const Eigen::Index num_params = params_r.rows();
+    log_probs.resize(params_r.cols());
+    gradients.resize(num_params, params_r.cols());
+    Eigen::Matrix<math::var, -1, 1> ad_params_r(num_params);
+    for (Eigen::Index n = 0; n < params_r.cols(); ++n) {
+      try {
+        for (Eigen::Index i = 0; i < num_params; ++i)
+          ad_params_r.coeffRef(i) = params_r.coeff(i, n);
+        math::var lp;
+        if (propto && jacobian)
+          lp = log_prob_propto_jacobian(ad_params_r, msgs);
+        else if (propto && !jacobian)
+          lp = log_prob_propto(ad_params_r, msgs);
+        else if (!propto && jacobian)
+          lp = log_prob_jacobian(ad_params_r, msgs);
+        else  // if (!propto && !jacobian)
+          lp = log_prob(ad_params_r, msgs);
+        lp.grad();
+        log_probs.coeffRef(n) = lp.val();
+        for (Eigen::Index i = 0; i < num_params; ++i)
+          gradients.coeffRef(i, n) = ad_params_r.coeff(i).adj();
+      } catch (...) {
+        math::recover_memory();
+        throw;
+      }
+      math::recover_memory();
+    }
+  }
+
   /**
    * Read constrained parameter values from the specified context,
    * unconstrain them, then concatenate the unconstrained sequences
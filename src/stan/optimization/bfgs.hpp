@@ -243,8 +243,10 @@ class BFGSMinimizer {
       _qn.update(yk, sk);
       _alphak_1 = _alpha;
     }
-    // Compute search direction for next step
-    _qn.search_direction(_pk, _gk);
+    // Compute search direction for next step in place, reusing the
+    // storage of _pk
+    _pk = _gk;
+    _qn.search_direction(_pk);
 
     // Check for convergence
     if (std::fabs(_fk_1 - _fk) < _conv_opts.tolAbsF) {
@@ -303,12 +305,15 @@ class ModelAdaptor {
     using stan::model::log_prob_propto;
     typedef typename index_type<Matrix<double, Dynamic, 1> >::type idx_t;
 
-    _x.resize(x.size());
-    for (idx_t i = 0; i < x.size(); i++)
-      _x[i] = x[i];
-
     try {
-      f = -log_prob_propto<jacobian>(_model, _x, _params_i, _msgs);
+      if (_params_i.empty()) {
+        f = -log_prob_propto<jacobian>(_model, x, _msgs);
+      } else {
+        _x.resize(x.size());
+        for (idx_t i = 0; i < x.size(); i++)
+          _x[i] = x[i];
+        f = -log_prob_propto<jacobian>(_model, _x, _params_i, _msgs);
+      }
     } catch (const std::domain_error &e) {
       if (_msgs)
         (*_msgs) << e.what() << std::endl;
@@ -325,6 +330,12 @@ class ModelAdaptor {
       return 2;
     }
   }
+  /**
+   * Evaluate the negative log density and its gradient.  Without integer
+   * parameters the model is evaluated straight from <code>x</code> and
+   * the gradient is written into <code>g</code>, without copies through
+   * <code>std::vector</code>.
+   */
   int operator()(const Eigen::Matrix<double, Eigen::Dynamic, 1> &x, double &f,
                  Eigen::Matrix<double, Eigen::Dynamic, 1> &g) {
     using Eigen::Dynamic;
@@ -333,31 +344,33 @@ class ModelAdaptor {
     using stan::model::log_prob_grad;
     typedef typename index_type<Matrix<double, Dynamic, 1> >::type idx_t;
 
-    _x.resize(x.size());
-    for (idx_t i = 0; i < x.size(); i++)
-      _x[i] = x[i];
-
     _fevals++;
 
     try {
-      f = -log_prob_grad<true, jacobian>(_model, _x, _params_i, _g, _msgs);
+      if (_params_i.empty()) {
+        f = -log_prob_grad<true, jacobian>(_model, x, g, _msgs);
+      } else {
+        _x.resize(x.size());
+        for (idx_t i = 0; i < x.size(); i++)
+          _x[i] = x[i];
+        f = -log_prob_grad<true, jacobian>(_model, _x, _params_i, _g, _msgs);
+        g = Eigen::Map<const Matrix<double, Dynamic, 1> >(_g.data(),
+                                                          _g.size());
+      }
     } catch (const std::domain_error &e) {
       if (_msgs)
         (*_msgs) << e.what() << std::endl;
       return 1;
     }
 
-    g.resize(_g.size());
-    for (size_t i = 0; i < _g.size(); i++) {
-      if (!std::isfinite(_g[i])) {
-        if (_msgs)
-          *_msgs << "Error evaluating model log probability: "
-                    "Non-finite gradient."
-                 << std::endl;
-        return 3;
-      }
-      g[i] = -_g[i];
+    if (!g.allFinite()) {
+      if (_msgs)
+        *_msgs << "Error evaluating model log probability: "
+                  "Non-finite gradient."
+               << std::endl;
+      return 3;
     }
+    g = -g;
 
     if (std::isfinite(f)) {
       return 0;
@@ -55,8 +55,22 @@ class BFGSUpdate_HInv {
     pk.noalias() = -(_Hk * gk);
   }
 
+  /**
+   * Compute the search direction in place, overwriting the gradient.
+   *
+   * @param[in,out] pk On input the gradient direction, on output the
+   * negative product of the inverse Hessian and the gradient.
+   **/
+  inline void search_direction(VectorT &pk) const {
+    _work.noalias() = -(_Hk * pk);
+    pk.swap(_work);
+  }
+
  private:
   HessianT _Hk;
+  // Product with the inverse Hessian, kept between calls so that the
+  // in place search direction does not allocate
+  mutable VectorT _work;
 };
 }  // namespace optimization
 }  // namespace stan
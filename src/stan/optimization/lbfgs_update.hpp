@@ -71,40 +71,59 @@ class LBFGSUpdate {
    * @param[in] gk Gradient direction.
    **/
   inline void search_direction(VectorT &pk, const VectorT &gk) const {
-    std::vector<Scalar> alphas(_buf.size());
-    typename boost::circular_buffer<UpdateT>::const_reverse_iterator buf_rit;
-    typename boost::circular_buffer<UpdateT>::const_iterator buf_it;
-    typename std::vector<Scalar>::const_iterator alpha_it;
-    typename std::vector<Scalar>::reverse_iterator alpha_rit;
-
     pk.noalias() = -gk;
-    for (buf_rit = _buf.rbegin(), alpha_rit = alphas.rbegin();
-         buf_rit != _buf.rend(); buf_rit++, alpha_rit++) {
-      Scalar alpha;
+    apply_inverse_hessian(pk);
+  }
+
+  /**
+   * Compute the search direction in place, overwriting the gradient.
+   *
+   * @param[in,out] pk On input the gradient direction, on output the
+   * negative product of the inverse Hessian and the gradient.
+   **/
+  inline void search_direction(VectorT &pk) const {
+    pk = -pk;
+    apply_inverse_hessian(pk);
+  }
+
+ protected:
+  boost::circular_buffer<UpdateT> _buf;
+  Scalar _gammak;
+  // Scratch space for the two loop recursion, kept between calls so
+  // that computing a search direction does not allocate
+  mutable std::vector<Scalar> _alphas;
+
+  /**
+   * Multiply a vector in place by the inverse Hessian approximation
+   * with the two loop recursion.
+   *
+   * @param[in,out] qk Vector to multiply.
+   **/
+  inline void apply_inverse_hessian(VectorT &qk) const {
+    _alphas.resize(_buf.size());
+    typename std::vector<Scalar>::reverse_iterator alpha_rit
+        = _alphas.rbegin();
+    for (auto buf_rit = _buf.rbegin(); buf_rit != _buf.rend();
+         ++buf_rit, ++alpha_rit) {
       const Scalar &rhoi(std::get<0>(*buf_rit));
       const VectorT &yi(std::get<1>(*buf_rit));
       const VectorT &si(std::get<2>(*buf_rit));
 
-      alpha = rhoi * si.dot(pk);
-      pk -= alpha * yi;
-      *alpha_rit = alpha;
+      *alpha_rit = rhoi * si.dot(qk);
+      qk -= *alpha_rit * yi;
     }
-    pk *= _gammak;
-    for (buf_it = _buf.begin(), alpha_it = alphas.begin(); buf_it != _buf.end();
-         buf_it++, alpha_it++) {
-      Scalar beta;
+    qk *= _gammak;
+    typename std::vector<Scalar>::const_iterator alpha_it = _alphas.begin();
+    for (auto buf_it = _buf.begin(); buf_it != _buf.end();
+         ++buf_it, ++alpha_it) {
       const Scalar &rhoi(std::get<0>(*buf_it));
       const VectorT &yi(std::get<1>(*buf_it));
       const VectorT &si(std::get<2>(*buf_it));
 
-      beta = rhoi * yi.dot(pk);
-      pk += (*alpha_it - beta) * si;
+      const Scalar beta = rhoi * yi.dot(qk);
+      qk += (*alpha_it - beta) * si;
     }
   }
-
- protected:
-  boost::circular_buffer<UpdateT> _buf;
-  Scalar _gammak;
 };
 }  // namespace optimization
 }  // namespace stan
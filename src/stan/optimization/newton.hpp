@@ -1,8 +1,8 @@
 #ifndef STAN_OPTIMIZATION_NEWTON_HPP
 #define STAN_OPTIMIZATION_NEWTON_HPP
 
-#include <stan/model/grad_hess_log_prob.hpp>
 #include <stan/model/log_prob_grad.hpp>
+#include <stan/model/log_prob_hessian.hpp>
 #include <stan/math/prim/fun/Eigen.hpp>
 #include <vector>
 
@@ -26,22 +26,34 @@ inline void make_negative_definite_and_solve(matrix_d& H, vector_d& g) {
   g = eigenvectors * eigenprojections;
 }
 
+/**
+ * Take a Newton step from params_r, halving the step size until the log
+ * density does not decrease.  The Hessian is computed in parallel with
+ * <code>stan::model::log_prob_hessian</code>.
+ *
+ * @tparam M Class of model.
+ * @tparam jacobian `true` to include Jacobian adjustment (default `false`)
+ * @param[in] model Model.
+ * @param[in,out] params_r Real-valued parameters, updated to the new
+ * point if the step succeeds.
+ * @param[in] params_i Integer-valued parameters.
+ * @param[in,out] output_stream Stream for messages from the model.
+ * @param[in] hessian_vector_product True to compute the Hessian with
+ * Hessian-vector products instead of finite differences.
+ * @return Log density at the new point.
+ */
 template <typename M, bool jacobian = false>
 double newton_step(M& model, std::vector<double>& params_r,
                    std::vector<int>& params_i,
-                   std::ostream* output_stream = 0) {
+                   std::ostream* output_stream = 0,
+                   bool hessian_vector_product = false) {
   std::vector<double> gradient;
-  std::vector<double> hessian;
-
-  double f0 = stan::model::grad_hess_log_prob<true, jacobian>(
-      model, params_r, params_i, gradient, hessian);
-  matrix_d H(params_r.size(), params_r.size());
-  for (size_t i = 0; i < hessian.size(); i++) {
-    H(i) = hessian[i];
-  }
-  vector_d g(params_r.size());
-  for (size_t i = 0; i < gradient.size(); i++)
-    g(i) = gradient[i];
+  double f0;
+  vector_d g;
+  matrix_d H;
+  stan::model::log_prob_hessian<true, jacobian>(
+      model, Eigen::Map<const vector_d>(params_r.data(), params_r.size()), f0,
+      g, H, hessian_vector_product, output_stream);
   make_negative_definite_and_solve(H, g);
   //         H.ldlt().solveInPlace(g);
 
@@ -6,8 +6,15 @@
 #include <stan/callbacks/writer.hpp>
 #include <stan/callbacks/structured_writer.hpp>
 #include <stan/math/rev.hpp>
+#include <stan/model/log_prob_hessian.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/services/util/create_rng.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <algorithm>
+#include <limits>
+#include <sstream>
 #include <string>
 #include <type_traits>
 #include <vector>
@@ -16,10 +23,133 @@ namespace stan {
 namespace services {
 namespace internal {
 
+/**
+ * Generate draws from the Laplace approximation in blocks, writing them
+ * to the sample writer in order.
+ *
+ * The standard normal variates of a block are drawn as the columns of a
+ * matrix and mapped to the approximation with a single triangular solve
+ * against the transposed Cholesky factor of the negative Hessian, so the
+ * factor is never inverted.  Blocks are processed in parallel, each with
+ * its own random number generator created from the seed and the block
+ * index, which it also passes to <code>write_array</code>, so the draws
+ * do not depend on how the blocks are scheduled.  As the approximation
+ * is normal, the log density of a draw is minus half the squared norm of
+ * its standard normal variates.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode
+ * @param[in] L_neg_hessian lower Cholesky factor of the negative Hessian
+ * at the mode
+ * @param[in] draws number of draws to generate
+ * @param[in] block_size number of draws in each block
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] random_seed seed for generating random numbers
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] interrupt callback called between rounds of blocks
+ * @param[in,out] logger callback for console messages
+ * @param[in,out] sample_writer callback for the draws
+ */
+template <bool jacobian, typename Model>
+void laplace_draws_blocked(const Model& model, const Eigen::VectorXd& theta_hat,
+                           const Eigen::MatrixXd& L_neg_hessian, int draws,
+                           int block_size, bool calculate_lp,
+                           unsigned int random_seed, int refresh,
+                           callbacks::interrupt& interrupt,
+                           callbacks::logger& logger,
+                           callbacks::writer& sample_writer) {
+  const Eigen::Index num_unc_params = theta_hat.size();
+  std::vector<std::string> param_tp_gq_names;
+  model.constrained_param_names(param_tp_gq_names, true, true);
+  const Eigen::Index draw_size = param_tp_gq_names.size();
+  const int num_blocks = (draws + block_size - 1) / block_size;
+  // Enough blocks are kept in memory at once to occupy every thread
+  const int round_size = std::max(1, tbb::this_task_arena::max_concurrency());
+  std::vector<Eigen::MatrixXd> values(round_size);
+  std::vector<std::stringstream> block_msgs(round_size);
+  std::vector<double> draw(2 + draw_size);
+  std::stringstream refresh_msg;
+  for (int first = 0; first < num_blocks; first += round_size) {
+    interrupt();
+    const int last = std::min(num_blocks, first + round_size);
+    tbb::parallel_for(
+        tbb::blocked_range<int>(first, last, 1),
+        [&](const tbb::blocked_range<int>& r) {
+          for (int b = r.begin(); b < r.end(); ++b) {
+            const int size = std::min(block_size, draws - b * block_size);
+            stan::rng_t rng = util::create_rng(random_seed, b + 1);
+            Eigen::MatrixXd z(num_unc_params, size);
+            for (int m = 0; m < size; ++m) {
+              for (Eigen::Index n = 0; n < num_unc_params; ++n) {
+                z(n, m) = math::std_normal_rng(rng);
+              }
+            }
+            Eigen::MatrixXd unc_draws
+                = L_neg_hessian.transpose()
+                      .template triangularView<Eigen::Upper>()
+                      .solve(z);
+            unc_draws.colwise() += theta_hat;
+
+            Eigen::MatrixXd& out = values[b - first];
+            std::stringstream& msgs = block_msgs[b - first];
+            out.resize(size, 2 + draw_size);
+            Eigen::VectorXd unc_draw;
+            Eigen::VectorXd draw_vec;
+            math::ScopedChainableStack stack;
+            for (int m = 0; m < size; ++m) {
+              unc_draw = unc_draws.col(m);
+              model.write_array(rng, unc_draw, draw_vec, true, true, &msgs);
+              double log_p = std::numeric_limits<double>::quiet_NaN();
+              if (calculate_lp) {
+                stack.execute([&] {
+                  math::nested_rev_autodiff nested;
+                  Eigen::Matrix<math::var, -1, 1> theta
+                      = unc_draw.cast<math::var>();
+                  log_p = model
+                              .template log_prob<true, jacobian, math::var>(
+                                  theta, &msgs)
+                              .val();
+                });
+              }
+              out(m, 0) = log_p;
+              out(m, 1) = -0.5 * z.col(m).squaredNorm();
+              out.row(m).tail(draw_size)
+                  = draw_vec.head(draw_size).transpose();
+            }
+          }
+        });
+
+    for (int b = first; b < last; ++b) {
+      std::stringstream& msgs = block_msgs[b - first];
+      if (refresh > 0 && msgs.peek() != std::char_traits<char>::eof())
+        logger.info(msgs);
+      msgs.str(std::string());
+      msgs.clear();
+      const Eigen::MatrixXd& out = values[b - first];
+      for (Eigen::Index m = 0; m < out.rows(); ++m) {
+        const Eigen::Index iteration = b * block_size + m;
+        if (refresh > 0 && iteration % refresh == 0) {
+          refresh_msg << "iteration: " << std::to_string(iteration);
+          logger.info(refresh_msg);
+          refresh_msg.str(std::string());
+        }
+        Eigen::Map<Eigen::RowVectorXd>(draw.data(), draw.size()) = out.row(m);
+        sample_writer(draw);
+      }
+    }
+  }
+}
+
 template <bool jacobian, typename Model>
 void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
                     int draws, bool calculate_lp, unsigned int random_seed,
-                    int refresh, callbacks::interrupt& interrupt,
+                    int refresh, int block_size,
+                    callbacks::interrupt& interrupt,
                     callbacks::logger& logger, callbacks::writer& sample_writer,
                     callbacks::structured_writer& hessian_writer) {
   if (draws <= 0) {
@@ -69,8 +199,8 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
   Eigen::VectorXd grad;  // dummy
   Eigen::MatrixXd hessian;
   interrupt();
-  math::internal::finite_diff_hessian_auto(log_density_fun, theta_hat, log_p,
-                                           grad, hessian);
+  stan::model::log_prob_hessian<true, jacobian>(
+      model, theta_hat, log_p, grad, hessian, false, &log_density_msgs);
   if (refresh > 0 && log_density_msgs.peek() != std::char_traits<char>::eof())
     logger.info(log_density_msgs);
 
@@ -81,6 +211,21 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
   hessian_writer.write("Hessian", hessian);
   hessian_writer.end_record();
 
+  if (block_size > 0) {
+    interrupt();
+    if (refresh > 0) {
+      logger.info("Calculating Cholesky factor");
+    }
+    Eigen::MatrixXd L_neg_hessian = (-hessian).llt().matrixL();
+    if (refresh > 0) {
+      logger.info("Generating draws");
+    }
+    laplace_draws_blocked<jacobian>(model, theta_hat, L_neg_hessian, draws,
+                                    block_size, calculate_lp, random_seed,
+                                    refresh, interrupt, logger, sample_writer);
+    return;
+  }
+
   // calculate Cholesky factor and inverse
   interrupt();
   if (refresh > 0) {
@@ -134,6 +279,60 @@ void laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
 }  // namespace internal
 }  // namespace internal
 
+/**
+ * Take the specified number of draws from the Laplace approximation
+ * for the model at the specified unconstrained mode, generating the
+ * draws in blocks of the specified size which are processed in
+ * parallel, and writing the draws, unnormalized log density, and
+ * unnormalized density of the approximation to the sample writer in
+ * order.  A block size of 0 generates the draws one at a time, as the
+ * overloads without a block size do.
+ *
+ * Blocked draws use a separate random number generator for each block,
+ * so they differ from the draws generated one at a time with the same
+ * seed, but do not depend on the number of threads.
+ *
+ * @tparam jacobian `true` to include Jacobian adjustment for
+ * constrained parameters
+ * @tparam Model a Stan model
+ * @param[in] model model from which to sample
+ * @param[in] theta_hat unconstrained mode at which to center the
+ * Laplace approximation
+ * @param[in] draws number of draws to generate
+ * @param[in] calculate_lp whether to calculate the log probability of the
+ * approximate draws
+ * @param[in] random_seed seed for generating random numbers in the
+ * Stan program and in sampling
+ * @param[in] refresh period between iterations at which updates are
+ * given, with a value of 0 turning off all messages
+ * @param[in] block_size number of draws generated together
+ * @param[in] interrupt callback for interrupting sampling
+ * @param[in,out] logger callback for writing console messages from
+ * sampler and from Stan programs
+ * @param[in,out] sample_writer callback for writing parameter names
+ * and then draws
+ * @param[in,out] hessian_writer callback for writing the log probability,
+ * gradient, and Hessian at the mode for diagnostic purposes
+ * @return a return code, with 0 indicating success
+ */
+template <bool jacobian, typename Model>
+int laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
+                   int draws, bool calculate_lp, unsigned int random_seed,
+                   int refresh, int block_size,
+                   callbacks::interrupt& interrupt, callbacks::logger& logger,
+                   callbacks::writer& sample_writer,
+                   callbacks::structured_writer& hessian_writer) {
+  try {
+    internal::laplace_sample<jacobian>(
+        model, theta_hat, draws, calculate_lp, random_seed, refresh,
+        block_size, interrupt, logger, sample_writer, hessian_writer);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  return error_codes::OK;
+}
+
 /**
  * Take the specified number of draws from the Laplace approximation
  * for the model at the specified unconstrained mode, writing the
@@ -175,15 +374,9 @@ int laplace_sample(const Model& model, const Eigen::VectorXd& theta_hat,
                    int refresh, callbacks::interrupt& interrupt,
                    callbacks::logger& logger, callbacks::writer& sample_writer,
                    callbacks::structured_writer& hessian_writer) {
-  try {
-    internal::laplace_sample<jacobian>(model, theta_hat, draws, calculate_lp,
-                                       random_seed, refresh, interrupt, logger,
-                                       sample_writer, hessian_writer);
-  } catch (const std::exception& e) {
-    logger.error(e.what());
-    return error_codes::CONFIG;
-  }
-  return error_codes::OK;
+  return laplace_sample<jacobian>(model, theta_hat, draws, calculate_lp,
+                                  random_seed, refresh, 0, interrupt, logger,
+                                  sample_writer, hessian_writer);
 }
 
 /**
@@ -0,0 +1,190 @@
+#ifndef STAN_SERVICES_OPTIMIZE_LBFGS_MULTI_HPP
+#define STAN_SERVICES_OPTIMIZE_LBFGS_MULTI_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/io/var_context.hpp>
+#include <stan/services/error_codes.hpp>
+#include <stan/services/optimize/lbfgs.hpp>
+#include <stan/services/util/duration_diff.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <chrono>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace optimize {
+namespace internal {
+
+/**
+ * Writer which forwards everything to another writer and keeps the last
+ * row of values, which <code>lbfgs</code> writes for the final mode.
+ */
+class last_values_writer : public callbacks::writer {
+ public:
+  explicit last_values_writer(callbacks::writer& writer) : writer_(writer) {}
+
+  void operator()(const std::vector<std::string>& names) { writer_(names); }
+
+  void operator()(const std::vector<double>& state) {
+    last_values_ = state;
+    writer_(state);
+  }
+
+  void operator()() { writer_(); }
+
+  void operator()(const std::string& message) { writer_(message); }
+
+  void operator()(const Eigen::Ref<Eigen::Matrix<double, -1, -1>>& values) {
+    writer_(values);
+  }
+
+  const std::vector<double>& last_values() const { return last_values_; }
+
+ private:
+  callbacks::writer& writer_;
+  std::vector<double> last_values_;
+};
+
+}  // namespace internal
+
+/**
+ * Runs the L-BFGS algorithm from several initializations of a model in
+ * parallel and reports the mode with the highest log density.
+ *
+ * Each path runs <code>lbfgs</code> on the same model instance with its
+ * own random number generator, created from <code>random_seed</code>
+ * and <code>init_chain_id + path</code>, and writes its iterations to
+ * its own writer.  Once every path has finished, the log density and
+ * return code of each path are logged and the mode with the highest log
+ * density among the paths which terminated normally is written to
+ * <code>parameter_writer</code>.
+ *
+ * @tparam Model A model implementation
+ * @tparam jacobian `true` to include Jacobian adjustment (default `false`)
+ * @tparam InitContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitWriter A type derived from `stan::callbacks::writer`
+ * @tparam SingleParamWriter A type derived from `stan::callbacks::writer`
+ * @param[in] model Input model to test (with data already instantiated)
+ * @param[in] init A std vector of var contexts for initialization of each
+ * path
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id id of the first path. The pseudo random number
+ * generator of each path is advanced by an integer sequence from
+ * `init_chain_id` to `init_chain_id + num_paths - 1`
+ * @param[in] init_radius radius to initialize
+ * @param[in] history_size amount of history to keep for L-BFGS
+ * @param[in] init_alpha line search step size for first iteration
+ * @param[in] tol_obj convergence tolerance on absolute changes in
+ *   objective function value
+ * @param[in] tol_rel_obj convergence tolerance on relative changes
+ *   in objective function value
+ * @param[in] tol_grad convergence tolerance on the norm of the gradient
+ * @param[in] tol_rel_grad convergence tolerance on the relative norm of
+ *   the gradient
+ * @param[in] tol_param convergence tolerance on changes in parameter
+ *   value
+ * @param[in] num_iterations maximum number of iterations
+ * @param[in] save_iterations indicates whether all the iterations should
+ *   be saved to the writer of each path
+ * @param[in] refresh how often to write output to logger
+ * @param[in] num_paths The number of L-BFGS paths to run. `init`,
+ * `init_writers` and `single_path_parameter_writer` must be at least this
+ * long.
+ * @param[in,out] interrupt callback to be called every iteration
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writers std vector of Writer callbacks for
+ * unconstrained inits of each path
+ * @param[in,out] single_path_parameter_writer std vector of Writers for the
+ * parameter values of each path
+ * @param[in,out] parameter_writer output for the best mode
+ * @return error_codes::OK if at least one path terminated normally, and
+ * otherwise the return code of the first path
+ */
+template <class Model, bool jacobian = false, typename InitContextPtr,
+          typename InitWriter, typename SingleParamWriter>
+int lbfgs_multi(Model& model, const std::vector<InitContextPtr>& init,
+                unsigned int random_seed, unsigned int init_chain_id,
+                double init_radius, int history_size, double init_alpha,
+                double tol_obj, double tol_rel_obj, double tol_grad,
+                double tol_rel_grad, double tol_param, int num_iterations,
+                bool save_iterations, int refresh, int num_paths,
+                callbacks::interrupt& interrupt, callbacks::logger& logger,
+                std::vector<InitWriter>& init_writers,
+                std::vector<SingleParamWriter>& single_path_parameter_writer,
+                callbacks::writer& parameter_writer) {
+  const auto start_time = std::chrono::steady_clock::now();
+  std::vector<int> return_codes(num_paths, error_codes::SOFTWARE);
+  std::vector<std::vector<double>> modes(num_paths);
+  try {
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, num_paths, 1),
+        [&](const tbb::blocked_range<int>& r) {
+          for (int path = r.begin(); path < r.end(); ++path) {
+            internal::last_values_writer path_writer(
+                single_path_parameter_writer[path]);
+            return_codes[path] = lbfgs<Model, jacobian>(
+                model, *init[path], random_seed, init_chain_id + path,
+                init_radius, history_size, init_alpha, tol_obj, tol_rel_obj,
+                tol_grad, tol_rel_grad, tol_param, num_iterations,
+                save_iterations, refresh, interrupt, logger,
+                init_writers[path], path_writer);
+            modes[path] = path_writer.last_values();
+          }
+        },
+        tbb::simple_partitioner());
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+
+  int best_path = -1;
+  double best_lp = -std::numeric_limits<double>::infinity();
+  for (int path = 0; path < num_paths; ++path) {
+    std::stringstream msg;
+    msg << "Path " << init_chain_id + path << ": ";
+    if (return_codes[path] != error_codes::OK || modes[path].empty()) {
+      msg << "failed";
+      logger.info(msg);
+      continue;
+    }
+    const double lp = modes[path][0];
+    msg << "log joint probability = " << lp;
+    logger.info(msg);
+    if (best_path < 0 || lp > best_lp) {
+      best_path = path;
+      best_lp = lp;
+    }
+  }
+  if (best_path < 0) {
+    logger.error("No L-BFGS path terminated normally");
+    return num_paths > 0 ? return_codes[0] : error_codes::SOFTWARE;
+  }
+
+  std::vector<std::string> names;
+  names.push_back("lp__");
+  model.constrained_param_names(names, true, true);
+  parameter_writer(names);
+  parameter_writer(modes[best_path]);
+  const double delta_time = util::duration_diff(
+      start_time, std::chrono::steady_clock::now());
+  parameter_writer();
+  parameter_writer("Best mode found by path "
+                   + std::to_string(init_chain_id + best_path) + " of "
+                   + std::to_string(num_paths));
+  parameter_writer("Elapsed Time: " + std::to_string(delta_time)
+                   + " seconds (Total)");
+  parameter_writer();
+  return error_codes::OK;
+}
+
+}  // namespace optimize
+}  // namespace services
+}  // namespace stan
+#endif
@@ -15,12 +15,53 @@
 #include <stan/services/util/initialize.hpp>
 #include <tbb/parallel_for.h>
 #include <boost/random/discrete_distribution.hpp>
+#include <algorithm>
 #include <string>
 #include <vector>
 
 namespace stan {
 namespace services {
 namespace pathfinder {
+namespace internal {
+
+/**
+ * Write draws picked from the draws of all paths in batches, without
+ * concatenating the draws of the paths.
+ * @tparam Blocks A std vector of Eigen types with parameters in the rows and
+ * draws in the columns
+ * @tparam ParamWriter Type inheriting from `stan::callbacks::writer`
+ * @param blocks The draws of each path
+ * @param draw_idx Indices of the draws to write, counting the draws of all
+ * paths in order
+ * @param[in,out] parameter_writer Writer for the picked draws
+ * @param batch_size The most draws given to the writer at once
+ */
+template <typename Blocks, typename ParamWriter>
+inline void write_draws_batched(const Blocks& blocks,
+                                const std::vector<Eigen::Index>& draw_idx,
+                                ParamWriter& parameter_writer,
+                                Eigen::Index batch_size = 256) {
+  // Index of the first draw of each path, followed by the number of draws
+  std::vector<Eigen::Index> block_start(blocks.size() + 1, 0);
+  for (std::size_t i = 0; i < blocks.size(); ++i) {
+    block_start[i + 1] = block_start[i] + blocks[i].cols();
+  }
+  const Eigen::Index num_draws = draw_idx.size();
+  Eigen::MatrixXd batch(blocks[0].rows(), std::min(batch_size, num_draws));
+  for (Eigen::Index start = 0; start < num_draws; start += batch_size) {
+    const Eigen::Index batch_draws = std::min(batch_size, num_draws - start);
+    for (Eigen::Index j = 0; j < batch_draws; ++j) {
+      const Eigen::Index idx = draw_idx[start + j];
+      const std::size_t block
+          = std::upper_bound(block_start.begin(), block_start.end(), idx)
+            - block_start.begin() - 1;
+      batch.col(j) = blocks[block].col(idx - block_start[block]).matrix();
+    }
+    parameter_writer(batch.leftCols(batch_draws));
+  }
+}
+
+}  // namespace internal
 
 /**
  * Runs multiple pathfinders with final approximate samples drawn using PSIS.
@@ -87,6 +128,12 @@ namespace pathfinder {
  *  samples are written to `parameter_writer`. If `false`, no psis resampling is
  * performed and (`num_paths` * `num_draws`) samples are written to
  * `parameter_writer`.
+ * @param[in] grain_size Number of approximate draws whose log density is
+ * evaluated by each parallel task within a path.
+ * @param[in] elbo_stride Positive number of LBFGS iterations between the ELBO
+ * estimates of each path
+ * @param[in] elbo_patience If positive, each path stops LBFGS once this many
+ * ELBO estimates in a row have not improved on its best ELBO.
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContext, typename InitWriter,
@@ -103,7 +150,8 @@ inline int pathfinder_lbfgs_multi(
     std::vector<SingleParamWriter>& single_path_parameter_writer,
     std::vector<SingleDiagnosticWriter>& single_path_diagnostic_writer,
     ParamWriter& parameter_writer, DiagnosticWriter& diagnostic_writer,
-    bool calculate_lp = true, bool psis_resample = true) {
+    bool calculate_lp = true, bool psis_resample = true,
+    std::size_t grain_size = 1, int elbo_stride = 1, int elbo_patience = 0) {
   const auto start_pathfinders_time = std::chrono::steady_clock::now();
   std::vector<std::string> param_names;
   param_names.push_back("lp_approx__");
@@ -129,7 +177,8 @@ inline int pathfinder_lbfgs_multi(
                     num_elbo_draws, num_draws, save_iterations, refresh,
                     interrupt, logger, init_writers[iter],
                     single_path_parameter_writer[iter],
-                    single_path_diagnostic_writer[iter], calculate_lp);
+                    single_path_diagnostic_writer[iter], calculate_lp,
+                    grain_size, elbo_stride, elbo_patience);
             if (unlikely(std::get<0>(pathfinder_ret) != error_codes::OK)) {
               logger.error(std::string("Pathfinder iteration: ")
                            + std::to_string(iter) + " failed.");
@@ -174,20 +223,10 @@ inline int pathfinder_lbfgs_multi(
   for (auto&& ilpr : individual_lp_ratios) {
     num_returned_samples += ilpr.size();
   }
-  // Rows are individual parameters and columns are samples per iteration
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> samples(
-      individual_samples[0].rows(), num_returned_samples);
-  Eigen::Index filling_start_row = 0;
-  for (size_t i = 0; i < successful_pathfinders; ++i) {
-    const Eigen::Index individ_num_samples = individual_samples[i].cols();
-    samples.middleCols(filling_start_row, individ_num_samples)
-        = individual_samples[i].matrix();
-    filling_start_row += individ_num_samples;
-  }
   double psis_delta_time = 0;
   if (psis_resample && calculate_lp) {
     Eigen::Array<double, Eigen::Dynamic, 1> lp_ratios(num_returned_samples);
-    filling_start_row = 0;
+    Eigen::Index filling_start_row = 0;
     for (size_t i = 0; i < successful_pathfinders; ++i) {
       const Eigen::Index individ_num_samples = individual_lp_ratios[i].size();
       lp_ratios.segment(filling_start_row, individ_num_samples)
@@ -207,15 +246,22 @@ inline int pathfinder_lbfgs_multi(
                      boost::iterator_range<double*>(
                          weight_vals.data(),
                          weight_vals.data() + weight_vals.size())));
-    for (size_t i = 0; i <= num_multi_draws - 1; ++i) {
-      parameter_writer(samples.col(rand_psis_idx()));
+    // The draws are picked before any are written and then copied out of
+    // the draws of their path a batch at a time
+    std::vector<Eigen::Index> psis_idx(num_multi_draws);
+    for (auto&& idx : psis_idx) {
+      idx = rand_psis_idx();
     }
+    internal::write_draws_batched(individual_samples, psis_idx,
+                                  parameter_writer);
     const auto end_psis_time = std::chrono::steady_clock::now();
     psis_delta_time
         = stan::services::util::duration_diff(start_psis_time, end_psis_time);
 
   } else {
-    parameter_writer(samples);
+    for (auto&& path_samples : individual_samples) {
+      parameter_writer(path_samples.matrix());
+    }
   }
   parameter_writer();
   const auto time_header = std::string("Elapsed Time: ");
@@ -5,8 +5,11 @@
 #include <stan/callbacks/logger.hpp>
 #include <stan/services/error_codes.hpp>
 #include <tbb/parallel_invoke.h>
+#include <algorithm>
 #include <iomanip>
+#include <numeric>
 #include <sstream>
+#include <vector>
 
 namespace stan {
 namespace services {
@@ -142,80 +145,37 @@ inline auto psis_smooth_tail(const EigArray& x, const double cutoff) {
   }
 }
 
-/**
- * Sort the input arr and store the original indices for the sorted array in
- * `idx`
- * @param[in, out] arr The Array of doubles to be sorted
- * @param[in, out] idx The index of the original positions of the elements of
- * `arr`. This is also sorted to keep track of the original positions of the
- * elements in `arr`.
- * @return None. arr and idx are modified in place.
- */
-inline void dual_sort(Eigen::Array<double, Eigen::Dynamic, 1>& arr,
-                      Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>& idx) {
-  std::vector<std::pair<double, int>> pair_vec;
-  pair_vec.reserve(arr.size());
-  for (std::size_t i = 0; i < arr.size(); ++i) {
-    pair_vec.emplace_back(arr[i], idx[i]);
-  }
-  std::sort(pair_vec.begin(), pair_vec.end(),
-            [](auto&& a, auto&& b) { return a.first < b.first; });
-  for (std::size_t i = 0; i < arr.size(); ++i) {
-    arr[i] = pair_vec[i].first;
-    idx[i] = pair_vec[i].second;
-  }
-  return;
-}
-
-/**
- * Returns the index to the first element in the range [first, last) that does
- * not satisfy element < value or last if no such element is found.
- * @param arr The index (range) to search
- * @param value The value to search for
- * @return The index to the first element in the range [first, last) that does
- * not satisfy element < value or last if no such element is found
- */
-inline auto lower_bound_idx(const Eigen::Array<double, Eigen::Dynamic, 1>& arr,
-                            const double value) {
-  Eigen::Index base = 0;
-  Eigen::Index search_len = arr.size();
-  while (search_len > 1) {
-    Eigen::Index half = search_len / 2;
-    // some compilers will replace this with  with a cmov
-    base += (arr.coeff(base + half) < value) * half;
-    search_len -= half;
-  }
-  return base;
-}
-
 /**
  * Get the largest N elements of an array.
+ *
+ * The positions of the largest N elements are partitioned out with
+ * `std::nth_element` and only those are sorted, so the cost is linear in the
+ * size of `arr` plus N log N for the tail. Ties are broken by position so the
+ * result does not depend on the standard library.
  * @param arr The normalized log ratios to sort
  * @param top_size The length of the tail that is needs to be sorted.
- * @return A pair with the largest N elements in `first` and the original index
- * of the largest N elements in `second`
+ * @return A pair with the largest N elements in ascending order in `first`
+ * and the original index of the largest N elements in `second`
  */
 inline std::pair<Eigen::Array<double, Eigen::Dynamic, 1>,
                  Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>>
 largest_n_elements(const Eigen::Array<double, Eigen::Dynamic, 1>& arr,
                    const Eigen::Index top_size) {
-  Eigen::Array<double, Eigen::Dynamic, 1> top_n = arr.head(top_size);
-  Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> top_n_idx
-      = Eigen::Array<Eigen::Index, Eigen::Dynamic, 1>::LinSpaced(top_size, 0,
-                                                                 top_size);
-  dual_sort(top_n, top_n_idx);
-  for (Eigen::Index i = top_size; i < arr.size(); ++i) {
-    if (arr.coeff(i) >= top_n.coeff(0)) {
-      const Eigen::Index starting_pos = lower_bound_idx(top_n, arr.coeff(i));
-      for (Eigen::Index k = 1; k <= starting_pos; ++k) {
-        top_n.coeffRef(k - 1) = top_n.coeff(k);
-      }
-      top_n.coeffRef(starting_pos) = arr.coeff(i);
-      for (Eigen::Index k = 1; k <= starting_pos; ++k) {
-        top_n_idx.coeffRef(k - 1) = top_n_idx.coeff(k);
-      }
-      top_n_idx.coeffRef(starting_pos) = i;
-    }
+  const Eigen::Index arr_size = arr.size();
+  std::vector<Eigen::Index> order(arr_size);
+  std::iota(order.begin(), order.end(), 0);
+  const auto less = [&arr](Eigen::Index a, Eigen::Index b) {
+    return arr.coeff(a) < arr.coeff(b)
+           || (arr.coeff(a) == arr.coeff(b) && a < b);
+  };
+  const auto tail_begin = order.begin() + (arr_size - top_size);
+  std::nth_element(order.begin(), tail_begin, order.end(), less);
+  std::sort(tail_begin, order.end(), less);
+  Eigen::Array<double, Eigen::Dynamic, 1> top_n(top_size);
+  Eigen::Array<Eigen::Index, Eigen::Dynamic, 1> top_n_idx(top_size);
+  for (Eigen::Index i = 0; i < top_size; ++i) {
+    top_n_idx.coeffRef(i) = tail_begin[i];
+    top_n.coeffRef(i) = arr.coeff(tail_begin[i]);
   }
   return {std::move(top_n), std::move(top_n_idx)};
 }
@@ -12,9 +12,11 @@
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/duration_diff.hpp>
 #include <boost/circular_buffer.hpp>
+#include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <tbb/concurrent_queue.h>
 #include <tbb/task_group.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 #include <atomic>
@@ -210,6 +212,9 @@ generate_matrix(Generator&& variate_generator, const Eigen::Index num_params,
  * @param logger A callback writer for messages
  * @param calculate_lp If true, calculate the log probability of the samples.
  * Else set to `NaN` for each sample.
+ * @param grain_size Number of samples whose log probability is calculated by
+ * each task. The samples are drawn before any are evaluated, so the result
+ * does not depend on how the evaluations are split between threads.
  * @return A struct with the ELBO estimate along with the samples and log
  * probability ratios.
  */
@@ -220,7 +225,8 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
                                    const taylor_approx_t& taylor_approx,
                                    size_t num_samples, const EigVec& alpha,
                                    const std::string& iter_msg, Logger&& logger,
-                                   bool calculate_lp = true) {
+                                   bool calculate_lp = true,
+                                   size_t grain_size = 1) {
   boost::variate_generator<stan::rng_t&, boost::normal_distribution<>>
       rand_unit_gaus(rng, boost::normal_distribution<>());
   const auto num_params = taylor_approx.x_center.size();
@@ -234,26 +240,34 @@ inline elbo_est_t est_approx_draws(LPF&& lp_fun, ConstrainF&& constrain_fun,
                            + num_params * stan::math::LOG_TWO_PI);
   Eigen::MatrixXd approx_samples
       = approximate_samples(std::move(unit_samps), taylor_approx);
-  const auto log_stream
-      = [](auto& logger, auto& pathfinder_ss, const auto& iter_msg) {
-          if (pathfinder_ss.str().length() == 0)
-            return;
-          logger.info(iter_msg + pathfinder_ss.str());
-          pathfinder_ss.str(std::string());
-        };
-  Eigen::VectorXd approx_samples_col;
-  std::stringstream pathfinder_ss;
   Eigen::Array<double, Eigen::Dynamic, 1> lp_ratio;
   if (calculate_lp) {
-    for (Eigen::Index i = 0; i < num_samples; ++i) {
-      try {
-        approx_samples_col = approx_samples.col(i);
-        ++lp_fun_calls;
-        lp_mat.coeffRef(i, 1) = lp_fun(approx_samples_col, pathfinder_ss);
-      } catch (const std::domain_error& e) {
-        lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
-      }
-      log_stream(logger, pathfinder_ss, iter_msg);
+    // Messages of each sample, logged in order once all are evaluated
+    std::vector<std::string> sample_msgs(num_samples);
+    tbb::parallel_for(
+        tbb::blocked_range<Eigen::Index>(0, num_samples,
+                                         std::max<size_t>(grain_size, 1)),
+        [&](const tbb::blocked_range<Eigen::Index>& r) {
+          Eigen::VectorXd approx_samples_col;
+          std::stringstream pathfinder_ss;
+          for (Eigen::Index i = r.begin(); i < r.end(); ++i) {
+            try {
+              approx_samples_col = approx_samples.col(i);
+              lp_mat.coeffRef(i, 1)
+                  = lp_fun(approx_samples_col, pathfinder_ss);
+            } catch (const std::domain_error& e) {
+              lp_mat.coeffRef(i, 1) = -std::numeric_limits<double>::infinity();
+            }
+            if (pathfinder_ss.str().length() > 0) {
+              sample_msgs[i] = pathfinder_ss.str();
+              pathfinder_ss.str(std::string());
+            }
+          }
+        });
+    lp_fun_calls = num_samples;
+    for (const auto& sample_msg : sample_msgs) {
+      if (sample_msg.length() > 0)
+        logger.info(iter_msg + sample_msg);
     }
     lp_ratio = lp_mat.col(1) - lp_mat.col(0);
   } else {
@@ -504,6 +518,8 @@ inline auto ret_pathfinder(int return_code, EigVec&& lp_ratio, EigMat&& samples,
  * @param num_elbo_draws Number of draws for the ELBO estimation
  * @param iter_msg The beginning of messages that includes the iteration number
  * @param logger A callback writer for messages
+ * @param grain_size Number of ELBO draws whose log density is evaluated by
+ * each task
  * @return A pair holding the elbo estimate information and the taylor
  * approximation information.
  */
@@ -514,7 +530,8 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
                      AlphaVec&& alpha, CurrentParams&& current_params,
                      CurrentGrads&& current_grads, GradMat&& Ykt_mat,
                      ParamMat&& Skt_mat, std::size_t num_elbo_draws,
-                     const std::string& iter_msg, Logger&& logger) {
+                     const std::string& iter_msg, Logger&& logger,
+                     std::size_t grain_size = 1) {
   const auto history_size = Ykt_mat.cols();
   Eigen::MatrixXd Rk = Eigen::MatrixXd::Zero(history_size, history_size);
   Rk.template triangularView<Eigen::Upper>() = Skt_mat.transpose() * Ykt_mat;
@@ -528,7 +545,8 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
   try {
     return std::make_pair(internal::est_approx_draws<true>(
                               lp_fun, constrain_fun, rng, taylor_appx,
-                              num_elbo_draws, alpha, iter_msg, logger),
+                              num_elbo_draws, alpha, iter_msg, logger,
+                              true, grain_size),
                           taylor_appx);
   } catch (const std::domain_error& e) {
     logger.warn(iter_msg + "ELBO estimation failed "
@@ -590,6 +608,18 @@ auto pathfinder_impl(RNG&& rng, LPFun&& lp_fun, ConstrainFun&& constrain_fun,
  * probability calculations will be `NA` and psis resampling will not be
  * performed. Setting this parameter to `false` will also set all of the lp
  * ratios to `NaN`.
+ * @param[in] grain_size Number of approximate draws whose log density is
+ * evaluated by each parallel task. The draws and their log densities do not
+ * depend on it.
+ * @param[in] elbo_stride Positive number of LBFGS iterations between ELBO
+ * estimates. The taylor approximation and the `num_elbo_draws` log density
+ * evaluations are only done at the first iteration, every `elbo_stride`
+ * iterations after it, and the last iteration.
+ * @param[in] elbo_patience If positive, LBFGS is stopped once this many ELBO
+ * estimates in a row have not improved on the best ELBO.
+ * With either of them set and `save_iterations`, every iteration record
+ * says whether the ELBO was estimated and an `elbo_schedule` record
+ * summarizes the schedule; with the defaults the diagnostics are unchanged.
  * @return If `ReturnLpSamples` is `true`, returns a tuple of the error code,
  * approximate draws, and a vector of the lp ratio. If `false`, only returns an
  * error code `error_codes::OK` if successful, `error_codes::SOFTWARE`
@@ -605,7 +635,8 @@ inline auto pathfinder_lbfgs_single(
     int num_elbo_draws, int num_draws, bool save_iterations, int refresh,
     callbacks::interrupt& interrupt, callbacks::logger& logger,
     callbacks::writer& init_writer, ParamWriter& parameter_writer,
-    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true) {
+    DiagnosticWriter& diagnostic_writer, bool calculate_lp = true,
+    std::size_t grain_size = 1, int elbo_stride = 1, int elbo_patience = 0) {
   const auto start_pathfinder_time = std::chrono::steady_clock::now();
   stan::rng_t rng = util::create_rng(random_seed, stride_id);
   std::vector<int> disc_vector;
@@ -677,6 +708,13 @@ inline auto pathfinder_lbfgs_single(
   };
   Eigen::VectorXd alpha = Eigen::VectorXd::Ones(num_parameters);
   Eigen::Index best_iteration = -1;
+  // Schedule of the ELBO estimates
+  int num_lbfgs_iters = 0;
+  int num_elbo_estimates = 0;
+  int num_elbo_skipped = 0;
+  int num_elbo_no_improve = 0;
+  bool stopped_early = false;
+  const bool elbo_scheduled = elbo_stride > 1 || elbo_patience > 0;
   internal::elbo_est_t elbo_best;
   internal::taylor_approx_t taylor_approx_best;
   std::size_t num_evals{lbfgs.grad_evals()};
@@ -737,6 +775,8 @@ inline auto pathfinder_lbfgs_single(
       if (save_iterations) {
         diagnostic_writer.write("lbfgs_success", false);
         diagnostic_writer.write("pathfinder_success", false);
+        if (elbo_scheduled)
+          diagnostic_writer.write("elbo_estimated", false);
         diagnostic_writer.write("lbfgs_note", lbfgs_ss.str());
         diagnostic_writer.end_record();
       }
@@ -746,6 +786,7 @@ inline auto pathfinder_lbfgs_single(
       }
       break;
     }
+    ++num_lbfgs_iters;
     try {
       param_buff.push_back(lbfgs.curr_x() - prev_params);
       grad_buff.push_back(lbfgs.curr_g() - prev_grads);
@@ -763,6 +804,28 @@ inline auto pathfinder_lbfgs_single(
                                * Sk))
                          * (Sk.array() / alpha.array()).square());
       }
+      // The history and diagonal are updated every iteration, but the
+      // taylor approximation and ELBO only when they are scheduled
+      if (elbo_stride > 1 && ret == 0
+          && (num_lbfgs_iters - 1) % elbo_stride != 0) {
+        ++num_elbo_skipped;
+        print_log_remainder(
+            write_log_cond, msg, ret, num_evals, lbfgs, elbo_best.elbo,
+            std::numeric_limits<double>::quiet_NaN(), lbfgs_ss, logger);
+        if (unlikely(save_iterations)) {
+          diagnostic_writer.write("lbfgs_success", true);
+          diagnostic_writer.write("pathfinder_success", false);
+          diagnostic_writer.write("elbo_estimated", false);
+          diagnostic_writer.write("lbfgs_note", lbfgs_ss.str());
+          diagnostic_writer.end_record();
+        }
+        if (lbfgs_ss.str().length() > 0) {
+          logger.info(lbfgs_ss);
+          lbfgs_ss.str("");
+        }
+        continue;
+      }
+      ++num_elbo_estimates;
       Eigen::Map<Eigen::MatrixXd> Ykt_map(Ykt_mat.data(), num_parameters,
                                           history_size);
       for (Eigen::Index i = 0; i < history_size; ++i) {
@@ -778,7 +841,7 @@ inline auto pathfinder_lbfgs_single(
 
       auto pathfinder_res = internal::pathfinder_impl(
           rng, lp_fun, constrain_fun, alpha, lbfgs.curr_x(), lbfgs.curr_g(),
-          Ykt_map, Skt_map, num_elbo_draws, iter_msg, logger);
+          Ykt_map, Skt_map, num_elbo_draws, iter_msg, logger, grain_size);
       num_evals += pathfinder_res.first.fn_calls;
       print_log_remainder(write_log_cond, msg, ret, num_evals, lbfgs,
                           pathfinder_res.first.elbo, pathfinder_res.first.elbo,
@@ -786,6 +849,8 @@ inline auto pathfinder_lbfgs_single(
       if (unlikely(save_iterations)) {
         diagnostic_writer.write("lbfgs_success", true);
         diagnostic_writer.write("pathfinder_success", true);
+        if (elbo_scheduled)
+          diagnostic_writer.write("elbo_estimated", true);
         diagnostic_writer.write("x_center", pathfinder_res.second.x_center);
         diagnostic_writer.write("logDetCholHk",
                                 pathfinder_res.second.logdetcholHk);
@@ -805,11 +870,22 @@ inline auto pathfinder_lbfgs_single(
         elbo_best = std::move(pathfinder_res.first);
         taylor_approx_best = std::move(pathfinder_res.second);
         best_iteration = lbfgs.iter_num();
+        num_elbo_no_improve = 0;
+      } else if (elbo_patience > 0 && ++num_elbo_no_improve >= elbo_patience) {
+        if (refresh != 0) {
+          logger.info(path_num + "Stopping LBFGS early: the ELBO has not "
+                      + "improved in " + std::to_string(num_elbo_no_improve)
+                      + " estimates");
+        }
+        stopped_early = true;
+        break;
       }
     } catch (const std::exception& e) {
       if (unlikely(save_iterations)) {
         diagnostic_writer.write("lbfgs_success", true);
         diagnostic_writer.write("pathfinder_success", false);
+        if (elbo_scheduled)
+          diagnostic_writer.write("elbo_estimated", true);
         diagnostic_writer.write("history_size", history_size);
         diagnostic_writer.write("history_size", history_size);
         diagnostic_writer.write("lbfgs_note", lbfgs_ss.str());
@@ -833,9 +909,30 @@ inline auto pathfinder_lbfgs_single(
     }
   }
   if (unlikely(save_iterations)) {
+    if (elbo_scheduled) {
+      diagnostic_writer.begin_record("elbo_schedule");
+      diagnostic_writer.write("lbfgs_iterations", num_lbfgs_iters);
+      diagnostic_writer.write("elbo_estimates", num_elbo_estimates);
+      diagnostic_writer.write("elbo_estimates_skipped", num_elbo_skipped);
+      diagnostic_writer.write(
+          "lp_evaluations_saved",
+          static_cast<std::size_t>(num_elbo_skipped) * num_elbo_draws);
+      diagnostic_writer.write("stopped_early", stopped_early);
+      diagnostic_writer.end_record();
+    }
     diagnostic_writer.end_record();
   }
-  if (unlikely(ret <= 0)) {
+  if (elbo_scheduled && refresh != 0) {
+    logger.info(path_num + "ELBO estimated at "
+                + std::to_string(num_elbo_estimates) + " of "
+                + std::to_string(num_lbfgs_iters)
+                + " LBFGS iterations, saving "
+                + std::to_string(static_cast<std::size_t>(num_elbo_skipped)
+                                 * num_elbo_draws)
+                + " log density evaluations"
+                + (stopped_early ? " and stopping early" : ""));
+  }
+  if (unlikely(ret <= 0 && !stopped_early)) {
     std::string prefix_err_msg
         = "Optimization terminated with error: " + lbfgs.get_code_string(ret);
     if (lbfgs.iter_num() < 2) {
@@ -877,7 +974,8 @@ inline auto pathfinder_lbfgs_single(
     try {
       internal::elbo_est_t est_draws = internal::est_approx_draws<false>(
           lp_fun, constrain_fun, rng, taylor_approx_best, remaining_draws,
-          taylor_approx_best.alpha, path_num, logger, calculate_lp);
+          taylor_approx_best.alpha, path_num, logger, calculate_lp,
+          grain_size);
       num_evals += est_draws.fn_calls;
       auto&& new_lp_ratio = est_draws.lp_ratio;
       auto&& lp_draws = est_draws.lp_mat;
@@ -11,7 +11,10 @@
 #include <stan/services/util/run_sampler.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/initialize_chains.hpp>
 #include <stan/services/util/inv_metric.hpp>
+#include <tbb/task_arena.h>
+#include <algorithm>
 #include <vector>
 
 namespace stan {
@@ -203,15 +206,19 @@ int hmc_nuts_dense_e(Model& model, size_t num_chains,
   std::vector<stan::rng_t> rngs;
   rngs.reserve(num_chains);
   std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
   using sample_t = stan::mcmc::dense_e_nuts<Model, stan::rng_t>;
   std::vector<sample_t> samplers;
   samplers.reserve(num_chains);
   try {
-    for (int i = 0; i < num_chains; ++i) {
+    for (int i = 0; i < num_chains; ++i)
       rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
+    // Threads not needed by the chains evaluate speculative inits
+    const size_t init_batch_size = std::max<size_t>(
+        1, tbb::this_task_arena::max_concurrency() / num_chains);
+    cont_vectors = util::initialize_chains(model, init, rngs, init_radius,
+                                           true, logger, init_writer,
+                                           init_batch_size);
+    for (int i = 0; i < num_chains; ++i) {
       Eigen::MatrixXd inv_metric = util::read_dense_inv_metric(
           *init_inv_metric[i], model.num_params_r(), logger);
       util::validate_dense_inv_metric(inv_metric, logger);
@@ -9,10 +9,15 @@
 #include <stan/math/prim.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
 #include <stan/services/error_codes.hpp>
+#include <stan/services/util/convergence_monitor.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/inv_metric.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/initialize_chains.hpp>
 #include <stan/services/util/run_adaptive_sampler.hpp>
+#include <stan/services/util/run_pooled_chains.hpp>
+#include <tbb/task_arena.h>
+#include <algorithm>
 #include <vector>
 
 namespace stan {
@@ -52,6 +57,12 @@ namespace sample {
  * @param[in,out] sample_writer Writer for draws
  * @param[in,out] diagnostic_writer Writer for diagnostic information
  * @param[in,out] metric_writer Writer for tuning params
+ * @param[in] warmup_metric_tol if positive, skip the remaining slow
+ *   adaptation windows once the relative change of the metric between
+ *   two windows falls below this value
+ * @param[in] warmup_stepsize_tol if positive, end warmup during the
+ *   terminal buffer once the adapted step size changes by less than this
+ *   relative value over 25 iterations
  * @return error_codes::OK if successful
  */
 template <class Model>
@@ -65,7 +76,8 @@ int hmc_nuts_diag_e_adapt(
     unsigned int window, callbacks::interrupt& interrupt,
     callbacks::logger& logger, callbacks::writer& init_writer,
     callbacks::writer& sample_writer, callbacks::writer& diagnostic_writer,
-    callbacks::structured_writer& metric_writer) {
+    callbacks::structured_writer& metric_writer, double warmup_metric_tol = 0,
+    double warmup_stepsize_tol = 0) {
   stan::rng_t rng = util::create_rng(random_seed, chain);
 
   std::vector<double> cont_vector;
@@ -98,6 +110,7 @@ int hmc_nuts_diag_e_adapt(
 
   sampler.set_window_params(num_warmup, init_buffer, term_buffer, window,
                             logger);
+  sampler.set_adaptive_warmup(warmup_metric_tol, warmup_stepsize_tol);
 
   try {
     util::run_adaptive_sampler(sampler, model, cont_vector, num_warmup,
@@ -273,6 +286,104 @@ int hmc_nuts_diag_e_adapt(
       dummy_metric_writer);
 }
 
+namespace internal {
+
+/**
+ * Initializes and configures one adaptive diagonal metric NUTS sampler
+ * per chain and runs them.  This is the body shared by the services
+ * running several chains of <code>hmc_nuts_diag_e_adapt</code>; the
+ * arguments are as documented there.
+ *
+ * @tparam Configure callable with signature
+ * <code>void(sampler&, size_t)</code>, applying any further settings
+ * to the sampler of the chain with the given index
+ * @tparam RunChains callable taking a function with signature
+ * <code>void(size_t)</code> that runs the chain with the given index,
+ * and running every chain with it
+ * @param[in] configure further sampler settings
+ * @param[in] run_chains how the chains are run
+ * @return error_codes::OK if successful
+ */
+template <class Model, typename InitContextPtr, typename InitInvContextPtr,
+          typename InitWriter, typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter, typename Configure, typename RunChains>
+int hmc_nuts_diag_e_adapt_chains(
+    Model& model, size_t num_chains, const std::vector<InitContextPtr>& init,
+    const std::vector<InitInvContextPtr>& init_inv_metric,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    double warmup_metric_tol, double warmup_stepsize_tol,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<InitWriter>& init_writer,
+    std::vector<SampleWriter>& sample_writer,
+    std::vector<DiagnosticWriter>& diagnostic_writer,
+    std::vector<MetricWriter>& metric_writer,
+    util::convergence_monitor* monitor, const Configure& configure,
+    const RunChains& run_chains) {
+  using sample_t = stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t>;
+  std::vector<stan::rng_t> rngs;
+  rngs.reserve(num_chains);
+  std::vector<std::vector<double>> cont_vectors;
+  std::vector<sample_t> samplers;
+  samplers.reserve(num_chains);
+  try {
+    for (int i = 0; i < num_chains; ++i)
+      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
+    // Threads not needed by the chains evaluate speculative inits
+    const size_t init_batch_size = std::max<size_t>(
+        1, tbb::this_task_arena::max_concurrency() / num_chains);
+    cont_vectors = util::initialize_chains(model, init, rngs, init_radius,
+                                           true, logger, init_writer,
+                                           init_batch_size);
+    for (int i = 0; i < num_chains; ++i) {
+      samplers.emplace_back(model, rngs[i]);
+      Eigen::VectorXd inv_metric = util::read_diag_inv_metric(
+          *init_inv_metric[i], model.num_params_r(), logger);
+      util::validate_diag_inv_metric(inv_metric, logger);
+
+      samplers[i].set_metric(inv_metric);
+      samplers[i].set_nominal_stepsize(stepsize);
+      samplers[i].set_stepsize_jitter(stepsize_jitter);
+      samplers[i].set_max_depth(max_depth);
+
+      samplers[i].get_stepsize_adaptation().set_mu(log(10 * stepsize));
+      samplers[i].get_stepsize_adaptation().set_delta(delta);
+      samplers[i].get_stepsize_adaptation().set_gamma(gamma);
+      samplers[i].get_stepsize_adaptation().set_kappa(kappa);
+      samplers[i].get_stepsize_adaptation().set_t0(t0);
+      samplers[i].set_window_params(num_warmup, init_buffer, term_buffer,
+                                    window, logger);
+      samplers[i].set_adaptive_warmup(warmup_metric_tol, warmup_stepsize_tol);
+      configure(samplers[i], i);
+    }
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::CONFIG;
+  }
+  auto run_chain = [num_warmup, num_samples, num_thin, refresh, save_warmup,
+                    num_chains, init_chain_id, &samplers, &model, &rngs,
+                    &interrupt, &logger, &sample_writer, &cont_vectors,
+                    &diagnostic_writer, &metric_writer, monitor](size_t i) {
+    util::run_adaptive_sampler(
+        samplers[i], model, cont_vectors[i], num_warmup, num_samples, num_thin,
+        refresh, save_warmup, rngs[i], interrupt, logger, sample_writer[i],
+        diagnostic_writer[i], metric_writer[i], init_chain_id + i, num_chains,
+        monitor);
+  };
+  try {
+    run_chains(run_chain);
+  } catch (const std::exception& e) {
+    logger.error(e.what());
+    return error_codes::SOFTWARE;
+  }
+  return error_codes::OK;
+}
+
+}  // namespace internal
+
 /**
  * Runs multiple chains of HMC with NUTS with adaptation using diagonal
  * Euclidean metric with a pre-specified diagonal metric and saves adapted
@@ -323,6 +434,22 @@ int hmc_nuts_diag_e_adapt(
  * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
  * information of each chain.
  * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @param[in] pool_adaptation true to pool the metric adaptation of the
+ * chains: at the end of each adaptation window the chains merge their
+ * estimators and all take the metric estimated from the draws of every
+ * chain.  The chains then run on one thread each.
+ * @param[in] pool_stepsize true to also give every chain the geometric
+ * mean of the adapted step sizes at the end of warmup.  Ignored unless
+ * `pool_adaptation` is true.
+ * @param[in] warmup_metric_tol if positive, skip the remaining slow
+ * adaptation windows once the relative change of the metric between two
+ * windows falls below this value
+ * @param[in] warmup_stepsize_tol if positive, end warmup of a chain during
+ * the terminal buffer once its adapted step size changes by less than this
+ * relative value over 25 iterations
+ * @param[in,out] monitor if not null, convergence monitor fed with the
+ * post-warmup draws of every chain, which stops sampling early once its
+ * targets are met if so configured
  * @return error_codes::OK if successful
  */
 template <class Model, typename InitContextPtr, typename InitInvContextPtr,
@@ -340,70 +467,45 @@ int hmc_nuts_diag_e_adapt(
     std::vector<InitWriter>& init_writer,
     std::vector<SampleWriter>& sample_writer,
     std::vector<DiagnosticWriter>& diagnostic_writer,
-    std::vector<MetricWriter>& metric_writer) {
-  if (num_chains == 1) {
+    std::vector<MetricWriter>& metric_writer, bool pool_adaptation = false,
+    bool pool_stepsize = false, double warmup_metric_tol = 0,
+    double warmup_stepsize_tol = 0,
+    util::convergence_monitor* monitor = nullptr) {
+  if (num_chains == 1 && monitor == nullptr) {
     return hmc_nuts_diag_e_adapt(
         model, *init[0], *init_inv_metric[0], random_seed, init_chain_id,
         init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
         stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
         init_buffer, term_buffer, window, interrupt, logger, init_writer[0],
-        sample_writer[0], diagnostic_writer[0], metric_writer[0]);
+        sample_writer[0], diagnostic_writer[0], metric_writer[0],
+        warmup_metric_tol, warmup_stepsize_tol);
   }
   using sample_t = stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t>;
-  std::vector<stan::rng_t> rngs;
-  rngs.reserve(num_chains);
-  std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
-  std::vector<sample_t> samplers;
-  samplers.reserve(num_chains);
-  try {
-    for (int i = 0; i < num_chains; ++i) {
-      rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
-      samplers.emplace_back(model, rngs[i]);
-      Eigen::VectorXd inv_metric = util::read_diag_inv_metric(
-          *init_inv_metric[i], model.num_params_r(), logger);
-      util::validate_diag_inv_metric(inv_metric, logger);
-
-      samplers[i].set_metric(inv_metric);
-      samplers[i].set_nominal_stepsize(stepsize);
-      samplers[i].set_stepsize_jitter(stepsize_jitter);
-      samplers[i].set_max_depth(max_depth);
-
-      samplers[i].get_stepsize_adaptation().set_mu(log(10 * stepsize));
-      samplers[i].get_stepsize_adaptation().set_delta(delta);
-      samplers[i].get_stepsize_adaptation().set_gamma(gamma);
-      samplers[i].get_stepsize_adaptation().set_kappa(kappa);
-      samplers[i].get_stepsize_adaptation().set_t0(t0);
-      samplers[i].set_window_params(num_warmup, init_buffer, term_buffer,
-                                    window, logger);
-    }
-  } catch (const std::exception& e) {
-    logger.error(e.what());
-    return error_codes::CONFIG;
-  }
-  try {
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, num_chains, 1),
-        [num_warmup, num_samples, num_thin, refresh, save_warmup, num_chains,
-         init_chain_id, &samplers, &model, &rngs, &interrupt, &logger,
-         &sample_writer, &cont_vectors, &diagnostic_writer,
-         &metric_writer](const tbb::blocked_range<size_t>& r) {
-          for (size_t i = r.begin(); i != r.end(); ++i) {
-            util::run_adaptive_sampler(
-                samplers[i], model, cont_vectors[i], num_warmup, num_samples,
-                num_thin, refresh, save_warmup, rngs[i], interrupt, logger,
-                sample_writer[i], diagnostic_writer[i], metric_writer[i],
-                init_chain_id + i, num_chains);
-          }
-        },
-        tbb::simple_partitioner());
-  } catch (const std::exception& e) {
-    logger.error(e.what());
-    return error_codes::SOFTWARE;
-  }
-  return error_codes::OK;
+  stan::mcmc::pooled_adaptation pool(num_chains, pool_stepsize);
+  return internal::hmc_nuts_diag_e_adapt_chains(
+      model, num_chains, init, init_inv_metric, random_seed, init_chain_id,
+      init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
+      stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
+      init_buffer, term_buffer, window, warmup_metric_tol, warmup_stepsize_tol,
+      interrupt, logger, init_writer, sample_writer, diagnostic_writer,
+      metric_writer, monitor,
+      [pool_adaptation, &pool](sample_t& sampler, size_t i) {
+        if (pool_adaptation)
+          sampler.set_adaptation_pool(&pool, i);
+      },
+      [num_chains, pool_adaptation, &pool](const auto& run_chain) {
+        if (pool_adaptation) {
+          util::run_pooled_chains(pool, run_chain);
+        } else {
+          tbb::parallel_for(
+              tbb::blocked_range<size_t>(0, num_chains, 1),
+              [&run_chain](const tbb::blocked_range<size_t>& r) {
+                for (size_t i = r.begin(); i != r.end(); ++i)
+                  run_chain(i);
+              },
+              tbb::simple_partitioner());
+        }
+      });
 }
 
 /**
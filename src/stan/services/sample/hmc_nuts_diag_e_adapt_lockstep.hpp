@@ -0,0 +1,129 @@
+#ifndef STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_LOCKSTEP_HPP
+#define STAN_SERVICES_SAMPLE_HMC_NUTS_DIAG_E_ADAPT_LOCKSTEP_HPP
+
+#include <stan/callbacks/interrupt.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/callbacks/writer.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/services/util/lockstep_gradient.hpp>
+#include <tbb/parallel_for.h>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace sample {
+
+/**
+ * Runs multiple chains of HMC with NUTS with adaptation using diagonal
+ * Euclidean metric, advancing the chains in lockstep so that the
+ * gradient of the log density is evaluated for all running chains in
+ * one call to the model's <code>log_prob_grad_batch</code> per
+ * leapfrog step.
+ *
+ * Each chain still builds its own trajectory, adapts and writes its
+ * own output, so for a given seed and chain id the draws match those
+ * of <code>hmc_nuts_diag_e_adapt</code>.  Chains whose trajectories
+ * terminate early wait for the others at their next gradient
+ * evaluation; chains that have finished sampling drop out of the
+ * batch.
+ *
+ * @tparam Model Model class, derived from <code>stan::model::model_base</code>
+ * @tparam InitContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitInvContextPtr A pointer with underlying type derived from
+ * `stan::io::var_context`
+ * @tparam InitWriter A type derived from `stan::callbacks::writer`
+ * @tparam SampleWriter A type derived from `stan::callbacks::writer`
+ * @tparam DiagnosticWriter A type derived from `stan::callbacks::writer`
+ * @tparam MetricWriter A type derived from `stan::callbacks::structured_writer`
+ * @param[in] model Input model (with data already instantiated)
+ * @param[in] num_chains The number of chains to run in lockstep. `init`,
+ * `init_inv_metric`, `init_writer`, `sample_writer`, `diagnostic_writer`
+ * and `metric_writer` must be the same length as this value.
+ * @param[in] init A std vector of init var contexts for initialization
+ * of each chain.
+ * @param[in] init_inv_metric A std vector of var contexts exposing an initial
+ * diagonal inverse Euclidean metric for each chain (must be positive definite)
+ * @param[in] random_seed random seed for the random number generator
+ * @param[in] init_chain_id first chain id. The pseudo random number generator
+ * will advance for each chain by an integer sequence from `init_chain_id` to
+ * `init_chain_id + num_chains - 1`
+ * @param[in] init_radius radius to initialize
+ * @param[in] num_warmup Number of warmup samples
+ * @param[in] num_samples Number of samples
+ * @param[in] num_thin Number to thin the samples
+ * @param[in] save_warmup Indicates whether to save the warmup iterations
+ * @param[in] refresh Controls the output
+ * @param[in] stepsize initial stepsize for discrete evolution
+ * @param[in] stepsize_jitter uniform random jitter of stepsize
+ * @param[in] max_depth Maximum tree depth
+ * @param[in] delta adaptation target acceptance statistic
+ * @param[in] gamma adaptation regularization scale
+ * @param[in] kappa adaptation relaxation exponent
+ * @param[in] t0 adaptation iteration offset
+ * @param[in] init_buffer width of initial fast adaptation interval
+ * @param[in] term_buffer width of final fast adaptation interval
+ * @param[in] window initial width of slow adaptation interval
+ * @param[in,out] interrupt Callback for interrupts
+ * @param[in,out] logger Logger for messages
+ * @param[in,out] init_writer std vector of Writer callbacks for unconstrained
+ * inits of each chain.
+ * @param[in,out] sample_writer std vector of Writers for draws of each chain.
+ * @param[in,out] diagnostic_writer std vector of Writers for diagnostic
+ * information of each chain.
+ * @param[in,out] metric_writer std vector of Writers for tuning params
+ * @return error_codes::OK if successful
+ */
+template <class Model, typename InitContextPtr, typename InitInvContextPtr,
+          typename InitWriter, typename SampleWriter, typename DiagnosticWriter,
+          typename MetricWriter>
+int hmc_nuts_diag_e_adapt_lockstep(
+    Model& model, size_t num_chains, const std::vector<InitContextPtr>& init,
+    const std::vector<InitInvContextPtr>& init_inv_metric,
+    unsigned int random_seed, unsigned int init_chain_id, double init_radius,
+    int num_warmup, int num_samples, int num_thin, bool save_warmup,
+    int refresh, double stepsize, double stepsize_jitter, int max_depth,
+    double delta, double gamma, double kappa, double t0,
+    unsigned int init_buffer, unsigned int term_buffer, unsigned int window,
+    callbacks::interrupt& interrupt, callbacks::logger& logger,
+    std::vector<InitWriter>& init_writer,
+    std::vector<SampleWriter>& sample_writer,
+    std::vector<DiagnosticWriter>& diagnostic_writer,
+    std::vector<MetricWriter>& metric_writer) {
+  using sample_t = stan::mcmc::adapt_diag_e_nuts<Model, stan::rng_t>;
+  util::lockstep_gradient<Model> lockstep(model, num_chains);
+  return internal::hmc_nuts_diag_e_adapt_chains(
+      model, num_chains, init, init_inv_metric, random_seed, init_chain_id,
+      init_radius, num_warmup, num_samples, num_thin, save_warmup, refresh,
+      stepsize, stepsize_jitter, max_depth, delta, gamma, kappa, t0,
+      init_buffer, term_buffer, window, 0, 0, interrupt, logger, init_writer,
+      sample_writer, diagnostic_writer, metric_writer, nullptr,
+      [&lockstep](sample_t& sampler, size_t i) {
+        sampler.set_gradient_evaluator(&lockstep.evaluator(i));
+      },
+      [num_chains, &lockstep, &logger](const auto& run_chain) {
+        tbb::parallel_for(
+            tbb::blocked_range<size_t>(0, num_chains, 1),
+            [&](const tbb::blocked_range<size_t>& r) {
+              for (size_t i = r.begin(); i != r.end(); ++i) {
+                lockstep.begin_chain();
+                try {
+                  run_chain(i);
+                } catch (...) {
+                  lockstep.end_chain(logger);
+                  throw;
+                }
+                lockstep.end_chain(logger);
+              }
+            },
+            tbb::simple_partitioner());
+      });
+}
+
+}  // namespace sample
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -10,7 +10,10 @@
 #include <stan/services/error_codes.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/initialize_chains.hpp>
 #include <stan/services/util/run_sampler.hpp>
+#include <tbb/task_arena.h>
+#include <algorithm>
 #include <vector>
 
 namespace stan {
@@ -141,14 +144,18 @@ int hmc_nuts_unit_e(Model& model, size_t num_chains,
   std::vector<stan::rng_t> rngs;
   rngs.reserve(num_chains);
   std::vector<std::vector<double>> cont_vectors;
-  cont_vectors.reserve(num_chains);
   std::vector<sample_t> samplers;
   samplers.reserve(num_chains);
   try {
-    for (int i = 0; i < num_chains; ++i) {
+    for (int i = 0; i < num_chains; ++i)
       rngs.emplace_back(util::create_rng(random_seed, init_chain_id + i));
-      cont_vectors.emplace_back(util::initialize(
-          model, *init[i], rngs[i], init_radius, true, logger, init_writer[i]));
+    // Threads not needed by the chains evaluate speculative inits
+    const size_t init_batch_size = std::max<size_t>(
+        1, tbb::this_task_arena::max_concurrency() / num_chains);
+    cont_vectors = util::initialize_chains(model, init, rngs, init_radius,
+                                           true, logger, init_writer,
+                                           init_batch_size);
+    for (int i = 0; i < num_chains; ++i) {
       samplers.emplace_back(model, rngs[i]);
 
       samplers[i].set_nominal_stepsize(stepsize);
@@ -0,0 +1,194 @@
+#ifndef STAN_SERVICES_UTIL_CONVERGENCE_MONITOR_HPP
+#define STAN_SERVICES_UTIL_CONVERGENCE_MONITOR_HPP
+
+#include <stan/analyze/mcmc/online_convergence.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/services/util/mcmc_writer.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Tracks the convergence of the post-warmup draws of a set of chains as
+ * they are generated, logging the diagnostics periodically and,
+ * optionally, asking the chains to stop sampling once the targets are
+ * met.
+ *
+ * <p>The draws of <code>lp__</code> and of every constrained parameter,
+ * transformed parameter and generated quantity are fed to an
+ * <code>stan::analyze::online_convergence</code> estimator, without
+ * calling the model again.  Whenever every chain has generated another
+ * <code>check_interval</code> draws, one of the chains computes the
+ * largest split R-hat and the smallest bulk and tail effective sample
+ * sizes over all quantities and logs them.  Quantities for which a
+ * diagnostic is undefined, such as constants, are ignored.  A chain
+ * which runs ahead of the others keeps sampling until the next check,
+ * so chains stopped early may end with different numbers of draws.
+ *
+ * <p>The monitor is shared by the chains, which may run on different
+ * threads.
+ */
+class convergence_monitor {
+ public:
+  /**
+   * Construct a monitor.
+   *
+   * @param[in] num_chains number of chains
+   * @param[in] init_chain_id id of the first chain; the chains are
+   * identified by <code>init_chain_id</code> to
+   * <code>init_chain_id + num_chains - 1</code>
+   * @param[in] check_interval number of draws per chain between checks
+   * @param[in] max_rhat largest acceptable split R-hat
+   * @param[in] min_ess_bulk smallest acceptable bulk effective sample
+   * size
+   * @param[in] min_ess_tail smallest acceptable tail effective sample
+   * size, ignored if the options do not track the tails
+   * @param[in] stop_when_converged stop sampling once the targets are met
+   * @param[in] options options of the online estimator
+   */
+  convergence_monitor(size_t num_chains, size_t init_chain_id,
+                      size_t check_interval, double max_rhat,
+                      double min_ess_bulk, double min_ess_tail,
+                      bool stop_when_converged,
+                      const analyze::online_convergence_options& options
+                      = analyze::online_convergence_options())
+      : num_chains_(num_chains),
+        init_chain_id_(init_chain_id),
+        check_interval_(std::max<size_t>(check_interval, 1)),
+        max_rhat_(max_rhat),
+        min_ess_bulk_(min_ess_bulk),
+        min_ess_tail_(min_ess_tail),
+        stop_when_converged_(stop_when_converged),
+        options_(options),
+        draws_(num_chains),
+        next_check_(check_interval_) {}
+
+  /**
+   * Add the draw most recently written by a chain and check convergence
+   * if it completes a check interval of every chain.
+   *
+   * @param[in] chain_id id of the chain
+   * @param[in] writer writer of the chain
+   * @param[in,out] logger logger for the diagnostics
+   */
+  void add_draw(size_t chain_id, const mcmc_writer& writer,
+                callbacks::logger& logger) {
+    const std::vector<double>& values = writer.last_sample_params();
+    const size_t offset
+        = writer.num_sample_params_ + writer.num_sampler_params_;
+    if (values.empty() || values.size() < offset)
+      return;
+    const size_t chain = chain_id - init_chain_id_;
+    std::vector<double>& draw = draws_[chain];
+    draw.assign(1, values[0]);
+    draw.insert(draw.end(), values.begin() + offset, values.end());
+    std::call_once(init_flag_, [this, &draw] {
+      diagnostics_.reset(new analyze::online_convergence(
+          num_chains_, draw.size(), options_));
+    });
+    if (draw.size() != diagnostics_->num_params())
+      return;
+    diagnostics_->add_draw(chain, draw.data());
+
+    size_t min_num_draws = diagnostics_->num_draws(0);
+    for (size_t c = 1; c < num_chains_; ++c)
+      min_num_draws = std::min(min_num_draws, diagnostics_->num_draws(c));
+    if (min_num_draws < next_check_.load())
+      return;
+    std::unique_lock<std::mutex> lock(check_mutex_, std::try_to_lock);
+    if (!lock.owns_lock() || min_num_draws < next_check_.load())
+      return;
+    next_check_ = (min_num_draws / check_interval_ + 1) * check_interval_;
+    check(logger);
+  }
+
+  /**
+   * Return true if the chains should stop sampling.
+   */
+  bool stop_requested() const { return stop_.load(); }
+
+  /**
+   * Return true if the targets were met at the latest check.
+   */
+  bool converged() const { return converged_.load(); }
+
+  /**
+   * Return the diagnostics of the draws added so far; the summary is
+   * not ready before any draw has been added.
+   */
+  analyze::online_convergence_summary summary() const {
+    if (!diagnostics_)
+      return analyze::online_convergence_summary();
+    return diagnostics_->summary();
+  }
+
+ private:
+  void check(callbacks::logger& logger) {
+    analyze::online_convergence_summary diagnostics = diagnostics_->summary();
+    if (!diagnostics.ready)
+      return;
+    const double rhat = extreme_finite(diagnostics.rhat, true);
+    const double ess_bulk = extreme_finite(diagnostics.ess_bulk, false);
+    const double ess_tail = extreme_finite(diagnostics.ess_tail, false);
+    std::stringstream message;
+    message << "Convergence after " << diagnostics.min_num_draws
+            << " draws per chain: max R-hat = " << rhat
+            << ", min bulk ESS = " << ess_bulk;
+    if (options_.tail)
+      message << ", min tail ESS = " << ess_tail;
+    logger.info(message);
+
+    const bool met = !(rhat > max_rhat_) && !(ess_bulk < min_ess_bulk_)
+                     && (!options_.tail || !(ess_tail < min_ess_tail_));
+    converged_ = met;
+    if (met && stop_when_converged_ && !stop_.exchange(true))
+      logger.info("Convergence targets met; stopping sampling.");
+  }
+
+  /**
+   * Return the largest finite entry if <code>largest</code> is true and
+   * the smallest otherwise, or NaN if there are none.
+   */
+  static double extreme_finite(const Eigen::VectorXd& x, bool largest) {
+    double result = std::numeric_limits<double>::quiet_NaN();
+    for (Eigen::Index i = 0; i < x.size(); ++i) {
+      if (!std::isfinite(x(i)))
+        continue;
+      if (std::isnan(result) || (largest ? x(i) > result : x(i) < result))
+        result = x(i);
+    }
+    return result;
+  }
+
+  size_t num_chains_;
+  size_t init_chain_id_;
+  size_t check_interval_;
+  double max_rhat_;
+  double min_ess_bulk_;
+  double min_ess_tail_;
+  bool stop_when_converged_;
+  analyze::online_convergence_options options_;
+  std::vector<std::vector<double>> draws_;
+  std::once_flag init_flag_;
+  std::unique_ptr<analyze::online_convergence> diagnostics_;
+  std::atomic<size_t> next_check_;
+  std::mutex check_mutex_;
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> converged_{false};
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
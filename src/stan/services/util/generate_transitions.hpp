@@ -2,7 +2,9 @@
 #define STAN_SERVICES_UTIL_GENERATE_TRANSITIONS_HPP
 
 #include <stan/callbacks/interrupt.hpp>
+#include <stan/mcmc/base_adapter.hpp>
 #include <stan/mcmc/base_mcmc.hpp>
+#include <stan/services/util/convergence_monitor.hpp>
 #include <stan/services/util/mcmc_writer.hpp>
 #include <string>
 
@@ -38,17 +40,33 @@ namespace util {
  * @param[in] chain_id The id of the current chain, used in output.
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number.
+ * @param[in,out] monitor if not null, the saved post-warmup draws are
+ *  added to this convergence monitor, and the transitions stop early once
+ *  it requests so.
+ * @param[in] adapter if not null, the warmup transitions stop early once
+ *  the adaptation of this adapter has converged.
+ * @return number of transitions generated
  */
 template <class Model, class RNG>
-void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
-                          int start, int finish, int num_thin, int refresh,
-                          bool save, bool warmup,
-                          util::mcmc_writer& mcmc_writer,
-                          stan::mcmc::sample& init_s, Model& model,
-                          RNG& base_rng, callbacks::interrupt& callback,
-                          callbacks::logger& logger, size_t chain_id = 1,
-                          size_t num_chains = 1) {
-  for (int m = 0; m < num_iterations; ++m) {
+int generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
+                         int start, int finish, int num_thin, int refresh,
+                         bool save, bool warmup, util::mcmc_writer& mcmc_writer,
+                         stan::mcmc::sample& init_s, Model& model,
+                         RNG& base_rng, callbacks::interrupt& callback,
+                         callbacks::logger& logger, size_t chain_id = 1,
+                         size_t num_chains = 1,
+                         convergence_monitor* monitor = nullptr,
+                         const stan::mcmc::base_adapter* adapter = nullptr) {
+  if (warmup)
+    monitor = nullptr;
+  else
+    adapter = nullptr;
+  int m = 0;
+  for (; m < num_iterations; ++m) {
+    if (monitor != nullptr && monitor->stop_requested())
+      break;
+    if (adapter != nullptr && adapter->adaptation_converged())
+      break;
     callback();
 
     if (refresh > 0
@@ -72,8 +90,11 @@ void generate_transitions(stan::mcmc::base_mcmc& sampler, int num_iterations,
     if (save && ((m % num_thin) == 0)) {
       mcmc_writer.write_sample_params(base_rng, init_s, sampler, model);
       mcmc_writer.write_diagnostic_params(init_s, sampler);
+      if (monitor != nullptr)
+        monitor->add_draw(chain_id, mcmc_writer, logger);
     }
   }
+  return m;
 }
 
 }  // namespace util
@@ -1,6 +1,7 @@
 #ifndef STAN_SERVICES_UTIL_INITIALIZE_HPP
 #define STAN_SERVICES_UTIL_INITIALIZE_HPP
 
+#include <stan/callbacks/buffer_logger.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
 #include <stan/io/var_context.hpp>
@@ -8,7 +9,12 @@
 #include <stan/io/chained_var_context.hpp>
 #include <stan/model/log_prob_grad.hpp>
 #include <stan/math/prim.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
 #include <chrono>
+#include <exception>
+#include <memory>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -17,6 +23,188 @@ namespace stan {
 namespace services {
 namespace util {
 
+namespace internal {
+
+/**
+ * Log the rejection of an initial value whose log density could not be
+ * evaluated.
+ *
+ * @param[in] e exception thrown by the model
+ * @param[in] msg messages printed by the model
+ * @param[in,out] logger logger for messages
+ */
+inline void log_init_rejection(const std::domain_error& e,
+                               const std::stringstream& msg,
+                               stan::callbacks::logger& logger) {
+  if (msg.str().length() > 0)
+    logger.info(msg);
+  logger.warn("Rejecting initial value:");
+  logger.warn(
+      "  Error evaluating the log probability"
+      " at the initial value.");
+  logger.warn(e.what());
+}
+
+/**
+ * Log an error from the model which ends the initialization.
+ *
+ * @param[in] msg messages printed by the model
+ * @param[in,out] logger logger for messages
+ */
+inline void log_init_error(const std::stringstream& msg,
+                           stan::callbacks::logger& logger) {
+  if (msg.str().length() > 0)
+    logger.info(msg);
+  logger.error(
+      "Unrecoverable error evaluating the log probability"
+      " at the initial value.");
+}
+
+/**
+ * A candidate initial value: the random values drawn for it, and the
+ * outcome of its evaluation.
+ */
+template <typename RNG>
+struct init_candidate {
+  // Random values, or null if drawing them threw
+  std::unique_ptr<stan::io::random_var_context> random_context;
+  // Exception thrown while drawing the random values or evaluating
+  std::exception_ptr error;
+  // State of the random number generator after drawing the values
+  RNG rng;
+  // Messages of the evaluation
+  stan::callbacks::buffer_logger log;
+  std::vector<double> unconstrained;
+  bool valid;
+
+  explicit init_candidate(const RNG& rng) : rng(rng), valid(false) {}
+};
+
+/**
+ * Evaluate a candidate initial value, logging why it is rejected.
+ *
+ * @tparam Jacobian indicates whether to include the Jacobian term when
+ *   evaluating the log density function
+ * @tparam Model the type of the model class
+ * @tparam InitContext the type of the user provided initial values
+ * @param[in] model the model
+ * @param[in] init a var_context with initial values
+ * @param[in] any_initialized true if <code>init</code> provides any
+ *   parameter
+ * @param[in] random_context random values for the other parameters
+ * @param[in] print_timing indicates whether a timing message should
+ *   be printed to the logger
+ * @param[out] unconstrained the initial value on the unconstrained scale
+ * @param[in,out] logger logger for messages
+ * @return true if the log density and its gradient are finite
+ * @throws exception passed through from the model if the model has a
+ *   fatal error (not a std::domain_error)
+ */
+template <bool Jacobian, typename Model, typename InitContext>
+bool evaluate_init(Model& model, const InitContext& init,
+                   bool any_initialized,
+                   stan::io::random_var_context& random_context,
+                   bool print_timing, std::vector<double>& unconstrained,
+                   stan::callbacks::logger& logger) {
+  std::vector<int> disc_vector;
+  std::stringstream msg;
+  try {
+    if (!any_initialized) {
+      unconstrained = random_context.get_unconstrained();
+    } else {
+      stan::io::chained_var_context context(init, random_context);
+
+      model.transform_inits(context, disc_vector, unconstrained, &msg);
+    }
+  } catch (std::domain_error& e) {
+    log_init_rejection(e, msg, logger);
+    return false;
+  } catch (std::exception& e) {
+    log_init_error(msg, logger);
+    throw;
+  }
+
+  msg.str("");
+  double log_prob(0);
+  try {
+    // we evaluate the log_prob function with propto=false
+    // because we're evaluating with `double` as the type of
+    // the parameters.
+    log_prob = model.template log_prob<false, Jacobian>(unconstrained,
+                                                        disc_vector, &msg);
+    if (msg.str().length() > 0)
+      logger.info(msg);
+  } catch (std::domain_error& e) {
+    log_init_rejection(e, msg, logger);
+    return false;
+  } catch (std::exception& e) {
+    log_init_error(msg, logger);
+    throw;
+  }
+  if (!std::isfinite(log_prob)) {
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Log probability evaluates to log(0),"
+        " i.e. negative infinity.");
+    logger.warn(
+        "  Stan can't start sampling from this"
+        " initial value.");
+    return false;
+  }
+  std::stringstream log_prob_msg;
+  std::vector<double> gradient;
+  auto start = std::chrono::steady_clock::now();
+  try {
+    // we evaluate this with propto=true since we're
+    // evaluating with autodiff variables
+    log_prob = stan::model::log_prob_grad<true, Jacobian>(
+        model, unconstrained, disc_vector, gradient, &log_prob_msg);
+  } catch (const std::exception& e) {
+    if (log_prob_msg.str().length() > 0)
+      logger.info(log_prob_msg);
+    logger.error(e.what());
+    throw;
+  }
+  auto end = std::chrono::steady_clock::now();
+  double deltaT
+      = std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+            .count()
+        / 1000000.0;
+  if (log_prob_msg.str().length() > 0)
+    logger.info(log_prob_msg);
+
+  bool gradient_ok = std::isfinite(stan::math::sum(gradient));
+
+  if (!gradient_ok) {
+    logger.warn("Rejecting initial value:");
+    logger.warn(
+        "  Gradient evaluated at the initial value"
+        " is not finite.");
+    logger.warn(
+        "  Stan can't start sampling from this"
+        " initial value.");
+  }
+  if (gradient_ok && print_timing) {
+    logger.info("");
+    std::stringstream msg1;
+    msg1 << "Gradient evaluation took " << deltaT << " seconds";
+    logger.info(msg1);
+
+    std::stringstream msg2;
+    msg2 << "1000 transitions using 10 leapfrog steps"
+         << " per transition would take"
+         << " " << 1e4 * deltaT << " seconds.";
+    logger.info(msg2);
+
+    logger.info("Adjust your expectations accordingly!");
+    logger.info("");
+    logger.info("");
+  }
+  return gradient_ok;
+}
+
+}  // namespace internal
+
 /**
  * Returns a valid initial value of the parameters of the model
  * on the unconstrained scale.
@@ -39,6 +227,17 @@ namespace util {
  * parameters that are valid or it hits <code>MAX_INIT_TRIES =
  * 100</code> (hard-coded).
  *
+ * With <code>max_batch_size</code> greater than one, the random
+ * initial values are tried in speculative batches evaluated in
+ * parallel.  The first batch holds one value and each following batch
+ * twice as many as the previous one, up to <code>max_batch_size</code>,
+ * so a model whose first initial value is valid is evaluated only once.
+ * The values are still drawn one after the other from <code>rng</code>,
+ * the first valid one is selected, and <code>rng</code> is left as if
+ * the later values had never been drawn, so the initial value, the
+ * messages, and the state of <code>rng</code> afterwards do not depend
+ * on the batch size.
+ *
  * Valid initialization is defined as a finite, non-NaN value for the
  * evaluation of the log probability density function and all its
  * gradients.
@@ -58,6 +257,8 @@ namespace util {
  *   be printed to the logger
  * @param[in,out] logger logger for messages
  * @param[in,out] init_writer init writer (on the unconstrained scale)
+ * @param[in] max_batch_size largest number of initial values evaluated
+ *   in parallel (optional, default == 1)
  * @throws exception passed through from the model if the model has a
  *   fatal error (not a std::domain_error)
  * @throws std::domain_error if the model can not be initialized and
@@ -70,10 +271,8 @@ template <bool Jacobian = true, typename Model, typename InitContext,
 std::vector<double> initialize(Model& model, const InitContext& init, RNG& rng,
                                double init_radius, bool print_timing,
                                stan::callbacks::logger& logger,
-                               stan::callbacks::writer& init_writer) {
-  std::vector<double> unconstrained;
-  std::vector<int> disc_vector;
-
+                               stan::callbacks::writer& init_writer,
+                               size_t max_batch_size = 1) {
   bool is_fully_initialized = true;
   bool any_initialized = false;
   std::vector<std::string> param_names;
@@ -88,127 +287,82 @@ std::vector<double> initialize(Model& model, const InitContext& init, RNG& rng,
   int MAX_INIT_TRIES
       = is_fully_initialized || is_initialized_with_zero ? 1 : 100;
   int num_init_tries = 0;
-  for (; num_init_tries < MAX_INIT_TRIES; num_init_tries++) {
-    std::stringstream msg;
-    try {
-      stan::io::random_var_context random_context(model, rng, init_radius,
-                                                  is_initialized_with_zero);
-
-      if (!any_initialized) {
-        unconstrained = random_context.get_unconstrained();
-      } else {
-        stan::io::chained_var_context context(init, random_context);
-
-        model.transform_inits(context, disc_vector, unconstrained, &msg);
+  size_t batch_size = 1;
+  while (num_init_tries < MAX_INIT_TRIES) {
+    // Draw the random values of the batch in order, stopping at a fatal
+    // error as the serial tries would
+    std::vector<internal::init_candidate<RNG>> candidates;
+    const size_t num_candidates
+        = std::min<size_t>(batch_size, MAX_INIT_TRIES - num_init_tries);
+    candidates.reserve(num_candidates);
+    for (size_t i = 0; i < num_candidates; ++i) {
+      std::unique_ptr<stan::io::random_var_context> random_context;
+      std::exception_ptr error;
+      bool fatal = false;
+      try {
+        random_context = std::make_unique<stan::io::random_var_context>(
+            model, rng, init_radius, is_initialized_with_zero);
+      } catch (std::domain_error& e) {
+        error = std::current_exception();
+      } catch (std::exception& e) {
+        error = std::current_exception();
+        fatal = true;
       }
-    } catch (std::domain_error& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Error evaluating the log probability"
-          " at the initial value.");
-      logger.warn(e.what());
-      continue;
-    } catch (std::exception& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.error(
-          "Unrecoverable error evaluating the log probability"
-          " at the initial value.");
-      throw;
+      candidates.emplace_back(rng);
+      candidates.back().random_context = std::move(random_context);
+      candidates.back().error = error;
+      if (fatal)
+        break;
     }
 
-    msg.str("");
-    double log_prob(0);
-    try {
-      // we evaluate the log_prob function with propto=false
-      // because we're evaluating with `double` as the type of
-      // the parameters.
-      log_prob = model.template log_prob<false, Jacobian>(unconstrained,
-                                                          disc_vector, &msg);
-      if (msg.str().length() > 0)
-        logger.info(msg);
-    } catch (std::domain_error& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Error evaluating the log probability"
-          " at the initial value.");
-      logger.warn(e.what());
-      continue;
-    } catch (std::exception& e) {
-      if (msg.str().length() > 0)
-        logger.info(msg);
-      logger.error(
-          "Unrecoverable error evaluating the log probability"
-          " at the initial value.");
-      throw;
-    }
-    if (!std::isfinite(log_prob)) {
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Log probability evaluates to log(0),"
-          " i.e. negative infinity.");
-      logger.warn(
-          "  Stan can't start sampling from this"
-          " initial value.");
-      continue;
-    }
-    std::stringstream log_prob_msg;
-    std::vector<double> gradient;
-    auto start = std::chrono::steady_clock::now();
-    try {
-      // we evaluate this with propto=true since we're
-      // evaluating with autodiff variables
-      log_prob = stan::model::log_prob_grad<true, Jacobian>(
-          model, unconstrained, disc_vector, gradient, &log_prob_msg);
-    } catch (const std::exception& e) {
-      if (log_prob_msg.str().length() > 0)
-        logger.info(log_prob_msg);
-      logger.error(e.what());
-      throw;
+    auto evaluate = [&model, &init, any_initialized, print_timing,
+                     &candidates](size_t i) {
+      auto& candidate = candidates[i];
+      if (!candidate.random_context)
+        return;
+      try {
+        candidate.valid = internal::evaluate_init<Jacobian>(
+            model, init, any_initialized, *candidate.random_context,
+            print_timing, candidate.unconstrained, candidate.log);
+      } catch (...) {
+        candidate.error = std::current_exception();
+      }
+    };
+    if (candidates.size() == 1) {
+      evaluate(0);
+    } else {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, candidates.size()),
+                        [&evaluate](const tbb::blocked_range<size_t>& r) {
+                          for (size_t i = r.begin(); i != r.end(); ++i)
+                            evaluate(i);
+                        });
     }
-    auto end = std::chrono::steady_clock::now();
-    double deltaT
-        = std::chrono::duration_cast<std::chrono::microseconds>(end - start)
-              .count()
-          / 1000000.0;
-    if (log_prob_msg.str().length() > 0)
-      logger.info(log_prob_msg);
-
-    bool gradient_ok = std::isfinite(stan::math::sum(gradient));
 
-    if (!gradient_ok) {
-      logger.warn("Rejecting initial value:");
-      logger.warn(
-          "  Gradient evaluated at the initial value"
-          " is not finite.");
-      logger.warn(
-          "  Stan can't start sampling from this"
-          " initial value.");
-    }
-    if (gradient_ok && print_timing) {
-      logger.info("");
-      std::stringstream msg1;
-      msg1 << "Gradient evaluation took " << deltaT << " seconds";
-      logger.info(msg1);
-
-      std::stringstream msg2;
-      msg2 << "1000 transitions using 10 leapfrog steps"
-           << " per transition would take"
-           << " " << 1e4 * deltaT << " seconds.";
-      logger.info(msg2);
-
-      logger.info("Adjust your expectations accordingly!");
-      logger.info("");
-      logger.info("");
-    }
-    if (gradient_ok) {
-      init_writer(unconstrained);
-      return unconstrained;
+    // Select the first valid candidate, logging the candidates before it
+    // as the serial tries would have
+    for (auto& candidate : candidates) {
+      ++num_init_tries;
+      rng = candidate.rng;
+      if (!candidate.random_context) {
+        try {
+          std::rethrow_exception(candidate.error);
+        } catch (std::domain_error& e) {
+          internal::log_init_rejection(e, std::stringstream(), logger);
+          continue;
+        } catch (std::exception& e) {
+          internal::log_init_error(std::stringstream(), logger);
+          throw;
+        }
+      }
+      candidate.log.replay(logger);
+      if (candidate.error)
+        std::rethrow_exception(candidate.error);
+      if (candidate.valid) {
+        init_writer(candidate.unconstrained);
+        return candidate.unconstrained;
+      }
     }
+    batch_size = std::min(2 * batch_size, std::max<size_t>(max_batch_size, 1));
   }
 
   if (!is_initialized_with_zero) {
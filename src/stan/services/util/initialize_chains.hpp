@@ -0,0 +1,87 @@
+#ifndef STAN_SERVICES_UTIL_INITIALIZE_CHAINS_HPP
+#define STAN_SERVICES_UTIL_INITIALIZE_CHAINS_HPP
+
+#include <stan/callbacks/buffer_logger.hpp>
+#include <stan/callbacks/logger.hpp>
+#include <stan/services/util/initialize.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <exception>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Returns valid initial values of the parameters of the model on the
+ * unconstrained scale for several chains, initializing the chains in
+ * parallel.
+ *
+ * Each chain is initialized by <code>initialize</code> with its own
+ * initial values, random number generator and init writer.  The
+ * messages of each chain are kept until every chain is done and then
+ * logged chain after chain, so they appear in the same order as if the
+ * chains had been initialized one after the other.  If a chain fails,
+ * the messages of the chains before it and its own are logged and its
+ * exception is rethrown.
+ *
+ * @tparam Jacobian indicates whether to include the Jacobian term when
+ *   evaluating the log density function
+ * @tparam Model the type of the model class
+ * @tparam InitContextPtr pointer to a var_context with initial values
+ * @tparam RNG the type of the random number generator
+ * @tparam InitWriter the type of the init writers
+ *
+ * @param[in] model the model
+ * @param[in] init var_contexts with initial values, one per chain
+ * @param[in,out] rngs random number generators, one per chain
+ * @param[in] init_radius the radius for generating random values
+ * @param[in] print_timing indicates whether a timing message should
+ *   be printed to the logger
+ * @param[in,out] logger logger for messages
+ * @param[in,out] init_writer init writers (on the unconstrained scale),
+ *   one per chain
+ * @param[in] max_batch_size largest number of initial values of a chain
+ *   evaluated in parallel (optional, default == 1)
+ * @throws exception thrown by <code>initialize</code> for the first
+ *   chain which fails
+ * @return valid unconstrained parameters for each chain
+ */
+template <bool Jacobian = true, typename Model, typename InitContextPtr,
+          typename RNG, typename InitWriter>
+std::vector<std::vector<double>> initialize_chains(
+    Model& model, const std::vector<InitContextPtr>& init,
+    std::vector<RNG>& rngs, double init_radius, bool print_timing,
+    stan::callbacks::logger& logger, std::vector<InitWriter>& init_writer,
+    size_t max_batch_size = 1) {
+  const size_t num_chains = rngs.size();
+  std::vector<std::vector<double>> cont_vectors(num_chains);
+  std::vector<stan::callbacks::buffer_logger> loggers(num_chains);
+  std::vector<std::exception_ptr> errors(num_chains);
+  tbb::parallel_for(
+      tbb::blocked_range<size_t>(0, num_chains, 1),
+      [&](const tbb::blocked_range<size_t>& r) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          try {
+            cont_vectors[i] = initialize<Jacobian>(
+                model, *init[i], rngs[i], init_radius, print_timing,
+                loggers[i], init_writer[i], max_batch_size);
+          } catch (...) {
+            errors[i] = std::current_exception();
+          }
+        }
+      },
+      tbb::simple_partitioner());
+  for (size_t i = 0; i < num_chains; ++i) {
+    loggers[i].replay(logger);
+    if (errors[i])
+      std::rethrow_exception(errors[i]);
+  }
+  return cont_vectors;
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+#endif
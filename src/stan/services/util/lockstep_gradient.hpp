@@ -0,0 +1,241 @@
+#ifndef STAN_SERVICES_UTIL_LOCKSTEP_GRADIENT_HPP
+#define STAN_SERVICES_UTIL_LOCKSTEP_GRADIENT_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/prim/fun/Eigen.hpp>
+#include <stan/mcmc/hmc/hamiltonians/gradient_evaluator.hpp>
+#include <tbb/task_arena.h>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Collects the gradient requests of several chains running in
+ * lockstep and evaluates them with a single call to the model's
+ * <code>log_prob_grad_batch</code>.
+ *
+ * Each chain runs on its own thread and evaluates gradients through
+ * its <code>evaluator(chain)</code>.  A request blocks until every
+ * active chain has posted one, at which point the last chain to
+ * arrive evaluates the whole batch and releases the others, so the
+ * chains advance one gradient evaluation (one leapfrog step) at a
+ * time.  Chains take part only between <code>begin_chain</code> and
+ * <code>end_chain</code>, so a chain that has finished sampling, or
+ * that has not started yet, never holds up the others.  An exception
+ * raised at one chain's point, such as <code>std::domain_error</code>
+ * for a point that is rejected, is rethrown to that chain alone, so
+ * its Hamiltonian handles it as when evaluating the model directly.
+ *
+ * @tparam Model model class, providing <code>log_prob_grad_batch</code>
+ */
+template <class Model>
+class lockstep_gradient {
+ public:
+  /**
+   * Gradient evaluator for one chain, forwarding to the lockstep
+   * batch.
+   */
+  class chain_evaluator : public mcmc::gradient_evaluator {
+   public:
+    chain_evaluator(lockstep_gradient& batch, size_t chain)
+        : batch_(batch), chain_(chain) {}
+
+    void operator()(const Eigen::VectorXd& q, double& lp,
+                    Eigen::VectorXd& grad, callbacks::logger& logger) {
+      batch_.evaluate(chain_, q, lp, grad, logger);
+    }
+
+   private:
+    lockstep_gradient& batch_;
+    size_t chain_;
+  };
+
+  /**
+   * Construct a lockstep batch for the specified number of chains.
+   *
+   * @param[in] model model whose log density is evaluated
+   * @param[in] num_chains number of chains
+   */
+  lockstep_gradient(const Model& model, size_t num_chains)
+      : model_(model),
+        params_r_(model.num_params_r(), num_chains),
+        log_probs_(num_chains),
+        gradients_(model.num_params_r(), num_chains),
+        pending_(num_chains, false),
+        errors_(num_chains),
+        num_active_(0),
+        num_pending_(0),
+        num_batches_(0) {
+    evaluators_.reserve(num_chains);
+    for (size_t i = 0; i < num_chains; ++i)
+      evaluators_.emplace_back(*this, i);
+  }
+
+  /**
+   * Return the gradient evaluator for the specified chain.
+   *
+   * @param[in] chain index of the chain
+   * @return evaluator to install in that chain's sampler
+   */
+  chain_evaluator& evaluator(size_t chain) { return evaluators_[chain]; }
+
+  /**
+   * Register a chain as running, so that batches wait for it.
+   */
+  void begin_chain() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++num_active_;
+  }
+
+  /**
+   * Deregister a chain that has stopped running.  If every remaining
+   * chain is already waiting, their batch is evaluated now.
+   *
+   * @param[in,out] logger logger for messages
+   */
+  void end_chain(callbacks::logger& logger) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --num_active_;
+    if (num_pending_ > 0 && num_pending_ == num_active_)
+      evaluate_pending(logger);
+  }
+
+  /**
+   * Return the number of batches evaluated so far.
+   */
+  size_t num_batches() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return num_batches_;
+  }
+
+  /**
+   * Post the specified point for a chain and block until the batch it
+   * belongs to has been evaluated.
+   *
+   * @param[in] chain index of the chain
+   * @param[in] q unconstrained parameters
+   * @param[out] lp log density
+   * @param[out] grad gradient of the log density
+   * @param[in,out] logger logger for messages
+   */
+  void evaluate(size_t chain, const Eigen::VectorXd& q, double& lp,
+                Eigen::VectorXd& grad, callbacks::logger& logger) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    params_r_.col(chain) = q;
+    pending_[chain] = true;
+    ++num_pending_;
+    if (num_pending_ == num_active_) {
+      evaluate_pending(logger);
+    } else {
+      const size_t batch = num_batches_;
+      ready_.wait(lock, [this, batch] { return num_batches_ != batch; });
+    }
+    if (errors_[chain]) {
+      std::exception_ptr error = errors_[chain];
+      errors_[chain] = nullptr;
+      std::rethrow_exception(error);
+    }
+    lp = log_probs_.coeff(chain);
+    grad = gradients_.col(chain);
+  }
+
+ private:
+  /**
+   * Evaluate all pending points in one call to the model, scatter the
+   * results back to their chains and wake the waiting chains.  Must be
+   * called with the mutex held.
+   */
+  void evaluate_pending(callbacks::logger& logger) {
+    batch_chains_.clear();
+    for (size_t i = 0; i < pending_.size(); ++i)
+      if (pending_[i])
+        batch_chains_.push_back(i);
+    const Eigen::Index batch_size = batch_chains_.size();
+    batch_params_r_.resize(params_r_.rows(), batch_size);
+    for (Eigen::Index n = 0; n < batch_size; ++n)
+      batch_params_r_.col(n) = params_r_.col(batch_chains_[n]);
+
+    // Isolated so that a model using TBB internally cannot pick up
+    // another chain's task on this thread while the lock is held
+    tbb::this_task_arena::isolate([&] {
+      std::stringstream msg;
+      try {
+        model_.log_prob_grad_batch(batch_params_r_, true, true,
+                                   batch_log_probs_, batch_gradients_, &msg);
+      } catch (...) {
+        // Evaluate the points one at a time, so that each chain gets
+        // its own result or exception just as if it had evaluated its
+        // gradient directly
+        msg.str("");
+        batch_log_probs_.resize(batch_size);
+        batch_gradients_.resize(params_r_.rows(), batch_size);
+        for (Eigen::Index n = 0; n < batch_size; ++n)
+          evaluate_one(n, msg);
+      }
+      if (msg.str().length() > 0)
+        logger.info(msg);
+    });
+
+    for (Eigen::Index n = 0; n < batch_size; ++n) {
+      const size_t chain = batch_chains_[n];
+      if (!errors_[chain]) {
+        log_probs_.coeffRef(chain) = batch_log_probs_.coeff(n);
+        gradients_.col(chain) = batch_gradients_.col(n);
+      }
+      pending_[chain] = false;
+    }
+    num_pending_ = 0;
+    ++num_batches_;
+    ready_.notify_all();
+  }
+
+  /**
+   * Evaluate a single point of the pending batch, recording the
+   * exception it throws, if any, for its chain.
+   *
+   * @param[in] n index of the point in the batch
+   * @param[in,out] msg stream to which messages are written
+   */
+  void evaluate_one(Eigen::Index n, std::stringstream& msg) {
+    Eigen::MatrixXd params_r = batch_params_r_.col(n);
+    Eigen::VectorXd log_prob;
+    Eigen::MatrixXd gradient;
+    try {
+      model_.log_prob_grad_batch(params_r, true, true, log_prob, gradient,
+                                 &msg);
+      batch_log_probs_.coeffRef(n) = log_prob.coeff(0);
+      batch_gradients_.col(n) = gradient.col(0);
+    } catch (...) {
+      errors_[batch_chains_[n]] = std::current_exception();
+    }
+  }
+
+  const Model& model_;
+  std::vector<chain_evaluator> evaluators_;
+  Eigen::MatrixXd params_r_;
+  Eigen::VectorXd log_probs_;
+  Eigen::MatrixXd gradients_;
+  std::vector<bool> pending_;
+  std::vector<std::exception_ptr> errors_;
+  std::vector<size_t> batch_chains_;
+  Eigen::MatrixXd batch_params_r_;
+  Eigen::VectorXd batch_log_probs_;
+  Eigen::MatrixXd batch_gradients_;
+  size_t num_active_;
+  size_t num_pending_;
+  size_t num_batches_;
+  mutable std::mutex mutex_;
+  std::condition_variable ready_;
+};
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
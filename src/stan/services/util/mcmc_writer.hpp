@@ -24,6 +24,7 @@ class mcmc_writer {
   callbacks::writer& sample_writer_;
   callbacks::writer& diagnostic_writer_;
   callbacks::logger& logger_;
+  std::vector<double> sample_values_;
 
  public:
   size_t num_sample_params_;
@@ -97,7 +98,8 @@ class mcmc_writer {
   template <class Model, class RNG>
   void write_sample_params(RNG& rng, stan::mcmc::sample& sample,
                            stan::mcmc::base_mcmc& sampler, Model& model) {
-    std::vector<double> values;
+    std::vector<double>& values = sample_values_;
+    values.clear();
 
     sample.get_sample_params(values);
     sampler.get_sampler_params(values);
@@ -134,6 +136,15 @@ class mcmc_writer {
     sample_writer_(values);
   }
 
+  /**
+   * Return the values most recently written by
+   * <code>write_sample_params</code>: the sample params, the sampler
+   * params and the constrained model values, in that order.
+   */
+  const std::vector<double>& last_sample_params() const {
+    return sample_values_;
+  }
+
   /**
    * Prints additional info to the streams
    *
@@ -145,6 +156,18 @@ class mcmc_writer {
     sample_writer_("Adaptation terminated");
   }
 
+  /**
+   * Print the number of warmup iterations run when the adaptation
+   * converged before the configured number of warmup iterations.
+   *
+   * @param num_warmup number of warmup iterations run
+   */
+  void write_num_warmup(int num_warmup) {
+    std::stringstream ss;
+    ss << "Warmup converged after " << num_warmup << " iterations";
+    sample_writer_(ss.str());
+  }
+
   /**
    * Print diagnostic names
    *
@@ -9,6 +9,7 @@
 #include <tbb/parallel_for.h>
 #include <chrono>
 #include <iostream>
+#include <sstream>
 #include <vector>
 
 namespace stan {
@@ -37,11 +38,14 @@ namespace util {
  * @param[in,out] logger logger for messages
  * @param[in,out] sample_writer writer for draws
  * @param[in,out] diagnostic_writer writer for diagnostic information
- * @param[in,out] metric_writer writer for adapted stepsize, metric
+ * @param[in,out] metric_writer writer for adapted stepsize, metric and,
+ *   if warmup may end early, the number of warmup iterations run
  * @param[in] chain_id The id for a given chain, (optional, default == 1)
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number,
  *  (optional, default == 1)
+ * @param[in,out] monitor convergence monitor fed with the post-warmup
+ *  draws, which may stop sampling early (optional, default == nullptr)
  */
 template <typename Sampler, typename Model, typename RNG>
 void run_adaptive_sampler(Sampler& sampler, Model& model,
@@ -53,7 +57,8 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
                           callbacks::writer& sample_writer,
                           callbacks::writer& diagnostic_writer,
                           callbacks::structured_writer& metric_writer,
-                          size_t chain_id = 1, size_t num_chains = 1) {
+                          size_t chain_id = 1, size_t num_chains = 1,
+                          convergence_monitor* monitor = nullptr) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
 
@@ -75,30 +80,40 @@ void run_adaptive_sampler(Sampler& sampler, Model& model,
   writer.write_diagnostic_names(s, sampler, model);
 
   auto start_warm = std::chrono::steady_clock::now();
-  util::generate_transitions(sampler, num_warmup, 0, num_warmup + num_samples,
-                             num_thin, refresh, save_warmup, true, writer, s,
-                             model, rng, interrupt, logger, chain_id,
-                             num_chains);
+  int num_warmup_run = util::generate_transitions(
+      sampler, num_warmup, 0, num_warmup + num_samples, num_thin, refresh,
+      save_warmup, true, writer, s, model, rng, interrupt, logger, chain_id,
+      num_chains, nullptr, &sampler);
   auto end_warm = std::chrono::steady_clock::now();
   double warm_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                             end_warm - start_warm)
                             .count()
                         / 1000.0;
   sampler.disengage_adaptation();
+  if (num_warmup_run < num_warmup) {
+    std::stringstream msg;
+    msg << "Warmup converged after " << num_warmup_run << " iterations";
+    if (num_chains != 1)
+      msg << " in chain " << chain_id;
+    logger.info(msg);
+  }
   writer.write_adapt_finish(sampler);
   sampler.write_sampler_state(sample_writer);
-  sampler.write_sampler_state_struct(metric_writer);
+  sampler.write_sampler_state_struct(
+      metric_writer, sampler.adaptive_warmup() ? num_warmup_run : -1);
 
   auto start_sample = std::chrono::steady_clock::now();
-  util::generate_transitions(sampler, num_samples, num_warmup,
-                             num_warmup + num_samples, num_thin, refresh, true,
-                             false, writer, s, model, rng, interrupt, logger,
-                             chain_id, num_chains);
+  util::generate_transitions(sampler, num_samples, num_warmup_run,
+                             num_warmup_run + num_samples, num_thin, refresh,
+                             true, false, writer, s, model, rng, interrupt,
+                             logger, chain_id, num_chains, monitor);
   auto end_sample = std::chrono::steady_clock::now();
   double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                               end_sample - start_sample)
                               .count()
                           / 1000.0;
+  if (num_warmup_run < num_warmup)
+    writer.write_num_warmup(num_warmup_run);
   writer.write_timing(warm_delta_t, sample_delta_t);
 }
 
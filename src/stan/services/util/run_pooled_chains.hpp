@@ -0,0 +1,66 @@
+#ifndef STAN_SERVICES_UTIL_RUN_POOLED_CHAINS_HPP
+#define STAN_SERVICES_UTIL_RUN_POOLED_CHAINS_HPP
+
+#include <stan/math/rev.hpp>
+#include <stan/mcmc/pooled_adaptation.hpp>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace stan {
+namespace services {
+namespace util {
+
+/**
+ * Runs the chains of a pooled adaptation, each on its own thread.
+ *
+ * The chains of a pool wait for each other at the end of every
+ * adaptation window, so they must all run at the same time; a task
+ * scheduler with fewer threads than chains would leave them waiting for
+ * chains that never start.  Each chain leaves the pool when it returns
+ * or throws, so the others do not wait for it.
+ *
+ * For the same reason the chains run on one thread each rather than as
+ * TBB tasks, so a pool always uses as many threads as it has chains,
+ * whatever the TBB concurrency limit.  The autodiff stack is only set
+ * up by TBB for its own worker threads, so each thread sets up its own
+ * stack before running its chain.  As for the other multi-chain
+ * services, the stack must be thread local (<code>STAN_THREADS</code>)
+ * for the chains to take gradients concurrently.
+ *
+ * @tparam F type of the callable running one chain
+ * @param[in,out] pool pool shared by the chains
+ * @param[in] run_chain callable taking the index of the chain to run
+ * @throw the first exception thrown by a chain, after all chains are done
+ */
+template <typename F>
+void run_pooled_chains(stan::mcmc::pooled_adaptation& pool,
+                       const F& run_chain) {
+  const std::size_t num_chains = pool.num_chains();
+  std::vector<std::exception_ptr> errors(num_chains);
+  std::vector<std::thread> threads;
+  threads.reserve(num_chains);
+  for (std::size_t i = 0; i < num_chains; ++i) {
+    threads.emplace_back([i, &pool, &run_chain, &errors] {
+      stan::math::ChainableStack thread_stack;
+      try {
+        run_chain(i);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+      pool.leave(i);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  for (const auto& error : errors)
+    if (error)
+      std::rethrow_exception(error);
+}
+
+}  // namespace util
+}  // namespace services
+}  // namespace stan
+
+#endif
@@ -35,6 +35,8 @@ namespace util {
  * @param[in] chain_id The id for a given chain.
  * @param[in] num_chains The number of chains used in the program. This
  *  is used in generate transitions to print out the chain number.
+ * @param[in,out] monitor convergence monitor fed with the post-warmup
+ *  draws, which may stop sampling early (optional, default == nullptr)
  */
 template <class Model, class RNG>
 void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
@@ -43,7 +45,8 @@ void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
                  RNG& rng, callbacks::interrupt& interrupt,
                  callbacks::logger& logger, callbacks::writer& sample_writer,
                  callbacks::writer& diagnostic_writer, size_t chain_id = 1,
-                 size_t num_chains = 1) {
+                 size_t num_chains = 1,
+                 convergence_monitor* monitor = nullptr) {
   Eigen::Map<Eigen::VectorXd> cont_params(cont_vector.data(),
                                           cont_vector.size());
   services::util::mcmc_writer writer(sample_writer, diagnostic_writer, logger);
@@ -70,7 +73,7 @@ void run_sampler(stan::mcmc::base_mcmc& sampler, Model& model,
   util::generate_transitions(sampler, num_samples, num_warmup,
                              num_warmup + num_samples, num_thin, refresh, true,
                              false, writer, s, model, rng, interrupt, logger,
-                             chain_id, num_chains);
+                             chain_id, num_chains, monitor);
   auto end_sample = std::chrono::steady_clock::now();
   double sample_delta_t = std::chrono::duration_cast<std::chrono::milliseconds>(
                               end_sample - start_sample)
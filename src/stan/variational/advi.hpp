@@ -4,18 +4,23 @@
 #include <stan/math.hpp>
 #include <stan/callbacks/logger.hpp>
 #include <stan/callbacks/writer.hpp>
+#include <stan/callbacks/stream_logger.hpp>
 #include <stan/callbacks/stream_writer.hpp>
 #include <stan/services/error_codes.hpp>
 #include <stan/variational/print_progress.hpp>
 #include <stan/variational/families/normal_fullrank.hpp>
 #include <stan/variational/families/normal_meanfield.hpp>
+#include <stan/variational/parallel_monte_carlo.hpp>
 #include <boost/circular_buffer.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <algorithm>
 #include <chrono>
 #include <limits>
 #include <numeric>
 #include <ostream>
 #include <queue>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -47,6 +52,13 @@ class advi {
    * @param[in] n_monte_carlo_elbo number of samples for ELBO computation
    * @param[in] eval_elbo evaluate ELBO at every "eval_elbo" iters
    * @param[in] n_posterior_samples number of samples to draw from posterior
+   * @param[in] parallel_monte_carlo whether to evaluate the Monte Carlo
+   * draws of the ELBO and its gradient in parallel
+   * @param[in] concurrent_eta_adaptation whether to try all the eta
+   * candidates of <code>adapt_eta</code> concurrently
+   * @param[in] eta_early_exit whether concurrent eta adaptation chooses
+   * eta with the early exit rule of the sequential search, rather than
+   * choosing the eta with the highest ELBO
    * @throw std::runtime_error if n_monte_carlo_grad is not positive
    * @throw std::runtime_error if n_monte_carlo_elbo is not positive
    * @throw std::runtime_error if eval_elbo is not positive
@@ -54,14 +66,18 @@ class advi {
    */
   advi(Model& m, Eigen::VectorXd& cont_params, BaseRNG& rng,
        int n_monte_carlo_grad, int n_monte_carlo_elbo, int eval_elbo,
-       int n_posterior_samples)
+       int n_posterior_samples, bool parallel_monte_carlo = false,
+       bool concurrent_eta_adaptation = false, bool eta_early_exit = true)
       : model_(m),
         cont_params_(cont_params),
         rng_(rng),
         n_monte_carlo_grad_(n_monte_carlo_grad),
         n_monte_carlo_elbo_(n_monte_carlo_elbo),
         eval_elbo_(eval_elbo),
-        n_posterior_samples_(n_posterior_samples) {
+        n_posterior_samples_(n_posterior_samples),
+        parallel_monte_carlo_(parallel_monte_carlo),
+        concurrent_eta_adaptation_(concurrent_eta_adaptation),
+        eta_early_exit_(eta_early_exit) {
     static const char* function = "stan::variational::advi";
     math::check_positive(function,
                          "Number of Monte Carlo samples for gradients",
@@ -89,7 +105,28 @@ class advi {
    * that the variational distribution has somehow collapsed.
    */
   double calc_ELBO(const Q& variational, callbacks::logger& logger) const {
+    return calc_ELBO(variational, rng_, logger);
+  }
+
+  /**
+   * Calculates the ELBO like <code>calc_ELBO</code>, drawing from the
+   * variational distribution with the specified random number generator.
+   *
+   * @tparam RNG class of random number generator
+   * @param[in] variational variational approximation at which to evaluate
+   * the ELBO.
+   * @param[in,out] rng random number generator
+   * @param logger logger for messages
+   * @return the evidence lower bound.
+   * @throw std::domain_error If n_monte_carlo_elbo_ evaluations of the log
+   * joint are dropped.
+   */
+  template <class RNG>
+  double calc_ELBO(const Q& variational, RNG& rng,
+                   callbacks::logger& logger) const {
     static const char* function = "stan::variational::advi::calc_ELBO";
+    if (parallel_monte_carlo_)
+      return calc_ELBO_parallel(variational, rng, logger);
 
     double elbo = 0.0;
     int dim = variational.dimension();
@@ -97,7 +134,7 @@ class advi {
 
     int n_dropped_evaluations = 0;
     for (int i = 0; i < n_monte_carlo_elbo_;) {
-      variational.sample(rng_, zeta);
+      variational.sample(rng, zeta);
       try {
         std::stringstream ss;
         double log_prob = model_.template log_prob<false, true>(zeta, &ss);
@@ -124,6 +161,51 @@ class advi {
     return elbo;
   }
 
+  /**
+   * Calculates the ELBO like <code>calc_ELBO</code>, but draws from the
+   * variational distribution with a generator for each draw, transforms
+   * the draws together, and evaluates the log joint of the draws in
+   * parallel.  The log joints are summed in order of the draws, so the
+   * ELBO does not depend on the number of threads.
+   *
+   * @tparam RNG class of random number generator
+   * @param[in] variational variational approximation at which to evaluate
+   * the ELBO.
+   * @param[in,out] rng random number generator seeding the generators of
+   * the draws
+   * @param logger logger for messages
+   * @return the evidence lower bound.
+   * @throw std::domain_error If n_monte_carlo_elbo_ evaluations of the log
+   * joint are dropped.
+   */
+  template <class RNG>
+  double calc_ELBO_parallel(const Q& variational, RNG& rng,
+                            callbacks::logger& logger) const {
+    static const char* function = "stan::variational::advi::calc_ELBO";
+
+    parallel_monte_carlo draws(rng, n_monte_carlo_elbo_);
+    Eigen::MatrixXd zeta = variational.transform_draws(
+        draws.standard_normal(variational.dimension()));
+    Eigen::VectorXd log_probs(n_monte_carlo_elbo_);
+    draws.evaluate(
+        [&](int i, int attempt, std::ostream& msgs) {
+          Eigen::VectorXd zeta_i = zeta.col(i);
+          if (attempt > 0)
+            variational.sample(draws.rng(i), zeta_i);
+          try {
+            double log_prob
+                = model_.template log_prob<false, true>(zeta_i, &msgs);
+            stan::math::check_finite(function, "log_prob", log_prob);
+            log_probs(i) = log_prob;
+            return true;
+          } catch (const std::domain_error& e) {
+            return false;
+          }
+        },
+        n_monte_carlo_elbo_, function, logger);
+    return log_probs.sum() / n_monte_carlo_elbo_ + variational.entropy();
+  }
+
   /**
    * Calculates the "black box" gradient of the ELBO.
    *
@@ -135,6 +217,24 @@ class advi {
    */
   void calc_ELBO_grad(const Q& variational, Q& elbo_grad,
                       callbacks::logger& logger) const {
+    calc_ELBO_grad(variational, elbo_grad, rng_, logger);
+  }
+
+  /**
+   * Calculates the "black box" gradient of the ELBO, drawing from the
+   * variational distribution with the specified random number generator.
+   *
+   * @tparam RNG class of random number generator
+   * @param[in] variational variational approximation at which to evaluate
+   * the ELBO.
+   * @param[out] elbo_grad gradient of ELBO with respect to variational
+   * approximation.
+   * @param[in,out] rng random number generator
+   * @param logger logger for messages
+   */
+  template <class RNG>
+  void calc_ELBO_grad(const Q& variational, Q& elbo_grad, RNG& rng,
+                      callbacks::logger& logger) const {
     static const char* function = "stan::variational::advi::calc_ELBO_grad";
 
     stan::math::check_size_match(
@@ -144,13 +244,22 @@ class advi {
         function, "Dimension of variational q", variational.dimension(),
         "Dimension of variables in model", cont_params_.size());
 
-    variational.calc_grad(elbo_grad, model_, cont_params_, n_monte_carlo_grad_,
-                          rng_, logger);
+    if (parallel_monte_carlo_)
+      variational.calc_grad_parallel(elbo_grad, model_, cont_params_,
+                                     n_monte_carlo_grad_, rng, logger);
+    else
+      variational.calc_grad(elbo_grad, model_, cont_params_,
+                            n_monte_carlo_grad_, rng, logger);
   }
 
   /**
    * Heuristic grid search to adapt eta to the scale of the problem.
    *
+   * The proposed values of eta are tried in sequence from the largest
+   * down, stopping once the ELBO gets worse, unless the concurrent eta
+   * adaptation given to the constructor is on, in which case all of them
+   * are tried at once (see <code>adapt_eta_concurrent</code>).
+   *
    * @param[in] variational initial variational distribution.
    * @param[in] adapt_iterations number of iterations to spend doing stochastic
    * gradient ascent at each proposed eta value.
@@ -189,6 +298,15 @@ class advi {
       stan::math::throw_domain_error(function, name, "", msg1);
     }
 
+    if (concurrent_eta_adaptation_) {
+      double eta_best = adapt_eta_concurrent(
+          variational, adapt_iterations,
+          std::vector<double>(eta_sequence, eta_sequence + eta_sequence_size),
+          elbo_init, logger);
+      variational = Q(cont_params_);
+      return eta_best;
+    }
+
     // Variational family to store gradients
     Q elbo_grad = Q(model_.num_params_r());
 
@@ -290,6 +408,186 @@ class advi {
     return eta_best;
   }
 
+  /**
+   * Tries all the proposed values of eta of <code>adapt_eta</code>
+   * concurrently.
+   *
+   * Every eta runs the stochastic gradient ascent of the sequential search
+   * from the same initial variational distribution, on its own autodiff
+   * stack and with its own random number generator, seeded from a stream
+   * seed taken from rng_ and the index of the eta, so the ELBOs do not
+   * depend on the number of threads.  Each eta records the ELBO every
+   * eval_elbo_ iterations and at the end, the former drawn with a second
+   * generator of its own so that they leave its ascent unchanged.  Once
+   * all are done, the messages and the ELBO trace of each eta are given
+   * to the logger in order of the sequence.
+   *
+   * If eta_early_exit_ is set, eta is chosen with the rule of the
+   * sequential search, as if the ELBOs had been found one at a time, and
+   * otherwise the eta with the highest ELBO is chosen.
+   *
+   * @param[in] variational initial variational distribution.
+   * @param[in] adapt_iterations number of iterations to spend doing
+   * stochastic gradient ascent at each proposed eta value.
+   * @param[in] eta_sequence proposed eta values, from largest to smallest
+   * @param[in] elbo_init ELBO at the initial variational distribution
+   * @param[in,out] logger logger for messages
+   * @return adapted (tuned) value of eta
+   * @throw std::domain_error If no proposed eta value improves on the
+   * initial ELBO.
+   */
+  double adapt_eta_concurrent(const Q& variational, int adapt_iterations,
+                              const std::vector<double>& eta_sequence,
+                              double elbo_init,
+                              callbacks::logger& logger) const {
+    static const char* function = "stan::variational::advi::adapt_eta";
+
+    const int eta_sequence_size = eta_sequence.size();
+    // Generators of the ascents, then of the ELBO traces
+    parallel_monte_carlo candidates(rng_, 2 * eta_sequence_size);
+    std::vector<double> elbos(eta_sequence_size);
+    std::vector<std::vector<double>> elbo_traces(eta_sequence_size);
+    std::vector<std::stringstream> info(eta_sequence_size);
+    std::vector<std::stringstream> warn(eta_sequence_size);
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, eta_sequence_size, 1),
+        [&](const tbb::blocked_range<int>& r) {
+          stan::math::ScopedChainableStack stack;
+          stack.execute([&] {
+            for (int k = r.begin(); k < r.end(); ++k) {
+              callbacks::stream_logger candidate_logger(
+                  info[k], info[k], warn[k], warn[k], warn[k]);
+              elbos[k] = adapt_eta_candidate(
+                  variational, eta_sequence[k], adapt_iterations,
+                  candidates.rng(k), candidates.rng(eta_sequence_size + k),
+                  elbo_traces[k], candidate_logger);
+            }
+          });
+        },
+        tbb::simple_partitioner());
+
+    for (int k = 0; k < eta_sequence_size; ++k) {
+      // stream_logger ends every message with a newline
+      std::string msgs = info[k].str();
+      if (!msgs.empty())
+        logger.info(msgs.substr(0, msgs.size() - 1));
+      msgs = warn[k].str();
+      if (!msgs.empty())
+        logger.warn(msgs.substr(0, msgs.size() - 1));
+      std::stringstream ss;
+      ss << "eta = " << eta_sequence[k] << ": ELBO = ";
+      for (size_t n = 0; n < elbo_traces[k].size(); ++n) {
+        if (n > 0)
+          ss << ", ";
+        if (elbo_traces[k][n] == -std::numeric_limits<double>::max())
+          ss << "diverged";
+        else
+          ss << elbo_traces[k][n];
+      }
+      logger.info(ss);
+    }
+
+    int k_best = -1;
+    bool earlier_than_expected = false;
+    if (eta_early_exit_) {
+      // Stop at the first eta whose ELBO is worse than the one before it,
+      // as long as that one improved on the initial ELBO
+      double elbo_best = -std::numeric_limits<double>::max();
+      int k = 0;
+      while (k < eta_sequence_size
+             && !(elbos[k] < elbo_best && elbo_best > elbo_init))
+        elbo_best = elbos[k++];
+      if (k < eta_sequence_size || elbo_best > elbo_init)
+        k_best = k - 1;
+      earlier_than_expected = k < eta_sequence_size - 1;
+    } else {
+      for (int k = 0; k < eta_sequence_size; ++k)
+        if (elbos[k] > elbo_init && (k_best < 0 || elbos[k] > elbos[k_best]))
+          k_best = k;
+    }
+    if (k_best < 0) {
+      const char* name = "All proposed step-sizes";
+      const char* msg1
+          = "failed. Your model may be either "
+            "severely ill-conditioned or misspecified.";
+      stan::math::throw_domain_error(function, name, "", msg1);
+    }
+
+    std::stringstream ss;
+    ss << "Success!"
+       << " Found best value [eta = " << eta_sequence[k_best] << "]";
+    if (earlier_than_expected)
+      ss << (" earlier than expected.");
+    else
+      ss << ".";
+    logger.info(ss);
+    logger.info("");
+    return eta_sequence[k_best];
+  }
+
+  /**
+   * Runs the stochastic gradient ascent of the grid search for eta at a
+   * single proposed value and returns the ELBO it reaches.
+   *
+   * @tparam RNG class of random number generator
+   * @param[in] variational initial variational distribution
+   * @param[in] eta proposed value of eta
+   * @param[in] adapt_iterations number of iterations of stochastic
+   * gradient ascent
+   * @param[in,out] rng random number generator
+   * @param[in,out] trace_rng random number generator for the ELBOs
+   * evaluated before the end of the ascent
+   * @param[out] elbo_trace the ELBO every eval_elbo_ iterations and after
+   * adaptation, the lowest double where it diverged
+   * @param[in,out] logger logger for messages
+   * @return the ELBO after adaptation, or the lowest double if it diverged
+   */
+  template <class RNG>
+  double adapt_eta_candidate(Q variational, double eta, int adapt_iterations,
+                             RNG& rng, RNG& trace_rng,
+                             std::vector<double>& elbo_trace,
+                             callbacks::logger& logger) const {
+    Q elbo_grad = Q(model_.num_params_r());
+    Q history_grad_squared = Q(model_.num_params_r());
+    double tau = 1.0;
+    double pre_factor = 0.9;
+    double post_factor = 0.1;
+
+    for (int iter_tune = 1; iter_tune <= adapt_iterations; ++iter_tune) {
+      try {
+        calc_ELBO_grad(variational, elbo_grad, rng, logger);
+      } catch (const std::domain_error& e) {
+        elbo_grad.set_to_zero();
+      }
+      if (iter_tune == 1) {
+        history_grad_squared += elbo_grad.square();
+      } else {
+        history_grad_squared = pre_factor * history_grad_squared
+                               + post_factor * elbo_grad.square();
+      }
+      double eta_scaled = eta / sqrt(static_cast<double>(iter_tune));
+      variational
+          += eta_scaled * elbo_grad / (tau + history_grad_squared.sqrt());
+
+      if (iter_tune % eval_elbo_ == 0 && iter_tune < adapt_iterations) {
+        try {
+          elbo_trace.push_back(calc_ELBO(variational, trace_rng, logger));
+        } catch (const std::domain_error& e) {
+          elbo_trace.push_back(-std::numeric_limits<double>::max());
+        }
+      }
+    }
+
+    double elbo;
+    try {
+      elbo = calc_ELBO(variational, rng, logger);
+    } catch (const std::domain_error& e) {
+      elbo = -std::numeric_limits<double>::max();
+    }
+    elbo_trace.push_back(elbo);
+    return elbo;
+  }
+
   /**
    * Runs stochastic gradient ascent with an adaptive stepsize sequence.
    *
@@ -560,6 +858,9 @@ class advi {
   int n_monte_carlo_elbo_;
   int eval_elbo_;
   int n_posterior_samples_;
+  bool parallel_monte_carlo_;
+  bool concurrent_eta_adaptation_;
+  bool eta_early_exit_;
 };
 }  // namespace variational
 }  // namespace stan
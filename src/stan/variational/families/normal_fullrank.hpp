@@ -5,6 +5,7 @@
 #include <stan/math/prim.hpp>
 #include <stan/model/gradient.hpp>
 #include <stan/variational/base_family.hpp>
+#include <stan/variational/parallel_monte_carlo.hpp>
 #include <algorithm>
 #include <ostream>
 #include <vector>
@@ -351,6 +352,26 @@ class normal_fullrank : public base_family {
     return (L_chol_ * eta) + mu_;
   }
 
+  /**
+   * Return the transform of each column of the specified matrix, computed
+   * with a single triangular matrix product.
+   *
+   * @param[in] eta Matrix whose columns are transformed.
+   * @throw std::domain_error If the number of rows does not match the
+   * dimensionality of this approximation.
+   * @return Matrix of transformed columns.
+   */
+  Eigen::MatrixXd transform_draws(const Eigen::MatrixXd& eta) const {
+    static const char* function
+        = "stan::variational::normal_fullrank::transform_draws";
+    stan::math::check_size_match(function, "Rows of input matrix",
+                                 eta.rows(), "Dimension of mean vector",
+                                 dimension());
+    Eigen::MatrixXd zeta = L_chol_.triangularView<Eigen::Lower>() * eta;
+    zeta.colwise() += mu_;
+    return zeta;
+  }
+
   template <class BaseRNG>
   void sample(BaseRNG& rng, Eigen::VectorXd& eta) const {
     // Draw from standard normal and transform to real-coordinate space
@@ -461,6 +482,81 @@ class normal_fullrank : public base_family {
     elbo_grad.set_mu(mu_grad);
     elbo_grad.set_L_chol(L_grad);
   }
+
+  /**
+   * Calculates the "blackbox" gradient with respect to the location
+   * vector (mu) and the cholesky factor of the scale matrix (L_chol),
+   * evaluating the Monte Carlo draws in parallel.
+   *
+   * The draws come from generators seeded by <code>rng</code> and the
+   * index of each draw, so the gradient does not depend on the number of
+   * threads, though it differs from that of <code>calc_grad</code>.  The
+   * draws are transformed together and the gradient with respect to
+   * L_chol is accumulated with a single matrix product.
+   *
+   * @tparam M Model class.
+   * @tparam BaseRNG Class of base random number generator.
+   * @param[in] elbo_grad Approximation to store "blackbox" gradient.
+   * @param[in] m Model.
+   * @param[in] cont_params Continuous parameters.
+   * @param[in] n_monte_carlo_grad Sample size for gradient computation.
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] logger logger for messages
+   * @throw std::domain_error If the number of divergent
+   * iterations exceeds its specified bounds.
+   */
+  template <class M, class BaseRNG>
+  void calc_grad_parallel(normal_fullrank& elbo_grad, M& m,
+                          Eigen::VectorXd& cont_params, int n_monte_carlo_grad,
+                          BaseRNG& rng, callbacks::logger& logger) const {
+    static const char* function
+        = "stan::variational::normal_fullrank::calc_grad_parallel";
+    stan::math::check_size_match(function, "Dimension of elbo_grad",
+                                 elbo_grad.dimension(),
+                                 "Dimension of variational q", dimension());
+    stan::math::check_size_match(function, "Dimension of variational q",
+                                 dimension(), "Dimension of variables in model",
+                                 cont_params.size());
+
+    parallel_monte_carlo draws(rng, n_monte_carlo_grad);
+    Eigen::MatrixXd eta = draws.standard_normal(dimension());
+    Eigen::MatrixXd zeta = transform_draws(eta);
+    Eigen::MatrixXd mu_grads(dimension(), n_monte_carlo_grad);
+
+    static const int n_retries = 10;
+    draws.evaluate(
+        [&](int i, int attempt, std::ostream& msgs) {
+          if (attempt > 0) {
+            for (int d = 0; d < dimension(); ++d)
+              eta(d, i) = stan::math::normal_rng(0, 1, draws.rng(i));
+            zeta.col(i) = transform(eta.col(i));
+          }
+          try {
+            double tmp_lp;
+            Eigen::VectorXd tmp_mu_grad;
+            stan::model::gradient(m, Eigen::VectorXd(zeta.col(i)), tmp_lp,
+                                  tmp_mu_grad, &msgs);
+            stan::math::check_finite(function, "Gradient of mu", tmp_mu_grad);
+            mu_grads.col(i) = tmp_mu_grad;
+            return true;
+          } catch (const std::exception& e) {
+            return false;
+          }
+        },
+        n_retries * n_monte_carlo_grad, function, logger);
+
+    Eigen::VectorXd mu_grad = mu_grads.rowwise().sum();
+    Eigen::MatrixXd L_grad = Eigen::MatrixXd::Zero(dimension(), dimension());
+    L_grad.triangularView<Eigen::Lower>() = mu_grads * eta.transpose();
+    mu_grad /= static_cast<double>(n_monte_carlo_grad);
+    L_grad /= static_cast<double>(n_monte_carlo_grad);
+
+    // Add gradient of entropy term
+    L_grad.diagonal().array() += L_chol_.diagonal().array().inverse();
+
+    elbo_grad.set_mu(mu_grad);
+    elbo_grad.set_L_chol(L_grad);
+  }
 };
 
 /**
@@ -5,6 +5,7 @@
 #include <stan/math/prim.hpp>
 #include <stan/model/gradient.hpp>
 #include <stan/variational/base_family.hpp>
+#include <stan/variational/parallel_monte_carlo.hpp>
 #include <algorithm>
 #include <ostream>
 #include <vector>
@@ -314,6 +315,25 @@ class normal_meanfield : public base_family {
     return eta.array().cwiseProduct(omega_.array().exp()) + mu_.array();
   }
 
+  /**
+   * Return the transform of each column of the specified matrix.
+   *
+   * @param[in] eta Matrix whose columns are transformed.
+   * @throw std::domain_error If the number of rows does not match the
+   * dimensionality of this approximation.
+   * @return Matrix of transformed columns.
+   */
+  Eigen::MatrixXd transform_draws(const Eigen::MatrixXd& eta) const {
+    static const char* function
+        = "stan::variational::normal_meanfield::transform_draws";
+    stan::math::check_size_match(function, "Dimension of mean vector",
+                                 dimension(), "Rows of input matrix",
+                                 eta.rows());
+    Eigen::MatrixXd zeta = omega_.array().exp().matrix().asDiagonal() * eta;
+    zeta.colwise() += mu_;
+    return zeta;
+  }
+
   /**
    * Calculates the "blackbox" gradient with respect to both the
    * location vector (mu) and the log-std vector (omega) in
@@ -392,6 +412,80 @@ class normal_meanfield : public base_family {
     elbo_grad.set_mu(mu_grad);
     elbo_grad.set_omega(omega_grad);
   }
+
+  /**
+   * Calculates the "blackbox" gradient with respect to the location
+   * vector (mu) and the log-std vector (omega), evaluating the Monte
+   * Carlo draws in parallel.
+   *
+   * The draws come from generators seeded by <code>rng</code> and the
+   * index of each draw, so the gradient does not depend on the number of
+   * threads, though it differs from that of <code>calc_grad</code>.
+   *
+   * @tparam M Model class.
+   * @tparam BaseRNG Class of base random number generator.
+   * @param[in] elbo_grad Parameters to store "blackbox" gradient
+   * @param[in] m Model.
+   * @param[in] cont_params Continuous parameters.
+   * @param[in] n_monte_carlo_grad Number of samples for gradient
+   * computation.
+   * @param[in,out] rng Random number generator.
+   * @param[in,out] logger logger for messages
+   * @throw std::domain_error If the number of divergent
+   * iterations exceeds its specified bounds.
+   */
+  template <class M, class BaseRNG>
+  void calc_grad_parallel(normal_meanfield& elbo_grad, M& m,
+                          Eigen::VectorXd& cont_params, int n_monte_carlo_grad,
+                          BaseRNG& rng, callbacks::logger& logger) const {
+    static const char* function
+        = "stan::variational::normal_meanfield::calc_grad_parallel";
+    stan::math::check_size_match(function, "Dimension of elbo_grad",
+                                 elbo_grad.dimension(),
+                                 "Dimension of variational q", dimension());
+    stan::math::check_size_match(function, "Dimension of variational q",
+                                 dimension(), "Dimension of variables in model",
+                                 cont_params.size());
+
+    parallel_monte_carlo draws(rng, n_monte_carlo_grad);
+    Eigen::MatrixXd eta = draws.standard_normal(dimension());
+    Eigen::MatrixXd zeta = transform_draws(eta);
+    Eigen::MatrixXd mu_grads(dimension(), n_monte_carlo_grad);
+
+    static const int n_retries = 10;
+    draws.evaluate(
+        [&](int i, int attempt, std::ostream& msgs) {
+          if (attempt > 0) {
+            for (int d = 0; d < dimension(); ++d)
+              eta(d, i) = stan::math::normal_rng(0, 1, draws.rng(i));
+            zeta.col(i) = transform(eta.col(i));
+          }
+          try {
+            double tmp_lp;
+            Eigen::VectorXd tmp_mu_grad;
+            stan::model::gradient(m, Eigen::VectorXd(zeta.col(i)), tmp_lp,
+                                  tmp_mu_grad, &msgs);
+            stan::math::check_finite(function, "Gradient of mu", tmp_mu_grad);
+            mu_grads.col(i) = tmp_mu_grad;
+            return true;
+          } catch (const std::exception& e) {
+            return false;
+          }
+        },
+        n_retries * n_monte_carlo_grad, function, logger);
+
+    Eigen::VectorXd mu_grad = mu_grads.rowwise().sum();
+    Eigen::VectorXd omega_grad = mu_grads.cwiseProduct(eta).rowwise().sum();
+    mu_grad /= static_cast<double>(n_monte_carlo_grad);
+    omega_grad /= static_cast<double>(n_monte_carlo_grad);
+
+    omega_grad.array() = omega_grad.array().cwiseProduct(omega_.array().exp());
+
+    omega_grad.array() += 1.0;  // add entropy gradient (unit)
+
+    elbo_grad.set_mu(mu_grad);
+    elbo_grad.set_omega(omega_grad);
+  }
 };
 
 /**
@@ -0,0 +1,130 @@
+#ifndef STAN_VARIATIONAL_PARALLEL_MONTE_CARLO_HPP
+#define STAN_VARIATIONAL_PARALLEL_MONTE_CARLO_HPP
+
+#include <stan/callbacks/logger.hpp>
+#include <stan/math/rev.hpp>
+#include <boost/random/mixmax.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+namespace stan {
+namespace variational {
+
+/**
+ * Evaluates the Monte Carlo draws of the ELBO or its gradient in
+ * parallel.
+ *
+ * Every draw has its own random number generator, seeded from a stream
+ * seed taken from the caller's generator and the index of the draw, so
+ * the draws, and sums of their evaluations taken in index order, do not
+ * depend on the number of threads.  A draw whose evaluation is dropped
+ * is replaced by the next draw from its own generator.
+ */
+class parallel_monte_carlo {
+ public:
+  using rng_t = boost::random::mixmax;
+
+  /**
+   * Construct the generators of the draws, advancing the specified
+   * generator by the two values of the stream seed.
+   *
+   * @tparam BaseRNG Class of random number generator.
+   * @param[in,out] rng Random number generator.
+   * @param[in] n_draws Number of draws.
+   */
+  template <class BaseRNG>
+  parallel_monte_carlo(BaseRNG& rng, int n_draws) {
+    boost::random::uniform_int_distribution<std::uint32_t> seed_dist;
+    const std::uint32_t seed_hi = seed_dist(rng);
+    const std::uint32_t seed_lo = seed_dist(rng);
+    rngs_.reserve(n_draws);
+    for (int i = 0; i < n_draws; ++i)
+      rngs_.emplace_back(1, seed_hi, seed_lo, i);
+  }
+
+  /**
+   * Return the number of draws.
+   */
+  int size() const { return rngs_.size(); }
+
+  /**
+   * Return the random number generator of a draw.
+   *
+   * @param[in] i Index of the draw.
+   */
+  rng_t& rng(int i) { return rngs_[i]; }
+
+  /**
+   * Return a matrix whose columns are standard normal draws from the
+   * generator of each draw.
+   *
+   * @param[in] dim Dimension of the draws.
+   */
+  Eigen::MatrixXd standard_normal(int dim) {
+    Eigen::MatrixXd eta(dim, size());
+    for (int i = 0; i < size(); ++i)
+      for (int d = 0; d < dim; ++d)
+        eta(d, i) = stan::math::normal_rng(0, 1, rngs_[i]);
+    return eta;
+  }
+
+  /**
+   * Evaluate every draw in parallel, each on its own autodiff stack.
+   *
+   * The functor is called as <code>f(i, attempt, msgs)</code> and returns
+   * false if the evaluation of draw <code>i</code> is dropped, in which
+   * case it is called again with the next attempt, which should make a
+   * new draw from <code>rng(i)</code>.  Messages written to
+   * <code>msgs</code> are given to the logger in order of the draws.
+   *
+   * @tparam F Type of functor.
+   * @param[in] f Functor evaluating a draw.
+   * @param[in] max_drops Number of dropped evaluations at which to give up.
+   * @param[in] function Name of the calling function for error messages.
+   * @param[in,out] logger Logger for messages.
+   * @throw std::domain_error If the number of dropped evaluations reaches
+   * max_drops.
+   */
+  template <typename F>
+  void evaluate(const F& f, int max_drops, const char* function,
+                callbacks::logger& logger) {
+    std::vector<int> drops(size(), 0);
+    std::vector<std::stringstream> msgs(size());
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, size()),
+        [&](const tbb::blocked_range<int>& r) {
+          stan::math::ScopedChainableStack stack;
+          stack.execute([&] {
+            for (int i = r.begin(); i < r.end(); ++i) {
+              while (!f(i, drops[i], msgs[i]) && ++drops[i] < max_drops)
+                continue;
+            }
+          });
+        });
+    int n_dropped_evaluations = 0;
+    for (int i = 0; i < size(); ++i) {
+      if (msgs[i].str().length() > 0)
+        logger.info(msgs[i]);
+      n_dropped_evaluations += drops[i];
+    }
+    if (n_dropped_evaluations >= max_drops) {
+      const char* name = "The number of dropped evaluations";
+      const char* msg1 = "has reached its maximum amount (";
+      const char* msg2
+          = "). Your model may be either severely "
+            "ill-conditioned or misspecified.";
+      stan::math::throw_domain_error(function, name, max_drops, msg1, msg2);
+    }
+  }
+
+ private:
+  std::vector<rng_t> rngs_;
+};
+
+}  // namespace variational
+}  // namespace stan
+#endif
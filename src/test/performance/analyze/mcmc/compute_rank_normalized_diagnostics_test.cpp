@@ -0,0 +1,75 @@
+#include <stan/analyze/mcmc/compute_rank_normalized_diagnostics.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/**
+ * Time to compute the rank normalized R-hats and effective sample sizes
+ * of many columns, one column at a time with the single column
+ * functions and with the batch function.
+ *
+ * Build and run with
+ *   make test/performance/analyze/mcmc/compute_rank_normalized_diagnostics_test
+ *   ./test/performance/analyze/mcmc/compute_rank_normalized_diagnostics_test
+ */
+TEST(PerformanceAnalyze, rank_normalized_diagnostics) {
+  const size_t num_chains = 4;
+  const size_t num_draws = 1000;
+  const Eigen::Index num_columns = 2000;
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> normal;
+  std::vector<Eigen::MatrixXd> chains(num_chains,
+                                      Eigen::MatrixXd(num_draws, num_columns));
+  for (auto& chain : chains) {
+    for (Eigen::Index j = 0; j < num_columns; ++j) {
+      double x = normal(rng);
+      for (size_t n = 0; n < num_draws; ++n) {
+        chain(n, j) = x;
+        x = 0.5 * x + normal(rng);
+      }
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Eigen::VectorXd rhat_bulk(num_columns);
+  const size_t half = num_draws / 2;
+  for (Eigen::Index j = 0; j < num_columns; ++j) {
+    std::vector<const double*> draws;
+    for (const auto& chain : chains)
+      draws.push_back(chain.col(j).data());
+    std::vector<size_t> sizes(num_chains, num_draws);
+    rhat_bulk(j)
+        = stan::analyze::compute_split_potential_scale_reduction_rank(draws,
+                                                                      sizes)
+              .first;
+    Eigen::MatrixXd split(half, 2 * num_chains);
+    for (size_t c = 0; c < num_chains; ++c) {
+      split.col(2 * c) = chains[c].col(j).head(half);
+      split.col(2 * c + 1) = chains[c].col(j).tail(half);
+    }
+    Eigen::MatrixXd z = stan::analyze::rank_transform(split);
+    std::vector<const double*> split_draws;
+    for (Eigen::Index k = 0; k < z.cols(); ++k)
+      split_draws.push_back(z.col(k).data());
+    stan::analyze::compute_effective_sample_size(
+        split_draws, std::vector<size_t>(2 * num_chains, half));
+  }
+  auto middle = std::chrono::steady_clock::now();
+  stan::analyze::rank_normalized_diagnostics diagnostics
+      = stan::analyze::compute_rank_normalized_diagnostics(chains);
+  auto end = std::chrono::steady_clock::now();
+
+  const double per_column
+      = std::chrono::duration<double>(middle - start).count();
+  const double batch = std::chrono::duration<double>(end - middle).count();
+  std::cout << std::setw(34) << "single column (bulk R-hat, ESS)"
+            << std::setw(10) << per_column << " s" << std::endl
+            << std::setw(34) << "batch (bulk and tail R-hat, ESS)"
+            << std::setw(10) << batch << " s" << std::endl;
+  for (Eigen::Index j = 0; j < num_columns; ++j)
+    EXPECT_DOUBLE_EQ(rhat_bulk(j), diagnostics.rhat_bulk(j));
+}
@@ -0,0 +1,91 @@
+#include <stan/callbacks/async_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * Wall time of a sampling loop writing a draw with many generated
+ * quantities to a CSV file after every transition, writing through a
+ * <code>stream_writer</code> directly and through an
+ * <code>async_writer</code> which formats and writes the draws on a
+ * background thread.  With a spare core the asynchronous loop takes
+ * about as long as the transitions alone.
+ *
+ * Build and run with
+ *   make test/performance/callbacks/async_writer_test
+ *   ./test/performance/callbacks/async_writer_test
+ */
+
+namespace {
+
+const int num_params = 100;
+const int num_gq = 20000;
+
+// Stand in for a transition: a fixed amount of arithmetic on the
+// parameters
+void transition(std::vector<double>& params, int n) {
+  for (int rep = 0; rep < 2000; ++rep)
+    for (int i = 0; i < num_params; ++i)
+      params[i] = std::sin(params[i] + 1e-3 * (n + rep));
+}
+
+// Stand in for the generated quantities of a draw
+void generated_quantities(const std::vector<double>& params,
+                          std::vector<double>& draw) {
+  for (int i = 0; i < num_gq; ++i)
+    draw[i] = params[i % num_params] * (i + 1);
+}
+
+double run(stan::callbacks::writer& writer, int num_draws) {
+  std::vector<double> params(num_params, 0.5);
+  std::vector<double> draw(num_gq);
+  std::vector<std::string> names;
+  for (int i = 0; i < num_gq; ++i)
+    names.push_back("y." + std::to_string(i + 1));
+  auto start = std::chrono::steady_clock::now();
+  writer(names);
+  for (int n = 0; n < num_draws; ++n) {
+    transition(params, n);
+    generated_quantities(params, draw);
+    writer(draw);
+  }
+  writer();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(PerformanceCallbacks, async_writer) {
+  const int num_draws = 200;
+  const std::string path = "async_writer_test.csv";
+
+  double sync_time;
+  {
+    std::ofstream out(path);
+    stan::callbacks::stream_writer writer(out, "# ");
+    sync_time = run(writer, num_draws);
+  }
+  double async_time;
+  {
+    std::ofstream out(path);
+    stan::callbacks::stream_writer inner(out, "# ");
+    stan::callbacks::async_writer writer(inner, 64);
+    async_time = run(writer, num_draws);
+  }
+  std::remove(path.c_str());
+
+  std::cout << std::setw(22) << "stream_writer (s)" << std::setw(22)
+            << "async_writer (s)" << std::endl;
+  std::cout << std::setw(22) << sync_time << std::setw(22) << async_time
+            << std::endl;
+  EXPECT_GT(sync_time, 0);
+  EXPECT_GT(async_time, 0);
+}
@@ -0,0 +1,80 @@
+#include <stan/callbacks/stream_writer.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Throughput of <code>stream_writer</code> writing draws to a CSV file,
+ * formatting values through the stream with 6 and with 17 significant
+ * digits, and as shortest round-trip strings collected in a buffer.
+ *
+ * Build and run with
+ *   make test/performance/callbacks/csv_format_test
+ *   ./test/performance/callbacks/csv_format_test
+ */
+
+namespace {
+
+struct throughput {
+  double seconds;
+  double megabytes;
+};
+
+throughput run(const std::vector<std::vector<double>>& draws, int precision,
+               stan::callbacks::number_format format) {
+  const std::string path = "csv_format_test.csv";
+  auto start = std::chrono::steady_clock::now();
+  {
+    std::ofstream out(path);
+    out << std::setprecision(precision);
+    stan::callbacks::stream_writer writer(out, "# ", format);
+    for (const auto& draw : draws)
+      writer(draw);
+  }
+  auto end = std::chrono::steady_clock::now();
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  const double bytes = in.tellg();
+  std::remove(path.c_str());
+  return {std::chrono::duration<double>(end - start).count(), bytes / 1e6};
+}
+
+}  // namespace
+
+TEST(PerformanceCallbacks, csv_format_throughput) {
+  const int num_draws = 2000;
+  const int num_columns = 1000;
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> normal;
+  std::vector<std::vector<double>> draws(num_draws,
+                                         std::vector<double>(num_columns));
+  for (auto& draw : draws)
+    for (auto& x : draw)
+      x = normal(rng);
+
+  struct mode {
+    const char* name;
+    int precision;
+    stan::callbacks::number_format format;
+  };
+  using stan::callbacks::number_format;
+  const mode modes[]
+      = {{"stream, 6 digits", 6, number_format::stream_precision},
+         {"stream, 17 digits", 17, number_format::stream_precision},
+         {"shortest round trip", 6, number_format::shortest_round_trip}};
+
+  std::cout << std::setw(22) << "mode" << std::setw(10) << "MB" << std::setw(10)
+            << "MB/s" << std::setw(12) << "rows/s" << std::endl;
+  for (const auto& m : modes) {
+    throughput t = run(draws, m.precision, m.format);
+    std::cout << std::setw(22) << m.name << std::setw(10) << t.megabytes
+              << std::setw(10) << t.megabytes / t.seconds << std::setw(12)
+              << num_draws / t.seconds << std::endl;
+    EXPECT_GT(t.megabytes, 0);
+  }
+}
@@ -0,0 +1,101 @@
+#include <stan/io/stan_csv_file_reader.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Time to read a Stan CSV file of 2000 draws of 1000 columns with
+ * <code>stan_csv_reader</code> and with <code>stan_csv_file_reader</code>,
+ * serially, in parallel and for a subset of 10 columns.
+ *
+ * Build and run with
+ *   make test/performance/io/stan_csv_file_reader_test
+ *   ./test/performance/io/stan_csv_file_reader_test
+ */
+
+namespace {
+
+void write_csv(const std::string& path, int num_draws, int num_columns) {
+  std::ofstream out(path);
+  out << "# model = performance_model\n";
+  out << "lp__";
+  for (int j = 1; j < num_columns; ++j)
+    out << ",theta." << j;
+  out << "\n# Adaptation terminated\n# Step size = 0.5\n"
+      << "# Diagonal elements of inverse mass matrix:\n# 1";
+  for (int j = 2; j < num_columns; ++j)
+    out << ", 1";
+  out << "\n";
+  std::mt19937 rng(1234);
+  std::normal_distribution<double> normal;
+  for (int n = 0; n < num_draws; ++n) {
+    out << normal(rng);
+    for (int j = 1; j < num_columns; ++j)
+      out << "," << normal(rng);
+    out << "\n";
+  }
+  out << "# \n#  Elapsed Time: 1.5 seconds (Warm-up)\n"
+      << "#                2.5 seconds (Sampling)\n";
+}
+
+template <typename F>
+double wall_time(F&& f) {
+  auto start = std::chrono::steady_clock::now();
+  f();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(PerformanceIo, stan_csv_file_reader) {
+  const std::string path = "stan_csv_file_reader_test.csv";
+  const int num_draws = 2000;
+  const int num_columns = 1000;
+  write_csv(path, num_draws, num_columns);
+
+  stan::io::stan_csv expected;
+  double stream_time = wall_time([&] {
+    std::ifstream in(path);
+    expected = stan::io::stan_csv_reader::parse(in, 0);
+  });
+
+  stan::io::stan_csv serial;
+  double serial_time = wall_time(
+      [&] { serial = stan::io::stan_csv_file_reader::parse(path, 0); });
+
+  stan::io::stan_csv_read_options options;
+  options.parallel = true;
+  stan::io::stan_csv parallel;
+  double parallel_time = wall_time([&] {
+    parallel = stan::io::stan_csv_file_reader::parse(path, 0, options);
+  });
+
+  for (int j = 1; j <= 10; ++j)
+    options.columns.push_back("theta." + std::to_string(j * 90));
+  stan::io::stan_csv subset;
+  double subset_time = wall_time([&] {
+    subset = stan::io::stan_csv_file_reader::parse(path, 0, options);
+  });
+  std::remove(path.c_str());
+
+  std::cout << std::setw(30) << "stan_csv_reader (s)" << std::setw(12)
+            << stream_time << std::endl
+            << std::setw(30) << "file reader (s)" << std::setw(12)
+            << serial_time << std::endl
+            << std::setw(30) << "file reader, parallel (s)" << std::setw(12)
+            << parallel_time << std::endl
+            << std::setw(30) << "file reader, 10 columns (s)" << std::setw(12)
+            << subset_time << std::endl;
+
+  EXPECT_TRUE(expected.samples == serial.samples);
+  EXPECT_TRUE(expected.samples == parallel.samples);
+  EXPECT_TRUE(expected.samples.col(900) == subset.samples.col(9));
+}
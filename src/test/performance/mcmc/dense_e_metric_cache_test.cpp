@@ -0,0 +1,128 @@
+#include <stan/mcmc/hmc/hamiltonians/dense_e_metric.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <boost/random/variate_generator.hpp>
+#include <gtest/gtest.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+
+/**
+ * Time spent in the kinetic energy of the dense metric per transition,
+ * recomputing the Cholesky factor of the inverse mass matrix at every
+ * momentum resampling and the inverse mass matrix times the momentum for
+ * both the kinetic energy and its gradient, as was done before they were
+ * cached in <code>dense_e_point</code>, against the cached versions.
+ *
+ * Each transition resamples the momentum and then, for every leapfrog
+ * step, takes the gradient of the kinetic energy to update the position,
+ * changes the momentum, and evaluates the kinetic energy and its gradient
+ * at the new momentum as NUTS does for the Hamiltonian and the no-U-turn
+ * criterion.
+ *
+ * Build and run with
+ *   make test/performance/mcmc/dense_e_metric_cache_test
+ *   ./test/performance/mcmc/dense_e_metric_cache_test
+ */
+
+namespace {
+
+// Only the kinetic energy is timed, so the model is never evaluated
+class placeholder_model : public stan::model::prob_grad {
+ public:
+  explicit placeholder_model(int n) : stan::model::prob_grad(n) {}
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& x, std::ostream* msgs = 0) const {
+    return 0;
+  }
+};
+
+typedef stan::mcmc::dense_e_metric<placeholder_model, stan::rng_t> metric_t;
+
+Eigen::MatrixXd make_inv_metric(int n) {
+  Eigen::MatrixXd a(n, n);
+  for (int i = 0; i < n; ++i)
+    for (int j = 0; j < n; ++j)
+      a(i, j) = i == j ? 1.0 : 0.5 / (1.0 + std::abs(i - j));
+  return a * a.transpose();
+}
+
+double uncached(const Eigen::MatrixXd& inv_metric, int num_transitions,
+                int num_steps, double& checksum) {
+  stan::rng_t rng = stan::services::util::create_rng(12345, 0);
+  boost::variate_generator<stan::rng_t&, boost::normal_distribution<> >
+      rand_gaus(rng, boost::normal_distribution<>());
+  const int n = inv_metric.rows();
+  Eigen::VectorXd u(n);
+  Eigen::VectorXd p(n);
+  Eigen::VectorXd p_sharp(n);
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_transitions; ++t) {
+    for (int i = 0; i < n; ++i)
+      u(i) = rand_gaus();
+    p = inv_metric.llt().matrixU().solve(u);
+    for (int s = 0; s < num_steps; ++s) {
+      p_sharp.noalias() = inv_metric * p;
+      p -= 1e-3 * p_sharp;
+      checksum += 0.5 * p.transpose() * inv_metric * p;
+      p_sharp.noalias() = inv_metric * p;
+      checksum += p_sharp(0);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double cached(const Eigen::MatrixXd& inv_metric, int num_transitions,
+              int num_steps, double& checksum) {
+  stan::rng_t rng = stan::services::util::create_rng(12345, 0);
+  const int n = inv_metric.rows();
+  placeholder_model model(n);
+  metric_t metric(model);
+  stan::mcmc::dense_e_point z(n);
+  z.set_metric(inv_metric);
+  Eigen::VectorXd p_sharp(n);
+  auto start = std::chrono::steady_clock::now();
+  for (int t = 0; t < num_transitions; ++t) {
+    metric.sample_p(z, rng);
+    for (int s = 0; s < num_steps; ++s) {
+      metric.dtau_dp_into(z, p_sharp);
+      z.p -= 1e-3 * p_sharp;
+      checksum += metric.T(z);
+      metric.dtau_dp_into(z, p_sharp);
+      checksum += p_sharp(0);
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(PerformanceDenseEMetric, cached_factor_and_product) {
+  const int num_transitions = 200;
+  const int num_steps = 10;
+
+  std::cout << std::setw(8) << "N" << std::setw(16) << "uncached (ms)"
+            << std::setw(14) << "cached (ms)" << std::setw(10) << "speedup"
+            << std::endl;
+  for (int n : {50, 200, 500}) {
+    Eigen::MatrixXd inv_metric = make_inv_metric(n);
+    double checksum_uncached = 0;
+    double checksum_cached = 0;
+    double time_uncached
+        = uncached(inv_metric, num_transitions, num_steps, checksum_uncached);
+    double time_cached
+        = cached(inv_metric, num_transitions, num_steps, checksum_cached);
+    std::cout << std::setw(8) << n << std::setw(16)
+              << 1e3 * time_uncached / num_transitions << std::setw(14)
+              << 1e3 * time_cached / num_transitions << std::setw(10)
+              << time_uncached / time_cached << std::endl;
+    // Both draw the same momenta, so they do the same arithmetic
+    EXPECT_NEAR(checksum_uncached, checksum_cached,
+                1e-8 * std::abs(checksum_uncached));
+    EXPECT_GT(time_cached, 0);
+  }
+}
@@ -0,0 +1,103 @@
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/math/rev.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/model/prob_grad.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+/**
+ * Wall time of a fixed number of NUTS transitions for a few chains as
+ * the number of cores grows, with and without speculative expansion of
+ * the trajectory in both directions.  Without it the wall time stops
+ * improving once there is one core per chain.
+ *
+ * Build and run with
+ *   make test/performance/mcmc/nuts_speculative_scaling_test
+ *   ./test/performance/mcmc/nuts_speculative_scaling_test
+ */
+
+namespace {
+
+// Correlated Gaussian whose gradient costs O(N^2) so that leapfrog
+// steps dominate the cost of a transition
+class correlated_gaussian : public stan::model::prob_grad {
+ public:
+  explicit correlated_gaussian(int n)
+      : stan::model::prob_grad(n), precision_(n, n) {
+    for (int i = 0; i < n; ++i)
+      for (int j = 0; j < n; ++j)
+        precision_(i, j) = i == j ? 1.0 : 0.9 / (1.0 + std::abs(i - j));
+    precision_ = precision_ * precision_.transpose();
+  }
+
+  template <bool propto, bool jacobian, typename T>
+  T log_prob(Eigen::Matrix<T, -1, 1>& x, std::ostream* msgs = 0) const {
+    T lp = 0;
+    for (int i = 0; i < x.size(); ++i) {
+      T row = 0;
+      for (int j = 0; j < x.size(); ++j)
+        row += precision_(i, j) * x(j);
+      lp -= 0.5 * x(i) * row;
+    }
+    return lp;
+  }
+
+ private:
+  Eigen::MatrixXd precision_;
+};
+
+typedef stan::mcmc::diag_e_nuts<correlated_gaussian, stan::rng_t> sampler_t;
+
+double run_chains(const correlated_gaussian& model, int num_chains,
+                  int num_threads, bool speculative, int num_transitions) {
+  tbb::task_arena arena(num_threads);
+  auto start = std::chrono::steady_clock::now();
+  arena.execute([&] {
+    tbb::parallel_for(0, num_chains, [&](int chain) {
+      std::stringstream out;
+      stan::callbacks::stream_logger logger(out, out, out, out, out);
+      stan::rng_t rng = stan::services::util::create_rng(12345, chain);
+      sampler_t sampler(model, rng);
+      sampler.set_nominal_stepsize(0.05);
+      sampler.set_max_depth(10);
+      sampler.set_speculative_expansion(speculative);
+      Eigen::VectorXd q = Eigen::VectorXd::Zero(model.num_params_r());
+      stan::mcmc::sample s(q, 0, 0);
+      for (int n = 0; n < num_transitions; ++n)
+        s = sampler.transition(s, logger);
+    });
+  });
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+}  // namespace
+
+TEST(PerformanceNuts, speculative_expansion_scaling) {
+  const int num_chains = 4;
+  const int num_transitions = 50;
+  correlated_gaussian model(100);
+
+  const int max_threads = std::max(
+      1, static_cast<int>(std::thread::hardware_concurrency()));
+  std::cout << std::setw(8) << "cores" << std::setw(14) << "serial (s)"
+            << std::setw(18) << "speculative (s)" << std::endl;
+  for (int num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    double serial = run_chains(model, num_chains, num_threads, false,
+                               num_transitions);
+    double speculative
+        = run_chains(model, num_chains, num_threads, true, num_transitions);
+    std::cout << std::setw(8) << num_threads << std::setw(14) << serial
+              << std::setw(18) << speculative << std::endl;
+    EXPECT_GT(serial, 0);
+    EXPECT_GT(speculative, 0);
+  }
+}
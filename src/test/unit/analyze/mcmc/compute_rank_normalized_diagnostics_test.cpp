@@ -0,0 +1,124 @@
+#include <stan/analyze/mcmc/compute_rank_normalized_diagnostics.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+class ComputeRankNormalizedDiagnostics : public testing::Test {
+ public:
+  void SetUp() {
+    std::stringstream out;
+    for (int i = 1; i <= 2; ++i) {
+      std::ifstream stream("src/test/unit/mcmc/test_csv_files/blocker."
+                           + std::to_string(i) + ".csv");
+      chains.push_back(stan::io::stan_csv_reader::parse(stream, &out).samples);
+    }
+    ASSERT_EQ("", out.str());
+  }
+
+  std::vector<Eigen::MatrixXd> chains;
+};
+
+TEST_F(ComputeRankNormalizedDiagnostics, matches_single_column_functions) {
+  stan::analyze::rank_normalized_diagnostics diagnostics
+      = stan::analyze::compute_rank_normalized_diagnostics(chains, 4);
+  const Eigen::Index num_params = chains[0].cols();
+  ASSERT_EQ(num_params, diagnostics.rhat_bulk.size());
+  const size_t num_draws = chains[0].rows();
+  const size_t half = num_draws / 2;
+  for (Eigen::Index j = 0; j < num_params; ++j) {
+    std::vector<const double*> draws{chains[0].col(j).data(),
+                                     chains[1].col(j).data()};
+    std::vector<size_t> sizes{num_draws, num_draws};
+    std::pair<double, double> rhat
+        = stan::analyze::compute_split_potential_scale_reduction_rank(draws,
+                                                                      sizes);
+    if (std::isnan(rhat.first)) {
+      EXPECT_TRUE(std::isnan(diagnostics.rhat_bulk(j))) << j;
+      EXPECT_TRUE(std::isnan(diagnostics.ess_bulk(j))) << j;
+      continue;
+    }
+    EXPECT_DOUBLE_EQ(rhat.first, diagnostics.rhat_bulk(j)) << j;
+    EXPECT_DOUBLE_EQ(rhat.second, diagnostics.rhat_tail(j)) << j;
+
+    Eigen::MatrixXd split(half, 4);
+    for (int c = 0; c < 2; ++c) {
+      split.col(2 * c) = chains[c].col(j).head(half);
+      split.col(2 * c + 1) = chains[c].col(j).tail(half);
+    }
+    Eigen::MatrixXd z = stan::analyze::rank_transform(split);
+    std::vector<const double*> split_draws;
+    for (int k = 0; k < 4; ++k)
+      split_draws.push_back(z.col(k).data());
+    std::vector<size_t> half_sizes(4, half);
+    EXPECT_DOUBLE_EQ(
+        stan::analyze::compute_effective_sample_size(split_draws, half_sizes),
+        diagnostics.ess_bulk(j))
+        << j;
+
+    // The tail ESS is NaN if either quantile indicator is constant
+    double ess_tail = std::numeric_limits<double>::infinity();
+    for (double p : {0.05, 0.95}) {
+      double bound = stan::math::quantile(split.reshaped(), p);
+      Eigen::MatrixXd indicator
+          = (split.array() <= bound).cast<double>().matrix();
+      for (int k = 0; k < 4; ++k)
+        split_draws[k] = indicator.col(k).data();
+      double ess = stan::analyze::compute_effective_sample_size(split_draws,
+                                                                half_sizes);
+      ess_tail = std::isnan(ess) ? ess : std::min(ess_tail, ess);
+    }
+    if (std::isnan(ess_tail))
+      EXPECT_TRUE(std::isnan(diagnostics.ess_tail(j))) << j;
+    else
+      EXPECT_DOUBLE_EQ(ess_tail, diagnostics.ess_tail(j)) << j;
+  }
+}
+
+TEST_F(ComputeRankNormalizedDiagnostics, stacked_draws) {
+  Eigen::MatrixXd stacked(2 * chains[0].rows(), chains[0].cols());
+  stacked << chains[0], chains[1];
+  stan::analyze::rank_normalized_diagnostics expected
+      = stan::analyze::compute_rank_normalized_diagnostics(chains);
+  stan::analyze::rank_normalized_diagnostics diagnostics
+      = stan::analyze::compute_rank_normalized_diagnostics(stacked, 2, 1);
+  for (Eigen::Index j = 0; j < stacked.cols(); ++j) {
+    if (std::isnan(expected.rhat_bulk(j))) {
+      EXPECT_TRUE(std::isnan(diagnostics.rhat_bulk(j)));
+      continue;
+    }
+    EXPECT_EQ(expected.rhat_bulk(j), diagnostics.rhat_bulk(j));
+    EXPECT_EQ(expected.rhat_tail(j), diagnostics.rhat_tail(j));
+    EXPECT_EQ(expected.ess_bulk(j), diagnostics.ess_bulk(j));
+    if (std::isnan(expected.ess_tail(j)))
+      EXPECT_TRUE(std::isnan(diagnostics.ess_tail(j)));
+    else
+      EXPECT_EQ(expected.ess_tail(j), diagnostics.ess_tail(j));
+  }
+}
+
+TEST(ComputeRankNormalizedDiagnosticsEdge, constant_and_non_finite) {
+  Eigen::MatrixXd draws = Eigen::MatrixXd::Ones(40, 3);
+  for (int i = 0; i < 40; ++i)
+    draws(i, 1) = std::sin(i);
+  draws(3, 2) = std::numeric_limits<double>::infinity();
+  stan::analyze::rank_normalized_diagnostics diagnostics
+      = stan::analyze::compute_rank_normalized_diagnostics(draws, 2);
+  EXPECT_TRUE(std::isnan(diagnostics.rhat_bulk(0)));
+  EXPECT_TRUE(std::isnan(diagnostics.ess_tail(0)));
+  EXPECT_FALSE(std::isnan(diagnostics.rhat_bulk(1)));
+  EXPECT_FALSE(std::isnan(diagnostics.ess_bulk(1)));
+  EXPECT_TRUE(std::isnan(diagnostics.rhat_tail(2)));
+  EXPECT_TRUE(std::isnan(diagnostics.ess_bulk(2)));
+
+  EXPECT_THROW(stan::analyze::compute_rank_normalized_diagnostics(draws, 3),
+               std::invalid_argument);
+  EXPECT_THROW(stan::analyze::compute_rank_normalized_diagnostics(
+                   std::vector<Eigen::MatrixXd>()),
+               std::invalid_argument);
+}
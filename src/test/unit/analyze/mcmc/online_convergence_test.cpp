@@ -0,0 +1,143 @@
+#include <stan/analyze/mcmc/online_convergence.hpp>
+#include <stan/analyze/mcmc/compute_effective_sample_size.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/**
+ * Draws of an AR(1) process with unit marginal variance, whose
+ * effective sample size is N (1 - rho) / (1 + rho).
+ */
+std::vector<double> ar1_chain(size_t num_draws, double rho, double mu,
+                              std::mt19937& rng) {
+  std::normal_distribution<double> normal;
+  std::vector<double> draws(num_draws);
+  const double scale = std::sqrt(1 - rho * rho);
+  double x = normal(rng);
+  for (size_t n = 0; n < num_draws; ++n) {
+    draws[n] = mu + x;
+    x = rho * x + scale * normal(rng);
+  }
+  return draws;
+}
+
+}  // namespace
+
+TEST(OnlineConvergence, matches_batch_diagnostics) {
+  const size_t num_chains = 4;
+  const size_t num_draws = 4096;
+  std::mt19937 rng(1234);
+  std::vector<std::vector<double>> chains;
+  for (size_t c = 0; c < num_chains; ++c)
+    chains.push_back(ar1_chain(num_draws, 0.5, 0, rng));
+
+  stan::analyze::online_convergence diagnostics(num_chains, 2);
+  for (size_t n = 0; n < num_draws; ++n) {
+    for (size_t c = 0; c < num_chains; ++c) {
+      double draw[2] = {chains[c][n], 3.0};
+      diagnostics.add_draw(c, draw);
+    }
+  }
+  stan::analyze::online_convergence_summary summary = diagnostics.summary();
+  ASSERT_TRUE(summary.ready);
+  EXPECT_EQ(num_draws, summary.min_num_draws);
+
+  std::vector<const double*> draws;
+  std::vector<size_t> sizes;
+  for (size_t c = 0; c < num_chains; ++c) {
+    draws.push_back(chains[c].data());
+    sizes.push_back(num_draws);
+  }
+  const double expected_ess = num_chains * num_draws / 3.0;
+  const double batch_ess
+      = stan::analyze::compute_split_effective_sample_size(draws, sizes);
+  EXPECT_NEAR(expected_ess, batch_ess, 0.15 * expected_ess);
+  EXPECT_NEAR(batch_ess, summary.ess_bulk(0), 0.25 * batch_ess);
+  EXPECT_NEAR(1.0, summary.rhat(0), 0.01);
+  EXPECT_GT(summary.ess_tail(0), 0.2 * expected_ess);
+  EXPECT_LT(summary.ess_tail(0), 2 * expected_ess);
+
+  // Constant quantities have no diagnostics
+  EXPECT_TRUE(std::isnan(summary.rhat(1)));
+  EXPECT_TRUE(std::isnan(summary.ess_bulk(1)));
+  EXPECT_TRUE(std::isnan(summary.ess_tail(1)));
+}
+
+TEST(OnlineConvergence, detects_chains_that_disagree) {
+  std::mt19937 rng(99);
+  const size_t num_draws = 1000;
+  std::vector<double> first = ar1_chain(num_draws, 0.3, 0, rng);
+  std::vector<double> second = ar1_chain(num_draws, 0.3, 2, rng);
+  stan::analyze::online_convergence diagnostics(2, 1);
+  for (size_t n = 0; n < num_draws; ++n) {
+    diagnostics.add_draw(0, &first[n]);
+    diagnostics.add_draw(1, &second[n]);
+  }
+  stan::analyze::online_convergence_summary summary = diagnostics.summary();
+  ASSERT_TRUE(summary.ready);
+  EXPECT_GT(summary.rhat(0), 1.2);
+}
+
+TEST(OnlineConvergence, not_ready_before_tail_pilot) {
+  stan::analyze::online_convergence_options options;
+  options.tail_pilot = 50;
+  stan::analyze::online_convergence diagnostics(1, 1, options);
+  std::mt19937 rng(7);
+  std::vector<double> draws = ar1_chain(100, 0, 0, rng);
+  for (size_t n = 0; n < 49; ++n)
+    diagnostics.add_draw(0, &draws[n]);
+  stan::analyze::online_convergence_summary summary = diagnostics.summary();
+  EXPECT_FALSE(summary.ready);
+  EXPECT_EQ(49, summary.min_num_draws);
+  EXPECT_TRUE(std::isnan(summary.rhat(0)));
+  for (size_t n = 49; n < 100; ++n)
+    diagnostics.add_draw(0, &draws[n]);
+  summary = diagnostics.summary();
+  EXPECT_TRUE(summary.ready);
+  EXPECT_FALSE(std::isnan(summary.ess_tail(0)));
+
+  options.tail = false;
+  stan::analyze::online_convergence no_tail(1, 1, options);
+  for (size_t n = 0; n < 8; ++n)
+    no_tail.add_draw(0, &draws[n]);
+  summary = no_tail.summary();
+  EXPECT_TRUE(summary.ready);
+  EXPECT_TRUE(std::isnan(summary.ess_tail(0)));
+}
+
+TEST(OnlineConvergence, concurrent_chains) {
+  const size_t num_chains = 4;
+  const size_t num_draws = 2000;
+  stan::analyze::online_convergence diagnostics(num_chains, 1);
+  std::vector<std::thread> threads;
+  for (size_t c = 0; c < num_chains; ++c) {
+    threads.emplace_back([&diagnostics, c] {
+      std::mt19937 rng(c);
+      std::vector<double> draws = ar1_chain(num_draws, 0.2, 0, rng);
+      for (double x : draws)
+        diagnostics.add_draw(c, &x);
+    });
+  }
+  for (size_t i = 0; i < 100; ++i)
+    diagnostics.summary();
+  for (auto& thread : threads)
+    thread.join();
+  stan::analyze::online_convergence_summary summary = diagnostics.summary();
+  ASSERT_TRUE(summary.ready);
+  EXPECT_EQ(num_draws, summary.min_num_draws);
+  EXPECT_NEAR(1.0, summary.rhat(0), 0.02);
+}
+
+TEST(OnlineConvergence, invalid_options) {
+  stan::analyze::online_convergence_options options;
+  options.max_batches = 7;
+  EXPECT_THROW(stan::analyze::online_convergence(2, 1, options),
+               std::invalid_argument);
+  EXPECT_THROW(stan::analyze::online_convergence(0, 1),
+               std::invalid_argument);
+}
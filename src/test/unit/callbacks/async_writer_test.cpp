@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/async_structured_writer.hpp>
+#include <stan/callbacks/async_writer.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+void write_output(stan::callbacks::writer& writer) {
+  writer("comment");
+  writer(std::vector<std::string>{"a", "b", "c"});
+  for (int n = 0; n < 100; ++n)
+    writer(std::vector<double>{n + 0.5, -n * 2.0, 1.0 / (n + 1)});
+  Eigen::MatrixXd m(3, 2);
+  m << 1, 2, 3, 4, 5, 6;
+  writer(m);
+  writer();
+  writer("done");
+}
+
+// Writer that is slow to write draws
+class slow_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const std::vector<double>& state) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    ++num_draws;
+  }
+  int num_draws = 0;
+};
+
+class throwing_writer : public stan::callbacks::writer {
+ public:
+  void operator()(const std::vector<double>& state) {
+    throw std::runtime_error("disk full");
+  }
+};
+
+}  // namespace
+
+TEST(StanInterfaceCallbacksAsyncWriter, same_output) {
+  std::stringstream expected;
+  stan::callbacks::stream_writer sync(expected, "# ");
+  write_output(sync);
+
+  for (std::size_t capacity : {1, 3, 1024}) {
+    std::stringstream ss;
+    stan::callbacks::stream_writer inner(ss, "# ");
+    {
+      stan::callbacks::async_writer writer(inner, capacity);
+      write_output(writer);
+    }
+    EXPECT_EQ(expected.str(), ss.str()) << "capacity " << capacity;
+  }
+}
+
+TEST(StanInterfaceCallbacksAsyncWriter, blank_comment_flushes) {
+  std::stringstream ss;
+  stan::callbacks::stream_writer inner(ss, "# ");
+  stan::callbacks::async_writer writer(inner);
+  writer(std::vector<double>{1, 2});
+  writer();
+  EXPECT_EQ("1,2\n# \n", ss.str());
+  writer("x");
+  writer.flush();
+  EXPECT_EQ("1,2\n# \n# x\n", ss.str());
+}
+
+TEST(StanInterfaceCallbacksAsyncWriter, drop) {
+  slow_writer inner;
+  const int N = 50;
+  int num_dropped;
+  {
+    stan::callbacks::async_writer writer(
+        inner, 2, stan::callbacks::async_backpressure::drop);
+    for (int n = 0; n < N; ++n)
+      writer(std::vector<double>{1.0 * n});
+    writer.flush();
+    num_dropped = writer.num_dropped();
+  }
+  EXPECT_GT(num_dropped, 0);
+  EXPECT_EQ(N, inner.num_draws + num_dropped);
+}
+
+TEST(StanInterfaceCallbacksAsyncWriter, block) {
+  slow_writer inner;
+  {
+    stan::callbacks::async_writer writer(inner, 2);
+    for (int n = 0; n < 20; ++n)
+      writer(std::vector<double>{1.0 * n});
+    EXPECT_EQ(0, writer.num_dropped());
+  }
+  EXPECT_EQ(20, inner.num_draws);
+}
+
+TEST(StanInterfaceCallbacksAsyncWriter, rethrows) {
+  throwing_writer inner;
+  stan::callbacks::async_writer writer(inner);
+  writer(std::vector<double>{1});
+  EXPECT_THROW(writer.flush(), std::runtime_error);
+  EXPECT_THROW(writer("more"), std::runtime_error);
+}
+
+TEST(StanInterfaceCallbacksAsyncStructuredWriter, same_output) {
+  auto write_record = [](stan::callbacks::structured_writer& writer) {
+    writer.begin_record();
+    writer.write("stepsize", 0.5);
+    writer.write("n", 3);
+    writer.write("name", "metric");
+    writer.write("flag", true);
+    writer.begin_record("inner");
+    writer.write("inv_metric", std::vector<double>{1, 2, 3});
+    Eigen::MatrixXd m(2, 2);
+    m << 1, 2, 3, 4;
+    writer.write("m", m);
+    writer.end_record();
+    writer.end_record();
+  };
+  std::stringstream expected;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> sync{
+      std::unique_ptr<std::stringstream, deleter_noop>(&expected)};
+  write_record(sync);
+
+  std::stringstream ss;
+  stan::callbacks::json_writer<std::stringstream, deleter_noop> inner{
+      std::unique_ptr<std::stringstream, deleter_noop>(&ss)};
+  stan::callbacks::async_structured_writer writer(inner);
+  write_record(writer);
+  // ending the outermost record waits for it to be written
+  EXPECT_EQ(expected.str(), ss.str());
+}
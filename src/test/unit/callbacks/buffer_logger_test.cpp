@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stan/callbacks/buffer_logger.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+
+class StanInterfaceCallbacksBufferLogger : public ::testing::Test {
+ public:
+  StanInterfaceCallbacksBufferLogger()
+      : stream_logger(debug, info, warn, error, fatal) {}
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger stream_logger;
+  stan::callbacks::buffer_logger logger;
+};
+
+TEST_F(StanInterfaceCallbacksBufferLogger, buffers_until_replay) {
+  std::stringstream message;
+  message << "message 2";
+  logger.info("message 1");
+  logger.warn(message);
+  EXPECT_EQ(2, logger.size());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+
+  logger.replay(stream_logger);
+  EXPECT_EQ(0, logger.size());
+  EXPECT_EQ("message 1\n", info.str());
+  EXPECT_EQ("message 2\n", warn.str());
+}
+
+TEST_F(StanInterfaceCallbacksBufferLogger, replay_keeps_levels_and_order) {
+  logger.debug("d");
+  logger.info("i1");
+  logger.error("e");
+  logger.info("i2");
+  logger.fatal("f");
+  logger.replay(stream_logger);
+  EXPECT_EQ("d\n", debug.str());
+  EXPECT_EQ("i1\ni2\n", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("e\n", error.str());
+  EXPECT_EQ("f\n", fatal.str());
+
+  logger.replay(stream_logger);
+  EXPECT_EQ("i1\ni2\n", info.str());
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <stan/callbacks/columnar_writer.hpp>
+#include <stan/io/columnar_reader.hpp>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+class StanInterfaceCallbacksColumnarWriter : public ::testing::Test {
+ public:
+  using writer_t
+      = stan::callbacks::columnar_writer<std::stringstream, deleter_noop>;
+
+  writer_t make_writer(std::size_t chunk_size = 0) {
+    return writer_t(std::unique_ptr<std::stringstream, deleter_noop>(&ss),
+                    chunk_size);
+  }
+
+  std::stringstream ss;
+};
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, round_trip) {
+  std::vector<std::string> names{"lp__", "theta.1", "theta.2"};
+  std::vector<std::vector<double>> draws;
+  {
+    auto writer = make_writer(3);
+    writer(names);
+    for (int n = 0; n < 10; ++n) {
+      draws.push_back({-n - 0.5, 1.0 / (n + 3), n * 1e300});
+      writer(draws.back());
+    }
+  }
+  stan::io::columnar_reader reader(ss);
+  EXPECT_EQ(names, reader.names());
+  ASSERT_EQ(3, reader.num_columns());
+  ASSERT_EQ(10, reader.num_draws());
+  ASSERT_EQ(4, reader.chunks().size());
+  EXPECT_EQ(1, reader.chunks().back().rows);
+  Eigen::MatrixXd values = reader.draws();
+  for (int n = 0; n < 10; ++n)
+    for (int j = 0; j < 3; ++j)
+      EXPECT_EQ(draws[n][j], values(n, j));
+  Eigen::VectorXd theta2 = reader.column("theta.2");
+  for (int n = 0; n < 10; ++n)
+    EXPECT_EQ(draws[n][2], theta2(n));
+  for (std::size_t c = 0; c < reader.chunks().size(); ++c)
+    for (std::size_t j = 0; j < 3; ++j)
+      EXPECT_EQ(0, reader.column_offset(c, j) % 8);
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, matrix) {
+  Eigen::MatrixXd values(2, 5);
+  values << 1, 2, 3, 4, 5, 6, 7, 8, 9, std::numeric_limits<double>::infinity();
+  {
+    auto writer = make_writer(2);
+    writer(std::vector<std::string>{"a", "b"});
+    writer(values);
+  }
+  stan::io::columnar_reader reader(ss);
+  ASSERT_EQ(5, reader.num_draws());
+  EXPECT_TRUE(values.transpose() == reader.draws());
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, variables) {
+  {
+    auto writer = make_writer();
+    writer(std::vector<std::string>{"lp__", "mu", "theta.1.1", "theta.2.1",
+                                    "theta.1.3", "theta.2.3", "z.real",
+                                    "z.imag", "y.1"});
+  }
+  stan::io::columnar_reader reader(ss);
+  const auto& variables = reader.variables();
+  ASSERT_EQ(6, variables.size());
+  EXPECT_EQ("lp__", variables[0].name);
+  EXPECT_TRUE(variables[0].dims.empty());
+  EXPECT_EQ("mu", variables[1].name);
+  EXPECT_EQ("theta", variables[2].name);
+  EXPECT_EQ((std::vector<size_t>{2, 3}), variables[2].dims);
+  EXPECT_EQ("z.real", variables[3].name);
+  EXPECT_EQ("z.imag", variables[4].name);
+  EXPECT_EQ("y", variables[5].name);
+  EXPECT_EQ(std::vector<size_t>{1}, variables[5].dims);
+  EXPECT_EQ(0, reader.num_draws());
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, comments_and_adaptation) {
+  {
+    auto writer = make_writer(2);
+    writer("model = \"m\"");
+    writer();
+    writer(std::vector<std::string>{"a", "b"});
+    writer("Adaptation terminated");
+    writer("Step size = 0.25");
+    writer("Elements of inverse mass matrix:");
+    writer("1, 0.5");
+    writer("0.5, 2");
+    writer(std::vector<double>{1, 2});
+    writer(std::vector<double>{3, 4});
+    writer(std::vector<double>{5, 6});
+    writer();
+    writer("Elapsed Time");
+  }
+  stan::io::columnar_reader reader(ss);
+  ASSERT_EQ(2, reader.header_comments().size());
+  EXPECT_EQ("model = \"m\"", reader.header_comments()[0].text);
+  EXPECT_TRUE(reader.header_comments()[1].blank);
+  ASSERT_EQ(7, reader.comments().size());
+  EXPECT_EQ(0, reader.comments()[0].draw);
+  EXPECT_EQ(3, reader.comments()[5].draw);
+  EXPECT_TRUE(reader.comments()[5].blank);
+  EXPECT_EQ("Elapsed Time", reader.comments()[6].text);
+
+  ASSERT_TRUE(reader.has_adaptation());
+  EXPECT_EQ(0.25, reader.adaptation().step_size);
+  Eigen::MatrixXd metric(2, 2);
+  metric << 1, 0.5, 0.5, 2;
+  EXPECT_TRUE(metric == reader.adaptation().metric);
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, no_adaptation) {
+  {
+    auto writer = make_writer();
+    writer(std::vector<std::string>{"a"});
+    writer(std::vector<double>{1});
+  }
+  stan::io::columnar_reader reader(ss);
+  EXPECT_FALSE(reader.has_adaptation());
+  EXPECT_EQ(1, reader.num_draws());
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, close) {
+  auto writer = make_writer();
+  writer(std::vector<std::string>{"a"});
+  writer(std::vector<double>{1});
+  writer.close();
+  const std::string closed = ss.str();
+  writer.close();
+  EXPECT_EQ(closed, ss.str());
+  stan::io::columnar_reader reader(ss);
+  EXPECT_EQ(1, reader.num_draws());
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, size_mismatch) {
+  auto writer = make_writer();
+  writer(std::vector<std::string>{"a", "b"});
+  EXPECT_THROW(writer(std::vector<double>{1}), std::invalid_argument);
+  EXPECT_THROW(writer(std::vector<std::string>{"a", "b"}), std::logic_error);
+}
+
+TEST_F(StanInterfaceCallbacksColumnarWriter, null) {
+  stan::callbacks::columnar_writer<std::stringstream, deleter_noop> writer(
+      std::unique_ptr<std::stringstream, deleter_noop>(nullptr));
+  EXPECT_NO_THROW(writer(std::vector<std::string>{"a"}));
+  EXPECT_NO_THROW(writer(std::vector<double>{1, 2}));
+  EXPECT_NO_THROW(writer("comment"));
+  EXPECT_NO_THROW(writer.close());
+}
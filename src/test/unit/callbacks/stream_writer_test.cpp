@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 #include <boost/lexical_cast.hpp>
 #include <stan/callbacks/stream_writer.hpp>
+#include <limits>
 
 class StanInterfaceCallbacksStreamWriter : public ::testing::Test {
  public:
@@ -47,3 +48,40 @@ TEST_F(StanInterfaceCallbacksStreamWriter, string) {
   EXPECT_NO_THROW(writer("message"));
   EXPECT_EQ("message\n", ss.str());
 }
+
+TEST_F(StanInterfaceCallbacksStreamWriter, shortest_round_trip) {
+  stan::callbacks::stream_writer fast(
+      ss, "# ", stan::callbacks::number_format::shortest_round_trip);
+  std::vector<std::string> names{"lp__", "x", "y"};
+  std::vector<double> x{-7, 0.1, 1.0 / 3.0};
+  fast(names);
+  fast(x);
+  // rows are buffered until the next comment
+  EXPECT_EQ("", ss.str());
+  fast();
+  fast("done");
+  EXPECT_EQ("lp__,x,y\n-7,0.1,0.3333333333333333\n# \n# done\n", ss.str());
+}
+
+TEST_F(StanInterfaceCallbacksStreamWriter, shortest_round_trip_exact) {
+  std::vector<double> x{1e-300, 123456789.123456789, -2.5e17, 0.0,
+                        std::numeric_limits<double>::infinity()};
+  {
+    stan::callbacks::stream_writer fast(
+        ss, "", stan::callbacks::number_format::shortest_round_trip);
+    for (int n = 0; n < 10000; ++n)
+      fast(x);
+  }
+  std::string line;
+  int num_lines = 0;
+  while (std::getline(ss, line)) {
+    std::stringstream line_ss(line);
+    std::string field;
+    for (double expected : x) {
+      ASSERT_TRUE(std::getline(line_ss, field, ','));
+      EXPECT_EQ(expected, std::stod(field));
+    }
+    ++num_lines;
+  }
+  EXPECT_EQ(10000, num_lines);
+}
@@ -66,3 +66,20 @@ TEST_F(StanInterfaceCallbacksStreamWriter, string) {
   EXPECT_NO_THROW(writer("message"));
   EXPECT_EQ("message\n", ss.str());
 }
+
+TEST_F(StanInterfaceCallbacksStreamWriter, shortest_round_trip) {
+  std::stringstream out;
+  stan::callbacks::unique_stream_writer<std::stringstream, deleter_noop> fast(
+      std::unique_ptr<std::stringstream, deleter_noop>(&out), "# ",
+      stan::callbacks::number_format::shortest_round_trip);
+  fast(std::vector<std::string>{"a", "b"});
+  fast(std::vector<double>{0.1, 2});
+  Eigen::MatrixXd m(2, 2);
+  m << 1.5, 1e-20, -3, 4;
+  fast(m);
+  EXPECT_EQ("", out.str());
+  fast.flush();
+  EXPECT_EQ("a,b\n0.1,2\n1.5,-3\n1e-20,4\n", out.str());
+  fast("done");
+  EXPECT_EQ("a,b\n0.1,2\n1.5,-3\n1e-20,4\n# done\n", out.str());
+}
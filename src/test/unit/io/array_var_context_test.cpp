@@ -307,3 +307,29 @@ TEST(array_var_context, ctor_complex) {
   std::vector<std::complex<double>> eta;
   EXPECT_EQ(eta, avc.vals_c("eta"));
 }
+
+TEST(array_var_context, vals_views) {
+  std::vector<double> v_r{1.5, 2.5, 3.5};
+  std::vector<int> v_i{4, 5};
+  std::vector<std::vector<size_t>> dims_r{std::vector<size_t>{3}};
+  std::vector<std::vector<size_t>> dims_i{std::vector<size_t>{2}};
+  std::vector<std::string> names_r{"alpha"};
+  std::vector<std::string> names_i{"beta"};
+  stan::io::array_var_context avc(names_r, v_r, dims_r, names_i, v_i, dims_i);
+
+  stan::io::vals_view<double> alpha = avc.vals_r_view("alpha");
+  EXPECT_FALSE(alpha.owns_values());
+  EXPECT_EQ(v_r, alpha.to_vector());
+  EXPECT_EQ(dims_r[0], avc.dims_r_view("alpha").to_vector());
+
+  stan::io::vals_view<double> beta_r = avc.vals_r_view("beta");
+  EXPECT_TRUE(beta_r.owns_values());
+  EXPECT_EQ(avc.vals_r("beta"), beta_r.to_vector());
+  stan::io::vals_view<int> beta_i = avc.vals_i_view("beta");
+  EXPECT_FALSE(beta_i.owns_values());
+  EXPECT_EQ(v_i, beta_i.to_vector());
+  EXPECT_EQ(dims_i[0], avc.dims_r_view("beta").to_vector());
+
+  EXPECT_TRUE(avc.vals_r_view("gamma").empty());
+  EXPECT_TRUE(avc.vals_i_view("gamma").empty());
+}
@@ -0,0 +1,102 @@
+#include <stan/callbacks/columnar_writer.hpp>
+#include <stan/io/columnar_reader.hpp>
+#include <stan/io/columnar_to_csv.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+
+/**
+ * Write the contents of a Stan CSV file to a columnar writer, as the
+ * services would have.
+ */
+void csv_to_columnar(std::istream& in, std::stringstream& out) {
+  stan::callbacks::columnar_writer<std::stringstream, deleter_noop> writer(
+      std::unique_ptr<std::stringstream, deleter_noop>(&out), 100);
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line[0] == '#') {
+      std::string text = line.substr(line.size() > 1 ? 2 : 1);
+      if (text.empty())
+        writer();
+      else
+        writer(text);
+      continue;
+    }
+    std::vector<std::string> fields;
+    std::stringstream ss(line);
+    std::string field;
+    while (std::getline(ss, field, ','))
+      fields.push_back(field);
+    if (std::isalpha(fields[0][0])) {
+      writer(fields);
+    } else {
+      std::vector<double> values;
+      for (const auto& f : fields)
+        values.push_back(std::stod(f));
+      writer(values);
+    }
+  }
+}
+
+}  // namespace
+
+class StanIoColumnarReader : public testing::Test {
+ public:
+  void SetUp() {
+    std::ifstream blocker0_stream(
+        "src/test/unit/io/test_csv_files/blocker.0.csv");
+    std::stringstream csv;
+    csv << blocker0_stream.rdbuf();
+    blocker0_csv = csv.str();
+    csv_to_columnar(csv, blocker0);
+  }
+
+  std::string blocker0_csv;
+  std::stringstream blocker0;
+};
+
+TEST_F(StanIoColumnarReader, to_csv) {
+  std::stringstream csv;
+  stan::io::columnar_to_csv(blocker0, csv);
+  EXPECT_EQ(blocker0_csv, csv.str());
+}
+
+TEST_F(StanIoColumnarReader, to_stan_csv) {
+  std::stringstream csv(blocker0_csv);
+  stan::io::stan_csv expected = stan::io::stan_csv_reader::parse(csv, 0);
+  stan::io::columnar_reader reader(blocker0);
+  stan::io::stan_csv data = reader.to_stan_csv();
+
+  EXPECT_EQ(expected.header, data.header);
+  EXPECT_EQ(expected.adaptation.step_size, data.adaptation.step_size);
+  EXPECT_TRUE(expected.adaptation.metric == data.adaptation.metric);
+  ASSERT_EQ(1000, data.samples.rows());
+  EXPECT_TRUE(expected.samples == data.samples);
+  EXPECT_EQ(10, reader.chunks().size());
+
+  const auto& variables = reader.variables();
+  ASSERT_EQ(13, variables.size());
+  EXPECT_EQ("mu", variables[9].name);
+  EXPECT_EQ(std::vector<size_t>{22}, variables[9].dims);
+}
+
+TEST_F(StanIoColumnarReader, bad_magic) {
+  std::stringstream in(blocker0_csv);
+  EXPECT_THROW(stan::io::columnar_reader reader(in), std::domain_error);
+}
+
+TEST_F(StanIoColumnarReader, truncated) {
+  std::string bytes = blocker0.str();
+  std::stringstream in(bytes.substr(0, bytes.size() - 20));
+  EXPECT_THROW(stan::io::columnar_reader reader(in), std::domain_error);
+}
@@ -683,3 +683,25 @@ TEST(io_dump, too_large_zero_array) {
   test_exception(
       "a <- structure(double(999918446744073709551616L), .Dim = c(2,3))");
 }
+
+TEST(io_dump, vals_views) {
+  std::stringstream in("foo <- c(1.5, 2, 3)\nbar <- c(1L, 2L)\n");
+  stan::io::dump dump(in);
+
+  stan::io::vals_view<double> foo = dump.vals_r_view("foo");
+  EXPECT_FALSE(foo.owns_values());
+  EXPECT_EQ(dump.vals_r("foo"), foo.to_vector());
+  EXPECT_EQ(dump.dims_r("foo"), dump.dims_r_view("foo").to_vector());
+
+  // Integers read as reals have to be converted
+  stan::io::vals_view<double> bar_r = dump.vals_r_view("bar");
+  EXPECT_TRUE(bar_r.owns_values());
+  EXPECT_EQ(dump.vals_r("bar"), bar_r.to_vector());
+  stan::io::vals_view<int> bar_i = dump.vals_i_view("bar");
+  EXPECT_FALSE(bar_i.owns_values());
+  EXPECT_EQ(dump.vals_i("bar"), bar_i.to_vector());
+
+  EXPECT_TRUE(dump.vals_r_view("baz").empty());
+  EXPECT_TRUE(dump.vals_i_view("foo").empty());
+  EXPECT_TRUE(dump.dims_r_view("baz").empty());
+}
@@ -494,3 +494,26 @@ TEST(ioJson, jsonData_promote_extra_large_int_to_double) {
   test_real_var(jdata, "foo", foo_vals_r, expected_dims);
   test_real_var(jdata, "bar", bar_vals_r, expected_dims);
 }
+
+TEST(ioJson, jsonData_vals_views) {
+  std::string txt = "{ \"foo\" : [1.5, 2.5, 3.5], \"bar\" : [[1, 2], [3, 4]] }";
+  std::stringstream in(txt);
+  stan::json::json_data jdata(in);
+
+  stan::io::vals_view<double> foo = jdata.vals_r_view("foo");
+  EXPECT_FALSE(foo.owns_values());
+  EXPECT_EQ(jdata.vals_r("foo"), foo.to_vector());
+  EXPECT_EQ(jdata.dims_r("foo"), jdata.dims_r_view("foo").to_vector());
+
+  // Integers read as reals have to be converted
+  stan::io::vals_view<double> bar_r = jdata.vals_r_view("bar");
+  EXPECT_TRUE(bar_r.owns_values());
+  EXPECT_EQ(jdata.vals_r("bar"), bar_r.to_vector());
+  stan::io::vals_view<int> bar_i = jdata.vals_i_view("bar");
+  EXPECT_FALSE(bar_i.owns_values());
+  EXPECT_EQ(jdata.vals_i("bar"), bar_i.to_vector());
+  EXPECT_EQ(jdata.dims_r("bar"), jdata.dims_r_view("bar").to_vector());
+
+  EXPECT_TRUE(jdata.vals_r_view("baz").empty());
+  EXPECT_TRUE(jdata.vals_i_view("baz").empty());
+}
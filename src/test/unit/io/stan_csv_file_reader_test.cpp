@@ -0,0 +1,88 @@
+#include <stan/io/stan_csv_file_reader.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+const std::string csv_dir = "src/test/unit/io/test_csv_files/";
+
+stan::io::stan_csv parse_stream(const std::string& filename) {
+  std::ifstream in(csv_dir + filename);
+  return stan::io::stan_csv_reader::parse(in, 0);
+}
+
+void expect_same(const stan::io::stan_csv& expected,
+                 const stan::io::stan_csv& data) {
+  EXPECT_EQ(expected.metadata.model, data.metadata.model);
+  EXPECT_EQ(expected.metadata.seed, data.metadata.seed);
+  EXPECT_EQ(expected.header, data.header);
+  EXPECT_EQ(expected.adaptation.step_size, data.adaptation.step_size);
+  EXPECT_TRUE(expected.adaptation.metric == data.adaptation.metric);
+  ASSERT_EQ(expected.samples.rows(), data.samples.rows());
+  ASSERT_EQ(expected.samples.cols(), data.samples.cols());
+  EXPECT_TRUE(expected.samples == data.samples);
+  EXPECT_FLOAT_EQ(expected.timing.warmup, data.timing.warmup);
+  EXPECT_FLOAT_EQ(expected.timing.sampling, data.timing.sampling);
+}
+
+}  // namespace
+
+TEST(StanIoStanCsvFileReader, same_as_stream_reader) {
+  for (const std::string filename : {"blocker.0.csv", "eight_schools.csv"}) {
+    SCOPED_TRACE(filename);
+    expect_same(parse_stream(filename),
+                stan::io::stan_csv_file_reader::parse(csv_dir + filename, 0));
+  }
+}
+
+TEST(StanIoStanCsvFileReader, parallel) {
+  stan::io::stan_csv_read_options options;
+  options.parallel = true;
+  options.grain_size = 7;
+  expect_same(parse_stream("blocker.0.csv"),
+              stan::io::stan_csv_file_reader::parse(csv_dir + "blocker.0.csv",
+                                                    0, options));
+}
+
+TEST(StanIoStanCsvFileReader, columns) {
+  stan::io::stan_csv expected = parse_stream("blocker.0.csv");
+  stan::io::stan_csv_read_options options;
+  options.columns = {"mu.3", "lp__", "delta[22]"};
+  options.parallel = true;
+  stan::io::stan_csv data = stan::io::stan_csv_file_reader::parse(
+      csv_dir + "blocker.0.csv", 0, options);
+
+  ASSERT_EQ(3, data.header.size());
+  EXPECT_EQ("mu[3]", data.header[0]);
+  EXPECT_EQ("lp__", data.header[1]);
+  EXPECT_EQ("delta[22]", data.header[2]);
+  ASSERT_EQ(expected.samples.rows(), data.samples.rows());
+  ASSERT_EQ(3, data.samples.cols());
+  EXPECT_TRUE(expected.samples.col(11) == data.samples.col(0));
+  EXPECT_TRUE(expected.samples.col(0) == data.samples.col(1));
+  EXPECT_TRUE(expected.samples.col(52) == data.samples.col(2));
+}
+
+TEST(StanIoStanCsvFileReader, bad_columns) {
+  stan::io::stan_csv_read_options options;
+  options.columns = {"not_a_column"};
+  EXPECT_THROW(stan::io::stan_csv_file_reader::parse(csv_dir + "blocker.0.csv",
+                                                     0, options),
+               std::invalid_argument);
+  options.columns = {"lp__", "lp__"};
+  EXPECT_THROW(stan::io::stan_csv_file_reader::parse(csv_dir + "blocker.0.csv",
+                                                     0, options),
+               std::invalid_argument);
+}
+
+TEST(StanIoStanCsvFileReader, missing_file) {
+  std::stringstream out;
+  EXPECT_THROW(
+      stan::io::stan_csv_file_reader::parse(csv_dir + "no_such_file.csv", &out),
+      std::invalid_argument);
+}
@@ -295,6 +295,29 @@ TEST_F(StanIoStanCsvReader, read_samples1) {
   EXPECT_FLOAT_EQ(0.648336, timing.sampling);
 }
 
+TEST_F(StanIoStanCsvReader, read_samples_warmup_converged) {
+  std::stringstream in;
+  in << "1,2\n3,4\n"
+     << "# Warmup converged after 1 iterations\n"
+     << "# \n"
+     << "#  Elapsed Time: 0.1 seconds (Warm-up)\n"
+     << "#                0.2 seconds (Sampling)\n";
+  Eigen::MatrixXd samples;
+  stan::io::stan_csv_timing timing;
+  size_t num_warmup = 1000;
+  EXPECT_TRUE(stan::io::stan_csv_reader::read_samples(in, samples, timing,
+                                                      num_warmup, 0));
+  EXPECT_EQ(2, samples.rows());
+  EXPECT_EQ(1, num_warmup);
+  EXPECT_FLOAT_EQ(0.1, timing.warmup);
+  EXPECT_FLOAT_EQ(0.2, timing.sampling);
+
+  size_t unchanged = 1000;
+  EXPECT_FALSE(stan::io::stan_csv_reader::read_num_warmup(
+      "#  Elapsed Time: 0.1 seconds (Warm-up)", unchanged));
+  EXPECT_EQ(1000, unchanged);
+}
+
 TEST_F(StanIoStanCsvReader, ParseBlocker) {
   stan::io::stan_csv blocker0;
   std::stringstream out;
@@ -168,3 +168,41 @@ TEST(McmcDenseEMetric, streams) {
   EXPECT_EQ("", stan::test::cout_ss.str());
   EXPECT_EQ("", stan::test::cerr_ss.str());
 }
+
+TEST(McmcDenseEMetric, cached_metric_products) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  Eigen::Matrix2d m_inv;
+  m_inv << 2.0, 0.5, 0.5, 1.0;
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::dense_e_metric<stan::mcmc::mock_model, stan::rng_t> metric(model);
+  stan::mcmc::dense_e_point z(2);
+  z.set_metric(m_inv);
+  z.p << 1.0, -2.0;
+
+  Eigen::VectorXd expected = m_inv * z.p;
+  EXPECT_MATRIX_NEAR(expected, metric.dtau_dp(z), 1e-12);
+  EXPECT_FLOAT_EQ(0.5 * z.p.dot(expected), metric.T(z));
+
+  // A new momentum is picked up without announcing it
+  z.p << 3.0, 1.0;
+  expected = m_inv * z.p;
+  EXPECT_MATRIX_NEAR(expected, metric.dtau_dp(z), 1e-12);
+  EXPECT_FLOAT_EQ(0.5 * z.p.dot(expected), metric.T(z));
+
+  // A metric written in place is picked up once announced
+  z.inv_e_metric_(0, 0) = 4.0;
+  z.metric_changed();
+  expected = z.inv_e_metric_ * z.p;
+  EXPECT_MATRIX_NEAR(expected, metric.dtau_dp(z), 1e-12);
+  EXPECT_MATRIX_NEAR(z.inv_e_metric_.llt().matrixU().toDenseMatrix(),
+                     z.inv_e_metric_llt().matrixU().toDenseMatrix(), 1e-12);
+
+  // set_metric discards the cached factor
+  z.set_metric(m_inv);
+  EXPECT_MATRIX_NEAR(m_inv.llt().matrixU().toDenseMatrix(),
+                     z.inv_e_metric_llt().matrixU().toDenseMatrix(), 1e-12);
+  metric.sample_p(z, base_rng);
+  EXPECT_MATRIX_NEAR(m_inv * z.p, metric.dtau_dp(z), 1e-12);
+}
@@ -0,0 +1,109 @@
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/mcmc/hmc/hamiltonians/lowrank_diag_e_metric.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+namespace {
+
+void set_test_metric(stan::mcmc::lowrank_diag_e_point& z,
+                     Eigen::MatrixXd& inv_metric) {
+  Eigen::VectorXd diag(3);
+  diag << 1.0, 2.0, 0.5;
+  Eigen::MatrixXd factor(3, 2);
+  factor << 1.0, 0.0, 0.5, 1.0, -1.0, 0.5;
+  z.set_metric(diag, factor);
+  inv_metric = Eigen::MatrixXd(diag.asDiagonal()) + factor * factor.transpose();
+}
+
+}  // namespace
+
+TEST(McmcLowrankDiagEMetric, kinetic_energy) {
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::lowrank_diag_e_metric<stan::mcmc::mock_model, stan::rng_t>
+      metric(model);
+  stan::mcmc::lowrank_diag_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  z.p << 1.0, -2.0, 0.5;
+
+  EXPECT_MATRIX_NEAR(inv_metric * z.p, metric.dtau_dp(z), 1e-12);
+  Eigen::VectorXd p_sharp;
+  metric.dtau_dp_into(z, p_sharp);
+  EXPECT_MATRIX_NEAR(inv_metric * z.p, p_sharp, 1e-12);
+  EXPECT_FLOAT_EQ(0.5 * z.p.dot(inv_metric * z.p), metric.T(z));
+  EXPECT_FLOAT_EQ(metric.T(z), metric.tau(z));
+}
+
+TEST(McmcLowrankDiagEMetric, sample_p) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(3);
+  stan::mcmc::lowrank_diag_e_metric<stan::mcmc::mock_model, stan::rng_t>
+      metric(model);
+  stan::mcmc::lowrank_diag_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+  Eigen::MatrixXd m = inv_metric.inverse();
+
+  int n_samples = 10000;
+  Eigen::MatrixXd sample_cov = Eigen::MatrixXd::Zero(3, 3);
+  for (int i = 0; i < n_samples; ++i) {
+    metric.sample_p(z, base_rng);
+    sample_cov += z.p * z.p.transpose() / n_samples;
+  }
+
+  // Within 5 sigma of the Wishart variance of each element
+  for (int i = 0; i < 3; ++i)
+    for (int j = 0; j < 3; ++j) {
+      double var = m(i, j) * m(i, j) + m(i, i) * m(j, j);
+      EXPECT_NEAR(m(i, j), sample_cov(i, j), 5.0 * sqrt(var / n_samples));
+    }
+}
+
+TEST(McmcLowrankDiagEMetric, diagonal_only) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  stan::mcmc::mock_model model(2);
+  stan::mcmc::lowrank_diag_e_metric<stan::mcmc::mock_model, stan::rng_t>
+      metric(model);
+  stan::mcmc::lowrank_diag_e_point z(2);
+  Eigen::VectorXd diag(2);
+  diag << 4.0, 0.25;
+  z.set_metric(diag);
+  EXPECT_EQ(0, z.rank());
+
+  z.p << 1.0, 2.0;
+  EXPECT_FLOAT_EQ(0.5 * (4.0 + 0.25 * 4.0), metric.T(z));
+
+  // With no low rank part the draw is the diagonal one
+  stan::rng_t rng_copy = base_rng;
+  boost::variate_generator<stan::rng_t&, boost::normal_distribution<> >
+      rand_gaus(rng_copy, boost::normal_distribution<>());
+  double u0 = rand_gaus();
+  double u1 = rand_gaus();
+  metric.sample_p(z, base_rng);
+  EXPECT_FLOAT_EQ(u0 / 2.0, z.p(0));
+  EXPECT_FLOAT_EQ(u1 / 0.5, z.p(1));
+}
+
+TEST(McmcLowrankDiagEMetric, write_metric) {
+  stan::mcmc::lowrank_diag_e_point z(3);
+  Eigen::MatrixXd inv_metric;
+  set_test_metric(z, inv_metric);
+
+  std::stringstream out;
+  stan::callbacks::stream_writer writer(out);
+  z.write_metric(writer);
+  EXPECT_EQ(
+      "Diagonal elements of inverse mass matrix:\n"
+      "1, 2, 0.5\n"
+      "Low rank factor of inverse mass matrix:\n"
+      "1, 0\n"
+      "0.5, 1\n"
+      "-1, 0.5\n",
+      out.str());
+  EXPECT_EQ("lowrank_diag_e", z.metric_type());
+}
@@ -0,0 +1,180 @@
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/dense_e_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+namespace stan {
+namespace mcmc {
+
+class criterion_inspector_mock_nuts
+    : public base_nuts<mock_model, mock_hamiltonian, mock_integrator,
+                       stan::rng_t> {
+ public:
+  std::vector<double> p_sharp_minus_values;
+  std::vector<double> p_sharp_plus_values;
+  std::vector<double> rho_values;
+  criterion_inspector_mock_nuts(const mock_model& m, stan::rng_t& rng)
+      : base_nuts<mock_model, mock_hamiltonian, mock_integrator, stan::rng_t>(
+          m, rng) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    p_sharp_minus_values.push_back(p_sharp_minus(0));
+    p_sharp_plus_values.push_back(p_sharp_plus(0));
+    rho_values.push_back(rho(0));
+    return true;
+  }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+TEST(McmcNutsBaseNuts, build_tree_iterative_matches_recursive) {
+  int model_size = 1;
+  double init_momentum = 1.5;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = init_momentum;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::mock_model model(model_size);
+
+  for (int depth = 0; depth < 5; ++depth) {
+    stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+    stan::mcmc::criterion_inspector_mock_nuts recursive(model, base_rng);
+    stan::mcmc::criterion_inspector_mock_nuts iterative(model, base_rng);
+
+    stan::mcmc::ps_point z_propose_rec(model_size);
+    stan::mcmc::ps_point z_propose_it(model_size);
+    Eigen::VectorXd p_sharp_beg_rec(model_size), p_sharp_beg_it(model_size);
+    Eigen::VectorXd p_sharp_end_rec(model_size), p_sharp_end_it(model_size);
+    Eigen::VectorXd p_beg_rec(model_size), p_beg_it(model_size);
+    Eigen::VectorXd p_end_rec(model_size), p_end_it(model_size);
+    Eigen::VectorXd rho_rec = Eigen::VectorXd::Zero(model_size);
+    Eigen::VectorXd rho_it = Eigen::VectorXd::Zero(model_size);
+    double log_sum_weight_rec = -std::numeric_limits<double>::infinity();
+    double log_sum_weight_it = -std::numeric_limits<double>::infinity();
+    int n_leapfrog_rec = 0;
+    int n_leapfrog_it = 0;
+    double sum_metro_prob_rec = 0;
+    double sum_metro_prob_it = 0;
+
+    recursive.set_nominal_stepsize(1);
+    recursive.sample_stepsize();
+    recursive.z() = z_init;
+    iterative.set_nominal_stepsize(1);
+    iterative.sample_stepsize();
+    iterative.z() = z_init;
+
+    bool valid_rec = recursive.build_tree(
+        depth, z_propose_rec, p_sharp_beg_rec, p_sharp_end_rec, rho_rec,
+        p_beg_rec, p_end_rec, -0.1, 1, n_leapfrog_rec, log_sum_weight_rec,
+        sum_metro_prob_rec, logger);
+    bool valid_it = iterative.build_tree_iterative(
+        depth, z_propose_it, p_sharp_beg_it, p_sharp_end_it, rho_it, p_beg_it,
+        p_end_it, -0.1, 1, n_leapfrog_it, log_sum_weight_it,
+        sum_metro_prob_it, logger);
+
+    EXPECT_EQ(valid_rec, valid_it);
+    EXPECT_EQ(n_leapfrog_rec, n_leapfrog_it);
+    EXPECT_EQ(log_sum_weight_rec, log_sum_weight_it);
+    EXPECT_EQ(sum_metro_prob_rec, sum_metro_prob_it);
+    EXPECT_EQ(rho_rec(0), rho_it(0));
+    EXPECT_EQ(p_beg_rec(0), p_beg_it(0));
+    EXPECT_EQ(p_end_rec(0), p_end_it(0));
+    EXPECT_EQ(p_sharp_beg_rec(0), p_sharp_beg_it(0));
+    EXPECT_EQ(p_sharp_end_rec(0), p_sharp_end_it(0));
+    EXPECT_EQ(recursive.z().q(0), iterative.z().q(0));
+
+    // U-turn criteria are checked on the same subtrees in the same order
+    EXPECT_EQ(recursive.rho_values, iterative.rho_values);
+    EXPECT_EQ(recursive.p_sharp_minus_values, iterative.p_sharp_minus_values);
+    EXPECT_EQ(recursive.p_sharp_plus_values, iterative.p_sharp_plus_values);
+  }
+}
+
+TEST(McmcNutsBaseNuts, iterative_tree_same_draws) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model_namespace::gauss3D_model model(data_var_context);
+
+  stan::rng_t rng_rec = stan::services::util::create_rng(4839294, 0);
+  stan::rng_t rng_it = stan::services::util::create_rng(4839294, 0);
+
+  stan::mcmc::diag_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      recursive(model, rng_rec);
+  stan::mcmc::diag_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      iterative(model, rng_it);
+
+  EXPECT_FALSE(iterative.get_iterative_tree());
+  iterative.set_iterative_tree(true);
+  EXPECT_TRUE(iterative.get_iterative_tree());
+
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(model.num_params_r());
+  stan::mcmc::sample s_rec(q, 0, 0);
+  stan::mcmc::sample s_it(q, 0, 0);
+
+  for (int n = 0; n < 100; ++n) {
+    s_rec = recursive.transition(s_rec, logger);
+    s_it = iterative.transition(s_it, logger);
+
+    for (int i = 0; i < q.size(); ++i)
+      EXPECT_EQ(s_rec.cont_params(i), s_it.cont_params(i));
+    EXPECT_EQ(s_rec.log_prob(), s_it.log_prob());
+    EXPECT_EQ(s_rec.accept_stat(), s_it.accept_stat());
+    EXPECT_EQ(recursive.depth_, iterative.depth_);
+    EXPECT_EQ(recursive.n_leapfrog_, iterative.n_leapfrog_);
+    EXPECT_EQ(recursive.divergent_, iterative.divergent_);
+  }
+}
+
+TEST(McmcNutsBaseNuts, iterative_tree_same_draws_dense_e) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model_namespace::gauss3D_model model(data_var_context);
+
+  stan::rng_t rng_rec = stan::services::util::create_rng(12345, 0);
+  stan::rng_t rng_it = stan::services::util::create_rng(12345, 0);
+
+  Eigen::MatrixXd inv_metric(3, 3);
+  inv_metric << 2.0, 0.5, 0.1, 0.5, 1.0, 0.2, 0.1, 0.2, 0.5;
+
+  stan::mcmc::dense_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      recursive(model, rng_rec);
+  stan::mcmc::dense_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
+      iterative(model, rng_it);
+  recursive.set_metric(inv_metric);
+  iterative.set_metric(inv_metric);
+  recursive.set_max_depth(8);
+  iterative.set_max_depth(8);
+  iterative.set_iterative_tree(true);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Ones(model.num_params_r());
+  stan::mcmc::sample s_rec(q, 0, 0);
+  stan::mcmc::sample s_it(q, 0, 0);
+
+  for (int n = 0; n < 100; ++n) {
+    s_rec = recursive.transition(s_rec, logger);
+    s_it = iterative.transition(s_it, logger);
+
+    for (int i = 0; i < q.size(); ++i)
+      EXPECT_EQ(s_rec.cont_params(i), s_it.cont_params(i));
+    EXPECT_EQ(s_rec.accept_stat(), s_it.accept_stat());
+    EXPECT_EQ(recursive.depth_, iterative.depth_);
+    EXPECT_EQ(recursive.n_leapfrog_, iterative.n_leapfrog_);
+  }
+}
@@ -0,0 +1,98 @@
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/dense_e_nuts.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <tbb/task_arena.h>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+
+typedef stan::mcmc::diag_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                                stan::rng_t>
+    diag_sampler_t;
+
+// Run a speculative sampler on the specified number of threads and
+// return the draws, tree depths and leapfrog counts
+std::vector<double> run_speculative(int num_threads, bool iterative,
+                                    int num_transitions) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model_namespace::gauss3D_model model(data_var_context);
+  stan::rng_t rng = stan::services::util::create_rng(4839294, 0);
+  diag_sampler_t sampler(model, rng);
+  sampler.set_speculative_expansion(true);
+  sampler.set_iterative_tree(iterative);
+  sampler.set_max_depth(8);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(model.num_params_r());
+  stan::mcmc::sample s(q, 0, 0);
+
+  std::vector<double> draws;
+  tbb::task_arena arena(num_threads);
+  arena.execute([&] {
+    for (int n = 0; n < num_transitions; ++n) {
+      s = sampler.transition(s, logger);
+      for (int i = 0; i < q.size(); ++i)
+        draws.push_back(s.cont_params(i));
+      draws.push_back(s.accept_stat());
+      draws.push_back(sampler.depth_);
+      draws.push_back(sampler.n_leapfrog_);
+    }
+  });
+  EXPECT_EQ("", error.str());
+  return draws;
+}
+
+}  // namespace
+
+TEST(McmcNutsBaseNuts, speculative_expansion_same_draws_any_threads) {
+  std::vector<double> serial = run_speculative(1, false, 100);
+  std::vector<double> parallel = run_speculative(4, false, 100);
+  EXPECT_EQ(serial, parallel);
+
+  // Both tree builders consume random numbers in the same order
+  std::vector<double> iterative = run_speculative(4, true, 100);
+  EXPECT_EQ(serial, iterative);
+}
+
+TEST(McmcNutsBaseNuts, speculative_expansion_moments) {
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::io::empty_var_context data_var_context;
+  gauss3D_model_namespace::gauss3D_model model(data_var_context);
+  stan::rng_t rng = stan::services::util::create_rng(1234, 0);
+  stan::mcmc::dense_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                           stan::rng_t>
+      sampler(model, rng);
+  EXPECT_FALSE(sampler.get_speculative_expansion());
+  sampler.set_speculative_expansion(true);
+  EXPECT_TRUE(sampler.get_speculative_expansion());
+  sampler.set_nominal_stepsize(0.9);
+
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(model.num_params_r());
+  stan::mcmc::sample s(q, 0, 0);
+
+  const int num_draws = 4000;
+  Eigen::VectorXd sum = Eigen::VectorXd::Zero(q.size());
+  Eigen::VectorXd sum_sq = Eigen::VectorXd::Zero(q.size());
+  for (int n = 0; n < num_draws; ++n) {
+    s = sampler.transition(s, logger);
+    sum += s.cont_params();
+    sum_sq += s.cont_params().array().square().matrix();
+    EXPECT_GE(sampler.depth_, 0);
+    EXPECT_LE(sampler.depth_, sampler.get_max_depth());
+    EXPECT_GE(sampler.n_leapfrog_, 1);
+  }
+  for (int i = 0; i < q.size(); ++i) {
+    double mean = sum(i) / num_draws;
+    EXPECT_NEAR(0, mean, 0.1);
+    EXPECT_NEAR(1, sum_sq(i) / num_draws - mean * mean, 0.15);
+  }
+  EXPECT_EQ("", error.str());
+}
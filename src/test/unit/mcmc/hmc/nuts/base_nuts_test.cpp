@@ -2,6 +2,7 @@
 #include <stan/callbacks/stream_logger.hpp>
 #include <stan/mcmc/hmc/nuts/base_nuts.hpp>
 #include <stan/mcmc/hmc/integrators/expl_leapfrog.hpp>
+#include <atomic>
 #include <vector>
 #include <stan/services/util/create_rng.hpp>
 #include <gtest/gtest.h>
@@ -55,6 +56,22 @@ class edge_inspector_mock_nuts
   }
 };
 
+class counting_mock_nuts : public base_nuts<mock_model, mock_hamiltonian,
+                                            mock_integrator, stan::rng_t> {
+ public:
+  std::atomic<int> num_criteria;
+  counting_mock_nuts(const mock_model& m, stan::rng_t& rng)
+      : base_nuts<mock_model, mock_hamiltonian, mock_integrator, stan::rng_t>(
+          m, rng),
+        num_criteria(0) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    ++num_criteria;
+    return true;
+  }
+};
+
 // Mock Hamiltonian
 template <typename M, typename BaseRNG>
 class divergent_hamiltonian : public base_hamiltonian<M, ps_point, BaseRNG> {
@@ -372,6 +389,37 @@ TEST(McmcNutsBaseNuts, transition) {
   EXPECT_EQ("", fatal.str());
 }
 
+TEST(McmcNutsBaseNuts, speculative_transition_derived_criterion) {
+  int model_size = 1;
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q(0) = 0;
+  z_init.p(0) = 1.5;
+  stan::mcmc::mock_model model(model_size);
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  for (bool speculative : {false, true}) {
+    stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+    stan::mcmc::counting_mock_nuts sampler(model, base_rng);
+    sampler.set_speculative_expansion(speculative);
+    sampler.set_nominal_stepsize(1);
+    sampler.set_stepsize_jitter(0);
+    sampler.sample_stepsize();
+    sampler.z() = z_init;
+
+    stan::mcmc::sample init_sample(z_init.q, 0, 0);
+    sampler.transition(init_sample, logger);
+
+    // The subtrees built by the speculative helpers check the
+    // criterion of this sampler, three times for each merge
+    EXPECT_EQ(sampler.get_max_depth(), sampler.depth_);
+    EXPECT_EQ((2 << (sampler.get_max_depth() - 1)) - 1, sampler.n_leapfrog_);
+    EXPECT_EQ(3 * sampler.n_leapfrog_, sampler.num_criteria.load());
+  }
+  EXPECT_EQ("", error.str());
+}
+
 TEST(McmcNutsBaseNuts, transition_egde_momenta) {
   stan::rng_t base_rng = stan::services::util::create_rng(42424253, 0);
 
@@ -3,9 +3,11 @@
 #include <stan/mcmc/hmc/nuts/unit_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/diag_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/lowrank_diag_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_unit_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_diag_e_nuts.hpp>
 #include <stan/mcmc/hmc/nuts/adapt_dense_e_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/adapt_lowrank_diag_e_nuts.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <stan/io/empty_var_context.hpp>
 #include <fstream>
@@ -32,6 +34,10 @@ TEST(McmcNuts, instantiaton_test) {
   stan::mcmc::dense_e_nuts<gauss3D_model_namespace::gauss3D_model, stan::rng_t>
       dense_e_sampler(model, base_rng);
 
+  stan::mcmc::lowrank_diag_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                                  stan::rng_t>
+      lowrank_diag_e_sampler(model, base_rng);
+
   stan::mcmc::adapt_unit_e_nuts<gauss3D_model_namespace::gauss3D_model,
                                 stan::rng_t>
       adapt_unit_e_sampler(model, base_rng);
@@ -43,4 +49,8 @@ TEST(McmcNuts, instantiaton_test) {
   stan::mcmc::adapt_dense_e_nuts<gauss3D_model_namespace::gauss3D_model,
                                  stan::rng_t>
       adapt_dense_e_sampler(model, base_rng);
+
+  stan::mcmc::adapt_lowrank_diag_e_nuts<gauss3D_model_namespace::gauss3D_model,
+                                        stan::rng_t>
+      adapt_lowrank_diag_e_sampler(model, base_rng, 2);
 }
@@ -0,0 +1,163 @@
+// Eigen asserts on any allocation of matrix storage while
+// set_is_malloc_allowed(false) is in effect
+#define EIGEN_RUNTIME_NO_MALLOC
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/mcmc/hmc/nuts/base_nuts.hpp>
+#include <stan/mcmc/hmc/nuts/nuts_workspace.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <new>
+
+namespace {
+// Every other heap allocation in this test executable goes through the
+// replaced global operator new below
+bool count_allocations = false;
+int num_allocations = 0;
+}  // namespace
+
+void* operator new(std::size_t size) {
+  if (count_allocations)
+    ++num_allocations;
+  void* ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace stan {
+namespace mcmc {
+
+// Mock Hamiltonian that writes the sharp momentum in place and skips
+// the autodiff gradient so that only the NUTS bookkeeping is measured
+template <typename Model, typename BaseRNG>
+class inplace_mock_hamiltonian : public mock_hamiltonian<Model, BaseRNG> {
+ public:
+  explicit inplace_mock_hamiltonian(const Model& model)
+      : mock_hamiltonian<Model, BaseRNG>(model) {}
+
+  void dtau_dp_into(ps_point& z, Eigen::VectorXd& p_sharp) { p_sharp = z.q; }
+
+  void init(ps_point& z, callbacks::logger& logger) { z.V = 0; }
+};
+
+class workspace_mock_nuts
+    : public base_nuts<mock_model, inplace_mock_hamiltonian, mock_integrator,
+                       stan::rng_t> {
+ public:
+  workspace_mock_nuts(const mock_model& m, stan::rng_t& rng)
+      : base_nuts<mock_model, inplace_mock_hamiltonian, mock_integrator,
+                  stan::rng_t>(m, rng) {}
+
+  bool compute_criterion(Eigen::VectorXd& p_sharp_minus,
+                         Eigen::VectorXd& p_sharp_plus, Eigen::VectorXd& rho) {
+    return true;
+  }
+
+  const nuts_workspace& workspace() const { return this->workspace_; }
+};
+
+}  // namespace mcmc
+}  // namespace stan
+
+TEST(McmcNutsWorkspace, resize) {
+  stan::mcmc::nuts_workspace workspace;
+  EXPECT_EQ(-1, workspace.dim());
+  EXPECT_EQ(0, workspace.max_depth());
+
+  workspace.resize(3, 4);
+  EXPECT_EQ(3, workspace.dim());
+  EXPECT_EQ(4, workspace.max_depth());
+  EXPECT_EQ(3, workspace.z_fwd.q.size());
+  EXPECT_EQ(3, workspace.rho.size());
+  EXPECT_EQ(3, workspace.subtree(3).rho_subtree.size());
+  EXPECT_EQ(3, workspace.subtree(3).z_propose_final.p.size());
+
+  // Shrinking the depth keeps the existing storage
+  workspace.resize(3, 2);
+  EXPECT_EQ(4, workspace.max_depth());
+
+  workspace.resize(5, 2);
+  EXPECT_EQ(5, workspace.dim());
+  EXPECT_EQ(2, workspace.max_depth());
+  EXPECT_EQ(5, workspace.p_sharp_bck_bck.size());
+  EXPECT_EQ(5, workspace.subtree(1).p_init_end.size());
+}
+
+TEST(McmcNutsWorkspace, build_trajectory_no_allocations_after_warmup) {
+  stan::rng_t base_rng = stan::services::util::create_rng(0, 0);
+
+  int model_size = 100;
+
+  stan::mcmc::ps_point z_init(model_size);
+  z_init.q.setZero();
+  z_init.p.setConstant(1.5);
+
+  stan::mcmc::mock_model model(model_size);
+  stan::mcmc::workspace_mock_nuts sampler(model, base_rng);
+
+  sampler.set_max_depth(8);
+  sampler.set_nominal_stepsize(1);
+  sampler.set_stepsize_jitter(0);
+  sampler.z() = z_init;
+
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger logger(debug, info, warn, error, fatal);
+
+  stan::mcmc::sample s(z_init.q, 0, 0);
+
+  // The first transition sizes the workspace
+  s = sampler.transition(s, logger);
+  EXPECT_EQ(model_size, sampler.workspace().dim());
+  EXPECT_EQ(sampler.get_max_depth(), sampler.workspace().max_depth());
+  EXPECT_EQ(sampler.get_max_depth(), sampler.depth_);
+
+  // Only the trajectory builder is allocation free: transition also
+  // copies the new state into the sample it returns
+  num_allocations = 0;
+  count_allocations = true;
+  Eigen::internal::set_is_malloc_allowed(false);
+  for (int n = 0; n < 10; ++n)
+    sampler.build_trajectory(logger);
+  Eigen::internal::set_is_malloc_allowed(true);
+  count_allocations = false;
+
+  EXPECT_EQ(0, num_allocations);
+  EXPECT_EQ(sampler.get_max_depth(), sampler.depth_);
+  EXPECT_EQ((2 << (sampler.get_max_depth() - 1)) - 1, sampler.n_leapfrog_);
+
+  // Building subtrees directly never allocates once sized
+  stan::mcmc::ps_point z_propose(model_size);
+  Eigen::VectorXd p_begin = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_sharp_begin = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_end = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd p_sharp_end = Eigen::VectorXd::Zero(model_size);
+  Eigen::VectorXd rho = Eigen::VectorXd::Zero(model_size);
+  double log_sum_weight = -std::numeric_limits<double>::infinity();
+  int n_leapfrog = 0;
+  double sum_metro_prob = 0;
+
+  num_allocations = 0;
+  count_allocations = true;
+  Eigen::internal::set_is_malloc_allowed(false);
+  bool valid_subtree = sampler.build_tree(
+      sampler.get_max_depth() - 1, z_propose, p_sharp_begin, p_sharp_end, rho,
+      p_begin, p_end, 0, 1, n_leapfrog, log_sum_weight, sum_metro_prob, logger);
+  Eigen::internal::set_is_malloc_allowed(true);
+  count_allocations = false;
+
+  EXPECT_TRUE(valid_subtree);
+  EXPECT_EQ(0, num_allocations);
+  EXPECT_EQ(1 << (sampler.get_max_depth() - 1), n_leapfrog);
+
+  EXPECT_EQ("", debug.str());
+  EXPECT_EQ("", info.str());
+  EXPECT_EQ("", warn.str());
+  EXPECT_EQ("", error.str());
+  EXPECT_EQ("", fatal.str());
+}
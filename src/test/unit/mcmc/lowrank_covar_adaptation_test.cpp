@@ -0,0 +1,80 @@
+#include <stan/mcmc/lowrank_covar_adaptation.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/mixmax.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+
+TEST(McmcLowrankCovarAdaptation, learn_covariance_constant_draws) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 10;
+  Eigen::VectorXd q = Eigen::VectorXd::Zero(n);
+  Eigen::VectorXd var(Eigen::VectorXd::Zero(n));
+  Eigen::MatrixXd factor(n, 0);
+
+  const int n_learn = 10;
+
+  stan::mcmc::lowrank_covar_adaptation adapter(n, 3);
+  adapter.set_window_params(50, 0, 0, n_learn, logger);
+
+  for (int i = 0; i < n_learn; ++i)
+    adapter.learn_covariance(var, factor, q);
+
+  for (int i = 0; i < n; ++i)
+    EXPECT_EQ(1e-3 * 5.0 / (n_learn + 5.0), var(i));
+  EXPECT_EQ(n, factor.rows());
+  EXPECT_EQ(0, factor.cols());
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST(McmcLowrankCovarAdaptation, learn_covariance_recovers_low_rank) {
+  stan::test::unit::instrumented_logger logger;
+
+  // Covariance diag(s) + w w^T with a single strong direction
+  const int n = 50;
+  Eigen::VectorXd s(n);
+  Eigen::VectorXd w(n);
+  for (int i = 0; i < n; ++i) {
+    s(i) = 0.5 + 0.01 * i;
+    w(i) = 2.0 + std::sin(i);
+  }
+  Eigen::MatrixXd covar = Eigen::MatrixXd(s.asDiagonal()) + w * w.transpose();
+  Eigen::MatrixXd chol = covar.llt().matrixL();
+
+  const int n_learn = 4000;
+  stan::mcmc::lowrank_covar_adaptation adapter(n, 2);
+  adapter.set_window_params(n_learn + 100, 0, 0, n_learn, logger);
+
+  boost::random::mixmax rng(1, 0, 0, 7);
+  boost::random::normal_distribution<> std_normal;
+  Eigen::VectorXd var(n);
+  Eigen::MatrixXd factor(n, 0);
+  Eigen::VectorXd u(n);
+  bool updated = false;
+  for (int i = 0; i < n_learn && !updated; ++i) {
+    for (int d = 0; d < n; ++d)
+      u(d) = std_normal(rng);
+    updated = adapter.learn_covariance(var, factor, chol * u);
+  }
+  ASSERT_TRUE(updated);
+  ASSERT_GE(factor.cols(), 1);
+  EXPECT_LE(factor.cols(), 2);
+
+  // The leading direction of the factor is the strong direction
+  double cos_angle
+      = std::abs(factor.col(0).dot(w)) / (factor.col(0).norm() * w.norm());
+  EXPECT_GT(cos_angle, 0.99);
+
+  // The metric has the marginal variances of the draws on average and
+  // their variance along the strong direction
+  Eigen::MatrixXd inv_metric
+      = Eigen::MatrixXd(var.asDiagonal()) + factor * factor.transpose();
+  double mean_ratio = 0;
+  for (int i = 0; i < n; ++i)
+    mean_ratio += inv_metric(i, i) / covar(i, i) / n;
+  EXPECT_NEAR(1.0, mean_ratio, 0.1);
+  Eigen::VectorXd e = w.normalized();
+  double target = e.dot(covar * e);
+  EXPECT_NEAR(target, e.dot(inv_metric * e), 0.1 * target);
+  EXPECT_EQ(0, logger.call_count());
+}
@@ -0,0 +1,132 @@
+#include <stan/mcmc/pooled_adaptation.hpp>
+#include <stan/mcmc/covar_adaptation.hpp>
+#include <stan/mcmc/var_adaptation.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Draws of chain c: the i-th draw has coordinates c + i and (c + i)^2 / 10
+Eigen::VectorXd draw(int chain, int i) {
+  Eigen::VectorXd q(2);
+  q << chain + i, (chain + i) * (chain + i) / 10.0;
+  return q;
+}
+
+}  // namespace
+
+TEST(McmcPooledAdaptation, pooled_variance_matches_all_draws) {
+  const int num_chains = 4;
+  const int n_learn = 10;
+  stan::mcmc::pooled_adaptation pool(num_chains);
+  std::vector<Eigen::VectorXd> vars(num_chains, Eigen::VectorXd::Ones(2));
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < num_chains; ++c) {
+    threads.emplace_back([c, &pool, &vars] {
+      stan::test::unit::instrumented_logger logger;
+      stan::mcmc::var_adaptation adapter(2);
+      adapter.set_window_params(50, 0, 0, n_learn, logger);
+      adapter.set_pool(&pool, c);
+      for (int i = 0; i < n_learn; ++i)
+        adapter.learn_variance(vars[c], draw(c, i));
+      pool.leave(c);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  stan::math::welford_var_estimator estimator(2);
+  for (int c = 0; c < num_chains; ++c)
+    for (int i = 0; i < n_learn; ++i)
+      estimator.add_sample(draw(c, i));
+  Eigen::VectorXd expected(2);
+  estimator.sample_variance(expected);
+  const double n = num_chains * n_learn;
+  expected = (n / (n + 5.0)) * expected
+             + 1e-3 * (5.0 / (n + 5.0)) * Eigen::VectorXd::Ones(2);
+
+  EXPECT_EQ(1, pool.num_synchronizations());
+  for (int c = 0; c < num_chains; ++c)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_NEAR(expected(j), vars[c](j), 1e-10 * expected(j));
+}
+
+TEST(McmcPooledAdaptation, pooled_covariance_matches_all_draws) {
+  const int num_chains = 3;
+  const int n_learn = 10;
+  stan::mcmc::pooled_adaptation pool(num_chains);
+  std::vector<Eigen::MatrixXd> covars(num_chains,
+                                      Eigen::MatrixXd::Identity(2, 2));
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < num_chains; ++c) {
+    threads.emplace_back([c, &pool, &covars] {
+      stan::test::unit::instrumented_logger logger;
+      stan::mcmc::covar_adaptation adapter(2);
+      adapter.set_window_params(50, 0, 0, n_learn, logger);
+      adapter.set_pool(&pool, c);
+      for (int i = 0; i < n_learn; ++i)
+        adapter.learn_covariance(covars[c], draw(c, i));
+      pool.leave(c);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  stan::math::welford_covar_estimator estimator(2);
+  for (int c = 0; c < num_chains; ++c)
+    for (int i = 0; i < n_learn; ++i)
+      estimator.add_sample(draw(c, i));
+  Eigen::MatrixXd expected(2, 2);
+  estimator.sample_covariance(expected);
+  const double n = num_chains * n_learn;
+  expected = (n / (n + 5.0)) * expected
+             + 1e-3 * (5.0 / (n + 5.0)) * Eigen::MatrixXd::Identity(2, 2);
+
+  for (int c = 0; c < num_chains; ++c)
+    for (int j = 0; j < 2; ++j)
+      for (int k = 0; k < 2; ++k)
+        EXPECT_NEAR(expected(j, k), covars[c](j, k),
+                    1e-10 * std::abs(expected(j, k)));
+}
+
+TEST(McmcPooledAdaptation, pooled_stepsize_is_geometric_mean) {
+  const int num_chains = 3;
+  stan::mcmc::pooled_adaptation pool(num_chains, true);
+  EXPECT_TRUE(pool.pools_stepsize());
+  std::vector<double> stepsizes = {0.1, 0.2, 0.4};
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < num_chains; ++c)
+    threads.emplace_back([c, &pool, &stepsizes] {
+      pool.pool_stepsize(c, stepsizes[c]);
+    });
+  for (auto& thread : threads)
+    thread.join();
+
+  for (int c = 0; c < num_chains; ++c)
+    EXPECT_FLOAT_EQ(0.2, stepsizes[c]);
+}
+
+TEST(McmcPooledAdaptation, leave_releases_waiting_chains) {
+  stan::mcmc::pooled_adaptation pool(3, true);
+  std::vector<double> stepsizes = {0.1, 0.4};
+
+  std::vector<std::thread> threads;
+  for (int c = 0; c < 2; ++c)
+    threads.emplace_back([c, &pool, &stepsizes] {
+      pool.pool_stepsize(c, stepsizes[c]);
+    });
+  // The third chain stops without reaching the end of warmup
+  pool.leave(2);
+  for (auto& thread : threads)
+    thread.join();
+
+  EXPECT_EQ(1, pool.num_synchronizations());
+  EXPECT_FLOAT_EQ(0.2, stepsizes[0]);
+  EXPECT_FLOAT_EQ(0.2, stepsizes[1]);
+}
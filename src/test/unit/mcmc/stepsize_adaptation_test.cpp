@@ -141,3 +141,34 @@ TEST(McmcStepsizeAdaptation, learn_stepsize_3) {
   EXPECT_NEAR(0.75, adaptation.kappa(), 1e-14);
   EXPECT_NEAR(10, adaptation.t0(), 1e-14);
 }
+
+TEST(McmcStepsizeAdaptation, stable) {
+  stan::mcmc::stepsize_adaptation adaptation;
+  adaptation.set_mu(0);
+  adaptation.set_delta(0.8);
+  double epsilon = 1;
+
+  // Disabled by default
+  for (int i = 0; i < 50; ++i)
+    adaptation.learn_stepsize(epsilon, 0.8);
+  EXPECT_FALSE(adaptation.stable());
+
+  adaptation.set_stability_params(0.01, 10);
+  adaptation.restart();
+  // With the target acceptance statistic the step size does not move,
+  // but the first window has no previous average to compare with
+  for (int i = 0; i < 10; ++i)
+    adaptation.learn_stepsize(epsilon, 0.8);
+  EXPECT_FALSE(adaptation.stable());
+  for (int i = 0; i < 10; ++i)
+    adaptation.learn_stepsize(epsilon, 0.8);
+  EXPECT_TRUE(adaptation.stable());
+
+  // A step size moving by more than the tolerance is not stable
+  for (int i = 0; i < 10; ++i)
+    adaptation.learn_stepsize(epsilon, 0.2);
+  EXPECT_FALSE(adaptation.stable());
+
+  adaptation.restart();
+  EXPECT_FALSE(adaptation.stable());
+}
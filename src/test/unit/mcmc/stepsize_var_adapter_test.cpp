@@ -0,0 +1,49 @@
+#include <stan/mcmc/stepsize_var_adapter.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <boost/random/mixmax.hpp>
+#include <boost/random/normal_distribution.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+
+// Runs the adaptation as the adaptive samplers do, with every draw
+// accepted at the target statistic, and returns the number of warmup
+// iterations run before the adaptation converged
+int run_warmup(stan::mcmc::stepsize_var_adapter& adapter, int num_warmup) {
+  boost::random::mixmax rng(0, 0, 0, 0);
+  boost::random::normal_distribution<> std_normal;
+  const double delta = adapter.get_stepsize_adaptation().get_delta();
+  Eigen::VectorXd var = Eigen::VectorXd::Ones(3);
+  Eigen::VectorXd q(3);
+  double epsilon = 1;
+  for (int m = 0; m < num_warmup; ++m) {
+    if (adapter.adaptation_converged())
+      return m;
+    adapter.get_stepsize_adaptation().learn_stepsize(epsilon, delta);
+    for (int i = 0; i < q.size(); ++i)
+      q(i) = std_normal(rng);
+    if (adapter.get_var_adaptation().learn_variance(var, q))
+      adapter.get_stepsize_adaptation().restart();
+  }
+  return num_warmup;
+}
+
+}  // namespace
+
+TEST(McmcStepsizeVarAdapter, fixed_schedule_by_default) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::stepsize_var_adapter adapter(3);
+  adapter.set_window_params(1000, 75, 50, 25, logger);
+  EXPECT_EQ(1000, run_warmup(adapter, 1000));
+}
+
+TEST(McmcStepsizeVarAdapter, stable_stepsize_ends_terminal_buffer) {
+  stan::test::unit::instrumented_logger logger;
+  stan::mcmc::stepsize_var_adapter adapter(3);
+  // Default buffers: the terminal buffer holds the last 50 iterations
+  adapter.set_window_params(1000, 75, 50, 25, logger);
+  adapter.set_adaptive_warmup(0, 0.05);
+  int num_warmup_run = run_warmup(adapter, 1000);
+  EXPECT_GT(num_warmup_run, 950 + 25);
+  EXPECT_LT(num_warmup_run, 1000);
+}
@@ -25,3 +25,35 @@ TEST(McmcVarAdaptation, learn_variance) {
 
   EXPECT_EQ(0, logger.call_count());
 }
+
+TEST(McmcVarAdaptation, convergence_skips_windows) {
+  stan::test::unit::instrumented_logger logger;
+
+  const int n = 3;
+  Eigen::VectorXd q(n);
+  Eigen::VectorXd var(Eigen::VectorXd::Ones(n));
+
+  stan::mcmc::var_adaptation adapter(n);
+  adapter.set_window_params(1000, 75, 50, 25, logger);
+  adapter.set_convergence_tolerance(0.1);
+
+  // Windows end after iterations 100 and 150; the estimates of the two
+  // windows differ by less than the tolerance
+  int num_updates = 0;
+  for (int i = 0; i < 150; ++i) {
+    q.setConstant(i % 2 == 0 ? 1 : -1);
+    num_updates += adapter.learn_variance(var, q);
+  }
+  EXPECT_EQ(2, num_updates);
+  EXPECT_LT(adapter.metric_change(), 0.1);
+  EXPECT_TRUE(adapter.windows_finished());
+  EXPECT_FALSE(adapter.schedule_finished());
+
+  // Only the terminal buffer remains
+  for (int i = 0; i < 50; ++i) {
+    q.setConstant(i % 2 == 0 ? 1 : -1);
+    num_updates += adapter.learn_variance(var, q);
+  }
+  EXPECT_EQ(2, num_updates);
+  EXPECT_TRUE(adapter.schedule_finished());
+}
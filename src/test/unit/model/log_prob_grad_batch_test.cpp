@@ -0,0 +1,53 @@
+#include <stan/model/log_prob_grad.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <gtest/gtest.h>
+
+TEST(ModelUtil, log_prob_grad_batch_matches_log_prob_grad) {
+  stan::io::empty_var_context data_var_context;
+  std::stringstream output;
+  rosenbrock_model_namespace::rosenbrock_model model(data_var_context, 0,
+                                                     &output);
+
+  Eigen::MatrixXd params_r(2, 4);
+  params_r << -1.2, 0.0, 1.0, 2.5, 1.0, 0.5, 1.0, -0.3;
+
+  Eigen::VectorXd log_probs;
+  Eigen::MatrixXd gradients;
+  model.log_prob_grad_batch(params_r, true, true, log_probs, gradients,
+                            &output);
+  ASSERT_EQ(4, log_probs.size());
+  ASSERT_EQ(2, gradients.rows());
+  ASSERT_EQ(4, gradients.cols());
+
+  for (int n = 0; n < params_r.cols(); ++n) {
+    Eigen::VectorXd q = params_r.col(n);
+    Eigen::VectorXd grad;
+    double lp = stan::model::log_prob_grad<true, true>(model, q, grad);
+    EXPECT_EQ(lp, log_probs(n));
+    for (int i = 0; i < q.size(); ++i)
+      EXPECT_EQ(grad(i), gradients(i, n));
+  }
+
+  // Dropping constants and the Jacobian does not change an
+  // unconstrained model without normalizing constants
+  Eigen::VectorXd log_probs_full;
+  Eigen::MatrixXd gradients_full;
+  model.log_prob_grad_batch(params_r, false, false, log_probs_full,
+                            gradients_full, &output);
+  for (int n = 0; n < params_r.cols(); ++n)
+    EXPECT_FLOAT_EQ(log_probs(n), log_probs_full(n));
+  EXPECT_EQ("", output.str());
+}
+
+TEST(ModelUtil, log_prob_grad_batch_empty) {
+  stan::io::empty_var_context data_var_context;
+  rosenbrock_model_namespace::rosenbrock_model model(data_var_context, 0,
+                                                     nullptr);
+  Eigen::MatrixXd params_r(2, 0);
+  Eigen::VectorXd log_probs;
+  Eigen::MatrixXd gradients;
+  model.log_prob_grad_batch(params_r, true, true, log_probs, gradients);
+  EXPECT_EQ(0, log_probs.size());
+  EXPECT_EQ(0, gradients.cols());
+}
@@ -0,0 +1,69 @@
+#include <stan/model/log_prob_hessian.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+class ModelLogProbHessian : public testing::Test {
+ public:
+  ModelLogProbHessian() : model(context, 0, &model_ss), x(2) {
+    x << -1, 1;
+    // Hessian of -((1 - x)^2 + 100 (y - x^2)^2) at (-1, 1)
+    expected.resize(2, 2);
+    expected << -802, -400, -400, -200;
+  }
+
+  std::stringstream model_ss;
+  stan::io::empty_var_context context;
+  rosenbrock_model_namespace::rosenbrock_model model;
+  Eigen::VectorXd x;
+  Eigen::MatrixXd expected;
+};
+
+TEST_F(ModelLogProbHessian, finite_diff_matches_serial) {
+  double lp;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hessian;
+  std::stringstream out;
+  stan::model::log_prob_hessian<true, false>(model, x, lp, grad, hessian,
+                                             false, &out);
+  EXPECT_FLOAT_EQ(-4, lp);
+  ASSERT_EQ(2, grad.size());
+  EXPECT_FLOAT_EQ(4, grad(0));
+  EXPECT_FLOAT_EQ(0, grad(1));
+  ASSERT_EQ(2, hessian.rows());
+  ASSERT_EQ(2, hessian.cols());
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_NEAR(expected(i, j), hessian(i, j), 1e-4);
+  EXPECT_EQ("", out.str());
+
+  auto log_density = [&](const Eigen::Matrix<stan::math::var, -1, 1>& theta) {
+    return model.template log_prob<true, false, stan::math::var>(
+        const_cast<Eigen::Matrix<stan::math::var, -1, 1>&>(theta), &out);
+  };
+  double serial_lp;
+  Eigen::VectorXd serial_grad;
+  Eigen::MatrixXd serial_hessian;
+  stan::math::internal::finite_diff_hessian_auto(log_density, x, serial_lp,
+                                                 serial_grad, serial_hessian);
+  EXPECT_DOUBLE_EQ(serial_lp, lp);
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_DOUBLE_EQ(serial_hessian(i, j), hessian(i, j));
+}
+
+TEST_F(ModelLogProbHessian, hessian_vector_product) {
+  double lp;
+  Eigen::VectorXd grad;
+  Eigen::MatrixXd hessian;
+  stan::model::log_prob_hessian<true, false>(model, x, lp, grad, hessian,
+                                             true);
+  EXPECT_FLOAT_EQ(-4, lp);
+  EXPECT_FLOAT_EQ(4, grad(0));
+  for (int i = 0; i < 2; ++i)
+    for (int j = 0; j < 2; ++j)
+      EXPECT_FLOAT_EQ(expected(i, j), hessian(i, j));
+}
@@ -300,6 +300,36 @@ TEST(OptimizationBfgs, ModelAdaptor_operator_parens__matrix_double_matrix) {
   EXPECT_FLOAT_EQ(mod(cont_vector, f, grad), 0);
 }
 
+TEST(OptimizationBfgs, ModelAdaptor_gradient_in_caller_buffer) {
+  Eigen::Matrix<double, Eigen::Dynamic, 1> cont_vector(2);
+  cont_vector[0] = -1;
+  cont_vector[1] = 1;
+  std::vector<int> disc_vector;
+
+  stan::io::empty_var_context dummy_context;
+  Model rb_model(dummy_context);
+  std::stringstream out;
+  stan::optimization::ModelAdaptor<Model> mod(rb_model, disc_vector, &out);
+
+  Eigen::Matrix<double, Eigen::Dynamic, 1> grad(2);
+  const double* grad_data = grad.data();
+  double f;
+  ASSERT_EQ(0, mod(cont_vector, f, grad));
+  EXPECT_EQ(grad_data, grad.data());
+  EXPECT_FLOAT_EQ(4, f);
+  EXPECT_FLOAT_EQ(-4, grad[0]);
+  EXPECT_FLOAT_EQ(0, grad[1]);
+
+  std::vector<double> cont_std{-1, 1};
+  std::vector<double> grad_std;
+  double lp = stan::model::log_prob_grad<true, false>(rb_model, cont_std,
+                                                      disc_vector, grad_std);
+  EXPECT_FLOAT_EQ(-lp, f);
+  EXPECT_FLOAT_EQ(-grad_std[0], grad[0]);
+  EXPECT_FLOAT_EQ(-grad_std[1], grad[1]);
+  EXPECT_EQ("", out.str());
+}
+
 TEST(OptimizationBfgs, ModelAdaptor_df) {
   Eigen::Matrix<double, Eigen::Dynamic, 1> cont_vector(2);
   cont_vector[0] = -1;
@@ -76,3 +76,23 @@ TEST(OptimizationBfgsUpdate, BFGSUpdate_HInv_search_direction) {
     }
   }
 }
+
+TEST(OptimizationBfgsUpdate, BFGSUpdate_HInv_search_direction_in_place) {
+  typedef stan::optimization::BFGSUpdate_HInv<> QNUpdateT;
+  typedef QNUpdateT::VectorT VectorT;
+
+  const int nDim = 10;
+  QNUpdateT bfgsUp;
+  for (int i = 0; i < 6; i++) {
+    VectorT sk = VectorT::LinSpaced(nDim, 1, i + 1);
+    VectorT yk = sk.cwiseProduct(VectorT::LinSpaced(nDim, 2, 3));
+    bfgsUp.update(yk, sk, i == 0);
+
+    VectorT gk = VectorT::LinSpaced(nDim, -1, i);
+    VectorT sdir(nDim);
+    bfgsUp.search_direction(sdir, gk);
+    bfgsUp.search_direction(gk);
+    for (int j = 0; j < nDim; j++)
+      EXPECT_DOUBLE_EQ(sdir[j], gk[j]);
+  }
+}
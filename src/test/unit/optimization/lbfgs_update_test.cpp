@@ -119,3 +119,23 @@ TEST(OptimizationLbfgsUpdate, search_direction) {
     }
   }
 }
+
+TEST(OptimizationLbfgsUpdate, search_direction_in_place) {
+  typedef stan::optimization::LBFGSUpdate<> QNUpdateT;
+  typedef QNUpdateT::VectorT VectorT;
+
+  const unsigned int nDim = 10;
+  QNUpdateT bfgsUp(4);
+  for (unsigned int i = 0; i < 6; i++) {
+    VectorT sk = VectorT::LinSpaced(nDim, 1, i + 1);
+    VectorT yk = sk.cwiseProduct(VectorT::LinSpaced(nDim, 2, 3));
+    bfgsUp.update(yk, sk, i == 0);
+
+    VectorT gk = VectorT::LinSpaced(nDim, -1, i);
+    VectorT sdir(nDim);
+    bfgsUp.search_direction(sdir, gk);
+    bfgsUp.search_direction(gk);
+    for (unsigned int j = 0; j < nDim; j++)
+      EXPECT_DOUBLE_EQ(sdir[j], gk[j]);
+  }
+}
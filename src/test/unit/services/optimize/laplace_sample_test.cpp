@@ -10,6 +10,7 @@
 #include <test/test-models/good/services/multi_normal.hpp>
 #include <test/unit/services/instrumented_callbacks.hpp>
 #include <test/unit/util.hpp>
+#include <tbb/task_arena.h>
 #include <cmath>
 #include <iostream>
 #include <vector>
@@ -205,3 +206,79 @@ TEST_F(ServicesLaplaceSample, consoleOutput) {
   EXPECT_EQ(1, count_matches("Generating draws\niteration: 0\niteration: 1",
                              console_str));
 }
+
+TEST_F(ServicesLaplaceSample, blockedValues) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  int draws = 50001;  // not a multiple of the block size
+  unsigned int seed = 1234;
+  int refresh = 0;
+  int block_size = 256;
+  stan::callbacks::structured_writer hessian_writer;
+
+  // The draws must not depend on the number of threads
+  std::stringstream serial_ss;
+  stan::callbacks::stream_writer serial_writer(serial_ss, "");
+  tbb::task_arena serial_arena(1);
+  int return_code = serial_arena.execute([&] {
+    return stan::services::laplace_sample<true>(
+        *model, theta_hat, draws, true, seed, refresh, block_size, interrupt,
+        logger, serial_writer, hessian_writer);
+  });
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  tbb::task_arena parallel_arena(4);
+  return_code = parallel_arena.execute([&] {
+    return stan::services::laplace_sample<true>(
+        *model, theta_hat, draws, true, seed, refresh, block_size, interrupt,
+        logger, sample_writer, hessian_writer);
+  });
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+
+  std::stringstream out;
+  stan::io::stan_csv serial_csv
+      = stan::io::stan_csv_reader::parse(serial_ss, &out);
+  stan::io::stan_csv draws_csv
+      = stan::io::stan_csv_reader::parse(sample_ss, &out);
+  ASSERT_EQ(4, draws_csv.header.size());
+  EXPECT_EQ("log_p__", draws_csv.header[0]);
+  EXPECT_EQ("log_q__", draws_csv.header[1]);
+  Eigen::MatrixXd sample = draws_csv.samples;
+  ASSERT_EQ(draws, sample.rows());
+  EXPECT_MATRIX_EQ(serial_csv.samples, sample);
+
+  // because target is normal, laplace approx is exact
+  for (int m = 0; m < draws; ++m) {
+    EXPECT_FLOAT_EQ(0, sample(m, 0) - sample(m, 1));
+  }
+  Eigen::VectorXd y1 = sample.col(2).array() - 2;
+  Eigen::VectorXd y2 = sample.col(3).array() - 3;
+  EXPECT_NEAR(0, y1.mean(), 0.05);
+  EXPECT_NEAR(0, y2.mean(), 0.05);
+  EXPECT_NEAR(1, y1.squaredNorm() / draws, 0.05);
+  EXPECT_NEAR(1, y2.squaredNorm() / draws, 0.05);
+  EXPECT_NEAR(0.8, y1.dot(y2) / draws, 0.05);
+}
+
+TEST_F(ServicesLaplaceSample, blockedConsoleOutput) {
+  Eigen::VectorXd theta_hat(2);
+  theta_hat << 2, 3;
+  std::stringstream sample_ss;
+  stan::callbacks::stream_writer sample_writer(sample_ss, "");
+  stan::callbacks::structured_writer hessian_writer;
+  std::stringstream logger_ss;
+  stan::callbacks::stream_logger sample_logger(logger_ss, logger_ss, logger_ss,
+                                               logger_ss, logger_ss);
+  int return_code = stan::services::laplace_sample<true>(
+      *model, theta_hat, 10, false, 1234, 1, 3, interrupt, sample_logger,
+      sample_writer, hessian_writer);
+  EXPECT_EQ(stan::services::error_codes::OK, return_code);
+  std::string console_str = logger_ss.str();
+  EXPECT_EQ(1, count_matches("Calculating Hessian\nCalculating Cholesky "
+                             "factor\nGenerating draws\niteration: 0\n"
+                             "iteration: 1\niteration: 2\niteration: 3\n",
+                             console_str));
+  EXPECT_EQ(1, count_matches("iteration: 9", console_str));
+}
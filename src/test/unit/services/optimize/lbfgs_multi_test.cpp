@@ -0,0 +1,68 @@
+#include <stan/services/optimize/lbfgs_multi.hpp>
+#include <gtest/gtest.h>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <test/test-models/good/optimization/bimodal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+static constexpr int num_paths = 4;
+
+struct ServicesOptimizeLbfgsMulti : public testing::Test {
+  ServicesOptimizeLbfgsMulti()
+      : init(num_paths),
+        path_ss(num_paths),
+        parameter(parameter_ss),
+        model(context, 0, &model_ss) {
+    for (int i = 0; i < num_paths; ++i)
+      path_parameter.emplace_back(path_ss[i]);
+    // Start two paths near each mode
+    for (double x : {-4.0, -2.0, 2.0, 4.0}) {
+      std::vector<std::vector<size_t>> dims{{}};
+      inits.push_back(std::make_shared<stan::io::array_var_context>(
+          std::vector<std::string>{"x"}, std::vector<double>{x}, dims));
+    }
+  }
+
+  std::stringstream parameter_ss, model_ss;
+  std::vector<std::stringstream> path_ss;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> init;
+  std::vector<stan::test::unit::values_writer> path_parameter;
+  stan::test::unit::values_writer parameter;
+  std::vector<std::shared_ptr<stan::io::array_var_context>> inits;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesOptimizeLbfgsMulti, best_mode) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  int return_code = stan::services::optimize::lbfgs_multi(
+      model, inits, 0, 1, 0, 5, 0.001, 1e-12, 10000, 1e-8, 10000000, 1e-8,
+      2000, false, 0, num_paths, interrupt, logger, init, path_parameter,
+      parameter);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ(num_paths,
+            logger.find_info("Optimization terminated normally: "));
+  EXPECT_EQ(num_paths, logger.find_info("log joint probability = "));
+
+  for (int i = 0; i < num_paths; ++i) {
+    ASSERT_EQ(2, path_parameter[i].names_.size());
+    EXPECT_EQ("lp__", path_parameter[i].names_[0]);
+    ASSERT_EQ(1, path_parameter[i].states_.size());
+    const double mode = i < 2 ? -3 : 3;
+    EXPECT_NEAR(mode, path_parameter[i].states_.back()[1], 1e-3) << i;
+  }
+
+  ASSERT_EQ(2, parameter.names_.size());
+  EXPECT_EQ("lp__", parameter.names_[0]);
+  EXPECT_EQ("x", parameter.names_[1]);
+  ASSERT_EQ(1, parameter.states_.size());
+  EXPECT_NEAR(3, parameter.states_[0][1], 1e-3);
+  EXPECT_GE(parameter.states_[0][0], path_parameter[0].states_.back()[0]);
+  EXPECT_GE(parameter.states_[0][0], path_parameter[3].states_.back()[0]);
+}
@@ -100,11 +100,8 @@ TEST_F(ServicesPathfinderEightSchools, multi) {
       single_path_parameter_writer, single_path_diagnostic_writer, parameter,
       diagnostics);
 
-  Eigen::MatrixXd param_vals(parameter.eigen_states_.size(),
-                             parameter.eigen_states_[0].size());
-  for (size_t i = 0; i < parameter.eigen_states_.size(); ++i) {
-    param_vals.row(i) = parameter.eigen_states_[i];
-  }
+  // The resampled draws are written in batches of columns
+  Eigen::MatrixXd param_vals = parameter.values_.transpose();
 
   Eigen::IOFormat CommaInitFmt(Eigen::StreamPrecision, 0, ", ", ", ", "\n", "",
                                "", "");
@@ -4,6 +4,7 @@
 #include <stan/io/empty_var_context.hpp>
 #include <stan/io/json/json_data.hpp>
 #include <stan/services/pathfinder/multi.hpp>
+#include <stan/callbacks/stream_logger.hpp>
 #include <stan/callbacks/stream_writer.hpp>
 #include <test/test-models/good/services/normal_glm.hpp>
 #include <test/unit/services/instrumented_callbacks.hpp>
@@ -177,6 +178,116 @@ TEST_F(ServicesPathfinderGLM, single_noreturnlp) {
     EXPECT_TRUE(std::isnan(param_vals.coeff(1, num_elbo_draws + i)))
         << "row: " << (num_draws + num_elbo_draws + i);
   }
+  // Without an ELBO schedule the diagnostics have no schedule keys
+  auto json = diagnostic_ss.str();
+  EXPECT_EQ(std::string::npos, json.find("elbo_schedule"));
+  EXPECT_EQ(std::string::npos, json.find("elbo_estimated"));
+}
+
+TEST_F(ServicesPathfinderGLM, single_grain_size) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = false;
+  constexpr int refresh = 0;
+  constexpr bool calculate_lp = true;
+
+  stan::test::mock_callback callback;
+  std::unique_ptr<std::ostream> empty_ostream(nullptr);
+  stan::test::test_logger logger(std::move(empty_ostream));
+
+  // The draws and their log densities do not depend on how the log
+  // density evaluations are split into tasks
+  std::vector<Eigen::MatrixXd> param_vals;
+  for (std::size_t grain_size : {1, 7, 1000}) {
+    stan::io::array_var_context init_context = init_init_context();
+    std::stringstream values_ss;
+    stan::test::in_memory_writer values(values_ss);
+    int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+        model, init_context, seed, chain, init_radius, history_size,
+        init_alpha, tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param,
+        num_iterations, num_elbo_draws, num_draws, save_iterations, refresh,
+        callback, logger, init, values, diagnostics, calculate_lp, grain_size);
+    ASSERT_EQ(rc, 0);
+    param_vals.push_back(std::move(values.values_));
+  }
+  for (std::size_t i = 1; i < param_vals.size(); ++i) {
+    ASSERT_EQ(param_vals[0].rows(), param_vals[i].rows());
+    ASSERT_EQ(param_vals[0].cols(), param_vals[i].cols());
+    for (Eigen::Index j = 0; j < param_vals[0].size(); ++j) {
+      EXPECT_EQ(param_vals[0](j), param_vals[i](j));
+    }
+  }
+}
+
+TEST_F(ServicesPathfinderGLM, single_elbo_schedule) {
+  constexpr unsigned int seed = 3;
+  constexpr unsigned int chain = 1;
+  constexpr double init_radius = 2;
+  constexpr double num_elbo_draws = 80;
+  constexpr double num_draws = 500;
+  constexpr int history_size = 35;
+  constexpr double init_alpha = 1;
+  constexpr double tol_obj = 0;
+  constexpr double tol_rel_obj = 0;
+  constexpr double tol_grad = 0;
+  constexpr double tol_rel_grad = 0;
+  constexpr double tol_param = 0;
+  constexpr int num_iterations = 400;
+  constexpr bool save_iterations = true;
+  constexpr int refresh = 1;
+  constexpr bool calculate_lp = true;
+  constexpr std::size_t grain_size = 1;
+  constexpr int elbo_stride = 3;
+  constexpr int elbo_patience = 5;
+
+  stan::test::mock_callback callback;
+  stan::io::array_var_context init_context = init_init_context();
+  std::stringstream log_ss;
+  stan::callbacks::stream_logger logger(log_ss, log_ss, log_ss, log_ss,
+                                        log_ss);
+
+  int rc = stan::services::pathfinder::pathfinder_lbfgs_single(
+      model, init_context, seed, chain, init_radius, history_size, init_alpha,
+      tol_obj, tol_rel_obj, tol_grad, tol_rel_grad, tol_param, num_iterations,
+      num_elbo_draws, num_draws, save_iterations, refresh, callback, logger,
+      init, parameter, diagnostics, calculate_lp, grain_size, elbo_stride,
+      elbo_patience);
+  ASSERT_EQ(rc, 0);
+  EXPECT_EQ(num_draws, parameter.values_.cols());
+
+  // The posterior is still found with fewer ELBO estimates
+  Eigen::VectorXd mean_vals = parameter.values_.rowwise().mean().eval();
+  Eigen::VectorXd prev_mean_vals = stan::test::normal_glm_param_summary().first;
+  for (int i = 2; i < mean_vals.size(); ++i) {
+    EXPECT_NEAR(prev_mean_vals(i), mean_vals(i), .1);
+  }
+  EXPECT_NE(std::string::npos, log_ss.str().find("log density evaluations"));
+  auto json = diagnostic_ss.str();
+  ASSERT_TRUE(stan::test::is_valid_JSON(json));
+  EXPECT_NE(std::string::npos, json.find("elbo_schedule"));
+  EXPECT_NE(std::string::npos, json.find("lp_evaluations_saved"));
+  // Every LBFGS iteration record has the same success keys, skipped or
+  // not; the record of the initial point has none
+  auto count = [&json](const std::string& key) {
+    std::size_t n = 0;
+    for (auto pos = json.find(key); pos != std::string::npos;
+         pos = json.find(key, pos + 1))
+      ++n;
+    return n;
+  };
+  EXPECT_EQ(count("\"iter\"") - 1, count("\"pathfinder_success\""));
+  EXPECT_EQ(count("\"iter\"") - 1, count("\"elbo_estimated\""));
 }
 
 TEST_F(ServicesPathfinderGLM, multi) {
@@ -219,12 +330,9 @@ TEST_F(ServicesPathfinderGLM, multi) {
       diagnostics);
   ASSERT_EQ(rc, 0);
 
-  Eigen::MatrixXd param_vals(parameter.eigen_states_.size(),
-                             parameter.eigen_states_[0].size());
-  for (size_t i = 0; i < parameter.eigen_states_.size(); ++i) {
-    param_vals.row(i) = parameter.eigen_states_[i];
-  }
-  param_vals.transposeInPlace();
+  // The resampled draws are written in batches of columns
+  Eigen::MatrixXd param_vals = parameter.values_;
+  EXPECT_EQ(num_multi_draws, param_vals.cols());
   Eigen::IOFormat CommaInitFmt(Eigen::StreamPrecision, 0, ", ", ", ", "\n", "",
                                "", "");
 
@@ -175,10 +175,19 @@ class in_memory_writer : public stan::callbacks::stream_writer {
   void operator()(const EigVec& vals) {
     eigen_states_.push_back(vals);
   }
+  /**
+   * Appends the columns of a matrix of values, which can be written over
+   * several calls.
+   */
   template <typename EigMat,
             stan::require_eigen_matrix_dynamic_t<EigMat>* = nullptr>
   void operator()(const EigMat& vals) {
-    values_ = vals;
+    if (values_.size() == 0) {
+      values_ = vals;
+      return;
+    }
+    values_.conservativeResize(Eigen::NoChange, values_.cols() + vals.cols());
+    values_.rightCols(vals.cols()) = vals;
   }
 };
 
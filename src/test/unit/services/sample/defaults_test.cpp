@@ -150,6 +150,18 @@ TEST(sample_defaults, max_depth) {
   EXPECT_EQ(10, max_depth::default_value());
 }
 
+TEST(sample_defaults, metric_rank) {
+  using stan::services::sample::metric_rank;
+  EXPECT_EQ("Maximum rank of the low rank part of the metric.",
+            metric_rank::description());
+
+  EXPECT_NO_THROW(metric_rank::validate(metric_rank::default_value()));
+  EXPECT_NO_THROW(metric_rank::validate(0));
+  EXPECT_THROW(metric_rank::validate(-1), std::invalid_argument);
+
+  EXPECT_EQ(10, metric_rank::default_value());
+}
+
 TEST(sample_defaults, stepsize) {
   using stan::services::sample::stepsize;
   EXPECT_EQ("Step size for discrete evolution.", stepsize::description());
@@ -0,0 +1,86 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/callbacks/structured_writer.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/util/convergence_monitor.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <test/test-models/good/mcmc/hmc/common/gauss3D.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+static constexpr size_t num_chains = 4;
+
+class ServicesSampleHmcNutsDiagEAdaptConvergence : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptConvergence()
+      : metric(num_chains), model(data_context, 0, &model_log) {
+    for (int i = 0; i < num_chains; ++i) {
+      init.push_back(stan::test::unit::instrumented_writer{});
+      parameter.push_back(stan::test::unit::instrumented_writer{});
+      diagnostic.push_back(stan::test::unit::instrumented_writer{});
+      context.push_back(std::make_shared<stan::io::empty_var_context>());
+      inv_metric.push_back(std::make_shared<stan::io::array_var_context>(
+          stan::services::util::create_unit_e_diag_inv_metric(
+              model.num_params_r())));
+    }
+  }
+
+  int run(stan::services::util::convergence_monitor& monitor) {
+    stan::test::unit::instrumented_interrupt interrupt;
+    return stan::services::sample::hmc_nuts_diag_e_adapt(
+        model, num_chains, context, inv_metric, 12345, 1, 2, 200, num_samples,
+        1, false, 0, 1, 0, 10, 0.8, 0.05, 0.75, 10, 75, 50, 25, interrupt,
+        logger, init, parameter, diagnostic, metric, false, false, 0, 0,
+        &monitor);
+  }
+
+  const int num_samples = 2000;
+  stan::io::empty_var_context data_context;
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> init;
+  std::vector<stan::test::unit::instrumented_writer> parameter;
+  std::vector<stan::test::unit::instrumented_writer> diagnostic;
+  std::vector<stan::callbacks::structured_writer> metric;
+  std::vector<std::shared_ptr<stan::io::empty_var_context>> context;
+  std::vector<std::shared_ptr<stan::io::array_var_context>> inv_metric;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptConvergence, stops_when_converged) {
+  stan::services::util::convergence_monitor monitor(num_chains, 1, 100, 1.05,
+                                                    200, 200, true);
+  EXPECT_EQ(0, run(monitor));
+  EXPECT_TRUE(monitor.converged());
+  EXPECT_TRUE(monitor.stop_requested());
+  EXPECT_EQ(1, logger.find_info("Convergence targets met"));
+  EXPECT_GT(logger.find_info("Convergence after"), 0);
+  // Chains which run ahead of the others keep sampling until the check,
+  // so only the total is certain to be short
+  size_t num_draws = 0;
+  for (size_t i = 0; i < num_chains; ++i) {
+    EXPECT_GE(parameter[i].call_count("vector_double"), 100);
+    num_draws += parameter[i].call_count("vector_double");
+  }
+  EXPECT_LT(num_draws, num_chains * num_samples);
+  stan::analyze::online_convergence_summary summary = monitor.summary();
+  ASSERT_TRUE(summary.ready);
+  // lp__ and the three parameters
+  EXPECT_EQ(4, summary.rhat.size());
+  EXPECT_LT(summary.rhat.maxCoeff(), 1.05);
+  EXPECT_GT(summary.ess_bulk.minCoeff(), 200);
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptConvergence, reports_without_stopping) {
+  stan::services::util::convergence_monitor monitor(num_chains, 1, 500, 1.05,
+                                                    200, 200, false);
+  EXPECT_EQ(0, run(monitor));
+  EXPECT_FALSE(monitor.stop_requested());
+  EXPECT_EQ(0, logger.find_info("Convergence targets met"));
+  EXPECT_EQ(num_samples / 500, logger.find_info("Convergence after"));
+  for (size_t i = 0; i < num_chains; ++i)
+    EXPECT_EQ(num_samples, parameter[i].call_count("vector_double"));
+}
@@ -0,0 +1,133 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/services/sample/hmc_nuts_diag_e_adapt_lockstep.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/callbacks/unique_stream_writer.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <src/test/unit/services/util.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <test/unit/util.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+static constexpr size_t num_chains = 4;
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+class ServicesSampleHmcNutsDiagEAdaptLockstep : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptLockstep()
+      : ss_lockstep(num_chains),
+        ss_par(num_chains),
+        ss_metric_lockstep(num_chains),
+        ss_metric_par(num_chains),
+        model(std::make_unique<rosenbrock_model_namespace::rosenbrock_model>(
+            data_context, 0, &model_log)) {
+    for (int i = 0; i < num_chains; ++i) {
+      init.push_back(stan::test::unit::instrumented_writer{});
+      lockstep_parameters.emplace_back(
+          std::unique_ptr<std::stringstream, deleter_noop>(&ss_lockstep[i]),
+          "#");
+      par_parameters.emplace_back(
+          std::unique_ptr<std::stringstream, deleter_noop>(&ss_par[i]), "#");
+      lockstep_metrics.emplace_back(
+          stan::callbacks::json_writer<std::stringstream, deleter_noop>(
+              std::unique_ptr<std::stringstream, deleter_noop>(
+                  &ss_metric_lockstep[i])));
+      par_metrics.emplace_back(
+          stan::callbacks::json_writer<std::stringstream, deleter_noop>(
+              std::unique_ptr<std::stringstream, deleter_noop>(
+                  &ss_metric_par[i])));
+      diagnostics.push_back(stan::test::unit::instrumented_writer{});
+      context.push_back(std::make_shared<stan::io::empty_var_context>());
+      inv_metric.push_back(std::make_shared<stan::io::array_var_context>(
+          stan::services::util::create_unit_e_diag_inv_metric(
+              model->num_params_r())));
+    }
+  }
+
+  stan::io::empty_var_context data_context;
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> init;
+  std::vector<std::stringstream> ss_lockstep;
+  std::vector<std::stringstream> ss_par;
+  std::vector<std::stringstream> ss_metric_lockstep;
+  std::vector<std::stringstream> ss_metric_par;
+  using str_writer
+      = stan::callbacks::unique_stream_writer<std::stringstream, deleter_noop>;
+  std::vector<str_writer> lockstep_parameters;
+  std::vector<str_writer> par_parameters;
+  using json_writer_t
+      = stan::callbacks::json_writer<std::stringstream, deleter_noop>;
+  std::vector<json_writer_t> lockstep_metrics;
+  std::vector<json_writer_t> par_metrics;
+  std::vector<stan::test::unit::instrumented_writer> diagnostics;
+  std::vector<std::shared_ptr<stan::io::empty_var_context>> context;
+  std::vector<std::shared_ptr<stan::io::array_var_context>> inv_metric;
+  std::unique_ptr<rosenbrock_model_namespace::rosenbrock_model> model;
+};
+
+/**
+ * Running the chains in lockstep with batched gradients must give the
+ * same draws and adapted metrics as running them independently.
+ */
+TEST_F(ServicesSampleHmcNutsDiagEAdaptLockstep, matches_parallel_chains) {
+  constexpr unsigned int random_seed = 0;
+  constexpr unsigned int chain = 0;
+  constexpr double init_radius = 0;
+  constexpr int num_warmup = 200;
+  constexpr int num_samples = 400;
+  constexpr int num_thin = 5;
+  constexpr bool save_warmup = true;
+  constexpr int refresh = 0;
+  constexpr double stepsize = 0.1;
+  constexpr double stepsize_jitter = 0;
+  constexpr int max_depth = 8;
+  constexpr double delta = .1;
+  constexpr double gamma = .1;
+  constexpr double kappa = .1;
+  constexpr double t0 = .1;
+  constexpr unsigned int init_buffer = 50;
+  constexpr unsigned int term_buffer = 50;
+  constexpr unsigned int window = 100;
+  stan::test::unit::instrumented_interrupt interrupt;
+
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt_lockstep(
+      *model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, interrupt, logger, init, lockstep_parameters,
+      diagnostics, lockstep_metrics);
+  EXPECT_EQ(0, return_code);
+  EXPECT_EQ((num_warmup + num_samples) * num_chains, interrupt.call_count());
+
+  return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      *model, num_chains, context, inv_metric, random_seed, chain, init_radius,
+      num_warmup, num_samples, num_thin, save_warmup, refresh, stepsize,
+      stepsize_jitter, max_depth, delta, gamma, kappa, t0, init_buffer,
+      term_buffer, window, interrupt, logger, init, par_parameters,
+      diagnostics, par_metrics);
+  EXPECT_EQ(0, return_code);
+
+  for (int i = 0; i < num_chains; ++i) {
+    auto lockstep_str = lockstep_parameters[i].get_stream().str();
+    std::istringstream lockstep_stream(
+        lockstep_str.substr(lockstep_str.find("Diagonal") - 1));
+    Eigen::MatrixXd lockstep_mat
+        = stan::test::read_stan_sample_csv(lockstep_stream, 80, 9);
+
+    auto par_str = par_parameters[i].get_stream().str();
+    std::istringstream par_stream(par_str.substr(par_str.find("Diagonal") - 1));
+    Eigen::MatrixXd par_mat = stan::test::read_stan_sample_csv(par_stream, 80, 9);
+
+    EXPECT_MATRIX_EQ(lockstep_mat, par_mat);
+    EXPECT_EQ(ss_metric_lockstep[i].str(), ss_metric_par[i].str());
+  }
+}
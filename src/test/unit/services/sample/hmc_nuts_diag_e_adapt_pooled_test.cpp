@@ -0,0 +1,87 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/callbacks/json_writer.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <test/test-models/good/optimization/rosenbrock.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <iostream>
+
+auto&& blah = stan::math::init_threadpool_tbb();
+
+static constexpr size_t num_chains = 4;
+
+struct deleter_noop {
+  template <typename T>
+  constexpr void operator()(T* arg) const {}
+};
+class ServicesSampleHmcNutsDiagEAdaptPooled : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptPooled()
+      : ss_metric(num_chains),
+        model(std::make_unique<rosenbrock_model_namespace::rosenbrock_model>(
+            data_context, 0, &model_log)) {
+    for (int i = 0; i < num_chains; ++i) {
+      init.push_back(stan::test::unit::instrumented_writer{});
+      parameters.push_back(stan::test::unit::instrumented_writer{});
+      diagnostics.push_back(stan::test::unit::instrumented_writer{});
+      metrics.emplace_back(
+          stan::callbacks::json_writer<std::stringstream, deleter_noop>(
+              std::unique_ptr<std::stringstream, deleter_noop>(
+                  &ss_metric[i])));
+      context.push_back(std::make_shared<stan::io::empty_var_context>());
+      inv_metric.push_back(std::make_shared<stan::io::array_var_context>(
+          stan::services::util::create_unit_e_diag_inv_metric(
+              model->num_params_r())));
+    }
+  }
+
+  int run(bool pool_adaptation, bool pool_stepsize) {
+    stan::test::unit::instrumented_interrupt interrupt;
+    int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+        *model, num_chains, context, inv_metric, 0, 0, 0, 200, 100, 1, false,
+        0, 0.1, 0, 8, 0.8, 0.05, 0.75, 10, 50, 50, 25, interrupt, logger, init,
+        parameters, diagnostics, metrics, pool_adaptation, pool_stepsize);
+    EXPECT_EQ(300 * num_chains, interrupt.call_count());
+    return return_code;
+  }
+
+  stan::io::empty_var_context data_context;
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  std::vector<stan::test::unit::instrumented_writer> init;
+  std::vector<stan::test::unit::instrumented_writer> parameters;
+  std::vector<stan::test::unit::instrumented_writer> diagnostics;
+  std::vector<std::stringstream> ss_metric;
+  using json_writer_t
+      = stan::callbacks::json_writer<std::stringstream, deleter_noop>;
+  std::vector<json_writer_t> metrics;
+  std::vector<std::shared_ptr<stan::io::empty_var_context>> context;
+  std::vector<std::shared_ptr<stan::io::array_var_context>> inv_metric;
+  std::unique_ptr<rosenbrock_model_namespace::rosenbrock_model> model;
+};
+
+std::string inv_metric_json(const std::string& metric) {
+  return metric.substr(metric.find("inv_metric"));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptPooled, independent_by_default) {
+  EXPECT_EQ(0, run(false, false));
+  for (int i = 1; i < num_chains; ++i)
+    EXPECT_NE(inv_metric_json(ss_metric[0].str()),
+              inv_metric_json(ss_metric[i].str()));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptPooled, shares_metric) {
+  EXPECT_EQ(0, run(true, false));
+  for (int i = 1; i < num_chains; ++i)
+    EXPECT_EQ(inv_metric_json(ss_metric[0].str()),
+              inv_metric_json(ss_metric[i].str()));
+}
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptPooled, shares_metric_and_stepsize) {
+  EXPECT_EQ(0, run(true, true));
+  for (int i = 1; i < num_chains; ++i)
+    EXPECT_EQ(ss_metric[0].str(), ss_metric[i].str());
+}
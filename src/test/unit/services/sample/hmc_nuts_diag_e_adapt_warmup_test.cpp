@@ -0,0 +1,57 @@
+#include <stan/services/sample/hmc_nuts_diag_e_adapt.hpp>
+#include <stan/callbacks/stream_writer.hpp>
+#include <stan/io/array_var_context.hpp>
+#include <stan/io/empty_var_context.hpp>
+#include <stan/io/stan_csv_reader.hpp>
+#include <stan/mcmc/chains.hpp>
+#include <stan/services/util/create_unit_e_diag_inv_metric.hpp>
+#include <test/test-models/good/services/multi_normal.hpp>
+#include <test/unit/services/instrumented_callbacks.hpp>
+#include <gtest/gtest.h>
+#include <sstream>
+
+class ServicesSampleHmcNutsDiagEAdaptWarmup : public testing::Test {
+ public:
+  ServicesSampleHmcNutsDiagEAdaptWarmup() : model(context, 0, &model_log) {}
+
+  std::stringstream model_log;
+  stan::test::unit::instrumented_logger logger;
+  stan::test::unit::instrumented_writer init, diagnostic;
+  stan::io::empty_var_context context;
+  stan_model model;
+};
+
+TEST_F(ServicesSampleHmcNutsDiagEAdaptWarmup, csv_round_trip_save_warmup) {
+  int num_warmup = 1000;
+  int num_samples = 100;
+  std::stringstream sample_ss;
+  sample_ss << "# num_samples = " << num_samples << "\n"
+            << "# num_warmup = " << num_warmup << "\n"
+            << "# save_warmup = 1\n"
+            << "# thin = 1\n";
+  stan::callbacks::stream_writer sample_writer(sample_ss, "# ");
+  stan::callbacks::structured_writer metric_writer;
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::io::array_var_context inv_metric
+      = stan::services::util::create_unit_e_diag_inv_metric(
+          model.num_params_r());
+
+  // Any change of the metric counts as converged, so warmup stops after
+  // the second slow window and the terminal buffer
+  int return_code = stan::services::sample::hmc_nuts_diag_e_adapt(
+      model, context, inv_metric, 0, 1, 2, num_warmup, num_samples, 1, true, 0,
+      1, 0, 10, 0.8, 0.05, 0.75, 10, 75, 50, 25, interrupt, logger, init,
+      sample_writer, diagnostic, metric_writer, 1e10, 0);
+  ASSERT_EQ(0, return_code);
+  ASSERT_EQ(1, logger.find_info("Warmup converged after"));
+
+  stan::io::stan_csv csv = stan::io::stan_csv_reader::parse(sample_ss, 0);
+  ASSERT_LT(csv.metadata.num_warmup, num_warmup);
+  EXPECT_EQ(interrupt.call_count() - num_samples,
+            static_cast<int>(csv.metadata.num_warmup));
+  EXPECT_EQ(csv.metadata.num_warmup + num_samples, csv.samples.rows());
+
+  stan::mcmc::chains<> chains(csv);
+  EXPECT_EQ(csv.metadata.num_warmup, chains.warmup(0));
+  EXPECT_EQ(num_samples, chains.num_kept_samples(0));
+}
@@ -9,6 +9,19 @@
 #include <iostream>
 #include <exception>
 
+// Adapter whose adaptation converges after a fixed number of checks
+class converging_adapter : public stan::mcmc::base_adapter {
+ public:
+  explicit converging_adapter(int num_checks) : num_checks_(num_checks) {}
+
+  bool adaptive_warmup() const { return true; }
+
+  bool adaptation_converged() const { return --num_checks_ < 0; }
+
+ private:
+  mutable int num_checks_;
+};
+
 class ServicesSamplesGenerateTransitions : public testing::Test {
  public:
   ServicesSamplesGenerateTransitions() : model(context, 0, &model_log) {}
@@ -128,3 +141,32 @@ TEST_F(ServicesSamplesGenerateTransitions, output_sizes) {
   EXPECT_EQ(parameter_names[0].size(), parameter_values[0].size());
   EXPECT_EQ(diagnostic_names[0].size(), diagnostic_values[0].size());
 }
+
+TEST_F(ServicesSamplesGenerateTransitions, warmup_stops_when_converged) {
+  stan::test::unit::instrumented_interrupt interrupt;
+  stan::rng_t rng = stan::services::util::create_rng(0, 1);
+
+  std::vector<double> cont_vector = stan::services::util::initialize(
+      model, context, rng, 0, false, logger, diagnostic);
+
+  stan::mcmc::fixed_param_sampler sampler;
+  stan::services::util::mcmc_writer writer(parameter, diagnostic, logger);
+  Eigen::VectorXd cont_params(cont_vector.size());
+  for (size_t i = 0; i < cont_vector.size(); i++)
+    cont_params[i] = cont_vector[i];
+  stan::mcmc::sample s(cont_params, 0, 0);
+
+  converging_adapter adapter(4);
+  int num_run = stan::services::util::generate_transitions(
+      sampler, 10, 0, 20, 1, 0, false, true, writer, s, model, rng, interrupt,
+      logger, 1, 1, nullptr, &adapter);
+  EXPECT_EQ(4, num_run);
+  EXPECT_EQ(4, interrupt.call_count());
+
+  // The adapter is ignored after warmup
+  converging_adapter converged(0);
+  num_run = stan::services::util::generate_transitions(
+      sampler, 10, 0, 20, 1, 0, false, false, writer, s, model, rng,
+      interrupt, logger, 1, 1, nullptr, &converged);
+  EXPECT_EQ(10, num_run);
+}
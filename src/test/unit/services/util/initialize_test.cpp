@@ -1,9 +1,11 @@
 #include <stan/services/util/initialize.hpp>
+#include <stan/services/util/initialize_chains.hpp>
 #include <stan/services/util/create_rng.hpp>
 #include <gtest/gtest.h>
 #include <test/unit/util.hpp>
 #include <stan/callbacks/stream_writer.hpp>
 #include <stan/callbacks/stream_logger.hpp>
+#include <atomic>
 #include <sstream>
 #include <test/test-models/good/services/test_lp.hpp>
 #include <stan/io/empty_var_context.hpp>
@@ -242,9 +244,9 @@ class mock_throwing_model : public stan::model::prob_grad {
       vars__.push_back(params_r__[i]);
   }
 
-  mutable int templated_log_prob_calls;
-  mutable int transform_inits_calls;
-  mutable int write_array_calls;
+  mutable std::atomic<int> templated_log_prob_calls;
+  mutable std::atomic<int> transform_inits_calls;
+  mutable std::atomic<int> write_array_calls;
   double log_prob_return_value;
 };
 
@@ -380,9 +382,9 @@ class mock_error_model : public stan::model::prob_grad {
       vars__.push_back(params_r__[i]);
   }
 
-  mutable int templated_log_prob_calls;
-  mutable int transform_inits_calls;
-  mutable int write_array_calls;
+  mutable std::atomic<int> templated_log_prob_calls;
+  mutable std::atomic<int> transform_inits_calls;
+  mutable std::atomic<int> write_array_calls;
   double log_prob_return_value;
 };
 }  // namespace test
@@ -516,9 +518,9 @@ class mock_throwing_model_in_write_array : public stan::model::prob_grad {
       vars__.push_back(params_r__[i]);
   }
 
-  mutable int templated_log_prob_calls;
-  mutable int transform_inits_calls;
-  mutable int write_array_calls;
+  mutable std::atomic<int> templated_log_prob_calls;
+  mutable std::atomic<int> transform_inits_calls;
+  mutable std::atomic<int> write_array_calls;
   double log_prob_return_value;
 };
 }  // namespace test
@@ -578,3 +580,218 @@ TEST_F(ServicesUtilInitialize, model_throws_in_write_array__full_init) {
   EXPECT_EQ(2, logger.call_count_error());
   EXPECT_EQ(100, logger.find_warn("throwing within write_array"));
 }
+
+TEST_F(ServicesUtilInitialize, radius_two__batch_matches_serial) {
+  stan::rng_t serial_rng = rng;
+  stan::test::unit::instrumented_logger serial_logger;
+  stan::test::unit::instrumented_writer serial_init;
+  std::vector<double> serial_params = stan::services::util::initialize(
+      model, empty_context, serial_rng, 2, true, serial_logger, serial_init);
+
+  std::vector<double> params = stan::services::util::initialize(
+      model, empty_context, rng, 2, true, logger, init, 8);
+  EXPECT_EQ(serial_params, params);
+  EXPECT_EQ(serial_logger.call_count(), logger.call_count());
+  EXPECT_EQ(serial_logger.call_count_info(), logger.call_count_info());
+  ASSERT_EQ(1, init.vector_double_values().size());
+  EXPECT_EQ(params, init.vector_double_values()[0]);
+  EXPECT_EQ(serial_rng(), rng());
+}
+
+namespace test {
+// mock_rejecting_model rejects the initial values listed in rejected, so
+// the same initial values are rejected whichever order they are
+// evaluated in
+class mock_rejecting_model : public stan::model::prob_grad {
+ public:
+  mock_rejecting_model()
+      : stan::model::prob_grad(1), templated_log_prob_calls(0) {}
+
+  template <bool propto__, bool jacobian__, typename T__>
+  T__ log_prob(std::vector<T__>& params_r__, std::vector<int>& params_i__,
+               std::ostream* pstream__ = 0) const {
+    ++templated_log_prob_calls;
+    for (size_t n = 0; n < rejected.size(); ++n) {
+      if (stan::math::value_of(params_r__[0]) == rejected[n]) {
+        std::stringstream msg;
+        msg << "rejecting initial value " << n;
+        throw std::domain_error(msg.str());
+      }
+    }
+    return -0.5 * params_r__[0] * params_r__[0];
+  }
+
+  void transform_inits(const stan::io::var_context& context__,
+                       std::vector<int>& params_i__,
+                       std::vector<double>& params_r__,
+                       std::ostream* pstream__) const {
+    params_r__ = context__.vals_r("theta");
+  }
+
+  void get_dims(std::vector<std::vector<size_t> >& dimss__,
+                bool include_tparams = true, bool include_gqs = true) const {
+    dimss__.resize(0);
+    std::vector<size_t> scalar_dim;
+    dimss__.push_back(scalar_dim);
+  }
+
+  void constrained_param_names(std::vector<std::string>& param_names__,
+                               bool include_tparams__ = true,
+                               bool include_gqs__ = true) const {
+    param_names__.push_back("theta");
+  }
+
+  void get_param_names(std::vector<std::string>& names,
+                       bool include_tparams = true,
+                       bool include_gqs = true) const {
+    constrained_param_names(names);
+  }
+
+  void unconstrained_param_names(std::vector<std::string>& param_names__,
+                                 bool include_tparams__ = true,
+                                 bool include_gqs__ = true) const {
+    param_names__.clear();
+    param_names__.push_back("param_0");
+  }
+
+  template <typename RNG>
+  void write_array(RNG& base_rng__, std::vector<double>& params_r__,
+                   std::vector<int>& params_i__, std::vector<double>& vars__,
+                   bool include_tparams__ = true, bool include_gqs__ = true,
+                   std::ostream* pstream__ = 0) const {
+    vars__ = params_r__;
+  }
+
+  std::vector<double> rejected;
+  mutable std::atomic<int> templated_log_prob_calls;
+};
+
+}  // namespace test
+
+TEST_F(ServicesUtilInitialize, radius_two__batch_rejects_as_serial) {
+  // Reject the first three random initial values, so the fourth one is
+  // selected from the third batch while the values after it are
+  // evaluated speculatively
+  test::mock_rejecting_model rejecting_model;
+  stan::rng_t draw_rng = rng;
+  for (int n = 0; n < 3; ++n) {
+    stan::io::random_var_context candidate(rejecting_model, draw_rng, 2,
+                                           false);
+    rejecting_model.rejected.push_back(candidate.get_unconstrained()[0]);
+  }
+
+  stan::rng_t serial_rng = rng;
+  std::stringstream serial_debug, serial_info, serial_warn, serial_error,
+      serial_fatal;
+  stan::callbacks::stream_logger serial_logger(
+      serial_debug, serial_info, serial_warn, serial_error, serial_fatal);
+  stan::test::unit::instrumented_writer serial_init;
+  std::vector<double> serial_params = stan::services::util::initialize(
+      rejecting_model, empty_context, serial_rng, 2, false, serial_logger,
+      serial_init);
+  // Four values and the gradient at the selected one
+  EXPECT_EQ(5, rejecting_model.templated_log_prob_calls);
+
+  rejecting_model.templated_log_prob_calls = 0;
+  std::stringstream debug, info, warn, error, fatal;
+  stan::callbacks::stream_logger stream_logger(debug, info, warn, error,
+                                               fatal);
+  std::vector<double> params = stan::services::util::initialize(
+      rejecting_model, empty_context, rng, 2, false, stream_logger, init, 8);
+  // Batches of one, two and four values, and the gradients at the valid
+  // values of the last batch
+  EXPECT_EQ(11, rejecting_model.templated_log_prob_calls);
+
+  EXPECT_EQ(serial_params, params);
+  ASSERT_EQ(1, init.vector_double_values().size());
+  EXPECT_EQ(params, init.vector_double_values()[0]);
+  EXPECT_EQ(serial_rng(), rng());
+
+  // The rejections are logged once each, in the order of the serial tries
+  std::stringstream expected_warn;
+  for (int n = 0; n < 3; ++n)
+    expected_warn << "Rejecting initial value:" << std::endl
+                  << "  Error evaluating the log probability at the initial"
+                  << " value." << std::endl
+                  << "rejecting initial value " << n << std::endl;
+  EXPECT_EQ(expected_warn.str(), serial_warn.str());
+  EXPECT_EQ(serial_warn.str(), warn.str());
+  EXPECT_EQ(serial_info.str(), info.str());
+  EXPECT_EQ(serial_error.str(), error.str());
+  EXPECT_EQ("", error.str());
+}
+
+TEST_F(ServicesUtilInitialize, model_throws__radius_two__batch) {
+  test::mock_throwing_model throwing_model;
+
+  double init_radius = 2;
+  bool print_timing = false;
+  EXPECT_THROW(stan::services::util::initialize(throwing_model, empty_context,
+                                                rng, init_radius, print_timing,
+                                                logger, init, 8),
+               std::domain_error);
+  EXPECT_EQ(303, logger.call_count());
+  EXPECT_EQ(300, logger.call_count_warn());
+  EXPECT_EQ(100, logger.find_warn("throwing within log_prob"));
+  EXPECT_EQ(0, init.vector_double_values().size());
+}
+
+TEST_F(ServicesUtilInitialize, model_errors__radius_two__batch) {
+  test::mock_error_model error_model;
+
+  double init_radius = 2;
+  bool print_timing = false;
+  EXPECT_THROW_MSG(stan::services::util::initialize(
+                       error_model, empty_context, rng, init_radius,
+                       print_timing, logger, init, 8),
+                   std::out_of_range, "out_of_range error in log_prob");
+  EXPECT_EQ(1, logger.call_count());
+  EXPECT_EQ(1, logger.call_count_error());
+}
+
+TEST_F(ServicesUtilInitialize, initialize_chains) {
+  const size_t num_chains = 3;
+  std::vector<stan::io::empty_var_context*> inits(num_chains,
+                                                  &empty_context);
+  std::vector<stan::rng_t> rngs;
+  std::vector<stan::rng_t> serial_rngs;
+  for (size_t i = 0; i < num_chains; ++i) {
+    rngs.emplace_back(stan::services::util::create_rng(0, i + 1));
+    serial_rngs.emplace_back(stan::services::util::create_rng(0, i + 1));
+  }
+  std::vector<stan::test::unit::instrumented_writer> init_writers(num_chains);
+  std::vector<std::vector<double>> params
+      = stan::services::util::initialize_chains(model, inits, rngs, 2, false,
+                                                logger, init_writers, 4);
+  ASSERT_EQ(num_chains, params.size());
+  for (size_t i = 0; i < num_chains; ++i) {
+    stan::test::unit::instrumented_logger serial_logger;
+    stan::test::unit::instrumented_writer serial_init;
+    EXPECT_EQ(stan::services::util::initialize(model, empty_context,
+                                               serial_rngs[i], 2, false,
+                                               serial_logger, serial_init),
+              params[i]);
+    ASSERT_EQ(1, init_writers[i].vector_double_values().size());
+    EXPECT_EQ(params[i], init_writers[i].vector_double_values()[0]);
+    EXPECT_EQ(serial_rngs[i](), rngs[i]());
+  }
+  EXPECT_EQ(0, logger.call_count());
+}
+
+TEST_F(ServicesUtilInitialize, initialize_chains__model_throws) {
+  test::mock_throwing_model throwing_model;
+  const size_t num_chains = 2;
+  std::vector<stan::io::empty_var_context*> inits(num_chains,
+                                                  &empty_context);
+  std::vector<stan::rng_t> rngs;
+  for (size_t i = 0; i < num_chains; ++i)
+    rngs.emplace_back(stan::services::util::create_rng(0, i + 1));
+  std::vector<stan::test::unit::instrumented_writer> init_writers(num_chains);
+  EXPECT_THROW(stan::services::util::initialize_chains(
+                   throwing_model, inits, rngs, 2, false, logger,
+                   init_writers),
+               std::domain_error);
+  // Only the messages of the first chain are logged
+  EXPECT_EQ(303, logger.call_count());
+  EXPECT_EQ(100, logger.find_warn("throwing within log_prob"));
+}
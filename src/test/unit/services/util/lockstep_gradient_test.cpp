@@ -0,0 +1,80 @@
+#include <stan/services/util/lockstep_gradient.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <test/unit/mcmc/hmc/mock_hmc.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Standard normal restricted to a positive first coordinate
+class batch_model : public stan::mcmc::mock_model {
+ public:
+  explicit batch_model(size_t num_params_r)
+      : stan::mcmc::mock_model(num_params_r) {}
+
+  void log_prob_grad_batch(const Eigen::MatrixXd& params_r, bool propto,
+                           bool jacobian, Eigen::VectorXd& log_probs,
+                           Eigen::MatrixXd& gradients,
+                           std::ostream* msgs = nullptr) const {
+    log_probs.resize(params_r.cols());
+    gradients.resize(params_r.rows(), params_r.cols());
+    for (Eigen::Index n = 0; n < params_r.cols(); ++n) {
+      if (params_r(0, n) < 0)
+        throw std::domain_error("first coordinate is negative");
+      log_probs(n) = -0.5 * params_r.col(n).squaredNorm();
+      gradients.col(n) = -params_r.col(n);
+    }
+  }
+};
+
+typedef stan::mcmc::mock_hamiltonian<batch_model, stan::rng_t> hamiltonian_t;
+
+}  // namespace
+
+TEST(ServicesUtilLockstepGradient, rejects_point_of_one_chain) {
+  const int num_chains = 2;
+  batch_model model(2);
+  stan::services::util::lockstep_gradient<batch_model> lockstep(model,
+                                                                num_chains);
+  std::vector<stan::mcmc::ps_point> z(num_chains, stan::mcmc::ps_point(2));
+  z[0].q << 1, 2;
+  z[1].q << -1, 0;
+  std::vector<std::stringstream> error(num_chains);
+
+  for (int i = 0; i < num_chains; ++i)
+    lockstep.begin_chain();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_chains; ++i) {
+    threads.emplace_back([&, i] {
+      std::stringstream debug, info, warn, fatal;
+      stan::callbacks::stream_logger logger(debug, info, warn, error[i],
+                                            fatal);
+      hamiltonian_t hamiltonian(model);
+      hamiltonian.set_gradient_evaluator(&lockstep.evaluator(i));
+      hamiltonian.update_potential_gradient(z[i], logger);
+      lockstep.end_chain(logger);
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(1, lockstep.num_batches());
+
+  // The other chain's point is evaluated as if it were alone
+  EXPECT_FLOAT_EQ(2.5, z[0].V);
+  EXPECT_FLOAT_EQ(1, z[0].g(0));
+  EXPECT_FLOAT_EQ(2, z[0].g(1));
+  EXPECT_EQ("", error[0].str());
+
+  // The rejected point is handled as when evaluating the model directly
+  EXPECT_EQ(std::numeric_limits<double>::infinity(), z[1].V);
+  EXPECT_NE(std::string::npos,
+            error[1].str().find("Metropolis proposal is about to be "
+                                "rejected"));
+  EXPECT_NE(std::string::npos,
+            error[1].str().find("first coordinate is negative"));
+}
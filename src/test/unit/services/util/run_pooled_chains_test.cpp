@@ -0,0 +1,58 @@
+#include <stan/services/util/run_pooled_chains.hpp>
+#include <stan/math/rev.hpp>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+// Gradient of sum_i (chain + 1) * x_i^2 at x taken with reverse mode
+// autodiff on the calling thread
+Eigen::VectorXd chain_gradient(int chain, const Eigen::VectorXd& x) {
+  double fx;
+  Eigen::VectorXd grad;
+  auto f = [chain](const auto& y) {
+    return (chain + 1.0) * stan::math::dot_self(y);
+  };
+  stan::math::gradient(f, x, fx, grad);
+  return grad;
+}
+
+}  // namespace
+
+TEST(ServicesUtilRunPooledChains, chains_take_gradients) {
+  const int num_chains = 4;
+  stan::mcmc::pooled_adaptation pool(num_chains, true);
+  Eigen::VectorXd x(3);
+  x << 1, -2, 0.5;
+  std::vector<Eigen::VectorXd> grads(num_chains);
+  std::vector<double> stepsizes(num_chains);
+  stan::services::util::run_pooled_chains(pool, [&](size_t i) {
+    // Wait for every chain to be running before differentiating
+    stepsizes[i] = std::exp(static_cast<double>(i));
+    pool.pool_stepsize(i, stepsizes[i]);
+    for (int n = 0; n < 100; ++n)
+      grads[i] = chain_gradient(i, x);
+  });
+  for (int i = 0; i < num_chains; ++i) {
+    EXPECT_FLOAT_EQ(std::exp(1.5), stepsizes[i]);
+    for (int n = 0; n < x.size(); ++n)
+      EXPECT_FLOAT_EQ(2 * (i + 1) * x(n), grads[i](n));
+  }
+}
+
+TEST(ServicesUtilRunPooledChains, rethrows_after_all_chains) {
+  const int num_chains = 3;
+  stan::mcmc::pooled_adaptation pool(num_chains);
+  std::vector<int> done(num_chains, 0);
+  auto run_chain = [&done](size_t i) {
+    if (i == 1)
+      throw std::domain_error("chain 1");
+    done[i] = 1;
+  };
+  EXPECT_THROW(stan::services::util::run_pooled_chains(pool, run_chain),
+               std::domain_error);
+  EXPECT_EQ(1, done[0]);
+  EXPECT_EQ(0, done[1]);
+  EXPECT_EQ(1, done[2]);
+}
@@ -233,3 +233,54 @@ TEST(advi_test, multivar_no_constraint_meanfield) {
                                           n_monte_carlo_grad, base_rng, logger),
                    std::invalid_argument, error);
 }
+
+TEST(advi_test, multivar_no_constraint_parallel_monte_carlo) {
+  stan::io::empty_var_context dummy_context;
+  Model my_model(dummy_context);
+  std::stringstream log_stream;
+  stan::callbacks::stream_logger logger(log_stream, log_stream, log_stream,
+                                        log_stream, log_stream);
+  Eigen::VectorXd cont_params = Eigen::VectorXd::Constant(2, 0.75);
+
+  Eigen::VectorXd mu = Eigen::VectorXd::Constant(my_model.num_params_r(), 2.5);
+  Eigen::MatrixXd L_chol = Eigen::MatrixXd::Identity(my_model.num_params_r(),
+                                                     my_model.num_params_r());
+  stan::variational::normal_fullrank muL(mu, L_chol);
+  stan::variational::normal_meanfield musigmatilde(
+      mu, Eigen::VectorXd::Zero(my_model.num_params_r()));
+
+  // Same analytical ELBO as above
+  double zeta = -0.5 * (3 * 2 * log(2.0 * stan::math::pi()) + 18.5 + 25 + 13);
+  Eigen::VectorXd mu_J(2);
+  mu_J << 10.5, 7.5;
+  double elbo_true = zeta + mu_J.dot(mu) - 0.5 * (3 * mu.dot(mu) + 3 * 2)
+                     + 1 + log(2.0 * stan::math::pi());
+
+  stan::rng_t fullrank_rng = stan::services::util::create_rng(0, 0);
+  stan::variational::advi<Model, stan::variational::normal_fullrank,
+                          stan::rng_t>
+      fullrank_advi(my_model, cont_params, fullrank_rng, 10, 1e4, 100, 1,
+                    true);
+  EXPECT_NEAR(elbo_true, fullrank_advi.calc_ELBO(muL, logger), 0.1);
+
+  stan::rng_t meanfield_rng = stan::services::util::create_rng(0, 0);
+  stan::variational::advi<Model, stan::variational::normal_meanfield,
+                          stan::rng_t>
+      meanfield_advi(my_model, cont_params, meanfield_rng, 10, 1e4, 100, 1,
+                     true);
+  EXPECT_NEAR(elbo_true, meanfield_advi.calc_ELBO(musigmatilde, logger), 0.1);
+
+  // Gradients depend only on the seed
+  stan::variational::normal_fullrank grad_a(my_model.num_params_r());
+  stan::variational::normal_fullrank grad_b(my_model.num_params_r());
+  stan::rng_t rng_a = stan::services::util::create_rng(7, 0);
+  stan::rng_t rng_b = stan::services::util::create_rng(7, 0);
+  muL.calc_grad_parallel(grad_a, my_model, cont_params, 100, rng_a, logger);
+  muL.calc_grad_parallel(grad_b, my_model, cont_params, 100, rng_b, logger);
+  for (int i = 0; i < my_model.num_params_r(); ++i) {
+    EXPECT_EQ(grad_a.mu()(i), grad_b.mu()(i));
+    for (int j = 0; j < my_model.num_params_r(); ++j)
+      EXPECT_EQ(grad_a.L_chol()(i, j), grad_b.L_chol()(i, j));
+  }
+  EXPECT_EQ(0, grad_a.L_chol()(0, 1));
+}
@@ -4,6 +4,7 @@
 #include <stan/io/empty_var_context.hpp>
 #include <gtest/gtest.h>
 #include <test/unit/util.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -62,3 +63,48 @@ TEST_F(eta_adapt_small_test, eta_should_be_small) {
   EXPECT_EQ(0.1, advi_meanfield_->adapt_eta(meanfield_init, 1000, logger));
   EXPECT_EQ(0.1, advi_fullrank_->adapt_eta(fullrank_init, 1000, logger));
 }
+
+TEST_F(eta_adapt_small_test, eta_should_be_small_concurrent) {
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params_);
+  stan::variational::normal_fullrank fullrank_init
+      = stan::variational::normal_fullrank(cont_params_);
+
+  stan::variational::advi<stan_model, stan::variational::normal_meanfield,
+                          stan::rng_t>
+      advi_meanfield(*model_, cont_params_, base_rng_, 1, 100, 100, 1, false,
+                     true);
+  stan::variational::advi<stan_model, stan::variational::normal_fullrank,
+                          stan::rng_t>
+      advi_fullrank(*model_, cont_params_, base_rng_, 1, 100, 100, 1, false,
+                    true);
+
+  EXPECT_EQ(0.1, advi_meanfield.adapt_eta(meanfield_init, 1000, logger));
+  EXPECT_EQ(0.1, advi_fullrank.adapt_eta(fullrank_init, 1000, logger));
+
+  // Every candidate reports its ELBO trace, in order of the sequence
+  std::string log = log_stream_.str();
+  size_t eta_100 = log.find("eta = 100: ELBO = ");
+  size_t eta_001 = log.find("eta = 0.01: ELBO = ");
+  ASSERT_NE(std::string::npos, eta_100);
+  ASSERT_NE(std::string::npos, eta_001);
+  EXPECT_LT(eta_100, eta_001);
+
+  // One ELBO every 100 iterations, the last one after adaptation
+  std::string trace = log.substr(eta_001, log.find('\n', eta_001) - eta_001);
+  EXPECT_EQ(9, std::count(trace.begin(), trace.end(), ','));
+}
+
+TEST_F(eta_adapt_small_test, eta_concurrent_highest_elbo) {
+  stan::variational::normal_meanfield meanfield_init
+      = stan::variational::normal_meanfield(cont_params_);
+
+  stan::variational::advi<stan_model, stan::variational::normal_meanfield,
+                          stan::rng_t>
+      advi_meanfield(*model_, cont_params_, base_rng_, 1, 100, 100, 1, false,
+                     true, false);
+
+  // Without the early exit all candidates compete, and the large step
+  // sizes diverge on this model
+  EXPECT_GE(0.1, advi_meanfield.adapt_eta(meanfield_init, 1000, logger));
+}
@@ -139,6 +139,31 @@ TEST(normal_fullrank_test, transform) {
   EXPECT_THROW(my_normal_fullrank.transform(x_nan);, std::domain_error);
 }
 
+TEST(normal_fullrank_test, transform_draws) {
+  Eigen::Vector3d mu;
+  mu << 5.7, -3.2, 0.1332;
+
+  Eigen::Matrix3d L;
+  L << 1.3, 0, 0, 2.3, 41, 0, 3.3, 42, 92;
+
+  stan::variational::normal_fullrank my_normal_fullrank(mu, L);
+
+  Eigen::MatrixXd x(3, 4);
+  x << 7.1, -9.2, 0.59, 1, 0.3, 2.5, -1.1, 0, -4, 0.25, 3.75, -2;
+
+  Eigen::MatrixXd x_result = my_normal_fullrank.transform_draws(x);
+  ASSERT_EQ(3, x_result.rows());
+  ASSERT_EQ(4, x_result.cols());
+  for (int j = 0; j < x.cols(); ++j) {
+    Eigen::VectorXd column = my_normal_fullrank.transform(x.col(j));
+    for (int i = 0; i < my_normal_fullrank.dimension(); ++i)
+      EXPECT_FLOAT_EQ(column(i), x_result(i, j));
+  }
+
+  EXPECT_THROW(my_normal_fullrank.transform_draws(Eigen::MatrixXd(2, 4)),
+               std::invalid_argument);
+}
+
 TEST(normal_fullrank_test, calc_log_g) {
   Eigen::Vector3d x;
   x << 7.1, -9.2, 0.59;
@@ -135,6 +135,31 @@ TEST(normal_meanfield_test, transform) {
   EXPECT_THROW(my_normal_meanfield.transform(x_nan);, std::domain_error);
 }
 
+TEST(normal_meanfield_test, transform_draws) {
+  Eigen::Vector3d mu;
+  mu << 5.7, -3.2, 0.1332;
+
+  Eigen::Vector3d omega;
+  omega << -0.42, 0.8922, 13.4;
+
+  stan::variational::normal_meanfield my_normal_meanfield(mu, omega);
+
+  Eigen::MatrixXd x(3, 4);
+  x << 7.1, -9.2, 0.59, 1, 0.3, 2.5, -1.1, 0, -4, 0.25, 3.75, -2;
+
+  Eigen::MatrixXd x_result = my_normal_meanfield.transform_draws(x);
+  ASSERT_EQ(3, x_result.rows());
+  ASSERT_EQ(4, x_result.cols());
+  for (int j = 0; j < x.cols(); ++j) {
+    Eigen::VectorXd column = my_normal_meanfield.transform(x.col(j));
+    for (int i = 0; i < my_normal_meanfield.dimension(); ++i)
+      EXPECT_FLOAT_EQ(column(i), x_result(i, j));
+  }
+
+  EXPECT_THROW(my_normal_meanfield.transform_draws(Eigen::MatrixXd(2, 4)),
+               std::invalid_argument);
+}
+
 TEST(normal_meanfield_test, calc_log_g) {
   Eigen::Vector3d x;
   x << 7.1, -9.2, 0.59;
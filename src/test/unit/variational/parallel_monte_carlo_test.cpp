@@ -0,0 +1,71 @@
+#include <stan/variational/parallel_monte_carlo.hpp>
+#include <stan/callbacks/stream_logger.hpp>
+#include <stan/services/util/create_rng.hpp>
+#include <tbb/task_arena.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <stdexcept>
+
+class ParallelMonteCarlo : public testing::Test {
+ public:
+  ParallelMonteCarlo() : logger(log, log, log, log, log) {}
+
+  /**
+   * Sum of the evaluations of draws which drop every third attempt,
+   * computed on the specified number of threads.
+   */
+  double sum_draws(int num_threads) {
+    stan::rng_t rng = stan::services::util::create_rng(1234, 0);
+    stan::variational::parallel_monte_carlo draws(rng, 50);
+    Eigen::MatrixXd eta = draws.standard_normal(3);
+    Eigen::VectorXd values(draws.size());
+    tbb::task_arena arena(num_threads);
+    arena.execute([&] {
+      draws.evaluate(
+          [&](int i, int attempt, std::ostream& msgs) {
+            if (attempt > 0)
+              eta(0, i) = stan::math::normal_rng(0, 1, draws.rng(i));
+            if (attempt == 0 && i % 3 == 0)
+              return false;
+            if (i == 7)
+              msgs << "draw 7";
+            values(i) = eta.col(i).sum();
+            return true;
+          },
+          100, "sum_draws", logger);
+    });
+    return values.sum();
+  }
+
+  std::stringstream log;
+  stan::callbacks::stream_logger logger;
+};
+
+TEST_F(ParallelMonteCarlo, independent_of_threads) {
+  double serial = sum_draws(1);
+  EXPECT_EQ(serial, sum_draws(4));
+  EXPECT_EQ(serial, sum_draws(2));
+  EXPECT_EQ("draw 7\ndraw 7\ndraw 7\n", log.str());
+}
+
+TEST_F(ParallelMonteCarlo, draws_differ) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 0);
+  stan::variational::parallel_monte_carlo draws(rng, 4);
+  Eigen::MatrixXd eta = draws.standard_normal(2);
+  for (int i = 1; i < 4; ++i)
+    EXPECT_NE(eta(0, 0), eta(0, i));
+  // The stream seed is taken from the caller's generator
+  stan::variational::parallel_monte_carlo next(rng, 4);
+  EXPECT_NE(eta(0, 0), next.standard_normal(2)(0, 0));
+}
+
+TEST_F(ParallelMonteCarlo, too_many_drops) {
+  stan::rng_t rng = stan::services::util::create_rng(1234, 0);
+  stan::variational::parallel_monte_carlo draws(rng, 5);
+  EXPECT_THROW(draws.evaluate(
+                   [](int i, int attempt, std::ostream& msgs) {
+                     return i != 2;
+                   },
+                   5, "too_many_drops", logger),
+               std::domain_error);
+}